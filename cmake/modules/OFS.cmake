@@ -53,3 +53,27 @@ target_link_libraries(${driver} PUBLIC
 endmacro(ofs_add_driver yml_file)
 
 
+
+macro(ofs_add_csr_header yml_file name)
+    add_custom_command(
+        OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${name}_csr.h
+        COMMAND ${PYTHON_EXECUTABLE} ${OPAE_LIBS_ROOT}/scripts/ofs/ofs_parse.py
+        ${CMAKE_CURRENT_LIST_DIR}/${yml_file} headers csr ${CMAKE_CURRENT_BINARY_DIR} --use-local-refs
+        WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+        DEPENDS
+            ${CMAKE_CURRENT_LIST_DIR}/${yml_file}
+            ${OPAE_LIBS_ROOT}/scripts/ofs/ofs_parse.py
+    )
+    add_custom_target(${name}_csr_header
+        DEPENDS ${CMAKE_CURRENT_BINARY_DIR}/${name}_csr.h
+    )
+    add_library(${name}_csr INTERFACE)
+    add_dependencies(${name}_csr ${name}_csr_header)
+    target_include_directories(${name}_csr INTERFACE
+        $<BUILD_INTERFACE:${CMAKE_CURRENT_BINARY_DIR}>
+        $<BUILD_INTERFACE:${OPAE_INCLUDE_PATH}>
+    )
+    target_link_libraries(${name}_csr INTERFACE
+        opae-cxx-core
+    )
+endmacro(ofs_add_csr_header yml_file name)
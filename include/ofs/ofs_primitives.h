@@ -27,6 +27,7 @@
 #define OFS_PRIMITIVES_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
 #define SEC2NSEC 1000000000
@@ -53,6 +54,8 @@
 	while(_bit != _value) {                                             \
 		if (_sleep_usec)                                            \
 			nanosleep(&ts, NULL);                               \
+		else                                                        \
+			ofs_cpu_relax();                                    \
 		clock_gettime(CLOCK_MONOTONIC, &now);                       \
 		struct timespec delta;                                      \
 		ofs_diff_timespec(&delta, &now, &begin);                    \
@@ -74,6 +77,8 @@
 	while(_bit == _value) {                                             \
 		if (_sleep_usec)                                            \
 			nanosleep(&ts, NULL);                               \
+		else                                                        \
+			ofs_cpu_relax();                                    \
 		clock_gettime(CLOCK_MONOTONIC, &now);                       \
 		struct timespec delta;                                      \
 		ofs_diff_timespec(&delta, &now, &begin);                    \
@@ -86,10 +91,200 @@
         _status;                                                            \
 })                                                                          \
 
+/*
+ * Adaptive versions of OFS_WAIT_FOR_EQ/NE. _bit is usually a register
+ * bitfield, which has no address to monitor, so these never use the
+ * umonitor/umwait tier of the policy (OFS_WAIT_UMWAIT); use
+ * ofs_adaptive_wait_for_* to wait on a variable in memory.
+ */
+#define OFS_ADAPTIVE_WAIT_FOR_EQ(_bit, _value, _timeout_usec, _policy,      \
+				 _elapsed_nsec)                             \
+({                                                                          \
+	int _status = 0;                                                    \
+	struct ofs_wait _w;                                                 \
+	uint64_t *_elapsed = (_elapsed_nsec);                               \
+	ofs_wait_begin(&_w, _timeout_usec, _policy);                        \
+	while(_bit != _value) {                                             \
+		if (ofs_wait_backoff(&_w, NULL)) {                          \
+			_status = 1;                                        \
+			break;                                              \
+		}                                                           \
+	}                                                                   \
+	if (_elapsed)                                                       \
+		*_elapsed = ofs_wait_elapsed_nsec(&_w);                     \
+	_status;                                                            \
+})                                                                          \
+
+#define OFS_ADAPTIVE_WAIT_FOR_NE(_bit, _value, _timeout_usec, _policy,      \
+				 _elapsed_nsec)                             \
+({                                                                          \
+	int _status = 0;                                                    \
+	struct ofs_wait _w;                                                 \
+	uint64_t *_elapsed = (_elapsed_nsec);                               \
+	ofs_wait_begin(&_w, _timeout_usec, _policy);                        \
+	while(_bit == _value) {                                             \
+		if (ofs_wait_backoff(&_w, NULL)) {                          \
+			_status = 1;                                        \
+			break;                                              \
+		}                                                           \
+	}                                                                   \
+	if (_elapsed)                                                       \
+		*_elapsed = ofs_wait_elapsed_nsec(&_w);                     \
+	_status;                                                            \
+})                                                                          \
+
+/**
+ * Use umonitor/umwait (when supported by the CPU) instead of nanosleep
+ * in the sleep phase of an adaptive wait. The wait then ends as soon as
+ * the monitored cache line is written. Only meaningful for variables in
+ * write-back memory (eg DMA buffers), not for MMIO registers.
+ */
+#define OFS_WAIT_UMWAIT 0x1
+
+/**
+ *  Adaptive wait policy
+ *
+ *  A waiter first busy-polls with a CPU pause hint for spin_usec. It then
+ *  sleeps, starting at sleep_usec and doubling the interval on each
+ *  iteration up to max_sleep_usec. The sleep is never longer than the
+ *  time left before the timeout.
+ */
+struct ofs_wait_policy {
+	uint64_t spin_usec;      /**< Busy-poll period before sleeping */
+	uint32_t sleep_usec;     /**< First sleep interval */
+	uint32_t max_sleep_usec; /**< Upper bound of the sleep interval */
+	uint32_t flags;          /**< Bitmask of OFS_WAIT_* flags */
+};
+
+#define OFS_WAIT_DEFAULT_SPIN_USEC 10
+#define OFS_WAIT_DEFAULT_SLEEP_USEC 1
+#define OFS_WAIT_DEFAULT_MAX_SLEEP_USEC 100
+
+/**
+ *  Adaptive wait state
+ *
+ *  All times are in ticks of the wait clock, which is the TSC when it is
+ *  invariant and CLOCK_MONOTONIC nanoseconds otherwise.
+ */
+struct ofs_wait {
+	uint64_t begin;
+	uint64_t spin_end;
+	uint64_t deadline;
+	uint32_t sleep_usec;
+	uint32_t max_sleep_usec;
+	uint32_t flags;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ *  Hint to the CPU that the caller is in a spin loop.
+ */
+inline void ofs_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	__asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ *  Read the adaptive wait clock
+ *
+ *  @returns The current time in wait clock ticks
+ */
+uint64_t ofs_wait_clock(void);
+
+/**
+ *  Convert wait clock ticks to nanoseconds
+ *
+ *  @param[in] ticks Number of wait clock ticks
+ *  @returns ticks expressed in nanoseconds
+ */
+uint64_t ofs_wait_ticks_to_nsec(uint64_t ticks);
+
+/**
+ *  Start an adaptive wait
+ *
+ *  The first call calibrates the wait clock.
+ *
+ *  @param[out] w           Wait state to initialize
+ *  @param[in] timeout_usec Timeout value in usec
+ *  @param[in] policy       Wait policy or NULL for the default policy
+ */
+void ofs_wait_begin(struct ofs_wait *w, uint64_t timeout_usec,
+		    const struct ofs_wait_policy *policy);
+
+/**
+ *  Back off once while the wait condition is not yet met
+ *
+ *  Pauses during the spin phase, then sleeps with an increasing interval.
+ *  With OFS_WAIT_UMWAIT, the sleep is a umwait on the cache line at
+ *  monitor_addr (when not NULL and the CPU supports it).
+ *
+ *  @param[in] w            Wait state from ofs_wait_begin
+ *  @param[in] monitor_addr Address to monitor or NULL
+ *  @returns 0 if the caller should check its condition again,
+ *           1 if the timeout expired
+ */
+int ofs_wait_backoff(struct ofs_wait *w, volatile void *monitor_addr);
+
+/**
+ *  Get the time elapsed since ofs_wait_begin
+ *
+ *  @param[in] w Wait state from ofs_wait_begin
+ *  @returns Elapsed time in nsec
+ */
+uint64_t ofs_wait_elapsed_nsec(const struct ofs_wait *w);
+
+/**
+ *  Adaptively wait for a 32-bit variable to equal a given value
+ *
+ *  @param[in] var           Pointer to a variable that may change
+ *  @param[in] value         Value to compare to var
+ *  @param[in] timeout_usec  Timeout value in usec
+ *  @param[in] policy        Wait policy or NULL for the default policy
+ *  @param[out] elapsed_nsec Time spent waiting in nsec (may be NULL)
+ *  @returns 0 if variable changed to value while waiting, 1 otherwise
+ */
+int ofs_adaptive_wait_for_eq32(volatile uint32_t *var, uint32_t value,
+			       uint64_t timeout_usec,
+			       const struct ofs_wait_policy *policy,
+			       uint64_t *elapsed_nsec);
+
+/**
+ *  Adaptively wait for a 64-bit variable to equal a given value
+ *
+ *  @see ofs_adaptive_wait_for_eq32
+ */
+int ofs_adaptive_wait_for_eq64(volatile uint64_t *var, uint64_t value,
+			       uint64_t timeout_usec,
+			       const struct ofs_wait_policy *policy,
+			       uint64_t *elapsed_nsec);
+
+/**
+ *  Adaptively wait for a 32-bit variable to differ from a given value
+ *
+ *  @see ofs_adaptive_wait_for_eq32
+ */
+int ofs_adaptive_wait_for_ne32(volatile uint32_t *var, uint32_t value,
+			       uint64_t timeout_usec,
+			       const struct ofs_wait_policy *policy,
+			       uint64_t *elapsed_nsec);
+
+/**
+ *  Adaptively wait for a 64-bit variable to differ from a given value
+ *
+ *  @see ofs_adaptive_wait_for_eq32
+ */
+int ofs_adaptive_wait_for_ne64(volatile uint64_t *var, uint64_t value,
+			       uint64_t timeout_usec,
+			       const struct ofs_wait_policy *policy,
+			       uint64_t *elapsed_nsec);
+
 /**
  *  Get timespec difference
  *
@@ -153,6 +348,8 @@ inline int ofs_wait_for_eq32(uint32_t *var, uint32_t value,
 	while(*var != value) {
 		if (sleep_usec)
 			nanosleep(&ts, NULL);
+		else
+			ofs_cpu_relax();
 		clock_gettime(CLOCK_MONOTONIC, &now);
 		struct timespec delta;
 		ofs_diff_timespec(&delta, &now, &begin);
@@ -186,6 +383,8 @@ inline int ofs_wait_for_eq64(uint64_t *var, uint64_t value,
 	while(*var != value) {
 		if (sleep_usec)
 			nanosleep(&ts, NULL);
+		else
+			ofs_cpu_relax();
 		clock_gettime(CLOCK_MONOTONIC, &now);
 		struct timespec delta;
 		ofs_diff_timespec(&delta, &now, &begin);
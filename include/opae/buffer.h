@@ -84,11 +84,23 @@ extern "C" {
  *                        pointed at in '*buf_addr' is already allocated an
  *                        mapped into virtual memory. FPGA_BUF_READ_ONLY
  *                        pins pages with only read access from the FPGA.
+ *                        FPGA_BUF_PREFAULT faults the pages in, on the
+ *                        device's NUMA node and from several threads,
+ *                        before they are pinned. FPGA_BUF_ZERO does the
+ *                        same and zeroes the buffer, which only costs
+ *                        extra for preallocated memory.
+ *                        FPGA_BUF_PREFAULT_THREADS(n) sets the thread
+ *                        count for either.
  * @returns FPGA_OK on success. FPGA_NO_MEMORY if the requested memory could
  * not be allocated. FPGA_INVALID_PARAM if invalid parameters were provided, or
  * if the parameter combination is not valid. FPGA_EXCEPTION if an internal
  * exception occurred while trying to access the handle.
  *
+ * @note Pinning faults a buffer's pages in one at a time, and the first
+ * fault of each hugepage clears it, so pinning a large buffer takes a long
+ * time on one thread. FPGA_BUF_PREFAULT spreads that work over several
+ * threads. The time it took is logged at message level (LIBOPAE_LOG=1).
+ *
  * @note As a special case, when FPGA_BUF_PREALLOCATED is present in flags,
  * if len == 0 and buf_addr == NULL, then the function returns FPGA_OK if
  * pre-allocated buffers are supported. In this case, a return value other
@@ -135,6 +147,123 @@ fpga_result fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid);
 fpga_result fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 			     uint64_t *ioaddr);
 
+/**
+ * Prepare several shared memory buffers at once
+ *
+ * Equivalent to calling fpgaPrepareBuffer() and then fpgaGetIOAddress() for
+ * each entry of `bufs`, but the plugin may take its locks once for the whole
+ * batch. The same `flags` apply to every buffer.
+ *
+ * The call is all or nothing: if any buffer can't be prepared, the ones
+ * already prepared by this call are released again before it returns.
+ *
+ * @param[in]    handle  Handle to previously opened accelerator resource
+ * @param[in]    count   Number of entries in `bufs`
+ * @param[inout] bufs    The buffers. See fpga_buffer_desc for which fields
+ *                       are inputs and which are outputs.
+ * @param[in]    flags   Flags, as for fpgaPrepareBuffer()
+ * @returns FPGA_OK on success. Otherwise, the first error returned for any
+ * of the buffers, as for fpgaPrepareBuffer().
+ */
+fpga_result fpgaPrepareBuffers(fpga_handle handle, uint32_t count,
+			       fpga_buffer_desc *bufs, int flags);
+
+/**
+ * Release several shared memory buffers at once
+ *
+ * Equivalent to calling fpgaReleaseBuffer() for each of `wsids`. Every buffer
+ * is attempted, even after an error.
+ *
+ * @param[in] handle  Handle to previously opened accelerator resource
+ * @param[in] count   Number of entries in `wsids`
+ * @param[in] wsids   Workspace IDs of the buffers to release
+ * @returns FPGA_OK on success. Otherwise, the first error returned for any
+ * of the buffers, as for fpgaReleaseBuffer().
+ */
+fpga_result fpgaReleaseBuffers(fpga_handle handle, uint32_t count,
+			       const uint64_t *wsids);
+
+/**
+ * Create a shared memory arena
+ *
+ * Prepares a single shared buffer of at least `len` bytes, as with
+ * fpgaPrepareBuffer(), and sets it up to be carved into many smaller buffers
+ * by fpgaBufferArenaAllocate(). Those sub-buffers share the arena's wsid and
+ * cost no further driver calls, so the arena suits large numbers of small
+ * buffers such as descriptor rings and messages.
+ *
+ * `len` is rounded up to a multiple of 64 KiB. The underlying buffer must be
+ * contiguous in IO space, so the limits of fpgaPrepareBuffer() on buffer size
+ * apply.
+ *
+ * @param[in]  handle  Handle to previously opened accelerator resource
+ * @param[in]  len     Size of the arena in bytes
+ * @param[in]  flags   FPGA_BUF_READ_ONLY and/or FPGA_BUF_QUIET, as for
+ *                     fpgaPrepareBuffer(). FPGA_BUF_PREALLOCATED is not
+ *                     supported.
+ * @param[out] arena   Receives the new arena
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM for invalid parameters.
+ * FPGA_NO_MEMORY if the arena could not be allocated. FPGA_EXCEPTION if the
+ * prepared buffer is not 64 KiB aligned in both virtual and IO space.
+ * Otherwise, the error returned by fpgaPrepareBuffer() or fpgaGetIOAddress().
+ */
+fpga_result fpgaCreateBufferArena(fpga_handle handle, uint64_t len, int flags,
+				  fpga_buffer_arena *arena);
+
+/**
+ * Destroy a shared memory arena
+ *
+ * Releases the arena's buffer with fpgaReleaseBuffer(). Any sub-buffers still
+ * allocated from the arena become invalid. No thread may be using the arena
+ * while it is destroyed.
+ *
+ * @param[inout] arena  The arena to destroy. Set to NULL on success.
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `arena` is invalid.
+ * Otherwise, the error returned by fpgaReleaseBuffer().
+ */
+fpga_result fpgaDestroyBufferArena(fpga_buffer_arena *arena);
+
+/**
+ * Allocate a sub-buffer from an arena
+ *
+ * Requests of up to 32 KiB come from per-size free lists. Each thread keeps a
+ * small cache of free sub-buffers, so most calls take no lock. Larger
+ * requests are satisfied from whole 64 KiB slabs of the arena.
+ *
+ * @param[in]  arena     The arena to allocate from
+ * @param[in]  len       Size of the sub-buffer in bytes
+ * @param[in]  align     Required alignment in bytes, a power of two, or 0
+ *                       for the default of 64 bytes. The alignment holds for
+ *                       both the virtual and the IO address.
+ * @param[out] buf_addr  Receives the virtual address of the sub-buffer
+ * @param[out] ioaddr    Receives the IO address of the sub-buffer. May be
+ *                       NULL.
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM for invalid parameters.
+ * FPGA_NO_MEMORY if the arena has no room for the request.
+ */
+fpga_result fpgaBufferArenaAllocate(fpga_buffer_arena arena, uint64_t len,
+				    uint64_t align, void **buf_addr,
+				    uint64_t *ioaddr);
+
+/**
+ * Return a sub-buffer to its arena
+ *
+ * @param[in] arena     The arena `buf_addr` was allocated from
+ * @param[in] buf_addr  An address returned by fpgaBufferArenaAllocate()
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `buf_addr` was not
+ * allocated from `arena`.
+ */
+fpga_result fpgaBufferArenaFree(fpga_buffer_arena arena, void *buf_addr);
+
+/**
+ * Retrieve the workspace id of an arena's buffer
+ *
+ * @param[in]  arena  The arena
+ * @param[out] wsid   Receives the wsid shared by all of its sub-buffers
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM for invalid parameters.
+ */
+fpga_result fpgaBufferArenaGetWSID(fpga_buffer_arena arena, uint64_t *wsid);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -24,6 +24,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 #pragma once
+#include <opae/cxx/core/async.h>
+#include <opae/cxx/core/buffer_arena.h>
+#include <opae/cxx/core/csr.h>
 #include <opae/cxx/core/errors.h>
 #include <opae/cxx/core/events.h>
 #include <opae/cxx/core/except.h>
@@ -0,0 +1,321 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include <opae/cxx/core/events.h>
+#include <opae/cxx/core/handle.h>
+#include <opae/cxx/core/shared_buffer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define OPAECXX_HAVE_COROUTINES 1
+#endif
+#endif
+
+namespace opae {
+namespace fpga {
+namespace types {
+
+/**
+ * @brief Completion callback for asynchronous operations
+ *
+ * Called on the executor thread with a null exception_ptr on success,
+ * or with the exception that ended the operation.
+ *
+ * In all of the functions below, a null executor selects
+ * executor::get_default().
+ */
+typedef std::function<void(std::exception_ptr)> completion_t;
+
+/**
+ * @brief An epoll-driven event loop for asynchronous OPAE operations
+ *
+ * One thread waits on file descriptors and timers and runs the
+ * callbacks that become ready. Blocking calls such as reconfiguration
+ * are handed to a small pool of worker threads and complete back on
+ * the loop thread, so a single executor can serve many devices.
+ *
+ * Callbacks must not block and must not destroy the executor.
+ * Destroying an executor drops any pending callbacks; futures
+ * waiting on them become ready with std::future_error.
+ */
+class executor {
+ public:
+  typedef std::shared_ptr<executor> ptr_t;
+  typedef std::chrono::steady_clock clock_type;
+
+  /**
+   * @brief Create a new executor and start its loop thread
+   *
+   * @param max_workers Upper bound on the threads used for
+   *                    blocking work submitted through offload().
+   *
+   * @return A shared ptr to the executor
+   */
+  static executor::ptr_t create(size_t max_workers = 4);
+
+  /**
+   * @brief Get the process-wide executor
+   *
+   * Created on first use; the async functions use it when no
+   * executor is given.
+   */
+  static executor::ptr_t get_default();
+
+  virtual ~executor();
+
+  /**
+   * @brief Run fn on the loop thread
+   */
+  void post(std::function<void()> fn);
+
+  /**
+   * @brief Run fn on the loop thread once delay has elapsed
+   */
+  void post_after(std::chrono::microseconds delay, std::function<void()> fn);
+
+  /**
+   * @brief Run fn on the loop thread once fd becomes readable
+   *
+   * The watch fires once. Only one watch may be pending per descriptor.
+   *
+   * @throws std::system_error if fd cannot be added to the epoll set.
+   */
+  void watch(int fd, std::function<void()> fn);
+
+  /**
+   * @brief Cancel a pending watch
+   *
+   * @return true if a watch on fd was pending and has been dropped
+   */
+  bool unwatch(int fd);
+
+  /**
+   * @brief Run blocking work on a worker thread
+   *
+   * done is called on the loop thread with any exception thrown by fn.
+   */
+  void offload(std::function<void()> fn, completion_t done);
+
+ private:
+  explicit executor(size_t max_workers);
+  void run();
+  void work();
+  void wake();
+  void arm_timer();
+
+  int epoll_fd_;
+  int wake_fd_;
+  int timer_fd_;
+  bool stop_;
+  std::mutex lock_;
+  std::deque<std::function<void()>> posted_;
+  std::multimap<clock_type::time_point, std::function<void()>> timers_;
+  std::map<int, std::function<void()>> watches_;
+  std::thread loop_;
+
+  size_t max_workers_;
+  size_t idle_workers_;
+  std::condition_variable work_cv_;
+  std::deque<std::function<void()>> work_;
+  std::vector<std::thread> workers_;
+};
+
+/**
+ * @brief Wait for an event to be signaled
+ *
+ * The event's pending notification count is consumed before done runs.
+ *
+ * @param ev The event to wait on
+ * @param done Called on the executor thread when the event fires
+ * @param ex The executor to wait on
+ */
+void async_wait(event::ptr_t ev, completion_t done, executor::ptr_t ex);
+
+/**
+ * @brief Wait for an event to be signaled
+ *
+ * @param ev The event to wait on
+ * @param ex The executor to wait on, or nullptr for the default one
+ *
+ * @return A future that becomes ready when the event fires
+ */
+std::future<void> async_wait(event::ptr_t ev, executor::ptr_t ex = nullptr);
+
+/**
+ * @brief Poll a 64-bit word in a shared buffer until it holds a value
+ *
+ * Completes once (word at offset & mask) == value. A nonzero timeout
+ * ends the operation with a std::system_error (std::errc::timed_out).
+ *
+ * @param buf The buffer to poll
+ * @param offset Byte offset of the 64-bit word
+ * @param mask Bits of the word to compare
+ * @param value Expected value of the masked bits
+ * @param interval Time between reads
+ * @param timeout Maximum time to poll; zero polls until satisfied
+ * @param done Called on the executor thread when polling ends
+ * @param ex The executor that schedules the reads
+ */
+void async_poll(shared_buffer::ptr_t buf, size_t offset, uint64_t mask,
+                uint64_t value, std::chrono::microseconds interval,
+                std::chrono::microseconds timeout, completion_t done,
+                executor::ptr_t ex);
+
+/**
+ * @brief Poll a 64-bit word in a shared buffer until it holds a value
+ *
+ * @return A future that becomes ready when the masked word matches
+ */
+std::future<void> async_poll(
+    shared_buffer::ptr_t buf, size_t offset, uint64_t mask, uint64_t value,
+    std::chrono::microseconds interval = std::chrono::microseconds(100),
+    std::chrono::microseconds timeout = std::chrono::microseconds(0),
+    executor::ptr_t ex = nullptr);
+
+/**
+ * @brief Load a bitstream without blocking the caller
+ *
+ * Runs handle::reconfigure() on one of the executor's worker threads.
+ * The bitstream is moved into the operation.
+ */
+void async_reconfigure(handle::ptr_t h, uint32_t slot,
+                       std::vector<uint8_t> bitstream, int flags,
+                       completion_t done, executor::ptr_t ex);
+
+/**
+ * @brief Load a bitstream without blocking the caller
+ *
+ * @return A future that becomes ready when programming finishes
+ */
+std::future<void> async_reconfigure(handle::ptr_t h, uint32_t slot,
+                                    std::vector<uint8_t> bitstream,
+                                    int flags = 0,
+                                    executor::ptr_t ex = nullptr);
+
+/**
+ * @brief Reset an accelerator without blocking the caller
+ *
+ * Runs handle::reset() on one of the executor's worker threads.
+ */
+void async_reset(handle::ptr_t h, completion_t done, executor::ptr_t ex);
+
+/**
+ * @brief Reset an accelerator without blocking the caller
+ *
+ * @return A future that becomes ready when the reset finishes
+ */
+std::future<void> async_reset(handle::ptr_t h, executor::ptr_t ex = nullptr);
+
+#ifdef OPAECXX_HAVE_COROUTINES
+namespace coro {
+
+/**
+ * @brief Awaitable wrapper for a callback-style async operation
+ *
+ * The awaiting coroutine resumes on the executor thread and
+ * co_await rethrows any exception that ended the operation.
+ */
+class awaitable {
+ public:
+  explicit awaitable(std::function<void(completion_t)> start)
+      : start_(std::move(start)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    // The coroutine may resume (and destroy *this) before start returns.
+    auto start = std::move(start_);
+    start([this, h](std::exception_ptr e) {
+      error_ = e;
+      h.resume();
+    });
+  }
+
+  void await_resume() const {
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  std::function<void(completion_t)> start_;
+  std::exception_ptr error_;
+};
+
+/// co_await an event; see async_wait()
+inline awaitable wait(event::ptr_t ev, executor::ptr_t ex = nullptr) {
+  return awaitable([ev, ex](completion_t done) {
+    async_wait(ev, std::move(done), ex);
+  });
+}
+
+/// co_await a buffer word; see async_poll()
+inline awaitable poll(
+    shared_buffer::ptr_t buf, size_t offset, uint64_t mask, uint64_t value,
+    std::chrono::microseconds interval = std::chrono::microseconds(100),
+    std::chrono::microseconds timeout = std::chrono::microseconds(0),
+    executor::ptr_t ex = nullptr) {
+  return awaitable([=](completion_t done) {
+    async_poll(buf, offset, mask, value, interval, timeout, std::move(done),
+               ex);
+  });
+}
+
+/// co_await reconfiguration; see async_reconfigure()
+inline awaitable reconfigure(handle::ptr_t h, uint32_t slot,
+                             std::vector<uint8_t> bitstream, int flags = 0,
+                             executor::ptr_t ex = nullptr) {
+  auto bits = std::make_shared<std::vector<uint8_t>>(std::move(bitstream));
+  return awaitable([h, slot, bits, flags, ex](completion_t done) {
+    async_reconfigure(h, slot, std::move(*bits), flags, std::move(done),
+                      ex);
+  });
+}
+
+/// co_await a reset; see async_reset()
+inline awaitable reset(handle::ptr_t h, executor::ptr_t ex = nullptr) {
+  return awaitable([h, ex](completion_t done) {
+    async_reset(h, std::move(done), ex);
+  });
+}
+
+}  // end of namespace coro
+#endif  // OPAECXX_HAVE_COROUTINES
+
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
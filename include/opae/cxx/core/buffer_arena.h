@@ -0,0 +1,103 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include <opae/buffer.h>
+#include <opae/cxx/core/handle.h>
+#include <opae/cxx/core/shared_buffer.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace opae {
+namespace fpga {
+namespace types {
+
+/** Sub-allocator for host/AFU shared memory
+ *
+ * buffer_arena prepares one large shared buffer and carves
+ * it into smaller shared_buffer objects. Allocating from the
+ * arena needs no driver call, so it suits many small buffers
+ * such as descriptor rings and messages.
+ */
+class buffer_arena : public std::enable_shared_from_this<buffer_arena> {
+ public:
+  typedef std::size_t size_t;
+  typedef std::shared_ptr<buffer_arena> ptr_t;
+
+  buffer_arena(const buffer_arena &) = delete;
+  buffer_arena &operator=(const buffer_arena &) = delete;
+
+  /** buffer_arena destructor.
+   */
+  virtual ~buffer_arena();
+
+  /** buffer_arena factory method - create an arena.
+   * @param[in] handle The handle used to allocate the arena's buffer.
+   * @param[in] len    The size of the arena in bytes.
+   * @return A valid buffer_arena smart pointer.
+   */
+  static buffer_arena::ptr_t create(handle::ptr_t handle, size_t len,
+                                    bool read_only = false);
+
+  /** Allocate a sub-buffer from the arena.
+   *
+   * The sub-buffer returns to the arena when its last reference is
+   * dropped, and it keeps the arena alive until then. It shares the
+   * arena's wsid, and its owner() is empty, because it must not be
+   * released on its own.
+   *
+   * @param[in] len   The length in bytes of the requested buffer.
+   * @param[in] align The required alignment, a power of two, or 0
+   * for the default of 64 bytes.
+   * @return A valid shared_buffer smart pointer.
+   * @throws no_memory if the arena has no room for the request.
+   */
+  shared_buffer::ptr_t allocate(size_t len, size_t align = 0);
+
+  /** Retrieve the underlying fpga_buffer_arena.
+   */
+  fpga_buffer_arena c_type() const { return arena_; }
+
+  /** Retrieve the handle smart pointer associated with
+   * this arena.
+   */
+  handle::ptr_t owner() const { return handle_; }
+
+  /** Retrieve the workspace id shared by all sub-buffers.
+   */
+  uint64_t wsid() const { return wsid_; }
+
+ private:
+  buffer_arena(handle::ptr_t handle, fpga_buffer_arena arena, uint64_t wsid);
+
+  handle::ptr_t handle_;
+  fpga_buffer_arena arena_;
+  uint64_t wsid_;
+};
+
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
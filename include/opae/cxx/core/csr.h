@@ -0,0 +1,260 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include <opae/cxx/core/handle.h>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace opae {
+namespace fpga {
+namespace types {
+namespace csr {
+
+/**
+ * @brief Software access mode of a register field
+ */
+enum class access {
+  ro,  ///< read-only; writes are ignored by hardware
+  rw,  ///< read-write
+  wo,  ///< write-only; reads return an undefined value
+  w1c  ///< read, write 1 to clear
+};
+
+/**
+ * @brief A register at a fixed offset in a CSR block
+ *
+ * Generated register types derive from this template so that each
+ * register is a distinct type. The layout is carried entirely in
+ * template arguments; accessors never compute offsets at run time.
+ *
+ * @tparam Offset Byte offset from the start of the CSR block
+ * @tparam T uint32_t or uint64_t
+ * @tparam Reset Value after reset
+ * @tparam W1CMask Bits belonging to write-1-to-clear fields
+ * @tparam WOMask Bits belonging to write-only fields, whose writes
+ *                have side effects (e.g. self-clearing "go" bits)
+ */
+template <uint64_t Offset, typename T = uint64_t, T Reset = 0, T W1CMask = 0,
+          T WOMask = 0>
+struct reg {
+  static_assert(std::is_same<T, uint32_t>::value ||
+                    std::is_same<T, uint64_t>::value,
+                "CSRs are 32 or 64 bits wide");
+  static_assert(Offset % sizeof(T) == 0, "CSR offset must be aligned");
+
+  typedef T value_type;
+  static constexpr uint64_t offset = Offset;
+  static constexpr T reset = Reset;
+  static constexpr T w1c_mask = W1CMask;
+  static constexpr T wo_mask = WOMask;
+};
+
+template <uint64_t Offset, typename T, T Reset, T W1CMask, T WOMask>
+constexpr uint64_t reg<Offset, T, Reset, W1CMask, WOMask>::offset;
+template <uint64_t Offset, typename T, T Reset, T W1CMask, T WOMask>
+constexpr T reg<Offset, T, Reset, W1CMask, WOMask>::reset;
+template <uint64_t Offset, typename T, T Reset, T W1CMask, T WOMask>
+constexpr T reg<Offset, T, Reset, W1CMask, WOMask>::w1c_mask;
+template <uint64_t Offset, typename T, T Reset, T W1CMask, T WOMask>
+constexpr T reg<Offset, T, Reset, W1CMask, WOMask>::wo_mask;
+
+/**
+ * @brief A bit range [Msb:Lsb] within register Reg
+ */
+template <typename Reg, unsigned Msb, unsigned Lsb, access A = access::rw>
+struct field {
+  typedef Reg reg_type;
+  typedef typename Reg::value_type value_type;
+
+  static_assert(Msb >= Lsb, "field bit range is reversed");
+  static_assert(Msb < 8 * sizeof(value_type), "field exceeds its register");
+
+  static constexpr unsigned shift = Lsb;
+  static constexpr unsigned width = Msb - Lsb + 1;
+  static constexpr value_type mask =
+      (width == 8 * sizeof(value_type)
+           ? ~value_type(0)
+           : ((value_type(1) << width) - 1) << Lsb);
+  static constexpr access mode = A;
+  static constexpr bool readable = A != access::wo;
+  static constexpr bool writable = A != access::ro;
+
+  /// Extract this field from a raw register value.
+  static constexpr value_type get(value_type raw) {
+    return (raw & mask) >> shift;
+  }
+
+  /// Replace this field in a raw register value.
+  static constexpr value_type put(value_type raw, value_type v) {
+    return (raw & ~mask) | ((v << shift) & mask);
+  }
+};
+
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr unsigned field<Reg, Msb, Lsb, A>::shift;
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr unsigned field<Reg, Msb, Lsb, A>::width;
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr typename field<Reg, Msb, Lsb, A>::value_type
+    field<Reg, Msb, Lsb, A>::mask;
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr access field<Reg, Msb, Lsb, A>::mode;
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr bool field<Reg, Msb, Lsb, A>::readable;
+template <typename Reg, unsigned Msb, unsigned Lsb, access A>
+constexpr bool field<Reg, Msb, Lsb, A>::writable;
+
+/**
+ * @brief A batched read-modify-write of one register
+ *
+ * Created by block::modify(). The register is loaded once; each set()
+ * only updates a local copy, and the value is stored once by commit()
+ * or when the object goes out of scope. Write-1-to-clear and
+ * write-only bits that were not explicitly set are written as 0 so
+ * that the write-back neither clears status nor re-triggers an action.
+ */
+template <typename Reg>
+class update {
+ public:
+  typedef typename Reg::value_type value_type;
+
+  update(volatile value_type *ptr)
+      : ptr_(ptr),
+        loaded_(*ptr),
+        value_(loaded_ & ~(Reg::w1c_mask | Reg::wo_mask)),
+        pending_(true) {}
+
+  update(update &&other)
+      : ptr_(other.ptr_),
+        loaded_(other.loaded_),
+        value_(other.value_),
+        pending_(other.pending_) {
+    other.pending_ = false;
+  }
+
+  update(const update &) = delete;
+  update &operator=(const update &) = delete;
+
+  ~update() { commit(); }
+
+  /// Stage a new value for field F.
+  template <typename F>
+  update &set(value_type v) {
+    static_assert(std::is_same<typename F::reg_type, Reg>::value,
+                  "field does not belong to this register");
+    static_assert(F::writable, "field is read-only");
+    value_ = F::put(value_, v);
+    pending_ = true;
+    return *this;
+  }
+
+  /// Field F of the value loaded (plus any staged changes).
+  /// Write-1-to-clear fields always report the loaded value.
+  template <typename F>
+  value_type get() const {
+    static_assert(std::is_same<typename F::reg_type, Reg>::value,
+                  "field does not belong to this register");
+    static_assert(F::readable, "field is write-only");
+    return F::get((loaded_ & Reg::w1c_mask) | (value_ & ~Reg::w1c_mask));
+  }
+
+  /// Store the staged value now.
+  void commit() {
+    if (pending_) {
+      *ptr_ = value_;
+      pending_ = false;
+    }
+  }
+
+ private:
+  volatile value_type *ptr_;
+  value_type loaded_;
+  value_type value_;
+  bool pending_;
+};
+
+/**
+ * @brief Typed access to a memory-mapped CSR block
+ *
+ * Every accessor is a single volatile load or store at the block base
+ * plus the register's compile-time offset.
+ */
+class block {
+ public:
+  /// Wrap an already-mapped CSR block.
+  explicit block(volatile uint8_t *base) : base_(base) {}
+
+  /// Wrap MMIO space csr_space of h, keeping the handle alive.
+  explicit block(handle::ptr_t h, uint32_t csr_space = 0)
+      : handle_(h), base_(h->mmio_ptr(0, csr_space)) {}
+
+  /// Read register R.
+  template <typename R>
+  typename R::value_type read() const {
+    return *ptr<R>();
+  }
+
+  /// Write register R.
+  template <typename R>
+  void write(typename R::value_type v) {
+    *ptr<R>() = v;
+  }
+
+  /// Read field F.
+  template <typename F>
+  typename F::value_type get() const {
+    static_assert(F::readable, "field is write-only");
+    return F::get(read<typename F::reg_type>());
+  }
+
+  /// Read-modify-write field F.
+  template <typename F>
+  void set(typename F::value_type v) {
+    modify<typename F::reg_type>().template set<F>(v);
+  }
+
+  /// Begin a batched read-modify-write of register R.
+  template <typename R>
+  update<R> modify() {
+    return update<R>(ptr<R>());
+  }
+
+ private:
+  template <typename R>
+  volatile typename R::value_type *ptr() const {
+    return reinterpret_cast<volatile typename R::value_type *>(base_ +
+                                                               R::offset);
+  }
+
+  handle::ptr_t handle_;
+  volatile uint8_t *base_;
+};
+
+}  // end of namespace csr
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
@@ -28,7 +28,10 @@
 #include <opae/enum.h>
 #include <opae/types.h>
 
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace opae {
@@ -177,7 +180,10 @@ class handle {
    * handle or FPGA_EXCEPTION if handle is not opened
    *
    * @note This is available for explicitly closing a handle.
-   * The destructor for handle will call close.
+   * The destructor for handle will call close. It is safe to call
+   * from several threads: the handle is closed once, after any
+   * reset(), reconfigure(), buffer allocation or event registration
+   * still in progress on it. Other calls must not race with close.
    */
   fpga_result close();
 
@@ -189,8 +195,38 @@ class handle {
  private:
   handle(fpga_handle h);
 
+  // Holds off close() for the duration of a call on handle_.
+  class in_flight;
+  friend class shared_buffer;
+  friend class event;
+
   fpga_handle handle_;
   fpga_token token_;
+  std::mutex lock_;  // guards handle_ against close(), and busy_
+  std::condition_variable idle_;
+  uint32_t busy_;
+};
+
+// Marks a call on the handle as in progress, and yields the
+// fpga_handle to make it on: nullptr once the handle is closed.
+class handle::in_flight {
+ public:
+  explicit in_flight(handle &h) : h_(h) {
+    std::lock_guard<std::mutex> g(h_.lock_);
+    ++h_.busy_;
+    c_handle_ = h_.handle_;
+  }
+
+  ~in_flight() {
+    std::lock_guard<std::mutex> g(h_.lock_);
+    if (--h_.busy_ == 0) h_.idle_.notify_all();
+  }
+
+  fpga_handle c_type() const { return c_handle_; }
+
+ private:
+  handle &h_;
+  fpga_handle c_handle_;
 };
 
 }  // end of namespace types
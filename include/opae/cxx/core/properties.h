@@ -107,6 +107,19 @@ class properties {
    */
   static properties::ptr_t get(std::shared_ptr<handle> h);
 
+  /** Copy every field of the properties in one call.
+   * Cheaper than reading the pvalue members one by one.
+   * @return The fields, see FPGA_SNAPSHOT_* for the meaning
+   * of valid_fields.
+   */
+  fpga_properties_snapshot snapshot() const;
+
+  /** Make the properties read-only.
+   * Reading a frozen properties object takes no lock.
+   * Assigning to any of its pvalue members afterwards throws.
+   */
+  void freeze();
+
  private:
   properties(bool alloc_props = true);
   fpga_properties props_;
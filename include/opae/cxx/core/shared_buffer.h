@@ -68,6 +68,17 @@ class shared_buffer {
   static shared_buffer::ptr_t allocate(handle::ptr_t handle, size_t len,
                                        bool read_only = false);
 
+  /** shared_buffer factory method - allocate several shared_buffers
+   * with a single call to fpgaPrepareBuffers().
+   * @param[in] handle The handle used to allocate the buffers.
+   * @param[in] lens   The length in bytes of each requested buffer.
+   * @return One valid shared_buffer smart pointer per entry of lens.
+   * Either all of the buffers are allocated, or an exception is thrown.
+   */
+  static std::vector<shared_buffer::ptr_t> allocate(
+      handle::ptr_t handle, const std::vector<size_t> &lens,
+      bool read_only = false);
+
   /** Attach a pre-allocated buffer to a shared_buffer object.
    *
    * @param[in] handle The handle used to attach the buffer.
@@ -125,11 +136,41 @@ class shared_buffer {
    */
   void fill(int c);
 
+  /** Write c to each byte location in the buffer.
+   *
+   * Buffers larger than the last-level cache are written with
+   * non-temporal stores.
+   *
+   * @param[in] c The byte value to write.
+   * @param[in] threads Number of threads to split the work across.
+   * 1 uses only the calling thread; 0 picks a count from the size.
+   */
+  void fill(int c, unsigned threads);
+
   /** Compare this shared_buffer (the first len bytes)
    * to that held in other, using memcmp().
    */
   int compare(ptr_t other, size_t len) const;
 
+  /** Compare this shared_buffer (the first len bytes)
+   * to that held in other, split across threads.
+   *
+   * @return 0 if the ranges are equal, 1 otherwise.
+   */
+  int compare(ptr_t other, size_t len, unsigned threads) const;
+
+  /** Copy the first len bytes of this buffer to other.
+   *
+   * Copies larger than the last-level cache use non-temporal stores.
+   *
+   * @param[in] other The destination buffer.
+   * @param[in] len Bytes to copy. 0 copies the whole buffer.
+   * @param[in] threads As for fill().
+   * @throws std::invalid_argument if other is null.
+   * @throws except if len exceeds either buffer.
+   */
+  void copy(ptr_t other, size_t len = 0, unsigned threads = 1) const;
+
   /** Read a T-sized block of memory at the given location.
    * @param[in] offset The byte offset from the start of the buffer.
    * @return A T from buffer base + offset.
@@ -151,6 +151,23 @@ class sysobject {
    */
   void write64(uint64_t value, int flags = 0) const;
 
+  /**
+   * @brief Update the buffered copy of this object from the system.
+   * For a container, every readable attribute in it is updated in one call.
+   *
+   * @param[in] flags Flags that control how the object is synchronized
+   * If FPGA_OBJECT_RECURSE_ALL is used, then nested containers are also
+   * synchronized. Flags are defaulted to 0 meaning no flags.
+   */
+  void sync(int flags = 0) const;
+
+  /**
+   * @brief Get the time of the last synchronization of this object.
+   *
+   * @return CLOCK_MONOTONIC time in nanoseconds, 0 if never synchronized.
+   */
+  uint64_t timestamp() const;
+
   /**
    * @brief Get all raw bytes from the object.
    *
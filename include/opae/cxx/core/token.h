@@ -71,6 +71,10 @@ class token {
  private:
   token(fpga_token tok);
 
+  /** Take ownership of tok rather than cloning it.
+   */
+  token(fpga_token tok, bool adopt);
+
   fpga_token token_;
 
   friend class handle;
@@ -102,6 +102,52 @@ fpga_result fpgaEnumerate(const fpga_properties *filters,
 			  uint32_t num_filters, fpga_token *tokens,
 			  uint32_t max_tokens, uint32_t *num_matches);
 
+/**
+ * Enumerate FPGA resources, returning every match
+ *
+ * Like fpgaEnumerate(), but the matching resources are found in a single
+ * pass and the library allocates a `tokens` array of exactly the right size.
+ * There is no need to call once for the count and again for the tokens.
+ *
+ * @note The returned array and its tokens belong to the caller. Release
+ * both with fpgaDestroyTokens(). A caller that wants to keep some tokens
+ * beyond that call may take them out of the array and set their entries to
+ * NULL; fpgaDestroyTokens() skips NULL entries. Such tokens are later
+ * destroyed individually with fpgaDestroyToken().
+ *
+ * @param[in] filters      Array of `fpga_properties` objects describing the
+ *                         properties of the objects that should be returned,
+ *                         as for fpgaEnumerate().
+ * @param[in] num_filters  Number of entries in the `filters` array, or 0 to
+ *                         match all FPGA resources when `filters` is NULL.
+ * @param[out] tokens      Receives the array of matching tokens, or NULL when
+ *                         nothing matches.
+ * @param[out] num_tokens  Receives the number of entries in `tokens`.
+ * @returns                FPGA_OK on success, including when nothing matches.
+ *                         FPGA_INVALID_PARAM if invalid pointers or objects
+ *                         are passed into the function.
+ *                         FPGA_NO_MEMORY if there was not enough memory to
+ *                         create tokens.
+ *                         FPGA_EXCEPTION if a plugin failed to enumerate.
+ *                         No tokens are returned on failure.
+ */
+fpga_result fpgaEnumerateAll(const fpga_properties *filters,
+			     uint32_t num_filters, fpga_token **tokens,
+			     uint32_t *num_tokens);
+
+/**
+ * Destroy an array of tokens returned by fpgaEnumerateAll()
+ *
+ * Destroys each non-NULL token in `tokens`, then frees the array itself.
+ *
+ * @param[in] tokens      Array returned by fpgaEnumerateAll(). May be NULL
+ *                        when `num_tokens` is 0.
+ * @param[in] num_tokens  Number of entries in `tokens`.
+ * @returns               FPGA_OK on success, or the first error returned
+ *                        by fpgaDestroyToken(). The array is freed either way.
+ */
+fpga_result fpgaDestroyTokens(fpga_token *tokens, uint32_t num_tokens);
+
 /**
  * Clone a fpga_token object
  *
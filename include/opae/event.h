@@ -106,6 +106,15 @@ fpga_result fpgaGetOSObjectFromEventHandle(const fpga_event_handle eh, int *fd);
  * the vector ID. The value of the flags parameter indicates the vector ID,
  * no bit encoding is used.
  *
+ * FPGA_EVENT_POWER_THERMAL is raised when one of the device's power or
+ * thermal sensors crosses a threshold reported by
+ * fpgaGetMetricsThresholdInfo(). It is proxied by fpgad when one is
+ * running. Otherwise, a monitor shared by the process's registrations
+ * for the same device reads the sensors once per interval, through the
+ * registering handles. The flags parameter is then the interval in
+ * milliseconds; 0 selects the default of one second. The handle must
+ * refer to an FPGA_DEVICE.
+ *
  * @todo define if calling fpgaRegisterEvent multiple times with the
  * same event_handle is an error condition or if it is silently ignored.
  *
@@ -153,6 +162,49 @@ fpga_result fpgaUnregisterEvent(fpga_handle handle,
 					     fpga_event_type event_type,
 					     fpga_event_handle event_handle);
 
+/**
+ * Register a range of user interrupt vectors
+ *
+ * Registers event_handles[i] for user interrupt vector start + i, for
+ * each i below count, as fpgaRegisterEvent() would for
+ * FPGA_EVENT_INTERRUPT. Where the driver allows it, the whole range is
+ * assigned with a single request, so that accelerators with many
+ * interrupt vectors don't pay for each one separately.
+ *
+ * Either every vector is registered or none is.
+ *
+ * @param[in]  handle        Handle to previously opened accelerator.
+ * @param[in]  start         The first vector ID.
+ * @param[in]  count         The number of vectors and event handles.
+ * @param[in]  event_handles count event handles created by
+ *                           fpgaCreateEventHandle().
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if handle does not refer
+ * to an accelerator, if any event handle is not valid, if the range
+ * exceeds the accelerator's vectors, or if a vector in it is already
+ * registered. FPGA_NOT_SUPPORTED if the accelerator has no user
+ * interrupts. FPGA_EXCEPTION if an internal exception occurred.
+ */
+fpga_result fpgaRegisterInterruptEvents(fpga_handle handle,
+					uint32_t start, uint32_t count,
+					fpga_event_handle *event_handles);
+
+/**
+ * Unregister user interrupt event handles
+ *
+ * Unregisters event handles registered by fpgaRegisterInterruptEvents()
+ * or by fpgaRegisterEvent() with FPGA_EVENT_INTERRUPT. Handles for
+ * consecutive vectors are unregistered with a single request.
+ *
+ * @param[in]  handle        Handle to previously opened accelerator.
+ * @param[in]  count         The number of event handles.
+ * @param[in]  event_handles count registered event handles.
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if handle does not refer
+ * to an accelerator, or if any event handle is not valid or not
+ * registered. FPGA_EXCEPTION if an internal exception occurred.
+ */
+fpga_result fpgaUnregisterInterruptEvents(fpga_handle handle, uint32_t count,
+					  fpga_event_handle *event_handles);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -0,0 +1,107 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef __OPAE_MEM_PREFAULT_H__
+#define __OPAE_MEM_PREFAULT_H__
+
+/**
+* Provides an API for faulting in (and optionally zeroing) a large
+* memory range from several threads at once, before the range is
+* pinned for DMA. Pinning faults pages in one at a time on the calling
+* thread, and for hugepages each fault includes clearing the page, so
+* a large buffer is much faster to pin once it is already populated.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Zero the range instead of only faulting it in. */
+#define MEM_PREFAULT_ZERO 0x1
+/** Fault the range in for reading only, e.g. a read-only mapping. */
+#define MEM_PREFAULT_READ 0x2
+
+struct mem_prefault {
+	uint32_t threads;	/**< In: thread count, 0 to choose. Out: used. */
+	int numa_node;		/**< In: node to place pages on, or -1. */
+	int flags;		/**< In: MEM_PREFAULT_* flags. */
+	uint64_t nsec;		/**< Out: wall time spent, in nanoseconds. */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * Fault in a memory range from several threads
+ *
+ * The range is split into runs of whole pages, one per thread. When
+ * numa_node is not negative, the range is given a preference for that
+ * node before it is touched, and the threads run on that node's CPUs,
+ * so that the pages land next to the device that will use them.
+ *
+ * Freshly mapped anonymous memory is zeroed by the kernel as it is
+ * faulted in; MEM_PREFAULT_ZERO is only needed for memory that may
+ * hold data already.
+ *
+ * @param[in]      addr      The page-aligned start of the range.
+ * @param[in]      len       The length of the range in bytes.
+ * @param[in]      page_size The size of the pages backing the range,
+ *                           or 0 for the system page size.
+ * @param[in, out] p         Options, and the statistics of the run.
+ * @returns Non-zero on error. Zero on success.
+ *
+ * Example
+ * @code{.c}
+ * struct mem_prefault p = { 0, 1, 0, 0 }; // any thread count, node 1
+ *
+ * if (mem_prefault(buf, 16UL << 30, 1UL << 30, &p)) {
+ *   // handle error
+ * } else {
+ *   printf("%u threads took %lu ns\n", p.threads, p.nsec);
+ * }
+ * @endcode
+ */
+int mem_prefault(void *addr,
+		 size_t len,
+		 size_t page_size,
+		 struct mem_prefault *p);
+
+/**
+ * Find the NUMA node of a device
+ *
+ * Searches the sysfs directory of the device, and each directory
+ * above it, for a numa_node attribute.
+ *
+ * @param[in] sysfs_path A sysfs path at or below the device, eg
+ *                       /sys/bus/pci/devices/0000:00:00.0
+ * @returns The node number, or -1 if it is not known.
+ */
+int mem_prefault_numa_node(const char *sysfs_path);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __OPAE_MEM_PREFAULT_H__
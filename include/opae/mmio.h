@@ -138,6 +138,36 @@ fpga_result fpgaWriteMMIO512(fpga_handle handle,
 			    uint32_t mmio_num, uint64_t offset,
 			    const void *value);
 
+/**
+ * Write a burst of 64-byte lines to MMIO space
+ *
+ * Writes num_lines consecutive 64-byte lines from lines to MMIO space,
+ * starting at a 64-byte aligned offset. With FPGA_MMIO_BURST_FIXED,
+ * every line is written to offset instead, as when submitting
+ * descriptors to a portal register.
+ *
+ * Each line is written with the widest store the CPU offers:
+ * MOVDIR64B, one AVX-512 store, two AVX2 stores, or eight 64-bit
+ * stores. Only the first two produce a single 64-byte write on the
+ * bus; pass FPGA_MMIO_BURST_ATOMIC to require that. One store fence
+ * follows the last line.
+ *
+ * @param[in]  handle    Handle to previously opened accelerator resource
+ * @param[in]  mmio_num  Number of MMIO space to access
+ * @param[in]  offset    Byte offset into MMIO space, a multiple of 64
+ * @param[in]  lines     num_lines * 64 bytes to write
+ * @param[in]  num_lines Number of 64-byte lines
+ * @param[in]  flags     Bitwise OR of fpga_mmio_burst_flags
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid. FPGA_NOT_SUPPORTED if FPGA_MMIO_BURST_ATOMIC
+ * was given and the CPU cannot write a line in one store. FPGA_EXCEPTION
+ * if an internal exception occurred while trying to access the handle.
+ */
+fpga_result fpgaWriteMMIOBurst(fpga_handle handle,
+			       uint32_t mmio_num, uint64_t offset,
+			       const void *lines, uint32_t num_lines,
+			       int flags);
+
 /**
  * Map MMIO space
  *
@@ -200,6 +230,29 @@ fpga_result fpgaMapMMIO(fpga_handle handle,
 fpga_result fpgaUnmapMMIO(fpga_handle handle,
 			  uint32_t mmio_num);
 
+/**
+ * Find a feature in the Device Feature List
+ *
+ * Looks up a feature of the accelerator by GUID or by feature ID. The
+ * Device Feature List in MMIO space 0 is walked once per handle, on
+ * the first call. Later lookups take constant time and perform no
+ * MMIO accesses.
+ *
+ * @param[in]  handle Handle to previously opened accelerator resource
+ * @param[in]  guid   GUID of the feature to find (AFU and BBB features
+ *                    carry a GUID), or NULL to search by id
+ * @param[in]  id     Feature ID to find when guid is NULL. When several
+ *                    features share an ID, the first in the list is
+ *                    returned
+ * @param[out] info   Receives the description of the feature
+ * @returns FPGA_OK on success. FPGA_NOT_FOUND if no such feature
+ * exists. FPGA_INVALID_PARAM if any of the supplied parameters is
+ * invalid. FPGA_NOT_SUPPORTED if the plugin does not implement feature
+ * lookup.
+ */
+fpga_result fpgaFindFeature(fpga_handle handle, fpga_guid guid,
+			    uint16_t id, fpga_feature_info *info);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
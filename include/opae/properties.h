@@ -157,6 +157,40 @@ fpga_result fpgaClearProperties(fpga_properties prop);
  */
 fpga_result fpgaCloneProperties(fpga_properties src, fpga_properties *dst);
 
+/**
+ * Copy all fields of a fpga_properties object
+ *
+ * Reads every field of `prop` in one call, rather than one
+ * fpgaPropertiesGet*() call (and one lock) per field.
+ *
+ * @param[in]  prop       fpga_properties object to read
+ * @param[out] snapshot   Receives the fields. See FPGA_SNAPSHOT_* for
+ *                        the flags of snapshot->valid_fields.
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `prop` is not a valid
+ * object, or if `snapshot` is NULL.
+ */
+fpga_result fpgaPropertiesGetSnapshot(const fpga_properties prop,
+				      fpga_properties_snapshot *snapshot);
+
+/**
+ * Make a fpga_properties object read-only
+ *
+ * After this call, `prop` can no longer be modified, and its
+ * fpgaPropertiesGet*() accessors no longer take a lock. This is
+ * useful for properties that many threads read, but nobody changes,
+ * such as the ones returned by fpgaGetProperties().
+ *
+ * The fpgaPropertiesSet*() functions, fpgaClearProperties() and
+ * fpgaUpdateProperties() fail with FPGA_INVALID_PARAM on a frozen
+ * object. It can still be cloned (the clone is not frozen), used
+ * as an fpgaEnumerate() filter, and destroyed.
+ *
+ * @param[in]  prop       fpga_properties object to freeze
+ * @returns FPGA_OK on success. FPGA_INVALID_PARAM if `prop` is not a valid
+ * object.
+ */
+fpga_result fpgaPropertiesFreeze(fpga_properties prop);
+
 /**
  * Destroy a fpga_properties object
  *
@@ -235,6 +235,41 @@ fpga_result fpgaObjectRead64(fpga_object obj, uint64_t *value, int flags);
  */
 fpga_result fpgaObjectWrite64(fpga_object obj, uint64_t value, int flags);
 
+/**
+ * @brief Synchronize the buffered copy of an object from the system.
+ * For an attribute object, this is the same as reading it with
+ * FPGA_OBJECT_SYNC. For a container object, the buffered copy of every
+ * readable attribute in the container is updated in one call.
+ *
+ * @param[in] obj An fpga_object instance.
+ * @param[in] flags Flags that control how the object is synchronized
+ * If FPGA_OBJECT_RECURSE_ALL is used, then attributes of containers nested in
+ * a container object are also synchronized.
+ *
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid, FPGA_EXCEPTION if any attribute could not be read.
+ * All attributes are attempted even if one of them fails.
+ *
+ * @note Attributes that are synchronized repeatedly keep their underlying
+ * file open until the object is destroyed.
+ */
+fpga_result fpgaObjectSync(fpga_object obj, int flags);
+
+/**
+ * @brief Get the time of the last synchronization of an object.
+ *
+ * @param[in] obj An fpga_object instance.
+ * @param[out] timestamp Pointer to a variable to store the CLOCK_MONOTONIC
+ * time, in nanoseconds, at which the object was last synchronized. For an
+ * attribute, this is when its buffered copy was last read from the system.
+ * For a container, this is when fpgaObjectSync() last completed on it.
+ * 0 if the object was never synchronized.
+ *
+ * @return FPGA_OK on success, FPGA_INVALID_PARAM if any of the supplied
+ * parameters is invalid
+ */
+fpga_result fpgaObjectGetTimestamp(fpga_object obj, uint64_t *timestamp);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
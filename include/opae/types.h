@@ -188,6 +188,15 @@ struct fpga_error_info {
  */
 typedef void *fpga_object;
 
+/** Sub-allocator for shared memory
+ *
+ * An `fpga_buffer_arena` owns one large buffer prepared with
+ * fpgaPrepareBuffer() and hands out smaller, aligned pieces of it, each with
+ * its own virtual and IO address. It is created by fpgaCreateBufferArena()
+ * and destroyed by fpgaDestroyBufferArena().
+ */
+typedef void *fpga_buffer_arena;
+
 /** FPGA Metric string size
  *
  *
@@ -252,4 +261,92 @@ typedef struct metric_threshold {
 	threshold hysteresis;                          // Hysteresis
 } metric_threshold;
 
+/**
+ * Device Feature Header info
+ *
+ * Describes one entry of an accelerator's Device Feature List,
+ * as returned by fpgaFindFeature().
+ */
+typedef struct fpga_feature_info {
+	uint64_t offset;    /**< Byte offset of the DFH in MMIO space 0 */
+	uint16_t id;        /**< Feature ID, DFH bits 11:0 */
+	uint8_t revision;   /**< Feature revision, DFH bits 15:12 */
+	uint8_t type;       /**< Feature type, DFH bits 63:60 */
+	fpga_guid guid;     /**< Feature GUID. Zero for private features */
+} fpga_feature_info;
+
+/** One buffer of a fpgaPrepareBuffers() call
+ *
+ * `len` is an input. `buf_addr` is an input when FPGA_BUF_PREALLOCATED is
+ * given and an output otherwise. `wsid` and `ioaddr` are outputs.
+ */
+typedef struct fpga_buffer_desc {
+	uint64_t len;       /**< Length of the buffer in bytes */
+	void *buf_addr;     /**< Virtual address of the buffer */
+	uint64_t wsid;      /**< Workspace ID, as from fpgaPrepareBuffer() */
+	uint64_t ioaddr;    /**< IO address, as from fpgaGetIOAddress() */
+} fpga_buffer_desc;
+
+/**
+ * Flags of fpga_properties_snapshot::valid_fields
+ *
+ * Each flag marks the corresponding member of the snapshot as set.
+ * Object-specific flags overlap, and are interpreted according to
+ * the snapshot's objtype.
+ */
+#define FPGA_SNAPSHOT_PARENT            (1ULL << 0)
+#define FPGA_SNAPSHOT_OBJTYPE           (1ULL << 1)
+#define FPGA_SNAPSHOT_SEGMENT           (1ULL << 2)
+#define FPGA_SNAPSHOT_BUS               (1ULL << 3)
+#define FPGA_SNAPSHOT_DEVICE            (1ULL << 4)
+#define FPGA_SNAPSHOT_FUNCTION          (1ULL << 5)
+#define FPGA_SNAPSHOT_SOCKETID          (1ULL << 6)
+#define FPGA_SNAPSHOT_VENDORID          (1ULL << 7)
+#define FPGA_SNAPSHOT_DEVICEID          (1ULL << 8)
+#define FPGA_SNAPSHOT_GUID              (1ULL << 9)
+#define FPGA_SNAPSHOT_OBJECTID          (1ULL << 10)
+#define FPGA_SNAPSHOT_NUM_ERRORS        (1ULL << 11)
+/* FPGA_DEVICE */
+#define FPGA_SNAPSHOT_NUM_SLOTS         (1ULL << 32)
+#define FPGA_SNAPSHOT_BBSID             (1ULL << 33)
+#define FPGA_SNAPSHOT_BBSVERSION        (1ULL << 34)
+/* FPGA_ACCELERATOR */
+#define FPGA_SNAPSHOT_ACCELERATOR_STATE (1ULL << 32)
+#define FPGA_SNAPSHOT_NUM_MMIO          (1ULL << 33)
+#define FPGA_SNAPSHOT_NUM_INTERRUPTS    (1ULL << 34)
+
+/**
+ * Plain copy of an fpga_properties object
+ *
+ * Filled by fpgaPropertiesGetSnapshot(). Members whose flag is clear
+ * in valid_fields are zero.
+ */
+typedef struct fpga_properties_snapshot {
+	uint64_t valid_fields;       /**< FPGA_SNAPSHOT_* flags */
+	fpga_token parent;           /**< Owned by the properties object */
+	fpga_objtype objtype;
+	uint16_t segment;
+	uint8_t bus;
+	uint8_t device;
+	uint8_t function;
+	uint8_t socket_id;
+	uint16_t vendor_id;
+	uint16_t device_id;
+	fpga_guid guid;
+	uint64_t object_id;
+	uint32_t num_errors;
+	union {
+		struct {
+			uint32_t num_slots;
+			uint64_t bbs_id;
+			fpga_version bbs_version;
+		} fpga;               /**< Valid for FPGA_DEVICE */
+		struct {
+			fpga_accelerator_state state;
+			uint32_t num_mmio;
+			uint32_t num_interrupts;
+		} accelerator;        /**< Valid for FPGA_ACCELERATOR */
+	} u;
+} fpga_properties_snapshot;
+
 #endif // __FPGA_TYPES_H__
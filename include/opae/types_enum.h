@@ -122,9 +122,25 @@ typedef enum {
 enum fpga_buffer_flags {
 	FPGA_BUF_PREALLOCATED = (1u << 0), /**< Use existing buffer */
 	FPGA_BUF_QUIET = (1u << 1),        /**< Suppress error messages */
-	FPGA_BUF_READ_ONLY = (1u << 2)     /**< Buffer is read-only */
+	FPGA_BUF_READ_ONLY = (1u << 2),    /**< Buffer is read-only */
+	FPGA_BUF_PREFAULT = (1u << 3),     /**< Fault pages in before pinning */
+	FPGA_BUF_ZERO = (1u << 4)          /**< Prefault and zero the buffer */
 };
 
+/**
+ * Thread count for FPGA_BUF_PREFAULT and FPGA_BUF_ZERO
+ *
+ * Bitwise OR FPGA_BUF_PREFAULT_THREADS(n) into the fpgaPrepareBuffer()
+ * flags to fault the buffer in with n threads. Without it, or with
+ * n == 0, the thread count is chosen from the buffer size and the CPUs
+ * on the device's NUMA node.
+ */
+#define FPGA_BUF_PREFAULT_THREADS_SHIFT 16
+#define FPGA_BUF_PREFAULT_THREADS_MASK  (0xffu << FPGA_BUF_PREFAULT_THREADS_SHIFT)
+#define FPGA_BUF_PREFAULT_THREADS(n) \
+	((int)(((unsigned)(n) << FPGA_BUF_PREFAULT_THREADS_SHIFT) & \
+	       FPGA_BUF_PREFAULT_THREADS_MASK))
+
 /**
  * Open flags
  *
@@ -147,6 +163,18 @@ enum fpga_reconf_flags {
 	FPGA_RECONF_SKIP_USRCLK = (1u << 1)
 };
 
+/**
+ * MMIO burst flags
+ *
+ * These flags can be passed to the fpgaWriteMMIOBurst() function.
+ */
+enum fpga_mmio_burst_flags {
+	/** Write every line to the same offset, e.g. a submission portal */
+	FPGA_MMIO_BURST_FIXED = (1u << 0),
+	/** Fail unless each line reaches the device as one 64-byte write */
+	FPGA_MMIO_BURST_ATOMIC = (1u << 1)
+};
+
 enum fpga_sysobject_flags {
 	FPGA_OBJECT_SYNC = (1u << 0), /**< Synchronize data from driver */
 	FPGA_OBJECT_GLOB = (1u << 1), /**< Treat names as glob expressions */
@@ -47,6 +47,7 @@
 
 #include <linux/vfio.h>
 #include <opae/mem_alloc.h>
+#include <opae/mem_prefault.h>
 
 /**
  * IO Virtual Address Range
@@ -124,6 +125,15 @@ struct opae_vfio_device {
 	struct opae_vfio_device_irq *irqs;		/**< IRQ list pointer. */
 };
 
+/**
+ * Buffer flags
+ *
+ * These flags can be passed to opae_vfio_buffer_allocate_ex().
+ */
+#define OPAE_VFIO_BUF_PREALLOCATED 0x1 /**< Register caller-owned memory. */
+#define OPAE_VFIO_BUF_READ_ONLY    0x2 /**< Device may only read the buffer. */
+#define OPAE_VFIO_BUF_QUIET        0x4 /**< Suppress mapping error messages. */
+
 /**
  * System DMA buffer
  *
@@ -133,6 +143,7 @@ struct opae_vfio_buffer {
 	uint8_t *buffer_ptr;		/**< Buffer virtual address. */
 	size_t buffer_size;		/**< Buffer size. */
 	uint64_t buffer_iova;		/**< Buffer IOVA address. */
+	int flags;			/**< OPAE_VFIO_BUF_* flags. */
 	struct opae_vfio_buffer *next;	/**< Pointer to next in list. */
 };
 
@@ -153,6 +164,8 @@ struct opae_vfio {
 	struct opae_vfio_group group;			/**< The VFIO device group. */
 	struct opae_vfio_device device;			/**< The VFIO device. */
 	struct opae_vfio_buffer *cont_buffers;		/**< List of allocated DMA buffers. */
+	struct opae_vfio *cont_owner;			/**< Container owner, when attached. */
+	uint32_t cont_users;				/**< Count of devices attached to our container. */
 };
 
 #ifdef __cplusplus
@@ -221,6 +234,70 @@ int opae_vfio_secure_open(struct opae_vfio *v,
 			  const char *pciaddr,
 			  const char *token);
 
+/**
+ * Open a VFIO device into an existing container
+ *
+ * Like opae_vfio_open, except that the device's VFIO group is added to
+ * the container of owner instead of a new container. All devices that
+ * share a container share one IOMMU domain, IOVA space, and set of
+ * DMA buffers. A buffer allocated (or registered) through any of them
+ * is mapped once and is visible to every device in the container at
+ * the same IOVA, so data may be passed between devices without copies.
+ *
+ * The group must be able to share the owner's IOMMU domain, or this
+ * call fails. IOVA ranges are those discovered when owner was opened.
+ *
+ * @note owner must remain open until every device attached to its
+ * container has been closed with opae_vfio_close. Closing owner
+ * releases all DMA buffers of the container.
+ *
+ * @param[out] v       Storage for the device info. May be stack-resident.
+ * @param[in]  pciaddr The PCIe address of the requested device.
+ * @param[in]  owner   A device previously opened by opae_vfio_open or
+ *                     opae_vfio_secure_open. If owner is itself
+ *                     attached, its container owner is used.
+ * @returns Non-zero on error. Zero on success.
+ *
+ * Example
+ * @code{.c}
+ * opae_vfio v0;
+ * opae_vfio v1;
+ * size_t sz = 2 * 1024 * 1024;
+ * uint8_t *buf = NULL;
+ * uint64_t iova = 0;
+ *
+ * if (opae_vfio_open(&v0, "0000:00:00.0") ||
+ *     opae_vfio_open_shared(&v1, "0000:01:00.0", &v0)) {
+ *   // handle error
+ * } else {
+ *   // one buffer, visible to both devices at iova
+ *   opae_vfio_buffer_allocate(&v1, &sz, &buf, &iova);
+ *   ...
+ *   opae_vfio_close(&v1);
+ *   opae_vfio_close(&v0);
+ * }
+ * @endcode
+ */
+int opae_vfio_open_shared(struct opae_vfio *v,
+			  const char *pciaddr,
+			  struct opae_vfio *owner);
+
+/**
+ * Open a VFIO device into an existing container, using a VF token
+ *
+ * The combination of opae_vfio_secure_open and opae_vfio_open_shared.
+ *
+ * @param[out] v       Storage for the device info. May be stack-resident.
+ * @param[in]  pciaddr The PCIe address of the requested device.
+ * @param[in]  token   The GUID representing the VF token.
+ * @param[in]  owner   The device whose container is to be shared.
+ * @returns Non-zero on error. Zero on success.
+ */
+int opae_vfio_secure_open_shared(struct opae_vfio *v,
+				 const char *pciaddr,
+				 const char *token,
+				 struct opae_vfio *owner);
+
 /**
  * Query device MMIO region
  *
@@ -262,15 +339,19 @@ int opae_vfio_region_get(struct opae_vfio *v,
  * Allocate and map system buffer
  *
  * Allocate, map, and retrieve info for a system buffer capable of
- * DMA. Saves an entry in the v->cont_buffers list. If the buffer
+ * DMA. Saves an entry in the v->cont_buffers list (of the container
+ * owner, for a device opened by opae_vfio_open_shared). If the buffer
  * is not explicitly freed by opae_vfio_buffer_free, it will be
- * freed during opae_vfio_close.
+ * freed during opae_vfio_close of the container owner.
  *
  * mmap is used for the allocation. If the size is greater than 2MB,
- * then the allocation request is fulfilled by a 1GB huge page. Else,
- * if the size is greater than 4096, then the request is fulfilled by
- * a 2MB huge page. Else, the request is fulfilled by the non-huge
- * page pool.
+ * then the size is rounded up to a multiple of 2MB and the buffer is
+ * composed of several huge pages placed back-to-back: 1GB pages for
+ * each 1GB-aligned run while the 1GB pool lasts, and 2MB pages for
+ * the remainder. Each page is mapped separately into a single
+ * contiguous IOVA range, so the device sees one buffer. Else, if the
+ * size is greater than 4096, then the request is fulfilled by a 2MB
+ * huge page. Else, the request is fulfilled by the non-huge page pool.
  *
  * @note Allocations from the huge page pool require that huge pages
  * be configured on the system. Huge pages may be configured on the
@@ -332,11 +413,111 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 			      uint8_t **buf,
 			      uint64_t *iova);
 
+/**
+ * Allocate and map, or register, a system buffer
+ *
+ * Behaves as opae_vfio_buffer_allocate when flags does not contain
+ * OPAE_VFIO_BUF_PREALLOCATED, additionally honoring
+ * OPAE_VFIO_BUF_READ_ONLY and OPAE_VFIO_BUF_QUIET.
+ *
+ * When flags contains OPAE_VFIO_BUF_PREALLOCATED, no memory is
+ * allocated. Instead, the caller-owned memory at *buf (for example,
+ * a hugetlbfs or memfd mapping) is pinned and mapped into IOVA space
+ * so that the device may access it in place. *buf and *size must both
+ * be page-aligned, and the range must not overlap a buffer that is
+ * already mapped. opae_vfio_buffer_free unregisters such a buffer
+ * without unmapping it from the process.
+ *
+ * @param[in, out] v     The open OPAE VFIO device.
+ * @param[in, out] size  A pointer to the requested size. Rounded as
+ *                       for opae_vfio_buffer_allocate, unless
+ *                       OPAE_VFIO_BUF_PREALLOCATED is given.
+ * @param[in, out] buf   Receives the virtual address of an allocated
+ *                       buffer. With OPAE_VFIO_BUF_PREALLOCATED,
+ *                       holds the address of the memory to register.
+ * @param[out]     iova  Optional pointer to receive the IOVA address
+ *                       for the buffer. Pass NULL to ignore.
+ * @param[in]      flags Bitwise OR of OPAE_VFIO_BUF_* flags.
+ *                       OPAE_VFIO_BUF_READ_ONLY maps the buffer for
+ *                       device reads only.
+ * @returns Non-zero on error. Zero on success.
+ *
+ * Example
+ * @code{.c}
+ * size_t sz = 4 * 1024 * 1024;
+ * uint8_t *mem = mmap(NULL, sz, PROT_READ|PROT_WRITE,
+ *                     MAP_SHARED, memfd, 0);
+ * uint64_t iova = 0;
+ *
+ * if (opae_vfio_buffer_allocate_ex(&v, &sz, &mem, &iova,
+ *                                  OPAE_VFIO_BUF_PREALLOCATED)) {
+ *   // handle registration error
+ * } else {
+ *   // program the device with iova
+ *
+ *   opae_vfio_buffer_free(&v, mem); // mem remains mapped
+ * }
+ * @endcode
+ */
+int opae_vfio_buffer_allocate_ex(struct opae_vfio *v,
+				 size_t *size,
+				 uint8_t **buf,
+				 uint64_t *iova,
+				 int flags);
+
+/**
+ * Allocate and map, or register, a prefaulted system buffer
+ *
+ * Behaves as opae_vfio_buffer_allocate_ex, but when p is not NULL the
+ * buffer is faulted in by mem_prefault() before it is pinned and
+ * mapped into IOVA space. Pinning faults pages in one at a time, so
+ * this is much faster for large buffers.
+ *
+ * Fresh buffers are zeroed by the kernel as they are faulted in.
+ * MEM_PREFAULT_ZERO in p->flags additionally clears preallocated
+ * memory.
+ *
+ * @param[in, out] v     The open OPAE VFIO device.
+ * @param[in, out] size  As for opae_vfio_buffer_allocate_ex.
+ * @param[in, out] buf   As for opae_vfio_buffer_allocate_ex.
+ * @param[out]     iova  As for opae_vfio_buffer_allocate_ex.
+ * @param[in]      flags Bitwise OR of OPAE_VFIO_BUF_* flags.
+ * @param[in, out] p     Prefault options, or NULL. A negative
+ *                       p->numa_node places the buffer on the node of
+ *                       the device v, and is replaced by that node.
+ *                       p->threads and p->nsec report the work done.
+ * @returns Non-zero on error. Zero on success.
+ *
+ * Example
+ * @code{.c}
+ * size_t sz = 16UL * 1024 * 1024 * 1024;
+ * uint8_t *buf = NULL;
+ * uint64_t iova = 0;
+ * struct mem_prefault p = { 0, -1, 0, 0 };
+ *
+ * if (opae_vfio_buffer_allocate_prefault(&v, &sz, &buf, &iova, 0, &p)) {
+ *   // handle allocation error
+ * } else {
+ *   printf("node %d, %u threads, %lu ns\n",
+ *          p.numa_node, p.threads, p.nsec);
+ * }
+ * @endcode
+ */
+int opae_vfio_buffer_allocate_prefault(struct opae_vfio *v,
+				       size_t *size,
+				       uint8_t **buf,
+				       uint64_t *iova,
+				       int flags,
+				       struct mem_prefault *p);
+
 /**
  * Unmap and free a system buffer
  *
  * The buffer corresponding to buf must have been created by a
- * previous call to opae_vfio_buffer_allocate.
+ * previous call to opae_vfio_buffer_allocate or
+ * opae_vfio_buffer_allocate_ex. Buffers registered with
+ * OPAE_VFIO_BUF_PREALLOCATED are unmapped from IOVA space only;
+ * the caller's memory is left intact.
  *
  * @param[in, out] v   The open OPAE VFIO device.
  * @param[in]      buf The virtual address corresponding to
@@ -385,6 +566,28 @@ int opae_vfio_irq_enable(struct opae_vfio *v,
 			 uint32_t subindex,
 			 int event_fd);
 
+/**
+ * Enable a range of IRQs
+ *
+ * Enables IRQs start through start + count - 1 with a single
+ * VFIO_DEVICE_SET_IRQS request.
+ *
+ * @param[in, out] v         The open OPAE VFIO device.
+ * @param[in]      index     The IRQ category. For MSI-X,
+ *                           use VFIO_PCI_MSIX_IRQ_INDEX.
+ * @param[in]      start     The first IRQ to enable.
+ * @param[in]      count     The number of IRQs to enable.
+ * @param[in]      event_fds count file descriptors, created
+ *                           by eventfd(). IRQ start + i signals
+ *                           event_fds[i].
+ * @returns Non-zero on error. Zero on success.
+ */
+int opae_vfio_irq_enable_range(struct opae_vfio *v,
+			       uint32_t index,
+			       uint32_t start,
+			       uint32_t count,
+			       const int *event_fds);
+
 /**
  * Unmask an IRQ
  *
@@ -424,6 +627,24 @@ int opae_vfio_irq_disable(struct opae_vfio *v,
 			  uint32_t index,
 			  uint32_t subindex);
 
+/**
+ * Disable a range of IRQs
+ *
+ * Disables IRQs start through start + count - 1 with a single
+ * VFIO_DEVICE_SET_IRQS request.
+ *
+ * @param[in, out] v        The open OPAE VFIO device.
+ * @param[in]      index    The IRQ category. For MSI-X,
+ *                          use VFIO_PCI_MSIX_IRQ_INDEX.
+ * @param[in]      start    The first IRQ to disable.
+ * @param[in]      count    The number of IRQs to disable.
+ * @returns Non-zero on error. Zero on success.
+ */
+int opae_vfio_irq_disable_range(struct opae_vfio *v,
+				uint32_t index,
+				uint32_t start,
+				uint32_t count);
+
 /**
  * Release and close a VFIO device
  *
@@ -28,3 +28,195 @@
 #endif // HAVE_CONFIG_H
 
 #include <ofs/ofs_primitives.h>
+
+/* external definitions of the inline primitives */
+extern inline void ofs_cpu_relax(void);
+extern inline int ofs_diff_timespec(struct timespec *result,
+				    struct timespec *lhs, struct timespec *rhs);
+extern inline int ofs_wait_for_eq32(uint32_t *var, uint32_t value,
+				    uint64_t timeout_usec, uint32_t sleep_usec);
+extern inline int ofs_wait_for_eq64(uint64_t *var, uint64_t value,
+				    uint64_t timeout_usec, uint32_t sleep_usec);
+
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define OFS_X86 1
+#endif // __x86_64__ || __i386__
+
+/* wait clock ticks per nsec, 1.0 when the clock is CLOCK_MONOTONIC */
+static double ticks_per_nsec = 1.0;
+static int use_tsc;
+static int have_umwait;
+static pthread_once_t wait_clock_once = PTHREAD_ONCE_INIT;
+
+#define TSC_CALIBRATE_NSEC 1000000
+
+static uint64_t monotonic_nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * SEC2NSEC + ts.tv_nsec;
+}
+
+#ifdef OFS_X86
+static inline void ofs_umonitor(volatile void *addr)
+{
+	/* umonitor %rax */
+	__asm__ __volatile__(".byte 0xf3, 0x0f, 0xae, 0xf0" :: "a"(addr));
+}
+
+static inline void ofs_umwait(uint64_t deadline)
+{
+	/* umwait %ecx, ecx=0 selects the C0.2 state */
+	__asm__ __volatile__(".byte 0xf2, 0x0f, 0xae, 0xf1"
+			     :: "c"(0), "d"((uint32_t)(deadline >> 32)),
+			     "a"((uint32_t)deadline)
+			     : "memory", "cc");
+}
+#endif // OFS_X86
+
+static void wait_clock_init(void)
+{
+#ifdef OFS_X86
+	unsigned int eax, ebx, ecx, edx;
+	uint64_t ns0, ns1, tsc0, tsc1;
+
+	/* invariant TSC */
+	if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ||
+	    !(edx & (1 << 8)))
+		return;
+
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+		have_umwait = !!(ecx & (1 << 5)); /* WAITPKG */
+
+	ns0 = monotonic_nsec();
+	tsc0 = __rdtsc();
+	do {
+		ns1 = monotonic_nsec();
+	} while (ns1 - ns0 < TSC_CALIBRATE_NSEC);
+	tsc1 = __rdtsc();
+
+	ticks_per_nsec = (double)(tsc1 - tsc0) / (double)(ns1 - ns0);
+	use_tsc = 1;
+#endif // OFS_X86
+}
+
+uint64_t ofs_wait_clock(void)
+{
+#ifdef OFS_X86
+	if (use_tsc)
+		return __rdtsc();
+#endif // OFS_X86
+	return monotonic_nsec();
+}
+
+uint64_t ofs_wait_ticks_to_nsec(uint64_t ticks)
+{
+	return (uint64_t)(ticks / ticks_per_nsec);
+}
+
+static inline uint64_t usec_to_ticks(uint64_t usec)
+{
+	return (uint64_t)(usec * USEC2NSEC * ticks_per_nsec);
+}
+
+void ofs_wait_begin(struct ofs_wait *w, uint64_t timeout_usec,
+		    const struct ofs_wait_policy *policy)
+{
+	uint64_t spin_usec = OFS_WAIT_DEFAULT_SPIN_USEC;
+
+	pthread_once(&wait_clock_once, wait_clock_init);
+
+	w->sleep_usec = OFS_WAIT_DEFAULT_SLEEP_USEC;
+	w->max_sleep_usec = OFS_WAIT_DEFAULT_MAX_SLEEP_USEC;
+	w->flags = 0;
+
+	if (policy) {
+		spin_usec = policy->spin_usec;
+		w->sleep_usec = policy->sleep_usec ? policy->sleep_usec : 1;
+		w->max_sleep_usec = policy->max_sleep_usec;
+		if (w->max_sleep_usec < w->sleep_usec)
+			w->max_sleep_usec = w->sleep_usec;
+		w->flags = policy->flags;
+	}
+
+	w->begin = ofs_wait_clock();
+	w->spin_end = w->begin + usec_to_ticks(spin_usec);
+	w->deadline = w->begin + usec_to_ticks(timeout_usec);
+}
+
+int ofs_wait_backoff(struct ofs_wait *w, volatile void *monitor_addr)
+{
+	uint64_t now = ofs_wait_clock();
+	uint64_t sleep_ticks;
+	uint64_t nsec;
+	struct timespec ts;
+
+	if (now >= w->deadline)
+		return 1;
+
+	if (now < w->spin_end) {
+		ofs_cpu_relax();
+		return 0;
+	}
+
+	sleep_ticks = usec_to_ticks(w->sleep_usec);
+	if (sleep_ticks > w->deadline - now)
+		sleep_ticks = w->deadline - now;
+
+	if (w->sleep_usec < w->max_sleep_usec) {
+		w->sleep_usec <<= 1;
+		if (w->sleep_usec > w->max_sleep_usec)
+			w->sleep_usec = w->max_sleep_usec;
+	}
+
+#ifdef OFS_X86
+	if ((w->flags & OFS_WAIT_UMWAIT) && have_umwait && monitor_addr) {
+		/*
+		 * A write landing between the caller's check and umonitor is
+		 * not seen, so umwait is bounded by the sleep interval.
+		 */
+		ofs_umonitor(monitor_addr);
+		ofs_umwait(now + sleep_ticks);
+		return 0;
+	}
+#else
+	(void)monitor_addr;
+#endif // OFS_X86
+
+	nsec = ofs_wait_ticks_to_nsec(sleep_ticks);
+	ts.tv_sec = nsec / SEC2NSEC;
+	ts.tv_nsec = nsec % SEC2NSEC;
+	nanosleep(&ts, NULL);
+	return 0;
+}
+
+uint64_t ofs_wait_elapsed_nsec(const struct ofs_wait *w)
+{
+	return ofs_wait_ticks_to_nsec(ofs_wait_clock() - w->begin);
+}
+
+#define OFS_ADAPTIVE_WAIT_FN(_name, _type, _cond)                           \
+int _name(volatile _type *var, _type value, uint64_t timeout_usec,          \
+	  const struct ofs_wait_policy *policy, uint64_t *elapsed_nsec)     \
+{                                                                           \
+	int status = 0;                                                     \
+	struct ofs_wait w;                                                  \
+	ofs_wait_begin(&w, timeout_usec, policy);                           \
+	while (!(*var _cond value)) {                                       \
+		if (ofs_wait_backoff(&w, var)) {                            \
+			status = 1;                                         \
+			break;                                              \
+		}                                                           \
+	}                                                                   \
+	if (elapsed_nsec)                                                   \
+		*elapsed_nsec = ofs_wait_elapsed_nsec(&w);                  \
+	return status;                                                      \
+}
+
+OFS_ADAPTIVE_WAIT_FN(ofs_adaptive_wait_for_eq32, uint32_t, ==)
+OFS_ADAPTIVE_WAIT_FN(ofs_adaptive_wait_for_eq64, uint64_t, ==)
+OFS_ADAPTIVE_WAIT_FN(ofs_adaptive_wait_for_ne32, uint32_t, !=)
+OFS_ADAPTIVE_WAIT_FN(ofs_adaptive_wait_for_ne64, uint64_t, !=)
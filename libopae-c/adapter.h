@@ -71,16 +71,30 @@ typedef struct _opae_api_adapter_table {
 	fpga_result (*fpgaWriteMMIO512)(fpga_handle handle, uint32_t mmio_num,
 				       uint64_t offset, void *value);
 
+	// optional
+	fpga_result (*fpgaWriteMMIOBurst)(fpga_handle handle,
+					  uint32_t mmio_num, uint64_t offset,
+					  const void *lines, uint32_t num_lines,
+					  int flags);
+
 	fpga_result (*fpgaMapMMIO)(fpga_handle handle, uint32_t mmio_num,
 				   uint64_t **mmio_ptr);
 
 	fpga_result (*fpgaUnmapMMIO)(fpga_handle handle, uint32_t mmio_num);
 
+	fpga_result (*fpgaFindFeature)(fpga_handle handle, fpga_guid guid,
+				       uint16_t id, fpga_feature_info *info);
+
 	fpga_result (*fpgaEnumerate)(const fpga_properties *filters,
 				     uint32_t num_filters, fpga_token *tokens,
 				     uint32_t max_tokens,
 				     uint32_t *num_matches);
 
+	fpga_result (*fpgaEnumerateAll)(const fpga_properties *filters,
+					uint32_t num_filters,
+					fpga_token **tokens,
+					uint32_t *num_tokens);
+
 	fpga_result (*fpgaCloneToken)(fpga_token src, fpga_token *dst);
 
 	fpga_result (*fpgaDestroyToken)(fpga_token *token);
@@ -102,6 +116,12 @@ typedef struct _opae_api_adapter_table {
 
 	fpga_result (*fpgaGetIOAddress)(fpga_handle handle, uint64_t wsid,
 					uint64_t *ioaddr);
+
+	fpga_result (*fpgaPrepareBuffers)(fpga_handle handle, uint32_t count,
+					  fpga_buffer_desc *bufs, int flags);
+
+	fpga_result (*fpgaReleaseBuffers)(fpga_handle handle, uint32_t count,
+					  const uint64_t *wsids);
 	/*
 	**	fpga_result (*fpgaGetOPAECVersion)(fpga_version *version);
 	**
@@ -142,6 +162,16 @@ typedef struct _opae_api_adapter_table {
 					   fpga_event_type event_type,
 					   fpga_event_handle event_handle);
 
+	// optional
+	fpga_result (*fpgaRegisterInterruptEvents)(
+		fpga_handle handle, uint32_t start, uint32_t count,
+		fpga_event_handle *event_handles);
+
+	// optional
+	fpga_result (*fpgaUnregisterInterruptEvents)(
+		fpga_handle handle, uint32_t count,
+		fpga_event_handle *event_handles);
+
 	fpga_result (*fpgaAssignPortToInterface)(fpga_handle fpga,
 						 uint32_t interface_num,
 						 uint32_t slot_num, int flags);
@@ -187,6 +217,11 @@ typedef struct _opae_api_adapter_table {
 	fpga_result (*fpgaObjectWrite64)(fpga_object obj, uint64_t value,
 					 int flags);
 
+	fpga_result (*fpgaObjectSync)(fpga_object obj, int flags);
+
+	fpga_result (*fpgaObjectGetTimestamp)(fpga_object obj,
+					      uint64_t *timestamp);
+
 	fpga_result (*fpgaSetUserClock)(fpga_handle handle, uint64_t high_clk,
 					uint64_t low_clk, int flags);
 
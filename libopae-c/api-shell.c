@@ -33,7 +33,9 @@
 #endif // _GNU_SOURCE
 
 #include <stdio.h>
+#include <string.h>
 
+#include <opae/enum.h>
 #include <opae/properties.h>
 #include <opae/types_enum.h>
 
@@ -499,7 +501,7 @@ fpga_result __OPAE_API__ fpgaUpdateProperties(fpga_token token,
 	// If the input properties already has a parent token
 	// set, then it will be wrapped.
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -601,6 +603,69 @@ fpga_result __OPAE_API__ fpgaWriteMMIO512(fpga_handle handle,
 		wrapped_handle->opae_handle, mmio_num, offset, value);
 }
 
+fpga_result __OPAE_API__ fpgaWriteMMIOBurst(fpga_handle handle,
+	uint32_t mmio_num, uint64_t offset, const void *lines,
+	uint32_t num_lines, int flags)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	opae_api_adapter_table *adapter;
+	const uint8_t *line = (const uint8_t *)lines;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+	int j;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+
+	adapter = wrapped_handle->adapter_table;
+	if (adapter->fpgaWriteMMIOBurst)
+		return adapter->fpgaWriteMMIOBurst(wrapped_handle->opae_handle,
+						   mmio_num, offset, lines,
+						   num_lines, flags);
+
+	if (offset % 64) {
+		OPAE_MSG("Misaligned MMIO access");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (num_lines)
+		ASSERT_NOT_NULL(lines);
+
+	/*
+	 * The plugin can't burst: write line by line, with 512-bit writes
+	 * when it has them and 64-bit writes otherwise.
+	 */
+	for (i = 0 ; (i < num_lines) && (res == FPGA_OK) ; ++i, line += 64) {
+		uint64_t off = (flags & FPGA_MMIO_BURST_FIXED) ?
+			offset : offset + (uint64_t)i * 64;
+
+		res = FPGA_NOT_SUPPORTED;
+		if (adapter->fpgaWriteMMIO512)
+			res = adapter->fpgaWriteMMIO512(
+				wrapped_handle->opae_handle, mmio_num, off,
+				(void *)line);
+
+		if ((res != FPGA_NOT_SUPPORTED) ||
+		    (flags & FPGA_MMIO_BURST_ATOMIC))
+			continue;
+
+		ASSERT_NOT_NULL_RESULT(adapter->fpgaWriteMMIO64,
+				       FPGA_NOT_SUPPORTED);
+
+		res = FPGA_OK;
+		for (j = 0 ; (j < 8) && (res == FPGA_OK) ; ++j) {
+			uint64_t q;
+
+			memcpy(&q, line + j * 8, sizeof(q));
+			res = adapter->fpgaWriteMMIO64(
+				wrapped_handle->opae_handle, mmio_num,
+				off + j * 8, q);
+		}
+	}
+
+	return res;
+}
+
 fpga_result __OPAE_API__ fpgaMapMMIO(fpga_handle handle, uint32_t mmio_num,
 			uint64_t **mmio_ptr)
 {
@@ -628,6 +693,21 @@ fpga_result __OPAE_API__ fpgaUnmapMMIO(fpga_handle handle, uint32_t mmio_num)
 		wrapped_handle->opae_handle, mmio_num);
 }
 
+fpga_result __OPAE_API__ fpgaFindFeature(fpga_handle handle, fpga_guid guid,
+					 uint16_t id, fpga_feature_info *info)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(info);
+	ASSERT_NOT_NULL_RESULT(wrapped_handle->adapter_table->fpgaFindFeature,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_handle->adapter_table->fpgaFindFeature(
+		wrapped_handle->opae_handle, guid, id, info);
+}
+
 typedef struct _opae_enumeration_context {
 	// <verbatim from fpgaEnumerate>
 	const fpga_properties *filters;
@@ -702,31 +782,72 @@ static int opae_enumerate(const opae_api_adapter_table *adapter, void *context)
 		       : OPAE_ENUM_CONTINUE;
 }
 
-fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
-	uint32_t num_filters, fpga_token *tokens, uint32_t max_tokens,
-	uint32_t *num_matches)
+// Copy filter p, replacing its wrapped parent with the plugin's token.
+STATIC fpga_properties opae_unwrap_filter(struct _fpga_properties *p,
+					  opae_wrapped_token *wrapped_parent)
 {
-	fpga_result res = FPGA_EXCEPTION;
-	fpga_token *adapter_tokens = NULL;
+	struct _fpga_properties *copy;
+	pthread_mutex_t save_lock;
 
-	opae_enumeration_context enum_context;
+	copy = opae_properties_create();
+	if (!copy)
+		return NULL;
+
+	save_lock = copy->lock;
 
-	typedef struct _parent_token_fixup {
-		struct _parent_token_fixup *next;
-		fpga_properties prop;
-		opae_wrapped_token *wrapped_token;
-	} parent_token_fixup;
+	*copy = *p;
+	copy->lock = save_lock;
+	copy->frozen = 0;
+	copy->parent = wrapped_parent->opae_token;
 
-	parent_token_fixup *ptf_list = NULL;
+	return copy;
+}
+
+STATIC void opae_destroy_unwrapped_filter(fpga_properties prop)
+{
+	struct _fpga_properties *p = (struct _fpga_properties *)prop;
+	int err;
+
+	p->magic = 0;
+	err = pthread_mutex_destroy(&p->lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_destroy() failed: %s", strerror(err));
+	free(p);
+}
+
+// Release the filter array built by opae_adapter_filters().
+STATIC void opae_release_adapter_filters(const fpga_properties *filters,
+					 fpga_properties *adapter_filters,
+					 uint32_t num_filters)
+{
 	uint32_t i;
 
-	ASSERT_NOT_NULL(num_matches);
+	if (!adapter_filters)
+		return;
 
-	if ((max_tokens > 0) && !tokens) {
-		OPAE_ERR("max_tokens > 0 with NULL tokens");
-		return FPGA_INVALID_PARAM;
+	for (i = 0; i < num_filters; ++i) {
+		if (adapter_filters[i] &&
+		    adapter_filters[i] != filters[i])
+			opae_destroy_unwrapped_filter(adapter_filters[i]);
 	}
 
+	free(adapter_filters);
+}
+
+// If any of the input filters has a parent token set,
+// then it will be wrapped. The plugins see a private copy
+// of such filters, with the parent unwrapped, so that the
+// caller's filters are never modified (they may be frozen).
+STATIC fpga_result opae_adapter_filters(const fpga_properties *filters,
+					uint32_t num_filters,
+					fpga_properties **adapter_filters)
+{
+	fpga_properties *af;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	*adapter_filters = NULL;
+
 	if ((num_filters > 0) && !filters) {
 		OPAE_ERR("num_filters > 0 with NULL filters");
 		return FPGA_INVALID_PARAM;
@@ -737,105 +858,308 @@ fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
 		return FPGA_INVALID_PARAM;
 	}
 
-	*num_matches = 0;
-
-	enum_context.filters = filters;
-	enum_context.num_filters = num_filters;
-	enum_context.wrapped_tokens = tokens;
-	enum_context.max_wrapped_tokens = max_tokens;
-	enum_context.num_matches = num_matches;
+	if (!num_filters)
+		return FPGA_OK;
 
-	if (tokens) {
-		adapter_tokens =
-			(fpga_token *)calloc(max_tokens, sizeof(fpga_token));
-		if (!adapter_tokens) {
-			OPAE_ERR("out of memory");
-			return FPGA_NO_MEMORY;
-		}
+	af = (fpga_properties *)calloc(num_filters, sizeof(fpga_properties));
+	if (!af) {
+		OPAE_ERR("out of memory");
+		return FPGA_NO_MEMORY;
 	}
 
-	enum_context.adapter_tokens = adapter_tokens;
-	enum_context.num_wrapped_tokens = 0;
-	enum_context.errors = 0;
-
-	// If any of the input filters has a parent token set,
-	// then it will be wrapped. We need to unwrap it here,
-	// then re-wrap below.
 	for (i = 0; i < num_filters; ++i) {
-		int err;
+		bool locked;
 		struct _fpga_properties *p =
-			opae_validate_and_lock_properties(filters[i]);
+			opae_validate_and_lock_properties_ro(filters[i], &locked);
 
 		if (!p) {
 			OPAE_ERR("Invalid input filter");
 			res = FPGA_INVALID_PARAM;
-			goto out_free_tokens;
+			goto out_release;
 		}
 
+		af[i] = filters[i];
+
 		if (FIELD_VALID(p, FPGA_PROPERTY_PARENT)) {
-			parent_token_fixup *fixup;
 			opae_wrapped_token *wrapped_parent =
 				opae_validate_wrapped_token(p->parent);
 
 			if (!wrapped_parent) {
 				OPAE_ERR("Invalid wrapped parent in filter");
 				res = FPGA_INVALID_PARAM;
-				opae_mutex_unlock(err, &p->lock);
-				goto out_free_tokens;
+				opae_unlock_properties_ro(p, locked);
+				goto out_release;
 			}
 
-			fixup = (parent_token_fixup *)malloc(
-				sizeof(parent_token_fixup));
+			af[i] = opae_unwrap_filter(p, wrapped_parent);
 
-			if (!fixup) {
+			if (!af[i]) {
 				OPAE_ERR("malloc failed");
 				res = FPGA_NO_MEMORY;
-				opae_mutex_unlock(err, &p->lock);
-				goto out_free_tokens;
+				opae_unlock_properties_ro(p, locked);
+				goto out_release;
 			}
+		}
 
-			fixup->next = NULL;
-			fixup->prop = filters[i];
-			fixup->wrapped_token = wrapped_parent;
+		opae_unlock_properties_ro(p, locked);
+	}
 
-			if (!ptf_list)
-				ptf_list = fixup;
-			else {
-				fixup->next = ptf_list;
-				ptf_list = fixup;
-			}
+	*adapter_filters = af;
+	return FPGA_OK;
 
-			// Set the unwrapped parent token.
-			p->parent = wrapped_parent->opae_token;
-		}
+out_release:
+	opae_release_adapter_filters(filters, af, num_filters);
+	return res;
+}
 
-		opae_mutex_unlock(err, &p->lock);
+fpga_result __OPAE_API__ fpgaEnumerate(const fpga_properties *filters,
+	uint32_t num_filters, fpga_token *tokens, uint32_t max_tokens,
+	uint32_t *num_matches)
+{
+	fpga_result res = FPGA_EXCEPTION;
+	fpga_token *adapter_tokens = NULL;
+	fpga_properties *adapter_filters = NULL;
+
+	opae_enumeration_context enum_context;
+
+	ASSERT_NOT_NULL(num_matches);
+
+	if ((max_tokens > 0) && !tokens) {
+		OPAE_ERR("max_tokens > 0 with NULL tokens");
+		return FPGA_INVALID_PARAM;
 	}
 
+	res = opae_adapter_filters(filters, num_filters, &adapter_filters);
+	if (res != FPGA_OK)
+		return res;
+
+	*num_matches = 0;
+
+	enum_context.filters = adapter_filters;
+	enum_context.num_filters = num_filters;
+	enum_context.wrapped_tokens = tokens;
+	enum_context.max_wrapped_tokens = max_tokens;
+	enum_context.num_matches = num_matches;
+
+	if (tokens) {
+		adapter_tokens =
+			(fpga_token *)calloc(max_tokens, sizeof(fpga_token));
+		if (!adapter_tokens) {
+			OPAE_ERR("out of memory");
+			res = FPGA_NO_MEMORY;
+			goto out_free_filters;
+		}
+	}
+
+	enum_context.adapter_tokens = adapter_tokens;
+	enum_context.num_wrapped_tokens = 0;
+	enum_context.errors = 0;
+
 	// perform the enumeration.
 	opae_plugin_mgr_for_each_adapter(opae_enumerate, &enum_context);
 
 	res = (enum_context.errors > 0) ? FPGA_EXCEPTION : FPGA_OK;
 
-out_free_tokens:
 	if (adapter_tokens)
 		free(adapter_tokens);
 
-	// Re-establish any wrapped parent tokens.
-	while (ptf_list) {
-		int err;
-		parent_token_fixup *trash = ptf_list;
-		struct _fpga_properties *p =
-			opae_validate_and_lock_properties(trash->prop);
-		ptf_list = ptf_list->next;
+out_free_filters:
+	opae_release_adapter_filters(filters, adapter_filters, num_filters);
+
+	return res;
+}
 
-		if (p) {
-			p->parent = trash->wrapped_token;
-			opae_mutex_unlock(err, &p->lock);
+typedef struct _opae_enumerate_all_context {
+	const fpga_properties *filters;
+	uint32_t num_filters;
+	fpga_token *wrapped_tokens;
+	uint32_t num_wrapped_tokens;
+	uint32_t max_wrapped_tokens;
+	fpga_result result;
+} opae_enumerate_all_context;
+
+// Ask an adapter without fpgaEnumerateAll() for the count, then the tokens.
+STATIC fpga_result opae_enumerate_counted(const opae_api_adapter_table *adapter,
+					  const fpga_properties *filters,
+					  uint32_t num_filters,
+					  fpga_token **tokens,
+					  uint32_t *num_tokens)
+{
+	fpga_token *adapter_tokens;
+	uint32_t num_matches = 0;
+	uint32_t capacity;
+	fpga_result res;
+
+	*tokens = NULL;
+	*num_tokens = 0;
+
+	res = adapter->fpgaEnumerate(filters, num_filters,
+				     NULL, 0, &num_matches);
+	if (res != FPGA_OK || !num_matches)
+		return res;
+
+	capacity = num_matches;
+	adapter_tokens = (fpga_token *)calloc(capacity, sizeof(fpga_token));
+	if (!adapter_tokens) {
+		OPAE_ERR("out of memory");
+		return FPGA_NO_MEMORY;
+	}
+
+	res = adapter->fpgaEnumerate(filters, num_filters,
+				     adapter_tokens, capacity, &num_matches);
+	if (res != FPGA_OK) {
+		free(adapter_tokens);
+		return res;
+	}
+
+	// The device set may have changed between the two calls.
+	*tokens = adapter_tokens;
+	*num_tokens = (num_matches < capacity) ? num_matches : capacity;
+
+	return FPGA_OK;
+}
+
+static int opae_enumerate_all(const opae_api_adapter_table *adapter,
+			      void *context)
+{
+	opae_enumerate_all_context *ctx =
+		(opae_enumerate_all_context *)context;
+	fpga_token *adapter_tokens = NULL;
+	uint32_t num_adapter_tokens = 0;
+	uint32_t i = 0;
+
+	if (!adapter->fpgaEnumerate) {
+		OPAE_MSG("NULL fpgaEnumerate in adapter \"%s\"",
+			 adapter->plugin.path);
+		return OPAE_ENUM_CONTINUE;
+	}
+
+	if (adapter->fpgaEnumerateAll)
+		ctx->result = adapter->fpgaEnumerateAll(ctx->filters,
+							ctx->num_filters,
+							&adapter_tokens,
+							&num_adapter_tokens);
+	else
+		ctx->result = opae_enumerate_counted(adapter,
+						     ctx->filters,
+						     ctx->num_filters,
+						     &adapter_tokens,
+						     &num_adapter_tokens);
+
+	if (ctx->result != FPGA_OK) {
+		OPAE_ERR("fpgaEnumerate() failed for \"%s\"",
+			 adapter->plugin.path);
+		if (ctx->result != FPGA_NO_MEMORY)
+			ctx->result = FPGA_EXCEPTION;
+		return OPAE_ENUM_STOP;
+	}
+
+	if (ctx->num_wrapped_tokens + num_adapter_tokens >
+	    ctx->max_wrapped_tokens) {
+		uint32_t max = ctx->max_wrapped_tokens ?
+			ctx->max_wrapped_tokens : 16;
+		fpga_token *grown;
+
+		while (max < ctx->num_wrapped_tokens + num_adapter_tokens)
+			max *= 2;
+
+		grown = (fpga_token *)realloc(ctx->wrapped_tokens,
+					      max * sizeof(fpga_token));
+		if (!grown) {
+			OPAE_ERR("out of memory");
+			ctx->result = FPGA_NO_MEMORY;
+			goto out_destroy;
+		}
+
+		ctx->wrapped_tokens = grown;
+		ctx->max_wrapped_tokens = max;
+	}
+
+	for (i = 0; i < num_adapter_tokens; ++i) {
+		opae_wrapped_token *wt = opae_allocate_wrapped_token(
+			adapter_tokens[i], adapter);
+		if (!wt) {
+			ctx->result = FPGA_NO_MEMORY;
+			goto out_destroy;
 		}
 
-		free(trash);
+		ctx->wrapped_tokens[ctx->num_wrapped_tokens++] = wt;
+	}
+
+	free(adapter_tokens);
+	return OPAE_ENUM_CONTINUE;
+
+out_destroy:
+	if (adapter->fpgaDestroyToken) {
+		for ( ; i < num_adapter_tokens; ++i)
+			adapter->fpgaDestroyToken(&adapter_tokens[i]);
 	}
+	free(adapter_tokens);
+	return OPAE_ENUM_STOP;
+}
+
+fpga_result __OPAE_API__ fpgaEnumerateAll(const fpga_properties *filters,
+					  uint32_t num_filters,
+					  fpga_token **tokens,
+					  uint32_t *num_tokens)
+{
+	fpga_properties *adapter_filters = NULL;
+	opae_enumerate_all_context ctx;
+	fpga_result res;
+
+	ASSERT_NOT_NULL(tokens);
+	ASSERT_NOT_NULL(num_tokens);
+
+	*tokens = NULL;
+	*num_tokens = 0;
+
+	res = opae_adapter_filters(filters, num_filters, &adapter_filters);
+	if (res != FPGA_OK)
+		return res;
+
+	ctx.filters = adapter_filters;
+	ctx.num_filters = num_filters;
+	ctx.wrapped_tokens = NULL;
+	ctx.num_wrapped_tokens = 0;
+	ctx.max_wrapped_tokens = 0;
+	ctx.result = FPGA_OK;
+
+	opae_plugin_mgr_for_each_adapter(opae_enumerate_all, &ctx);
+
+	opae_release_adapter_filters(filters, adapter_filters, num_filters);
+
+	if (ctx.result != FPGA_OK) {
+		fpgaDestroyTokens(ctx.wrapped_tokens, ctx.num_wrapped_tokens);
+		return ctx.result;
+	}
+
+	*tokens = ctx.wrapped_tokens;
+	*num_tokens = ctx.num_wrapped_tokens;
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaDestroyTokens(fpga_token *tokens,
+					   uint32_t num_tokens)
+{
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	if (!tokens)
+		return num_tokens ? FPGA_INVALID_PARAM : FPGA_OK;
+
+	for (i = 0; i < num_tokens; ++i) {
+		fpga_result r;
+
+		if (!tokens[i])
+			continue;
+
+		r = fpgaDestroyToken(&tokens[i]);
+		if (r != FPGA_OK && res == FPGA_OK)
+			res = r;
+	}
+
+	free(tokens);
 
 	return res;
 }
@@ -972,6 +1296,100 @@ fpga_result __OPAE_API__ fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 		wrapped_handle->opae_handle, wsid, ioaddr);
 }
 
+fpga_result __OPAE_API__ fpgaPrepareBuffers(fpga_handle handle,
+					    uint32_t count,
+					    fpga_buffer_desc *bufs, int flags)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	const opae_api_adapter_table *adapter;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(bufs);
+
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	adapter = wrapped_handle->adapter_table;
+
+	if (adapter->fpgaPrepareBuffers)
+		return adapter->fpgaPrepareBuffers(
+			wrapped_handle->opae_handle, count, bufs, flags);
+
+	ASSERT_NOT_NULL_RESULT(adapter->fpgaPrepareBuffer,
+			       FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(adapter->fpgaGetIOAddress,
+			       FPGA_NOT_SUPPORTED);
+	ASSERT_NOT_NULL_RESULT(adapter->fpgaReleaseBuffer,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		res = adapter->fpgaPrepareBuffer(wrapped_handle->opae_handle,
+						 bufs[i].len,
+						 &bufs[i].buf_addr,
+						 &bufs[i].wsid, flags);
+		if (res != FPGA_OK)
+			break;
+
+		res = adapter->fpgaGetIOAddress(wrapped_handle->opae_handle,
+						bufs[i].wsid,
+						&bufs[i].ioaddr);
+		if (res != FPGA_OK) {
+			adapter->fpgaReleaseBuffer(wrapped_handle->opae_handle,
+						   bufs[i].wsid);
+			break;
+		}
+	}
+
+	if (res != FPGA_OK) {
+		while (i--)
+			adapter->fpgaReleaseBuffer(wrapped_handle->opae_handle,
+						   bufs[i].wsid);
+	}
+
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaReleaseBuffers(fpga_handle handle,
+					    uint32_t count,
+					    const uint64_t *wsids)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	const opae_api_adapter_table *adapter;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+
+	if (!count)
+		return FPGA_OK;
+
+	ASSERT_NOT_NULL(wsids);
+
+	adapter = wrapped_handle->adapter_table;
+
+	if (adapter->fpgaReleaseBuffers)
+		return adapter->fpgaReleaseBuffers(
+			wrapped_handle->opae_handle, count, wsids);
+
+	ASSERT_NOT_NULL_RESULT(adapter->fpgaReleaseBuffer,
+			       FPGA_NOT_SUPPORTED);
+
+	for (i = 0 ; i < count ; ++i) {
+		fpga_result r = adapter->fpgaReleaseBuffer(
+			wrapped_handle->opae_handle, wsids[i]);
+		if (r != FPGA_OK && res == FPGA_OK)
+			res = r;
+	}
+
+	return res;
+}
+
 fpga_result __OPAE_API__ fpgaGetOPAECVersion(fpga_version *version)
 {
 	ASSERT_NOT_NULL(version);
@@ -1193,21 +1611,16 @@ fpga_result __OPAE_API__ fpgaGetOSObjectFromEventHandle(
 	return res;
 }
 
-fpga_result __OPAE_API__ fpgaRegisterEvent(fpga_handle handle,
-	fpga_event_type event_type, fpga_event_handle event_handle,
-	uint32_t flags)
+/*
+ * Create the plugin's event handle on first registration, now that the
+ * fpga_handle tells us which adapter to use. Called with the wrapped
+ * event handle's lock held.
+ */
+STATIC fpga_result
+opae_bind_wrapped_event_handle(opae_wrapped_handle *wrapped_handle,
+			       opae_wrapped_event_handle *wrapped_event_handle)
 {
-	fpga_result res = FPGA_OK;
-	opae_wrapped_handle *wrapped_handle =
-		opae_validate_wrapped_handle(handle);
-	opae_wrapped_event_handle *wrapped_event_handle =
-		opae_validate_wrapped_event_handle(event_handle);
-	int ires;
-
-	ASSERT_NOT_NULL(wrapped_handle);
-	ASSERT_NOT_NULL(wrapped_event_handle);
-
-	opae_mutex_lock(ires, &wrapped_event_handle->lock);
+	fpga_result res;
 
 	if (!(wrapped_event_handle->flags
 	      & OPAE_WRAPPED_EVENT_HANDLE_CREATED)) {
@@ -1216,17 +1629,14 @@ fpga_result __OPAE_API__ fpgaRegisterEvent(fpga_handle handle,
 
 		if (!wrapped_handle->adapter_table->fpgaCreateEventHandle) {
 			OPAE_ERR("NULL fpgaCreateEventHandle() in adapter.");
-			opae_mutex_unlock(ires, &wrapped_event_handle->lock);
 			return FPGA_NOT_SUPPORTED;
 		}
 
 		res = wrapped_handle->adapter_table->fpgaCreateEventHandle(
 			&wrapped_event_handle->opae_event_handle);
 
-		if (res != FPGA_OK) {
-			opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+		if (res != FPGA_OK)
 			return res;
-		}
 
 		// The event_handle is now created.
 		wrapped_event_handle->adapter_table =
@@ -1237,16 +1647,40 @@ fpga_result __OPAE_API__ fpgaRegisterEvent(fpga_handle handle,
 
 	if (!wrapped_event_handle->opae_event_handle) {
 		OPAE_ERR("NULL fpga_event_handle");
-		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
 		return FPGA_INVALID_PARAM;
 	}
 
 	if (!wrapped_event_handle->adapter_table) {
 		OPAE_ERR("NULL adapter table in wrapped event handle.");
-		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
 		return FPGA_INVALID_PARAM;
 	}
 
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaRegisterEvent(fpga_handle handle,
+	fpga_event_type event_type, fpga_event_handle event_handle,
+	uint32_t flags)
+{
+	fpga_result res = FPGA_OK;
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	opae_wrapped_event_handle *wrapped_event_handle =
+		opae_validate_wrapped_event_handle(event_handle);
+	int ires;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(wrapped_event_handle);
+
+	opae_mutex_lock(ires, &wrapped_event_handle->lock);
+
+	res = opae_bind_wrapped_event_handle(wrapped_handle,
+					     wrapped_event_handle);
+	if (res != FPGA_OK) {
+		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+		return res;
+	}
+
 	if (!wrapped_event_handle->adapter_table->fpgaRegisterEvent) {
 		OPAE_ERR("NULL fpgaRegisterEvent() in adapter.");
 		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
@@ -1306,6 +1740,177 @@ fpga_result __OPAE_API__ fpgaUnregisterEvent(fpga_handle handle,
 	return res;
 }
 
+/*
+ * Unwrap count event handles into a new array of the plugin's event
+ * handles. With bind, handles are created on first use, as by
+ * fpgaRegisterEvent(); otherwise they must already be registered.
+ */
+STATIC fpga_result
+opae_unwrap_event_handles(opae_wrapped_handle *wrapped_handle,
+			  uint32_t count, fpga_event_handle *event_handles,
+			  bool bind, fpga_event_handle **unwrapped)
+{
+	fpga_event_handle *ehs;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+	int ires;
+
+	ehs = calloc(count, sizeof(fpga_event_handle));
+	if (!ehs) {
+		OPAE_ERR("malloc failed");
+		return FPGA_NO_MEMORY;
+	}
+
+	for (i = 0 ; (i < count) && (res == FPGA_OK) ; ++i) {
+		opae_wrapped_event_handle *wrapped_event_handle =
+			opae_validate_wrapped_event_handle(event_handles[i]);
+
+		if (!wrapped_event_handle) {
+			OPAE_ERR("invalid event handle at %u", i);
+			res = FPGA_INVALID_PARAM;
+			break;
+		}
+
+		opae_mutex_lock(ires, &wrapped_event_handle->lock);
+
+		if (bind) {
+			res = opae_bind_wrapped_event_handle(
+				wrapped_handle, wrapped_event_handle);
+		} else if (!(wrapped_event_handle->flags &
+			     OPAE_WRAPPED_EVENT_HANDLE_CREATED) ||
+			   !wrapped_event_handle->opae_event_handle) {
+			OPAE_ERR("event handle %u is not registered", i);
+			res = FPGA_INVALID_PARAM;
+		}
+
+		if ((res == FPGA_OK) &&
+		    (wrapped_event_handle->adapter_table !=
+		     wrapped_handle->adapter_table)) {
+			OPAE_ERR("event handle %u belongs to another plugin",
+				 i);
+			res = FPGA_INVALID_PARAM;
+		}
+
+		ehs[i] = wrapped_event_handle->opae_event_handle;
+
+		opae_mutex_unlock(ires, &wrapped_event_handle->lock);
+	}
+
+	if (res != FPGA_OK) {
+		free(ehs);
+		return res;
+	}
+
+	*unwrapped = ehs;
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaRegisterInterruptEvents(fpga_handle handle,
+	uint32_t start, uint32_t count, fpga_event_handle *event_handles)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	const opae_api_adapter_table *adapter;
+	fpga_event_handle *ehs = NULL;
+	fpga_result res;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(event_handles);
+
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	adapter = wrapped_handle->adapter_table;
+
+	if (!adapter->fpgaRegisterInterruptEvents)
+		ASSERT_NOT_NULL_RESULT(adapter->fpgaRegisterEvent,
+				       FPGA_NOT_SUPPORTED);
+
+	res = opae_unwrap_event_handles(wrapped_handle, count,
+					event_handles, true, &ehs);
+	if (res != FPGA_OK)
+		return res;
+
+	if (adapter->fpgaRegisterInterruptEvents) {
+		res = adapter->fpgaRegisterInterruptEvents(
+			wrapped_handle->opae_handle, start, count, ehs);
+		free(ehs);
+		return res;
+	}
+
+	for (i = 0 ; i < count ; ++i) {
+		res = adapter->fpgaRegisterEvent(wrapped_handle->opae_handle,
+						 FPGA_EVENT_INTERRUPT, ehs[i],
+						 start + i);
+		if (res != FPGA_OK)
+			break;
+	}
+
+	if ((res != FPGA_OK) && adapter->fpgaUnregisterEvent) {
+		while (i--)
+			adapter->fpgaUnregisterEvent(
+				wrapped_handle->opae_handle,
+				FPGA_EVENT_INTERRUPT, ehs[i]);
+	}
+
+	free(ehs);
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaUnregisterInterruptEvents(fpga_handle handle,
+	uint32_t count, fpga_event_handle *event_handles)
+{
+	opae_wrapped_handle *wrapped_handle =
+		opae_validate_wrapped_handle(handle);
+	const opae_api_adapter_table *adapter;
+	fpga_event_handle *ehs = NULL;
+	fpga_result res;
+	fpga_result first = FPGA_OK;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(wrapped_handle);
+	ASSERT_NOT_NULL(event_handles);
+
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	adapter = wrapped_handle->adapter_table;
+
+	if (!adapter->fpgaUnregisterInterruptEvents)
+		ASSERT_NOT_NULL_RESULT(adapter->fpgaUnregisterEvent,
+				       FPGA_NOT_SUPPORTED);
+
+	res = opae_unwrap_event_handles(wrapped_handle, count,
+					event_handles, false, &ehs);
+	if (res != FPGA_OK)
+		return res;
+
+	if (adapter->fpgaUnregisterInterruptEvents) {
+		res = adapter->fpgaUnregisterInterruptEvents(
+			wrapped_handle->opae_handle, count, ehs);
+		free(ehs);
+		return res;
+	}
+
+	// Keep going after a failure, so that as much as possible is
+	// released, and report the first error.
+	for (i = 0 ; i < count ; ++i) {
+		res = adapter->fpgaUnregisterEvent(wrapped_handle->opae_handle,
+						   FPGA_EVENT_INTERRUPT,
+						   ehs[i]);
+		if ((res != FPGA_OK) && (first == FPGA_OK))
+			first = res;
+	}
+
+	free(ehs);
+	return first;
+}
+
 fpga_result __OPAE_API__ fpgaAssignPortToInterface(fpga_handle fpga,
 	uint32_t interface_num, uint32_t slot_num, int flags)
 {
@@ -1616,6 +2221,33 @@ fpga_result __OPAE_API__ fpgaObjectWrite64(fpga_object obj, uint64_t value,
 		wrapped_object->opae_object, value, flags);
 }
 
+fpga_result __OPAE_API__ fpgaObjectSync(fpga_object obj, int flags)
+{
+	opae_wrapped_object *wrapped_object = opae_validate_wrapped_object(obj);
+
+	ASSERT_NOT_NULL(wrapped_object);
+	ASSERT_NOT_NULL_RESULT(wrapped_object->adapter_table->fpgaObjectSync,
+			       FPGA_NOT_SUPPORTED);
+
+	return wrapped_object->adapter_table->fpgaObjectSync(
+		wrapped_object->opae_object, flags);
+}
+
+fpga_result __OPAE_API__ fpgaObjectGetTimestamp(fpga_object obj,
+						uint64_t *timestamp)
+{
+	opae_wrapped_object *wrapped_object = opae_validate_wrapped_object(obj);
+
+	ASSERT_NOT_NULL(wrapped_object);
+	ASSERT_NOT_NULL(timestamp);
+	ASSERT_NOT_NULL_RESULT(
+		wrapped_object->adapter_table->fpgaObjectGetTimestamp,
+		FPGA_NOT_SUPPORTED);
+
+	return wrapped_object->adapter_table->fpgaObjectGetTimestamp(
+		wrapped_object->opae_object, timestamp);
+}
+
 fpga_result __OPAE_API__ fpgaSetUserClock(fpga_handle handle,
 	uint64_t high_clk, uint64_t low_clk, int flags)
 {
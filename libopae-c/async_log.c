@@ -0,0 +1,736 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <ctype.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+
+#include <opae/log.h>
+#include "async_log.h"
+
+#define LOG_RING_RECORDS 128 // power of 2
+#define LOG_RING_MASK    (LOG_RING_RECORDS - 1)
+#define LOG_MAX_ARGS     16
+#define LOG_TEXT_SIZE    368
+#define LOG_SPEC_MAX     64
+
+#define LOG_BACKOFF_MIN_US 100
+#define LOG_BACKOFF_MAX_US 10000
+
+enum log_arg_type {
+	LOG_ARG_SIGNED = 0,
+	LOG_ARG_UNSIGNED,
+	LOG_ARG_CHAR,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER
+};
+
+enum log_length {
+	LOG_LEN_NONE = 0,
+	LOG_LEN_HH,
+	LOG_LEN_H,
+	LOG_LEN_L,
+	LOG_LEN_LL,
+	LOG_LEN_J,
+	LOG_LEN_Z,
+	LOG_LEN_T,
+	LOG_LEN_BIG_L
+};
+
+typedef struct _log_record {
+	uint64_t seq;		// global call order
+	int16_t loglevel;
+	int16_t nargs;		// -1 when text holds the formatted message
+	uint8_t types[LOG_MAX_ARGS];
+	union {
+		long long i;
+		unsigned long long u;
+		double d;
+		const void *p;
+		uint32_t offset;	// of a string argument within text
+	} args[LOG_MAX_ARGS];
+	char text[LOG_TEXT_SIZE];	// format string, then string arguments
+} log_record;
+
+typedef struct _log_ring {
+	uint64_t head __attribute__((aligned(64)));	// written by the owner
+	uint64_t dropped;				// written by the owner
+	uint64_t tail __attribute__((aligned(64)));	// written by the flusher
+	uint64_t reported;				// written by the flusher
+	int in_use;
+	struct _log_ring *next;
+	log_record records[LOG_RING_RECORDS];
+} log_ring;
+
+typedef struct _log_spec {
+	const char *start;	// the '%'
+	const char *length;	// the length modifier, if any
+	const char *end;	// one past the conversion character
+	enum log_length len;
+	char conv;
+} log_spec;
+
+static log_ring *g_rings;
+static __thread log_ring *t_ring;
+static pthread_key_t g_ring_key;
+static int g_ring_key_valid;
+static pthread_once_t g_ring_once = PTHREAD_ONCE_INIT;
+static pthread_once_t g_atfork_once = PTHREAD_ONCE_INIT;
+
+static int g_running;
+static int g_writers;	// producers between the g_running check and publish
+static int g_stop;
+static uint64_t g_seq;
+static FILE *g_file;
+static pthread_t g_flusher;
+
+/*
+ * Find the next conversion specification in p. Returns 1 when one was
+ * found, 0 at the end of the string and -1 when the specification
+ * can't be captured for deferred formatting.
+ */
+STATIC int log_next_spec(const char *p, log_spec *s)
+{
+	for (;;) {
+		p = strchr(p, '%');
+		if (!p)
+			return 0;
+		if (p[1] != '%')
+			break;
+		p += 2;
+	}
+
+	s->start = p++;
+
+	while (*p && strchr("-+ #0'", *p))
+		++p;
+
+	if (*p == '*')
+		return -1;
+	while (isdigit((unsigned char)*p))
+		++p;
+
+	if (*p == '.') {
+		++p;
+		if (*p == '*')
+			return -1;
+		while (isdigit((unsigned char)*p))
+			++p;
+	}
+
+	s->length = p;
+	s->len = LOG_LEN_NONE;
+
+	switch (*p) {
+	case 'h':
+		if (p[1] == 'h') {
+			s->len = LOG_LEN_HH;
+			++p;
+		} else
+			s->len = LOG_LEN_H;
+		++p;
+		break;
+	case 'l':
+		if (p[1] == 'l') {
+			s->len = LOG_LEN_LL;
+			++p;
+		} else
+			s->len = LOG_LEN_L;
+		++p;
+		break;
+	case 'q':
+		s->len = LOG_LEN_LL;
+		++p;
+		break;
+	case 'j':
+		s->len = LOG_LEN_J;
+		++p;
+		break;
+	case 'z':
+		s->len = LOG_LEN_Z;
+		++p;
+		break;
+	case 't':
+		s->len = LOG_LEN_T;
+		++p;
+		break;
+	case 'L':
+		s->len = LOG_LEN_BIG_L;
+		++p;
+		break;
+	}
+
+	if (!*p)
+		return -1;
+
+	s->conv = *p;
+	s->end = p + 1;
+
+	return 1;
+}
+
+STATIC int log_capture_signed(log_record *r, int n,
+			      enum log_length len, va_list *argp)
+{
+	r->types[n] = LOG_ARG_SIGNED;
+
+	switch (len) {
+	case LOG_LEN_NONE:
+		r->args[n].i = va_arg(*argp, int);
+		break;
+	case LOG_LEN_HH:
+		r->args[n].i = (signed char)va_arg(*argp, int);
+		break;
+	case LOG_LEN_H:
+		r->args[n].i = (short)va_arg(*argp, int);
+		break;
+	case LOG_LEN_L:
+		r->args[n].i = va_arg(*argp, long);
+		break;
+	case LOG_LEN_LL:
+		r->args[n].i = va_arg(*argp, long long);
+		break;
+	case LOG_LEN_J:
+		r->args[n].i = va_arg(*argp, intmax_t);
+		break;
+	case LOG_LEN_Z:
+		r->args[n].i = va_arg(*argp, ssize_t);
+		break;
+	case LOG_LEN_T:
+		r->args[n].i = va_arg(*argp, ptrdiff_t);
+		break;
+	default:
+		return 1;
+	}
+
+	return 0;
+}
+
+STATIC int log_capture_unsigned(log_record *r, int n,
+				enum log_length len, va_list *argp)
+{
+	r->types[n] = LOG_ARG_UNSIGNED;
+
+	switch (len) {
+	case LOG_LEN_NONE:
+		r->args[n].u = va_arg(*argp, unsigned);
+		break;
+	case LOG_LEN_HH:
+		r->args[n].u = (unsigned char)va_arg(*argp, unsigned);
+		break;
+	case LOG_LEN_H:
+		r->args[n].u = (unsigned short)va_arg(*argp, unsigned);
+		break;
+	case LOG_LEN_L:
+		r->args[n].u = va_arg(*argp, unsigned long);
+		break;
+	case LOG_LEN_LL:
+		r->args[n].u = va_arg(*argp, unsigned long long);
+		break;
+	case LOG_LEN_J:
+		r->args[n].u = va_arg(*argp, uintmax_t);
+		break;
+	case LOG_LEN_Z:
+		r->args[n].u = va_arg(*argp, size_t);
+		break;
+	case LOG_LEN_T:
+		r->args[n].u = (unsigned long long)va_arg(*argp, ptrdiff_t);
+		break;
+	default:
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Copy fmt and the values of its arguments into r, so that the
+ * message can be formatted later. String arguments are copied
+ * (truncated when they don't fit), because the caller's buffers
+ * may not outlive the call. Returns non-zero when fmt uses a
+ * conversion that can't be deferred (eg %m, %n or '*' widths).
+ */
+STATIC int log_capture(log_record *r, const char *fmt, va_list *argp)
+{
+	size_t used = strlen(fmt) + 1;
+	const char *p;
+	log_spec s;
+	int n = 0;
+	int res;
+
+	if (used >= LOG_TEXT_SIZE)
+		return 1;
+
+	memcpy(r->text, fmt, used);
+
+	for (p = r->text ; (res = log_next_spec(p, &s)) > 0 ; p = s.end) {
+		const char *str;
+		size_t len;
+
+		if (n == LOG_MAX_ARGS)
+			return 1;
+
+		switch (s.conv) {
+		case 'd':
+		case 'i':
+			if (log_capture_signed(r, n, s.len, argp))
+				return 1;
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			if (log_capture_unsigned(r, n, s.len, argp))
+				return 1;
+			break;
+		case 'c':
+			if (s.len != LOG_LEN_NONE)
+				return 1;
+			r->types[n] = LOG_ARG_CHAR;
+			r->args[n].i = va_arg(*argp, int);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (s.len != LOG_LEN_NONE && s.len != LOG_LEN_L)
+				return 1;
+			r->types[n] = LOG_ARG_DOUBLE;
+			r->args[n].d = va_arg(*argp, double);
+			break;
+		case 's':
+			if (s.len != LOG_LEN_NONE)
+				return 1;
+			str = va_arg(*argp, const char *);
+			if (!str)
+				str = "(null)";
+			len = strnlen(str, LOG_TEXT_SIZE - used - 1);
+			memcpy(r->text + used, str, len);
+			r->text[used + len] = '\0';
+			r->types[n] = LOG_ARG_STRING;
+			r->args[n].offset = (uint32_t)used;
+			used += len + 1;
+			break;
+		case 'p':
+			if (s.len != LOG_LEN_NONE)
+				return 1;
+			r->types[n] = LOG_ARG_POINTER;
+			r->args[n].p = va_arg(*argp, void *);
+			break;
+		default:
+			return 1;
+		}
+
+		// Keep room for at least an empty string argument.
+		if (used >= LOG_TEXT_SIZE)
+			return 1;
+
+		++n;
+	}
+
+	if (res < 0)
+		return 1;
+
+	r->nargs = (int16_t)n;
+	return 0;
+}
+
+// Write the literal text in [p, end), collapsing "%%" to '%'.
+STATIC void log_literal(FILE *fp, const char *p, const char *end)
+{
+	const char *pct;
+
+	while (p < end) {
+		pct = memchr(p, '%', end - p);
+		if (!pct) {
+			fwrite(p, 1, end - p, fp);
+			return;
+		}
+
+		fwrite(p, 1, pct - p + 1, fp);
+		p = pct + 2;
+	}
+}
+
+STATIC void log_emit(FILE *fp, const log_record *r)
+{
+	char spec[LOG_SPEC_MAX];
+	const char *p;
+	log_spec s;
+	size_t len;
+	int n = 0;
+
+	if (r->nargs < 0) {
+		fputs(r->text, fp);
+		return;
+	}
+
+	for (p = r->text ; log_next_spec(p, &s) > 0 ; p = s.end, ++n) {
+		log_literal(fp, p, s.start);
+
+		// Flags, width and precision are reused as-is; the length
+		// modifier is rewritten to match the captured value.
+		len = s.length - s.start;
+		if (len > LOG_SPEC_MAX - 4)
+			continue;
+		memcpy(spec, s.start, len);
+
+		switch (r->types[n]) {
+		case LOG_ARG_SIGNED:
+			memcpy(spec + len, "ll", 2);
+			spec[len + 2] = s.conv;
+			spec[len + 3] = '\0';
+			fprintf(fp, spec, r->args[n].i);
+			break;
+		case LOG_ARG_UNSIGNED:
+			memcpy(spec + len, "ll", 2);
+			spec[len + 2] = s.conv;
+			spec[len + 3] = '\0';
+			fprintf(fp, spec, r->args[n].u);
+			break;
+		case LOG_ARG_CHAR:
+			spec[len] = s.conv;
+			spec[len + 1] = '\0';
+			fprintf(fp, spec, (int)r->args[n].i);
+			break;
+		case LOG_ARG_DOUBLE:
+			spec[len] = s.conv;
+			spec[len + 1] = '\0';
+			fprintf(fp, spec, r->args[n].d);
+			break;
+		case LOG_ARG_STRING:
+			spec[len] = s.conv;
+			spec[len + 1] = '\0';
+			fprintf(fp, spec, r->text + r->args[n].offset);
+			break;
+		case LOG_ARG_POINTER:
+			spec[len] = s.conv;
+			spec[len + 1] = '\0';
+			fprintf(fp, spec, r->args[n].p);
+			break;
+		}
+	}
+
+	log_literal(fp, p, p + strlen(p));
+}
+
+STATIC void log_ring_release(void *arg)
+{
+	log_ring *ring = (log_ring *)arg;
+
+	t_ring = NULL;
+	__atomic_store_n(&ring->in_use, 0, __ATOMIC_RELEASE);
+}
+
+STATIC void log_ring_key_init(void)
+{
+	g_ring_key_valid = !pthread_key_create(&g_ring_key, log_ring_release);
+}
+
+// Find or allocate the calling thread's ring. The rings of exited
+// threads are reused, so the list only grows with the peak number
+// of logging threads.
+STATIC log_ring *log_ring_get(void)
+{
+	log_ring *ring;
+	void *mem = NULL;
+	int expected;
+
+	if (t_ring)
+		return t_ring;
+
+	pthread_once(&g_ring_once, log_ring_key_init);
+
+	for (ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE) ;
+	     ring ; ring = ring->next) {
+		expected = 0;
+		if (__atomic_compare_exchange_n(&ring->in_use, &expected, 1,
+						0, __ATOMIC_ACQ_REL,
+						__ATOMIC_RELAXED))
+			goto out_claim;
+	}
+
+	if (posix_memalign(&mem, 64, sizeof(log_ring)))
+		return NULL;
+
+	ring = (log_ring *)mem;
+	memset(ring, 0, sizeof(log_ring));
+	ring->in_use = 1;
+
+	ring->next = __atomic_load_n(&g_rings, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&g_rings, &ring->next, ring,
+					    1, __ATOMIC_RELEASE,
+					    __ATOMIC_RELAXED))
+		/* retry */;
+
+out_claim:
+	if (g_ring_key_valid)
+		pthread_setspecific(g_ring_key, ring);
+	t_ring = ring;
+	return ring;
+}
+
+int opae_log_async_print(int loglevel, const char *fmt, va_list argp)
+{
+	log_ring *ring;
+	log_record *r;
+	uint64_t head;
+	va_list copy;
+	int res;
+
+	// Announce the write before checking g_running, so that
+	// opae_log_async_stop() either sees us or we see it stopping.
+	__atomic_add_fetch(&g_writers, 1, __ATOMIC_SEQ_CST);
+
+	if (!__atomic_load_n(&g_running, __ATOMIC_SEQ_CST)) {
+		res = 1;
+		goto out;
+	}
+
+	ring = log_ring_get();
+	if (!ring) {
+		res = 1;
+		goto out;
+	}
+
+	head = ring->head;
+	if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >=
+	    LOG_RING_RECORDS) {
+		__atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+		res = 0;
+		goto out;
+	}
+
+	r = &ring->records[head & LOG_RING_MASK];
+	r->loglevel = (int16_t)loglevel;
+
+	va_copy(copy, argp);
+	res = log_capture(r, fmt, &copy);
+	va_end(copy);
+
+	if (res) {
+		// Format now, in the calling thread.
+		va_copy(copy, argp);
+		vsnprintf(r->text, sizeof(r->text), fmt, copy);
+		va_end(copy);
+		r->nargs = -1;
+	}
+
+	r->seq = __atomic_fetch_add(&g_seq, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+	res = 0;
+
+out:
+	__atomic_sub_fetch(&g_writers, 1, __ATOMIC_RELEASE);
+	return res;
+}
+
+// Emit the pending records of all rings in call order.
+// Returns the number of records written.
+STATIC int log_drain(void)
+{
+	log_ring *ring;
+	int count = 0;
+
+	for (ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE) ;
+	     ring ; ring = ring->next) {
+		uint64_t dropped =
+			__atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+
+		if (dropped != ring->reported) {
+			fprintf(stderr, "opae_print: log buffer full, "
+				"dropped %llu message(s)\n",
+				(unsigned long long)(dropped - ring->reported));
+			ring->reported = dropped;
+		}
+	}
+
+	for (;;) {
+		log_ring *oldest_ring = NULL;
+		log_record *oldest = NULL;
+
+		for (ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE) ;
+		     ring ; ring = ring->next) {
+			log_record *r;
+
+			if (ring->tail ==
+			    __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+				continue;
+
+			r = &ring->records[ring->tail & LOG_RING_MASK];
+			if (!oldest || r->seq < oldest->seq) {
+				oldest = r;
+				oldest_ring = ring;
+			}
+		}
+
+		if (!oldest)
+			break;
+
+		log_emit(oldest->loglevel == OPAE_LOG_ERROR ? stderr : g_file,
+			 oldest);
+
+		__atomic_store_n(&oldest_ring->tail, oldest_ring->tail + 1,
+				 __ATOMIC_RELEASE);
+		++count;
+	}
+
+	if (count) {
+		fflush(g_file);
+		fflush(stderr);
+	}
+
+	return count;
+}
+
+STATIC void *log_flusher(void *arg)
+{
+	useconds_t backoff = LOG_BACKOFF_MIN_US;
+	(void)arg;
+
+	while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) {
+		if (log_drain()) {
+			backoff = LOG_BACKOFF_MIN_US;
+			continue;
+		}
+
+		usleep(backoff);
+		if (backoff < LOG_BACKOFF_MAX_US)
+			backoff <<= 1;
+	}
+
+	log_drain();
+
+	return NULL;
+}
+
+// The flusher doesn't survive fork(), so the child logs synchronously.
+STATIC void log_atfork_child(void)
+{
+	__atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+	// Writers caught mid-record by fork() do not exist in the child.
+	__atomic_store_n(&g_writers, 0, __ATOMIC_RELEASE);
+}
+
+STATIC void log_atfork_init(void)
+{
+	pthread_atfork(NULL, NULL, log_atfork_child);
+}
+
+int opae_log_async_start(FILE *logfile)
+{
+	sigset_t all;
+	sigset_t prev;
+	int res;
+
+	if (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+		return 0;
+
+	pthread_once(&g_atfork_once, log_atfork_init);
+
+	g_file = logfile ? logfile : stdout;
+	__atomic_store_n(&g_stop, 0, __ATOMIC_RELEASE);
+
+	// Signals are for the application's threads, not the flusher.
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &prev);
+	res = pthread_create(&g_flusher, NULL, log_flusher, NULL);
+	pthread_sigmask(SIG_SETMASK, &prev, NULL);
+
+	if (res)
+		return res;
+
+	__atomic_store_n(&g_running, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void opae_log_async_stop(void)
+{
+	if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+		return;
+
+	__atomic_store_n(&g_running, 0, __ATOMIC_SEQ_CST);
+
+	// Producers that got past g_running publish before the last drain.
+	while (__atomic_load_n(&g_writers, __ATOMIC_SEQ_CST))
+		sched_yield();
+
+	__atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+	pthread_join(g_flusher, NULL);
+}
+
+uint64_t opae_log_async_dropped(void)
+{
+	log_ring *ring;
+	uint64_t dropped = 0;
+
+	for (ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE) ;
+	     ring ; ring = ring->next)
+		dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+
+	return dropped;
+}
+
+// The key's destructor belongs to this library, so it may not
+// outlive it. Rings still claimed by live threads are reachable
+// through their t_ring, and are left allocated; only those of exited
+// threads are freed.
+__attribute__((destructor)) STATIC void log_release(void)
+{
+	log_ring *ring;
+	int expected;
+
+	opae_log_async_stop();
+
+	if (g_ring_key_valid)
+		pthread_key_delete(g_ring_key);
+
+	ring = __atomic_exchange_n(&g_rings, NULL, __ATOMIC_ACQ_REL);
+	while (ring) {
+		log_ring *trash = ring;
+		ring = ring->next;
+		expected = 0;
+		if (__atomic_compare_exchange_n(&trash->in_use, &expected, 1,
+						0, __ATOMIC_ACQ_REL,
+						__ATOMIC_RELAXED))
+			free(trash);
+	}
+}
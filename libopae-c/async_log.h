@@ -0,0 +1,66 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __OPAE_ASYNC_LOG_H__
+#define __OPAE_ASYNC_LOG_H__
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Asynchronous backend for opae_print(), enabled by LIBOPAE_LOG_ASYNC.
+ *
+ * Each logging thread owns a single-producer ring of records. A record
+ * captures the format string and the argument values; formatting and
+ * file I/O happen later on a background flusher thread, which merges
+ * the rings in call order. When a ring is full, the message is dropped
+ * and counted rather than blocking the caller.
+ */
+
+// Start the flusher, writing to logfile (errors go to stderr).
+// non-zero on failure.
+int opae_log_async_start(FILE *logfile);
+
+// Drain all pending records and stop the flusher.
+void opae_log_async_stop(void);
+
+// Queue a message. Returns non-zero when the asynchronous logger is
+// not running, in which case the caller should print synchronously.
+int opae_log_async_print(int loglevel, const char *fmt, va_list argp);
+
+// Total number of messages dropped because a ring was full.
+uint64_t opae_log_async_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OPAE_ASYNC_LOG_H__
@@ -0,0 +1,615 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opae/buffer.h>
+
+#include "opae_int.h"
+
+#define OPAE_BUFFER_ARENA_MAGIC 0x4152454e
+
+// The arena is divided into slabs. A slab is either free, carved into
+// blocks of one size class, or part of a run backing one large buffer.
+#define ARENA_SLAB_SHIFT 16
+#define ARENA_SLAB_SIZE  (1ULL << ARENA_SLAB_SHIFT)
+
+// Size classes are powers of two from one cache line to half a slab.
+#define ARENA_MIN_SHIFT   6
+#define ARENA_NUM_CLASSES (ARENA_SLAB_SHIFT - ARENA_MIN_SHIFT)
+
+// Per-thread cache depth for each size class. Refills and flushes
+// move half of it at a time, under the arena lock.
+#define ARENA_CACHE_DEPTH 32
+
+#define SLAB_FREE     0xff
+#define SLAB_RUN      0xfe
+#define SLAB_RUN_TAIL 0xfd
+
+typedef struct _arena_block {
+	struct _arena_block *prev;
+	struct _arena_block *next;
+} arena_block;
+
+typedef struct _arena_slab {
+	uint8_t kind;   // size class, or one of SLAB_*
+	uint32_t run;   // number of slabs, for SLAB_RUN
+	uint32_t nfree; // blocks on the arena free list, for a size class
+} arena_slab;
+
+struct _opae_buffer_arena;
+
+typedef struct _arena_cache {
+	struct _opae_buffer_arena *arena;
+	struct _arena_cache *prev;
+	struct _arena_cache *next;
+	uint32_t count[ARENA_NUM_CLASSES];
+	void *blocks[ARENA_NUM_CLASSES][ARENA_CACHE_DEPTH];
+} arena_cache;
+
+typedef struct _opae_buffer_arena {
+	uint32_t magic;
+	fpga_handle handle;
+	uint64_t wsid;
+	uint8_t *base;
+	uint64_t iova;
+	uint64_t len;
+	uint32_t num_slabs;
+	uint32_t slab_hint;
+	pthread_mutex_t lock;
+	pthread_key_t cache_key;
+	arena_cache *caches;
+	arena_block *free_list[ARENA_NUM_CLASSES];
+	arena_slab *slabs;
+} opae_buffer_arena;
+
+static inline opae_buffer_arena *
+opae_validate_buffer_arena(fpga_buffer_arena a)
+{
+	opae_buffer_arena *arena = (opae_buffer_arena *)a;
+
+	if (!arena || arena->magic != OPAE_BUFFER_ARENA_MAGIC)
+		return NULL;
+	return arena;
+}
+
+STATIC int arena_size_class(uint64_t len, uint64_t align)
+{
+	uint64_t size = len > align ? len : align;
+	int shift = ARENA_MIN_SHIFT;
+
+	while (shift < ARENA_SLAB_SHIFT && (1ULL << shift) < size)
+		++shift;
+
+	return shift < ARENA_SLAB_SHIFT ? shift - ARENA_MIN_SHIFT : -1;
+}
+
+// Find count free slabs whose first index is a multiple of stride.
+// Called with the arena lock held.
+STATIC int64_t arena_find_slabs(opae_buffer_arena *arena,
+				uint32_t count, uint32_t stride)
+{
+	uint32_t start;
+	uint32_t pass;
+
+	for (pass = 0 ; pass < 2 ; ++pass) {
+		start = pass ? 0 : arena->slab_hint;
+		start = (start + stride - 1) / stride * stride;
+
+		while (start + count <= arena->num_slabs) {
+			uint32_t i;
+
+			for (i = 0 ; i < count ; ++i) {
+				if (arena->slabs[start + i].kind != SLAB_FREE)
+					break;
+			}
+
+			if (i == count)
+				return start;
+
+			start = (start + i + stride) / stride * stride;
+		}
+	}
+
+	return -1;
+}
+
+static inline uint32_t arena_slab_of(opae_buffer_arena *arena, void *p)
+{
+	return (uint32_t)(((uint8_t *)p - arena->base) >> ARENA_SLAB_SHIFT);
+}
+
+// Called with the arena lock held.
+static inline void arena_link_block(opae_buffer_arena *arena, int cls,
+				    arena_block *b)
+{
+	b->prev = NULL;
+	b->next = arena->free_list[cls];
+	if (b->next)
+		b->next->prev = b;
+	arena->free_list[cls] = b;
+}
+
+// Called with the arena lock held.
+static inline void arena_unlink_block(opae_buffer_arena *arena, int cls,
+				      arena_block *b)
+{
+	if (b->prev)
+		b->prev->next = b->next;
+	else
+		arena->free_list[cls] = b->next;
+	if (b->next)
+		b->next->prev = b->prev;
+}
+
+// Carve a free slab into blocks of class cls.
+// Called with the arena lock held.
+STATIC int arena_grow_class(opae_buffer_arena *arena, int cls)
+{
+	uint64_t size = 1ULL << (cls + ARENA_MIN_SHIFT);
+	int64_t slab = arena_find_slabs(arena, 1, 1);
+	uint8_t *p;
+	uint64_t off;
+
+	if (slab < 0)
+		return 1;
+
+	arena->slabs[slab].kind = (uint8_t)cls;
+	arena->slabs[slab].nfree = (uint32_t)(ARENA_SLAB_SIZE / size);
+	arena->slab_hint = (uint32_t)slab + 1;
+
+	p = arena->base + ((uint64_t)slab << ARENA_SLAB_SHIFT);
+	for (off = ARENA_SLAB_SIZE ; off ; off -= size)
+		arena_link_block(arena, cls, (arena_block *)(p + off - size));
+
+	return 0;
+}
+
+// Called with the arena lock held.
+STATIC arena_block *arena_pop_block(opae_buffer_arena *arena, int cls)
+{
+	arena_block *b = arena->free_list[cls];
+
+	if (b) {
+		arena_unlink_block(arena, cls, b);
+		--arena->slabs[arena_slab_of(arena, b)].nfree;
+	}
+
+	return b;
+}
+
+// Return a block to the free list of its class. Once all of a slab's
+// blocks are back, the slab is freed for use by any size, so that a
+// class does not keep slabs it no longer needs.
+// Called with the arena lock held.
+STATIC void arena_push_block(opae_buffer_arena *arena, int cls, void *p)
+{
+	uint64_t size = 1ULL << (cls + ARENA_MIN_SHIFT);
+	uint32_t slab = arena_slab_of(arena, p);
+	uint8_t *base;
+	uint64_t off;
+
+	arena_link_block(arena, cls, (arena_block *)p);
+
+	if (++arena->slabs[slab].nfree < ARENA_SLAB_SIZE / size)
+		return;
+
+	base = arena->base + ((uint64_t)slab << ARENA_SLAB_SHIFT);
+	for (off = 0 ; off < ARENA_SLAB_SIZE ; off += size)
+		arena_unlink_block(arena, cls, (arena_block *)(base + off));
+
+	arena->slabs[slab].kind = SLAB_FREE;
+	arena->slabs[slab].nfree = 0;
+	if (slab < arena->slab_hint)
+		arena->slab_hint = slab;
+}
+
+STATIC void arena_flush_cache(opae_buffer_arena *arena, arena_cache *cache,
+			      int cls, uint32_t keep)
+{
+	while (cache->count[cls] > keep)
+		arena_push_block(arena, cls,
+				 cache->blocks[cls][--cache->count[cls]]);
+}
+
+// Return a thread's cached blocks to the arena when the thread exits.
+STATIC void arena_cache_release(void *c)
+{
+	arena_cache *cache = (arena_cache *)c;
+	opae_buffer_arena *arena = cache->arena;
+	int cls;
+	int err;
+
+	opae_mutex_lock(err, &arena->lock);
+
+	for (cls = 0 ; cls < ARENA_NUM_CLASSES ; ++cls)
+		arena_flush_cache(arena, cache, cls, 0);
+
+	if (cache->prev)
+		cache->prev->next = cache->next;
+	else
+		arena->caches = cache->next;
+	if (cache->next)
+		cache->next->prev = cache->prev;
+
+	opae_mutex_unlock(err, &arena->lock);
+
+	free(cache);
+}
+
+STATIC arena_cache *arena_get_cache(opae_buffer_arena *arena)
+{
+	arena_cache *cache = pthread_getspecific(arena->cache_key);
+	int err;
+
+	if (cache)
+		return cache;
+
+	cache = calloc(1, sizeof(arena_cache));
+	if (!cache)
+		return NULL;
+
+	cache->arena = arena;
+
+	if (pthread_setspecific(arena->cache_key, cache)) {
+		free(cache);
+		return NULL;
+	}
+
+	opae_mutex_lock(err, &arena->lock);
+	cache->next = arena->caches;
+	if (arena->caches)
+		arena->caches->prev = cache;
+	arena->caches = cache;
+	opae_mutex_unlock(err, &arena->lock);
+
+	return cache;
+}
+
+fpga_result __OPAE_API__ fpgaCreateBufferArena(fpga_handle handle,
+					       uint64_t len, int flags,
+					       fpga_buffer_arena *arena)
+{
+	opae_buffer_arena *a;
+	fpga_result res;
+	void *base = NULL;
+	uint32_t i;
+
+	ASSERT_NOT_NULL(handle);
+	ASSERT_NOT_NULL(arena);
+
+	if (!len) {
+		OPAE_ERR("len is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (flags & FPGA_BUF_PREALLOCATED) {
+		OPAE_ERR("FPGA_BUF_PREALLOCATED is not supported");
+		return FPGA_INVALID_PARAM;
+	}
+
+	len = (len + ARENA_SLAB_SIZE - 1) & ~(ARENA_SLAB_SIZE - 1);
+	if ((len >> ARENA_SLAB_SHIFT) > UINT32_MAX) {
+		OPAE_ERR("len is too large");
+		return FPGA_INVALID_PARAM;
+	}
+
+	a = calloc(1, sizeof(opae_buffer_arena));
+	if (!a) {
+		OPAE_ERR("out of memory");
+		return FPGA_NO_MEMORY;
+	}
+
+	a->num_slabs = (uint32_t)(len >> ARENA_SLAB_SHIFT);
+	a->slabs = malloc(a->num_slabs * sizeof(arena_slab));
+	if (!a->slabs) {
+		OPAE_ERR("out of memory");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	for (i = 0 ; i < a->num_slabs ; ++i) {
+		a->slabs[i].kind = SLAB_FREE;
+		a->slabs[i].run = 0;
+		a->slabs[i].nfree = 0;
+	}
+
+	if (pthread_mutex_init(&a->lock, NULL)) {
+		OPAE_ERR("pthread_mutex_init() failed");
+		res = FPGA_EXCEPTION;
+		goto out_free;
+	}
+
+	if (pthread_key_create(&a->cache_key, arena_cache_release)) {
+		OPAE_ERR("pthread_key_create() failed");
+		res = FPGA_EXCEPTION;
+		goto out_destroy_lock;
+	}
+
+	res = fpgaPrepareBuffer(handle, len, &base, &a->wsid, flags);
+	if (res != FPGA_OK)
+		goto out_delete_key;
+
+	res = fpgaGetIOAddress(handle, a->wsid, &a->iova);
+	if (res != FPGA_OK) {
+		fpgaReleaseBuffer(handle, a->wsid);
+		goto out_delete_key;
+	}
+
+	// Block alignment is relative to the start of the arena. Buffers
+	// this size are hugepage-backed, so the start is slab-aligned in
+	// both address spaces.
+	if (((uint64_t)base | a->iova) & (ARENA_SLAB_SIZE - 1)) {
+		OPAE_ERR("arena buffer is not %llu-byte aligned",
+			 ARENA_SLAB_SIZE);
+		fpgaReleaseBuffer(handle, a->wsid);
+		res = FPGA_EXCEPTION;
+		goto out_delete_key;
+	}
+
+	a->handle = handle;
+	a->base = (uint8_t *)base;
+	a->len = len;
+	a->magic = OPAE_BUFFER_ARENA_MAGIC;
+
+	*arena = a;
+	return FPGA_OK;
+
+out_delete_key:
+	pthread_key_delete(a->cache_key);
+out_destroy_lock:
+	pthread_mutex_destroy(&a->lock);
+out_free:
+	free(a->slabs);
+	free(a);
+	return res;
+}
+
+fpga_result __OPAE_API__ fpgaDestroyBufferArena(fpga_buffer_arena *arena)
+{
+	opae_buffer_arena *a;
+	fpga_result res;
+	int err;
+
+	ASSERT_NOT_NULL(arena);
+
+	a = opae_validate_buffer_arena(*arena);
+	ASSERT_NOT_NULL(a);
+
+	res = fpgaReleaseBuffer(a->handle, a->wsid);
+	if (res != FPGA_OK)
+		return res;
+
+	// Deleting the key does not run the destructors, so free the
+	// caches of threads that are still alive here.
+	opae_mutex_lock(err, &a->lock);
+	a->magic = 0;
+	pthread_key_delete(a->cache_key);
+	while (a->caches) {
+		arena_cache *cache = a->caches;
+		a->caches = cache->next;
+		free(cache);
+	}
+	opae_mutex_unlock(err, &a->lock);
+
+	pthread_mutex_destroy(&a->lock);
+	free(a->slabs);
+	free(a);
+
+	*arena = NULL;
+	return FPGA_OK;
+}
+
+STATIC fpga_result arena_allocate_run(opae_buffer_arena *arena, uint64_t len,
+				      uint64_t align, uint8_t **p)
+{
+	uint32_t count;
+	uint32_t stride;
+	int64_t slab;
+	uint32_t i;
+	int err;
+
+	if (len > arena->len || align > arena->len)
+		return FPGA_NO_MEMORY;
+
+	count = (uint32_t)((len + ARENA_SLAB_SIZE - 1) >> ARENA_SLAB_SHIFT);
+	stride = align > ARENA_SLAB_SIZE ?
+		(uint32_t)(align >> ARENA_SLAB_SHIFT) : 1;
+
+	opae_mutex_lock(err, &arena->lock);
+
+	slab = arena_find_slabs(arena, count, stride);
+	if (slab >= 0) {
+		arena->slabs[slab].kind = SLAB_RUN;
+		arena->slabs[slab].run = count;
+		for (i = 1 ; i < count ; ++i)
+			arena->slabs[slab + i].kind = SLAB_RUN_TAIL;
+		arena->slab_hint = (uint32_t)slab + count;
+	}
+
+	opae_mutex_unlock(err, &arena->lock);
+
+	if (slab < 0)
+		return FPGA_NO_MEMORY;
+
+	*p = arena->base + ((uint64_t)slab << ARENA_SLAB_SHIFT);
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaBufferArenaAllocate(fpga_buffer_arena arena,
+						 uint64_t len, uint64_t align,
+						 void **buf_addr,
+						 uint64_t *ioaddr)
+{
+	opae_buffer_arena *a = opae_validate_buffer_arena(arena);
+	arena_cache *cache;
+	uint8_t *p = NULL;
+	int cls;
+	int err;
+
+	ASSERT_NOT_NULL(a);
+	ASSERT_NOT_NULL(buf_addr);
+
+	if (!align)
+		align = 1ULL << ARENA_MIN_SHIFT;
+
+	if (!len || (align & (align - 1))) {
+		OPAE_ERR("invalid len or align");
+		return FPGA_INVALID_PARAM;
+	}
+
+	cls = arena_size_class(len, align);
+
+	if (cls < 0) {
+		fpga_result res = arena_allocate_run(a, len, align, &p);
+		if (res != FPGA_OK)
+			return res;
+		goto out_addr;
+	}
+
+	cache = arena_get_cache(a);
+	if (!cache) {
+		OPAE_ERR("failed to allocate thread cache");
+		return FPGA_NO_MEMORY;
+	}
+
+	if (!cache->count[cls]) {
+		opae_mutex_lock(err, &a->lock);
+
+		while (cache->count[cls] < ARENA_CACHE_DEPTH / 2) {
+			arena_block *b = arena_pop_block(a, cls);
+
+			if (!b) {
+				if (arena_grow_class(a, cls))
+					break;
+				continue;
+			}
+
+			cache->blocks[cls][cache->count[cls]++] = b;
+		}
+
+		opae_mutex_unlock(err, &a->lock);
+
+		if (!cache->count[cls])
+			return FPGA_NO_MEMORY;
+	}
+
+	p = cache->blocks[cls][--cache->count[cls]];
+
+out_addr:
+	*buf_addr = p;
+	if (ioaddr)
+		*ioaddr = a->iova + (uint64_t)(p - a->base);
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaBufferArenaFree(fpga_buffer_arena arena,
+					     void *buf_addr)
+{
+	opae_buffer_arena *a = opae_validate_buffer_arena(arena);
+	uint8_t *p = (uint8_t *)buf_addr;
+	arena_cache *cache;
+	uint64_t off;
+	uint32_t slab;
+	uint8_t kind;
+	int err;
+
+	ASSERT_NOT_NULL(a);
+	ASSERT_NOT_NULL(buf_addr);
+
+	if (p < a->base || p >= a->base + a->len) {
+		OPAE_ERR("buffer does not belong to this arena");
+		return FPGA_INVALID_PARAM;
+	}
+
+	off = (uint64_t)(p - a->base);
+	slab = (uint32_t)(off >> ARENA_SLAB_SHIFT);
+	kind = a->slabs[slab].kind;
+
+	if (kind == SLAB_RUN) {
+		uint32_t i;
+
+		if (off & (ARENA_SLAB_SIZE - 1)) {
+			OPAE_ERR("invalid buffer address");
+			return FPGA_INVALID_PARAM;
+		}
+
+		opae_mutex_lock(err, &a->lock);
+		for (i = 0 ; i < a->slabs[slab].run ; ++i)
+			a->slabs[slab + i].kind = SLAB_FREE;
+		a->slabs[slab].run = 0;
+		if (slab < a->slab_hint)
+			a->slab_hint = slab;
+		opae_mutex_unlock(err, &a->lock);
+
+		return FPGA_OK;
+	}
+
+	if (kind >= ARENA_NUM_CLASSES ||
+	    (off & ((1ULL << (kind + ARENA_MIN_SHIFT)) - 1))) {
+		OPAE_ERR("invalid buffer address");
+		return FPGA_INVALID_PARAM;
+	}
+
+	cache = arena_get_cache(a);
+	if (!cache) {
+		// Still return the block, just without caching it.
+		opae_mutex_lock(err, &a->lock);
+		arena_push_block(a, kind, p);
+		opae_mutex_unlock(err, &a->lock);
+
+		return FPGA_OK;
+	}
+
+	if (cache->count[kind] == ARENA_CACHE_DEPTH) {
+		opae_mutex_lock(err, &a->lock);
+		arena_flush_cache(a, cache, kind, ARENA_CACHE_DEPTH / 2);
+		opae_mutex_unlock(err, &a->lock);
+	}
+
+	cache->blocks[kind][cache->count[kind]++] = p;
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaBufferArenaGetWSID(fpga_buffer_arena arena,
+						uint64_t *wsid)
+{
+	opae_buffer_arena *a = opae_validate_buffer_arena(arena);
+
+	ASSERT_NOT_NULL(a);
+	ASSERT_NOT_NULL(wsid);
+
+	*wsid = a->wsid;
+	return FPGA_OK;
+}
@@ -0,0 +1,260 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "opae_int.h"
+#include "dfh_index.h"
+
+#define DFH_ID(__dfh)       ((uint16_t)((__dfh) & 0xfff))
+#define DFH_REVISION(__dfh) ((uint8_t)(((__dfh) >> 12) & 0xf))
+#define DFH_NEXT(__dfh)     (((__dfh) >> 16) & 0xffffff)
+#define DFH_EOL(__dfh)      (((__dfh) >> 40) & 0x1)
+#define DFH_TYPE(__dfh)     ((uint8_t)(((__dfh) >> 60) & 0xf))
+
+#define DFH_TYPE_PRIVATE 3
+
+// Bound the walk, in case the list is malformed and loops.
+#define DFH_MAX_FEATURES 4096
+
+STATIC uint32_t dfh_hash_id(uint16_t id)
+{
+	return (uint32_t)id * 2654435761u;
+}
+
+STATIC uint32_t dfh_hash_guid(const uint8_t *guid)
+{
+	uint32_t h = 2166136261u;
+	size_t i;
+
+	for (i = 0 ; i < sizeof(fpga_guid) ; ++i) {
+		h ^= guid[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+void opae_dfh_guid(uint64_t lo, uint64_t hi, fpga_guid guid)
+{
+	int i;
+
+	// The high word holds the first eight bytes of the GUID.
+	for (i = 0 ; i < 8 ; ++i) {
+		guid[i] = (uint8_t)(hi >> (56 - 8 * i));
+		guid[8 + i] = (uint8_t)(lo >> (56 - 8 * i));
+	}
+}
+
+STATIC int dfh_guid_null(const fpga_guid guid)
+{
+	size_t i;
+
+	for (i = 0 ; i < sizeof(fpga_guid) ; ++i) {
+		if (guid[i])
+			return 0;
+	}
+	return 1;
+}
+
+STATIC fpga_result dfh_index_hash(opae_dfh_index *index)
+{
+	uint32_t size = 8;
+	uint32_t i;
+
+	while (size < 2 * index->count)
+		size <<= 1;
+
+	index->mask = size - 1;
+	index->by_id = malloc(size * sizeof(int32_t));
+	index->by_guid = malloc(size * sizeof(int32_t));
+	if (!index->by_id || !index->by_guid) {
+		OPAE_ERR("malloc failed");
+		return FPGA_NO_MEMORY;
+	}
+
+	memset(index->by_id, 0xff, size * sizeof(int32_t));
+	memset(index->by_guid, 0xff, size * sizeof(int32_t));
+
+	for (i = 0 ; i < index->count ; ++i) {
+		const fpga_feature_info *f = &index->features[i];
+		uint32_t slot;
+
+		// Keep the first feature of any duplicate ID.
+		for (slot = dfh_hash_id(f->id) & index->mask ;
+		     index->by_id[slot] >= 0 ;
+		     slot = (slot + 1) & index->mask) {
+			if (index->features[index->by_id[slot]].id == f->id)
+				break;
+		}
+		if (index->by_id[slot] < 0)
+			index->by_id[slot] = (int32_t)i;
+
+		if (dfh_guid_null(f->guid))
+			continue;
+
+		for (slot = dfh_hash_guid(f->guid) & index->mask ;
+		     index->by_guid[slot] >= 0 ;
+		     slot = (slot + 1) & index->mask) {
+			if (!memcmp(index->features[index->by_guid[slot]].guid,
+				    f->guid, sizeof(fpga_guid)))
+				break;
+		}
+		if (index->by_guid[slot] < 0)
+			index->by_guid[slot] = (int32_t)i;
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result opae_dfh_index_build(opae_dfh_index **index,
+				 opae_dfh_read64 read64,
+				 void *context)
+{
+	opae_dfh_index *idx;
+	uint32_t capacity = 16;
+	uint64_t offset = 0;
+	fpga_result res;
+
+	ASSERT_NOT_NULL(index);
+	ASSERT_NOT_NULL(read64);
+
+	idx = calloc(1, sizeof(opae_dfh_index));
+	if (!idx) {
+		OPAE_ERR("calloc failed");
+		return FPGA_NO_MEMORY;
+	}
+
+	idx->features = malloc(capacity * sizeof(fpga_feature_info));
+	if (!idx->features) {
+		OPAE_ERR("malloc failed");
+		res = FPGA_NO_MEMORY;
+		goto out_destroy;
+	}
+
+	while (idx->count < DFH_MAX_FEATURES) {
+		fpga_feature_info *f;
+		uint64_t dfh = 0;
+		uint64_t lo = 0;
+		uint64_t hi = 0;
+
+		res = read64(context, offset, &dfh);
+		if (res)
+			goto out_destroy;
+
+		if (idx->count == capacity) {
+			fpga_feature_info *grown;
+
+			capacity *= 2;
+			grown = realloc(idx->features,
+					capacity * sizeof(fpga_feature_info));
+			if (!grown) {
+				OPAE_ERR("realloc failed");
+				res = FPGA_NO_MEMORY;
+				goto out_destroy;
+			}
+			idx->features = grown;
+		}
+
+		f = &idx->features[idx->count++];
+		memset(f, 0, sizeof(*f));
+		f->offset = offset;
+		f->id = DFH_ID(dfh);
+		f->revision = DFH_REVISION(dfh);
+		f->type = DFH_TYPE(dfh);
+
+		if (f->type != DFH_TYPE_PRIVATE) {
+			res = read64(context, offset + 0x8, &lo);
+			if (!res)
+				res = read64(context, offset + 0x10, &hi);
+			if (res)
+				goto out_destroy;
+			opae_dfh_guid(lo, hi, f->guid);
+		}
+
+		if (DFH_EOL(dfh) || !DFH_NEXT(dfh))
+			break;
+
+		offset += DFH_NEXT(dfh);
+	}
+
+	res = dfh_index_hash(idx);
+	if (res)
+		goto out_destroy;
+
+	*index = idx;
+	return FPGA_OK;
+
+out_destroy:
+	opae_dfh_index_destroy(idx);
+	return res;
+}
+
+const fpga_feature_info *opae_dfh_index_find(const opae_dfh_index *index,
+					     const uint8_t *guid,
+					     uint16_t id)
+{
+	uint32_t slot;
+	int32_t i;
+
+	if (!index)
+		return NULL;
+
+	if (guid) {
+		for (slot = dfh_hash_guid(guid) & index->mask ;
+		     (i = index->by_guid[slot]) >= 0 ;
+		     slot = (slot + 1) & index->mask) {
+			if (!memcmp(index->features[i].guid,
+				    guid, sizeof(fpga_guid)))
+				return &index->features[i];
+		}
+		return NULL;
+	}
+
+	for (slot = dfh_hash_id(id) & index->mask ;
+	     (i = index->by_id[slot]) >= 0 ;
+	     slot = (slot + 1) & index->mask) {
+		if (index->features[i].id == id)
+			return &index->features[i];
+	}
+	return NULL;
+}
+
+void opae_dfh_index_destroy(opae_dfh_index *index)
+{
+	if (!index)
+		return;
+
+	free(index->features);
+	free(index->by_id);
+	free(index->by_guid);
+	free(index);
+}
@@ -0,0 +1,84 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __OPAE_DFH_INDEX_H__
+#define __OPAE_DFH_INDEX_H__
+
+#include <stdint.h>
+
+#include <opae/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An index of the Device Feature List in an accelerator's MMIO
+ * space 0. Built by one walk of the DFH chain, then searched by
+ * feature ID or GUID through two open-addressed hash tables.
+ */
+typedef struct _opae_dfh_index {
+	uint32_t count;			// number of features
+	fpga_feature_info *features;	// in list order
+	uint32_t mask;			// hash table size - 1
+	int32_t *by_id;			// indices into features, -1 if empty
+	int32_t *by_guid;		// indices into features, -1 if empty
+} opae_dfh_index;
+
+// Reads the 64-bit register at offset of MMIO space 0.
+typedef fpga_result (*opae_dfh_read64)(void *context,
+				       uint64_t offset,
+				       uint64_t *value);
+
+/*
+ * Walk the DFH chain starting at offset 0, using read64 for every
+ * register access, and return the result in *index.
+ */
+fpga_result opae_dfh_index_build(opae_dfh_index **index,
+				 opae_dfh_read64 read64,
+				 void *context);
+
+/*
+ * Find a feature by GUID, or by ID when guid is NULL.
+ * Returns NULL when there is no such feature.
+ */
+const fpga_feature_info *opae_dfh_index_find(const opae_dfh_index *index,
+					     const uint8_t *guid,
+					     uint16_t id);
+
+void opae_dfh_index_destroy(opae_dfh_index *index);
+
+/*
+ * Convert the two GUID registers of a DFH (lo at offset 0x8, hi at
+ * offset 0x10) to an fpga_guid.
+ */
+void opae_dfh_guid(uint64_t lo, uint64_t hi, fpga_guid guid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OPAE_DFH_INDEX_H__
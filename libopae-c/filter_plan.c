@@ -0,0 +1,306 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "opae_int.h"
+#include "props.h"
+#include "filter_plan.h"
+
+// Match order: cheap, selective comparisons first; those that need
+// a callback (and likely a system call) last.
+STATIC const uint8_t filter_rank[OPAE_FILTER_FIELD_COUNT] = {
+	[OPAE_FILTER_BUS]               = 0,
+	[OPAE_FILTER_DEVICE]            = 1,
+	[OPAE_FILTER_FUNCTION]          = 2,
+	[OPAE_FILTER_SEGMENT]           = 3,
+	[OPAE_FILTER_DEVICEID]          = 4,
+	[OPAE_FILTER_VENDORID]          = 5,
+	[OPAE_FILTER_GUID]              = 6,
+	[OPAE_FILTER_SOCKETID]          = 7,
+	[OPAE_FILTER_OBJTYPE]           = 8,
+	[OPAE_FILTER_NUM_SLOTS]         = 9,
+	[OPAE_FILTER_BBSID]             = 10,
+	[OPAE_FILTER_BBSVERSION]        = 11,
+	[OPAE_FILTER_ACCELERATOR_STATE] = 12,
+	[OPAE_FILTER_NUM_MMIO]          = 13,
+	[OPAE_FILTER_NUM_INTERRUPTS]    = 14,
+	[OPAE_FILTER_PARENT]            = 15,
+	[OPAE_FILTER_OBJECTID]          = 16,
+	[OPAE_FILTER_NUM_ERRORS]        = 17,
+};
+
+#define BBS_VERSION_KEY(__v) \
+	(((uint64_t)(__v).major << 16) | \
+	 ((uint64_t)(__v).minor << 8) | \
+	 (uint64_t)(__v).patch)
+
+STATIC void filter_add_term(opae_filter_clause *clause,
+			    uint32_t field, uint64_t value)
+{
+	uint32_t i = clause->count++;
+
+	// Insertion sort by rank.
+	while (i && filter_rank[clause->terms[i - 1].field] >
+		    filter_rank[field]) {
+		clause->terms[i] = clause->terms[i - 1];
+		--i;
+	}
+
+	clause->terms[i].field = field;
+	clause->terms[i].value = value;
+}
+
+STATIC void filter_compile_clause(const struct _fpga_properties *p,
+				  opae_filter_parent_key parent_key,
+				  opae_filter_clause *clause)
+{
+	if (FIELD_VALID(p, FPGA_PROPERTY_PARENT)) {
+		if (p->parent && parent_key)
+			clause->parent_key = parent_key(p->parent,
+							&clause->parent_key_len);
+		if (!clause->parent_key)
+			clause->never = true;
+		filter_add_term(clause, OPAE_FILTER_PARENT, 0);
+	}
+
+	if (FIELD_VALID(p, FPGA_PROPERTY_OBJTYPE))
+		filter_add_term(clause, OPAE_FILTER_OBJTYPE, p->objtype);
+	if (FIELD_VALID(p, FPGA_PROPERTY_SEGMENT))
+		filter_add_term(clause, OPAE_FILTER_SEGMENT, p->segment);
+	if (FIELD_VALID(p, FPGA_PROPERTY_BUS))
+		filter_add_term(clause, OPAE_FILTER_BUS, p->bus);
+	if (FIELD_VALID(p, FPGA_PROPERTY_DEVICE))
+		filter_add_term(clause, OPAE_FILTER_DEVICE, p->device);
+	if (FIELD_VALID(p, FPGA_PROPERTY_FUNCTION))
+		filter_add_term(clause, OPAE_FILTER_FUNCTION, p->function);
+	if (FIELD_VALID(p, FPGA_PROPERTY_SOCKETID))
+		filter_add_term(clause, OPAE_FILTER_SOCKETID, p->socket_id);
+	if (FIELD_VALID(p, FPGA_PROPERTY_VENDORID))
+		filter_add_term(clause, OPAE_FILTER_VENDORID, p->vendor_id);
+	if (FIELD_VALID(p, FPGA_PROPERTY_DEVICEID))
+		filter_add_term(clause, OPAE_FILTER_DEVICEID, p->device_id);
+
+	if (FIELD_VALID(p, FPGA_PROPERTY_GUID)) {
+		memcpy(clause->guid, p->guid, sizeof(fpga_guid));
+		filter_add_term(clause, OPAE_FILTER_GUID, 0);
+	}
+
+	if (FIELD_VALID(p, FPGA_PROPERTY_OBJECTID))
+		filter_add_term(clause, OPAE_FILTER_OBJECTID, p->object_id);
+	if (FIELD_VALID(p, FPGA_PROPERTY_NUM_ERRORS))
+		filter_add_term(clause, OPAE_FILTER_NUM_ERRORS, p->num_errors);
+
+	// The object-specific fields share bit numbers, so they are
+	// only meaningful when the filter also names the object type.
+	if (!FIELD_VALID(p, FPGA_PROPERTY_OBJTYPE))
+		return;
+
+	if (p->objtype == FPGA_DEVICE) {
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_SLOTS))
+			filter_add_term(clause, OPAE_FILTER_NUM_SLOTS,
+					p->u.fpga.num_slots);
+		if (FIELD_VALID(p, FPGA_PROPERTY_BBSID))
+			filter_add_term(clause, OPAE_FILTER_BBSID,
+					p->u.fpga.bbs_id);
+		if (FIELD_VALID(p, FPGA_PROPERTY_BBSVERSION))
+			filter_add_term(clause, OPAE_FILTER_BBSVERSION,
+					BBS_VERSION_KEY(p->u.fpga.bbs_version));
+	} else if (p->objtype == FPGA_ACCELERATOR) {
+		if (FIELD_VALID(p, FPGA_PROPERTY_ACCELERATOR_STATE))
+			filter_add_term(clause, OPAE_FILTER_ACCELERATOR_STATE,
+					p->u.accelerator.state);
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_MMIO))
+			filter_add_term(clause, OPAE_FILTER_NUM_MMIO,
+					p->u.accelerator.num_mmio);
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_INTERRUPTS))
+			filter_add_term(clause, OPAE_FILTER_NUM_INTERRUPTS,
+					p->u.accelerator.num_interrupts);
+	}
+}
+
+fpga_result opae_filter_plan_compile(const fpga_properties *filters,
+				     uint32_t num_filters,
+				     opae_filter_parent_key parent_key,
+				     opae_filter_plan **plan)
+{
+	opae_filter_plan *pln;
+	uint32_t i;
+	uint32_t j;
+
+	ASSERT_NOT_NULL(plan);
+
+	if (num_filters && !filters) {
+		OPAE_MSG("num_filters > 0 with NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	pln = (opae_filter_plan *)calloc(1, sizeof(opae_filter_plan) +
+				num_filters * sizeof(opae_filter_clause));
+	if (!pln) {
+		OPAE_ERR("calloc failed");
+		return FPGA_NO_MEMORY;
+	}
+
+	for (i = 0 ; i < num_filters ; ++i) {
+		opae_filter_clause *clause = &pln->clauses[i];
+		bool locked;
+		struct _fpga_properties *p =
+			opae_validate_and_lock_properties_ro(filters[i], &locked);
+
+		if (!p) {
+			OPAE_MSG("Invalid filter");
+			pln->count = i;
+			opae_filter_plan_destroy(pln);
+			return FPGA_INVALID_PARAM;
+		}
+
+		filter_compile_clause(p, parent_key, clause);
+
+		opae_unlock_properties_ro(p, locked);
+
+		for (j = 0 ; j < clause->count ; ++j)
+			pln->needs |= OPAE_FILTER_BIT(clause->terms[j].field);
+	}
+
+	pln->count = num_filters;
+	*plan = pln;
+
+	return FPGA_OK;
+}
+
+STATIC bool filter_match_term(const opae_filter_clause *clause,
+			      const opae_filter_term *t,
+			      const opae_filter_candidate *c)
+{
+	const void *key;
+	size_t len = 0;
+	uint64_t value = 0;
+
+	switch (t->field) {
+	case OPAE_FILTER_PARENT:
+		if (c->objtype != FPGA_ACCELERATOR || !c->parent)
+			return false; // Only accelerators have a parent.
+		key = c->parent(c->context, &len);
+		return key && len == clause->parent_key_len &&
+		       !memcmp(key, clause->parent_key, len);
+	case OPAE_FILTER_OBJTYPE:
+		return (uint64_t)c->objtype == t->value;
+	case OPAE_FILTER_SEGMENT:
+		return c->segment == t->value;
+	case OPAE_FILTER_BUS:
+		return c->bus == t->value;
+	case OPAE_FILTER_DEVICE:
+		return c->device == t->value;
+	case OPAE_FILTER_FUNCTION:
+		return c->function == t->value;
+	case OPAE_FILTER_SOCKETID:
+		return c->socket_id == t->value;
+	case OPAE_FILTER_VENDORID:
+		return c->vendor_id == t->value;
+	case OPAE_FILTER_DEVICEID:
+		return c->device_id == t->value;
+	case OPAE_FILTER_GUID:
+		return c->guid && !memcmp(c->guid, clause->guid,
+					  sizeof(fpga_guid));
+	case OPAE_FILTER_OBJECTID:
+	case OPAE_FILTER_NUM_ERRORS:
+		return c->fetch &&
+		       c->fetch(c->context, t->field, &value) == FPGA_OK &&
+		       value == t->value;
+	case OPAE_FILTER_NUM_SLOTS:
+		return c->objtype == FPGA_DEVICE &&
+		       c->num_slots == t->value;
+	case OPAE_FILTER_BBSID:
+		return c->objtype == FPGA_DEVICE &&
+		       c->bbs_id == t->value;
+	case OPAE_FILTER_BBSVERSION:
+		return c->objtype == FPGA_DEVICE &&
+		       BBS_VERSION_KEY(c->bbs_version) == t->value;
+	case OPAE_FILTER_ACCELERATOR_STATE:
+		return c->objtype == FPGA_ACCELERATOR &&
+		       (uint64_t)c->state == t->value;
+	case OPAE_FILTER_NUM_MMIO:
+		return c->objtype == FPGA_ACCELERATOR &&
+		       c->num_mmio == t->value;
+	case OPAE_FILTER_NUM_INTERRUPTS:
+		return c->objtype == FPGA_ACCELERATOR &&
+		       c->num_interrupts == t->value;
+	}
+
+	return false;
+}
+
+bool opae_filter_plan_match(const opae_filter_plan *plan,
+			    const opae_filter_candidate *c)
+{
+	uint32_t i;
+	uint32_t j;
+
+	if (!plan->count) // no filter == match everything
+		return true;
+
+	for (i = 0 ; i < plan->count ; ++i) {
+		const opae_filter_clause *clause = &plan->clauses[i];
+
+		if (clause->never)
+			continue;
+
+		for (j = 0 ; j < clause->count ; ++j) {
+			const opae_filter_term *t = &clause->terms[j];
+
+			if (!(c->present & OPAE_FILTER_BIT(t->field)))
+				continue;
+
+			if (!filter_match_term(clause, t, c))
+				break;
+		}
+
+		if (j == clause->count)
+			return true;
+	}
+
+	return false;
+}
+
+void opae_filter_plan_destroy(opae_filter_plan *plan)
+{
+	uint32_t i;
+
+	if (!plan)
+		return;
+
+	for (i = 0 ; i < plan->count ; ++i)
+		free(plan->clauses[i].parent_key);
+
+	free(plan);
+}
@@ -0,0 +1,155 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __OPAE_FILTER_PLAN_H__
+#define __OPAE_FILTER_PLAN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <opae/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The attributes a filter may constrain. Unlike the FPGA_PROPERTY_*
+ * bit numbers, these don't overlap between object types.
+ */
+enum opae_filter_field {
+	OPAE_FILTER_PARENT = 0,
+	OPAE_FILTER_OBJTYPE,
+	OPAE_FILTER_SEGMENT,
+	OPAE_FILTER_BUS,
+	OPAE_FILTER_DEVICE,
+	OPAE_FILTER_FUNCTION,
+	OPAE_FILTER_SOCKETID,
+	OPAE_FILTER_VENDORID,
+	OPAE_FILTER_DEVICEID,
+	OPAE_FILTER_GUID,
+	OPAE_FILTER_OBJECTID,
+	OPAE_FILTER_NUM_ERRORS,
+	OPAE_FILTER_NUM_SLOTS,
+	OPAE_FILTER_BBSID,
+	OPAE_FILTER_BBSVERSION,
+	OPAE_FILTER_ACCELERATOR_STATE,
+	OPAE_FILTER_NUM_MMIO,
+	OPAE_FILTER_NUM_INTERRUPTS,
+	OPAE_FILTER_FIELD_COUNT
+};
+
+#define OPAE_FILTER_BIT(__f) ((uint32_t)1 << (__f))
+
+typedef struct _opae_filter_term {
+	uint32_t field;
+	uint64_t value;
+} opae_filter_term;
+
+typedef struct _opae_filter_clause {
+	bool never;		// can't match anything (eg NULL parent)
+	uint32_t count;
+	opae_filter_term terms[OPAE_FILTER_FIELD_COUNT]; // in match order
+	fpga_guid guid;
+	void *parent_key;	// plugin-defined parent identity
+	size_t parent_key_len;
+} opae_filter_clause;
+
+/*
+ * An immutable copy of the filters passed to fpgaEnumerate(). Each
+ * filter becomes a clause whose terms are ordered so that the cheap,
+ * selective comparisons run first and the ones needing a system call
+ * run last. Matching takes no locks.
+ */
+typedef struct _opae_filter_plan {
+	uint32_t count;		// 0 matches everything
+	uint32_t needs;		// OPAE_FILTER_BIT()s used by any clause
+	opae_filter_clause clauses[];
+} opae_filter_plan;
+
+/*
+ * An enumeration candidate, as seen by opae_filter_plan_match().
+ * Terms on fields missing from present are ignored.
+ */
+typedef struct _opae_filter_candidate {
+	uint32_t present;	// OPAE_FILTER_BIT()s provided
+	fpga_objtype objtype;
+	uint16_t segment;
+	uint8_t bus;
+	uint8_t device;
+	uint8_t function;
+	uint8_t socket_id;
+	uint16_t vendor_id;
+	uint16_t device_id;
+	const uint8_t *guid;
+	uint32_t num_slots;
+	uint64_t bbs_id;
+	fpga_version bbs_version;
+	fpga_accelerator_state state;
+	uint32_t num_mmio;
+	uint32_t num_interrupts;
+
+	// Fetch OPAE_FILTER_OBJECTID or OPAE_FILTER_NUM_ERRORS on demand.
+	fpga_result (*fetch)(void *context, uint32_t field, uint64_t *value);
+	// Return the parent identity, or NULL when there is no parent.
+	const void *(*parent)(void *context, size_t *len);
+	void *context;
+} opae_filter_candidate;
+
+/*
+ * Return the identity of a parent token, in a buffer allocated with
+ * malloc(). A clause whose parent has no identity never matches.
+ */
+typedef void *(*opae_filter_parent_key)(fpga_token parent, size_t *len);
+
+/*
+ * Compile num_filters filters into *plan, taking each filter's lock
+ * once (frozen filters need none). parent_key resolves
+ * FPGA_PROPERTY_PARENT up front.
+ */
+fpga_result opae_filter_plan_compile(const fpga_properties *filters,
+				     uint32_t num_filters,
+				     opae_filter_parent_key parent_key,
+				     opae_filter_plan **plan);
+
+bool opae_filter_plan_match(const opae_filter_plan *plan,
+			    const opae_filter_candidate *c);
+
+void opae_filter_plan_destroy(opae_filter_plan *plan);
+
+static inline bool opae_filter_plan_needs(const opae_filter_plan *plan,
+					  uint32_t field)
+{
+	return (plan->needs & OPAE_FILTER_BIT(field)) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OPAE_FILTER_PLAN_H__
@@ -45,6 +45,7 @@
 #include <opae/utils.h>
 #include "pluginmgr.h"
 #include "opae_int.h"
+#include "async_log.h"
 
 /* global loglevel */
 static int g_loglevel = OPAE_DEFAULT_LOGLEVEL;
@@ -74,12 +75,18 @@ void opae_print(int loglevel, const char *fmt, ...)
 	if (loglevel > g_loglevel)
 		return;
 
+	va_start(argp, fmt);
+
+	if (!opae_log_async_print(loglevel, fmt, argp)) {
+		va_end(argp);
+		return;
+	}
+
 	if (loglevel == OPAE_LOG_ERROR)
 		fp = stderr;
 	else
 		fp = g_logfile == NULL ? stdout : g_logfile;
 
-	va_start(argp, fmt);
 	err = pthread_mutex_lock(
 		&log_lock); /* ignore failure and print anyway */
 	if (err)
@@ -197,6 +204,16 @@ __attribute__((constructor)) STATIC void opae_init(void)
 	if (g_logfile == NULL)
 		g_logfile = stdout;
 
+	// Hand formatting and file I/O to a background thread, so that
+	// raising the log level doesn't serialize the callers.
+	if (getenv("LIBOPAE_LOG_ASYNC")) {
+		int err = opae_log_async_start(g_logfile);
+		if (err)
+			fprintf(stderr,
+				"Could not start the asynchronous logger: %s\n",
+				strerror(err));
+	}
+
 	with_ase = getenv("WITH_ASE");
 	if (with_ase) {
 		cfg_path = find_ase_cfg();
@@ -213,9 +230,11 @@ __attribute__((constructor)) STATIC void opae_init(void)
 		free(cfg_path);
 	}
 	// If the environment hasn't requested explicit initialization,
-	// perform the initialization implicitly here.
+	// perform the initialization implicitly on first use, so that
+	// processes which never enumerate don't pay for platform
+	// detection and plugin loading.
 	else if (getenv("OPAE_EXPLICIT_INITIALIZE") == NULL)
-		fpgaInitialize(NULL);
+		opae_plugin_mgr_defer_initialize();
 }
 
 __attribute__((destructor)) STATIC void opae_release(void)
@@ -226,6 +245,8 @@ __attribute__((destructor)) STATIC void opae_release(void)
 	if (res != FPGA_OK)
 		OPAE_ERR("fpgaFinalize: %s", fpgaErrStr(res));
 
+	opae_log_async_stop();
+
 	if (g_logfile != NULL && g_logfile != stdout) {
 		fclose(g_logfile);
 	}
@@ -0,0 +1,145 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "mmio_burst.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define CPUID_7_0_ECX_MOVDIR64B (1u << 28)
+
+static void write_line_movdir64b(volatile void *dst, const void *src)
+{
+	// movdir64b (%rdx), %rax; spelled out for older assemblers
+	__asm__ volatile(".byte 0x66, 0x0f, 0x38, 0xf8, 0x02"
+			 :
+			 : "a"(dst), "d"(src)
+			 : "memory");
+}
+
+__attribute__((target("avx512f")))
+static void write_line_avx512(volatile void *dst, const void *src)
+{
+	_mm512_store_si512((void *)dst, _mm512_loadu_si512(src));
+}
+
+__attribute__((target("avx2")))
+static void write_line_avx2(volatile void *dst, const void *src)
+{
+	const __m256i *s = (const __m256i *)src;
+	__m256i *d = (__m256i *)dst;
+
+	_mm256_store_si256(d, _mm256_loadu_si256(s));
+	_mm256_store_si256(d + 1, _mm256_loadu_si256(s + 1));
+}
+
+#endif // __x86_64__
+
+static void write_line_qword(volatile void *dst, const void *src)
+{
+	volatile uint64_t *d = (volatile uint64_t *)dst;
+	uint64_t q[8];
+	int i;
+
+	memcpy(q, src, sizeof(q));
+	for (i = 0 ; i < 8 ; ++i)
+		d[i] = q[i];
+}
+
+static opae_mmio_line_method mmio_line_method = (opae_mmio_line_method)-1;
+
+opae_mmio_line_method opae_mmio_line_method_get(void)
+{
+	opae_mmio_line_method m = __atomic_load_n(&mmio_line_method,
+						   __ATOMIC_RELAXED);
+
+	if (m != (opae_mmio_line_method)-1)
+		return m;
+
+	m = OPAE_MMIO_LINE_QWORD;
+#if defined(__x86_64__)
+	{
+		unsigned int eax, ebx, ecx, edx;
+
+		__builtin_cpu_init();
+		if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+		    (ecx & CPUID_7_0_ECX_MOVDIR64B))
+			m = OPAE_MMIO_LINE_MOVDIR64B;
+		else if (__builtin_cpu_supports("avx512f"))
+			m = OPAE_MMIO_LINE_AVX512;
+		else if (__builtin_cpu_supports("avx2"))
+			m = OPAE_MMIO_LINE_AVX2;
+	}
+#endif // __x86_64__
+
+	// Racing callers compute the same value.
+	__atomic_store_n(&mmio_line_method, m, __ATOMIC_RELAXED);
+	return m;
+}
+
+void opae_mmio_write_lines(volatile void *dst, const void *src,
+			   uint32_t num_lines, bool fixed)
+{
+	void (*write_line)(volatile void *, const void *) = write_line_qword;
+	volatile uint8_t *d = (volatile uint8_t *)dst;
+	const uint8_t *s = (const uint8_t *)src;
+	size_t stride = fixed ? 0 : 64;
+	uint32_t i;
+
+#if defined(__x86_64__)
+	switch (opae_mmio_line_method_get()) {
+	case OPAE_MMIO_LINE_MOVDIR64B:
+		write_line = write_line_movdir64b;
+		break;
+	case OPAE_MMIO_LINE_AVX512:
+		write_line = write_line_avx512;
+		break;
+	case OPAE_MMIO_LINE_AVX2:
+		write_line = write_line_avx2;
+		break;
+	default:
+		break;
+	}
+#endif // __x86_64__
+
+	for (i = 0 ; i < num_lines ; ++i, d += stride, s += 64)
+		write_line(d, s);
+
+	// Direct and write-combined stores are weakly ordered.
+#if defined(__x86_64__)
+	_mm_sfence();
+#else
+	__sync_synchronize();
+#endif // __x86_64__
+}
@@ -0,0 +1,72 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef __OPAE_MMIO_BURST_H__
+#define __OPAE_MMIO_BURST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * How a 64-byte line is written to MMIO, best first. Picked once per
+ * process from the CPU's features.
+ */
+typedef enum _opae_mmio_line_method {
+	OPAE_MMIO_LINE_MOVDIR64B = 0,	// one 64-byte direct store
+	OPAE_MMIO_LINE_AVX512,		// one 64-byte vector store
+	OPAE_MMIO_LINE_AVX2,		// two 32-byte vector stores
+	OPAE_MMIO_LINE_QWORD		// eight 64-bit stores
+} opae_mmio_line_method;
+
+opae_mmio_line_method opae_mmio_line_method_get(void);
+
+/*
+ * true when each line reaches the device as a single 64-byte write,
+ * as fpgaWriteMMIO512() requires.
+ */
+static inline bool opae_mmio_line_atomic(void)
+{
+	return opae_mmio_line_method_get() <= OPAE_MMIO_LINE_AVX512;
+}
+
+/*
+ * Write num_lines 64-byte lines from src to the 64-byte aligned MMIO
+ * address dst. When fixed is true, every line goes to dst (a
+ * submission portal); otherwise consecutive lines go to consecutive
+ * addresses. src needs no particular alignment. A single store fence
+ * follows the last line.
+ */
+void opae_mmio_write_lines(volatile void *dst, const void *src,
+			   uint32_t num_lines, bool fixed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OPAE_MMIO_BURST_H__
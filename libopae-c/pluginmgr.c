@@ -35,6 +35,7 @@
 #include <dlfcn.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <linux/limits.h>
 #include <pthread.h>
 #include <pwd.h>
@@ -79,6 +80,7 @@ static platform_data platform_data_table[] = {
 
 static int initialized;
 static int finalizing;
+static int deferred;
 
 STATIC opae_api_adapter_table *adapter_list = (void *)0;
 static pthread_mutex_t adapter_list_lock =
@@ -326,6 +328,7 @@ int opae_plugin_mgr_finalize_all(void)
 
 	opae_plugin_mgr_reset_cfg();
 	initialized = 0;
+	deferred = 0;
 	finalizing = 0;
 	opae_mutex_unlock(res, &adapter_list_lock);
 
@@ -541,11 +544,51 @@ STATIC void opae_plugin_mgr_detect_platform(uint16_t vendor, uint16_t device)
 	}
 }
 
+// Read a hex sysfs attribute (vendor or device) relative to dfd.
+STATIC int opae_plugin_mgr_read_id(int dfd, const char *dev,
+				   const char *attr, uint16_t *id)
+{
+	char path[PATH_MAX];
+	char buf[16];
+	ssize_t n;
+	int fd;
+
+	if (snprintf(path, sizeof(path), "%s/%s", dev, attr) < 0)
+		return 1;
+
+	fd = openat(dfd, path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 1;
+
+	n = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+
+	if (n <= 0)
+		return 1;
+
+	buf[n] = '\0';
+	*id = (uint16_t)strtoul(buf, NULL, 16);
+
+	return 0;
+}
+
+// Retrieve the vendor and device IDs of PCI device dev. These
+// attributes are cached by the kernel, so unlike 'config' reading them
+// does not resume a runtime-suspended device.
+STATIC int opae_plugin_mgr_read_ids(int dfd, const char *dev,
+				    uint16_t *vendor, uint16_t *device)
+{
+	if (opae_plugin_mgr_read_id(dfd, dev, "vendor", vendor) ||
+	    opae_plugin_mgr_read_id(dfd, dev, "device", device))
+		return 1;
+
+	return 0;
+}
+
 STATIC int opae_plugin_mgr_detect_platforms(void)
 {
+	const char *base_dir = "/sys/bus/pci/devices";
 	DIR *dir;
-	char base_dir[PATH_MAX];
-	char file_path[PATH_MAX];
 	struct dirent *dirent;
 	int errors = 0;
 
@@ -553,8 +596,6 @@ STATIC int opae_plugin_mgr_detect_platforms(void)
 	// This directory contains symbolic links to device directories
 	// where 'vendor' and 'device' files exist.
 
-	memcpy(base_dir, "/sys/bus/pci/devices", 21);
-
 	dir = opendir(base_dir);
 	if (!dir) {
 		OPAE_ERR("Failed to open %s. Aborting platform detection.", base_dir);
@@ -562,71 +603,25 @@ STATIC int opae_plugin_mgr_detect_platforms(void)
 	}
 
 	while ((dirent = readdir(dir)) != NULL) {
-		FILE *fp;
-		unsigned vendor = 0;
-		unsigned device = 0;
+		uint16_t vendor = 0;
+		uint16_t device = 0;
 
-		if (!strcmp(dirent->d_name, ".") ||
-		    !strcmp(dirent->d_name, ".."))
+		if (dirent->d_name[0] == '.')
 			continue;
 
-		// Read the 'vendor' file.
-		if (snprintf(file_path, sizeof(file_path),
-			     "%s/%s/vendor",
-			     base_dir,
-			     dirent->d_name) < 0) {
-			OPAE_ERR("snprintf buffer overflow");
-			++errors;
-			goto out_close;
-		}
-
-		fp = fopen(file_path, "r");
-		if (!fp) {
-			OPAE_ERR("Failed to open %s. Aborting platform detection.", file_path);
+		if (opae_plugin_mgr_read_ids(dirfd(dir), dirent->d_name,
+					     &vendor, &device)) {
+			OPAE_ERR("Failed to read IDs of %s/%s. "
+				 "Aborting platform detection.",
+				 base_dir, dirent->d_name);
 			++errors;
-			goto out_close;
-		}
-
-		if (EOF == fscanf(fp, "%x", &vendor)) {
-			OPAE_ERR("Failed to read %s. Aborting platform detection.", file_path);
-			fclose(fp);
-			++errors;
-			goto out_close;
-		}
-
-		fclose(fp);
-
-		// Read the 'device' file.
-		if (snprintf(file_path, sizeof(file_path),
-			     "%s/%s/device",
-			     base_dir,
-			     dirent->d_name) < 0) {
-			OPAE_ERR("snprintf buffer overflow");
-			++errors;
-			goto out_close;
-		}
-
-		fp = fopen(file_path, "r");
-		if (!fp) {
-			OPAE_ERR("Failed to open %s. Aborting platform detection.", file_path);
-			++errors;
-			goto out_close;
-		}
-
-		if (EOF == fscanf(fp, "%x", &device)) {
-			OPAE_ERR("Failed to read %s. Aborting platform detection.", file_path);
-			fclose(fp);
-			++errors;
-			goto out_close;
+			break;
 		}
 
-		fclose(fp);
-
 		// Detect platform for this (vendor, device).
-		opae_plugin_mgr_detect_platform((uint16_t) vendor, (uint16_t) device);
+		opae_plugin_mgr_detect_platform(vendor, device);
 	}
 
-out_close:
 	closedir(dir);
 	return errors;
 }
@@ -751,6 +746,8 @@ int opae_plugin_mgr_initialize(const char *cfg_file)
 
 	opae_mutex_lock(res, &adapter_list_lock);
 
+	deferred = 0;
+
 	if (initialized) { // prevent multiple init.
 		opae_mutex_unlock(res, &adapter_list_lock);
 		return 0;
@@ -786,6 +783,18 @@ out_unlock:
 	return errors;
 }
 
+void opae_plugin_mgr_defer_initialize(void)
+{
+	int res;
+
+	opae_mutex_lock(res, &adapter_list_lock);
+
+	if (!initialized)
+		deferred = 1;
+
+	opae_mutex_unlock(res, &adapter_list_lock);
+}
+
 int opae_plugin_mgr_for_each_adapter
 	(int (*callback)(const opae_api_adapter_table *, void *), void *context)
 {
@@ -800,6 +809,9 @@ int opae_plugin_mgr_for_each_adapter
 
 	opae_mutex_lock(res, &adapter_list_lock);
 
+	if (deferred)
+		opae_plugin_mgr_initialize(NULL);
+
 	for (aptr = adapter_list; aptr; aptr = aptr->next) {
 		cb_res = callback(aptr, context);
 		if (cb_res)
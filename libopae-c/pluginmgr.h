@@ -32,6 +32,10 @@
 // non-zero on failure.
 int opae_plugin_mgr_initialize(const char *cfg_file);
 
+// Postpone platform detection and plugin loading until the
+// first call to opae_plugin_mgr_for_each_adapter().
+void opae_plugin_mgr_defer_initialize(void);
+
 // non-zero on failure.
 int opae_plugin_mgr_finalize_all(void);
 
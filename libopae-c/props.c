@@ -141,6 +141,7 @@ fpga_result __OPAE_API__ fpgaCloneProperties(fpga_properties src,
 
 	*clone = *p;
 	clone->lock = save_lock;
+	clone->frozen = 0;
 
 	if (FIELD_VALID(p, FPGA_PROPERTY_PARENT)) {
 		opae_wrapped_token *wrapped_token =
@@ -159,7 +160,7 @@ fpga_result __OPAE_API__ fpgaCloneProperties(fpga_properties src,
 fpga_result __OPAE_API__ fpgaClearProperties(fpga_properties props)
 {
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(props);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(props);
 
 	ASSERT_NOT_NULL(p);
 
@@ -178,16 +179,106 @@ fpga_result __OPAE_API__ fpgaClearProperties(fpga_properties props)
 	return FPGA_OK;
 }
 
+#define SNAPSHOT_FIELDS_MASK                                                   \
+	((((uint64_t)1 << (FPGA_PROPERTY_NUM_ERRORS + 1)) - 1) |               \
+	 ((uint64_t)1 << FPGA_PROPERTY_NUM_SLOTS) |                            \
+	 ((uint64_t)1 << FPGA_PROPERTY_BBSID) |                                \
+	 ((uint64_t)1 << FPGA_PROPERTY_BBSVERSION))
+
+fpga_result __OPAE_API__ fpgaPropertiesGetSnapshot(const fpga_properties prop,
+					fpga_properties_snapshot *snapshot)
+{
+	struct _fpga_properties *p;
+	bool locked;
+
+	ASSERT_NOT_NULL(snapshot);
+
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
+
+	ASSERT_NOT_NULL(p);
+
+	memset(snapshot, 0, sizeof(*snapshot));
+
+	// FPGA_SNAPSHOT_* flags use the same bit positions as the
+	// FPGA_PROPERTY_* fields.
+	snapshot->valid_fields = p->valid_fields & SNAPSHOT_FIELDS_MASK;
+
+	if (FIELD_VALID(p, FPGA_PROPERTY_PARENT))
+		snapshot->parent = p->parent;
+	if (FIELD_VALID(p, FPGA_PROPERTY_OBJTYPE))
+		snapshot->objtype = p->objtype;
+	if (FIELD_VALID(p, FPGA_PROPERTY_SEGMENT))
+		snapshot->segment = p->segment;
+	if (FIELD_VALID(p, FPGA_PROPERTY_BUS))
+		snapshot->bus = p->bus;
+	if (FIELD_VALID(p, FPGA_PROPERTY_DEVICE))
+		snapshot->device = p->device;
+	if (FIELD_VALID(p, FPGA_PROPERTY_FUNCTION))
+		snapshot->function = p->function;
+	if (FIELD_VALID(p, FPGA_PROPERTY_SOCKETID))
+		snapshot->socket_id = p->socket_id;
+	if (FIELD_VALID(p, FPGA_PROPERTY_VENDORID))
+		snapshot->vendor_id = p->vendor_id;
+	if (FIELD_VALID(p, FPGA_PROPERTY_DEVICEID))
+		snapshot->device_id = p->device_id;
+	if (FIELD_VALID(p, FPGA_PROPERTY_GUID))
+		memcpy(snapshot->guid, p->guid, sizeof(fpga_guid));
+	if (FIELD_VALID(p, FPGA_PROPERTY_OBJECTID))
+		snapshot->object_id = p->object_id;
+	if (FIELD_VALID(p, FPGA_PROPERTY_NUM_ERRORS))
+		snapshot->num_errors = p->num_errors;
+
+	if (FIELD_VALID(p, FPGA_PROPERTY_OBJTYPE) &&
+	    p->objtype == FPGA_DEVICE) {
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_SLOTS))
+			snapshot->u.fpga.num_slots = p->u.fpga.num_slots;
+		if (FIELD_VALID(p, FPGA_PROPERTY_BBSID))
+			snapshot->u.fpga.bbs_id = p->u.fpga.bbs_id;
+		if (FIELD_VALID(p, FPGA_PROPERTY_BBSVERSION))
+			snapshot->u.fpga.bbs_version = p->u.fpga.bbs_version;
+	} else if (FIELD_VALID(p, FPGA_PROPERTY_OBJTYPE) &&
+		   p->objtype == FPGA_ACCELERATOR) {
+		if (FIELD_VALID(p, FPGA_PROPERTY_ACCELERATOR_STATE))
+			snapshot->u.accelerator.state =
+				p->u.accelerator.state;
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_MMIO))
+			snapshot->u.accelerator.num_mmio =
+				p->u.accelerator.num_mmio;
+		if (FIELD_VALID(p, FPGA_PROPERTY_NUM_INTERRUPTS))
+			snapshot->u.accelerator.num_interrupts =
+				p->u.accelerator.num_interrupts;
+	}
+
+	opae_unlock_properties_ro(p, locked);
+
+	return FPGA_OK;
+}
+
+fpga_result __OPAE_API__ fpgaPropertiesFreeze(fpga_properties prop)
+{
+	int err;
+	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+
+	ASSERT_NOT_NULL(p);
+
+	// Publishes every earlier write to readers that skip the lock.
+	__atomic_store_n(&p->frozen, 1, __ATOMIC_RELEASE);
+
+	opae_mutex_unlock(err, &p->lock);
+
+	return FPGA_OK;
+}
+
 fpga_result __OPAE_API__ fpgaPropertiesGetParent(const fpga_properties prop,
 						 fpga_token *parent)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(parent);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -198,7 +289,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetParent(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -212,7 +303,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetParent(fpga_properties prop,
 
 	ASSERT_NOT_NULL(parent);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -240,12 +331,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetObjectType(
 	const fpga_properties prop, fpga_objtype *objtype)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(objtype);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -256,7 +347,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetObjectType(
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -265,7 +356,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetObjectType(fpga_properties prop,
 						     fpga_objtype objtype)
 {
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -281,12 +372,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetSegment(const fpga_properties prop,
 						  uint16_t *segment)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(segment);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -297,7 +388,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetSegment(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -306,7 +397,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetSegment(fpga_properties prop,
 						  uint16_t segment)
 {
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -322,12 +413,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBus(const fpga_properties prop,
 					      uint8_t *bus)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(bus);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -338,7 +429,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBus(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -348,7 +439,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetBus(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -364,12 +455,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetDevice(const fpga_properties prop,
 						 uint8_t *device)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(device);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -380,7 +471,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetDevice(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -390,7 +481,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetDevice(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -406,12 +497,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetFunction(const fpga_properties prop,
 						   uint8_t *function)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(function);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -422,7 +513,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetFunction(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -440,7 +531,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetFunction(fpga_properties prop,
 		return FPGA_INVALID_PARAM;
 	}
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_rw(prop);
 	ASSERT_NOT_NULL(p);
 
 	SET_FIELD_VALID(p, FPGA_PROPERTY_FUNCTION);
@@ -455,12 +546,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetSocketID(const fpga_properties prop,
 						   uint8_t *socket_id)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(socket_id);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -471,7 +562,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetSocketID(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -481,7 +572,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetSocketID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -497,12 +588,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetDeviceID(const fpga_properties prop,
 						   uint16_t *device_id)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(device_id);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -513,7 +604,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetDeviceID(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -523,7 +614,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetDeviceID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -539,12 +630,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumSlots(const fpga_properties prop,
 						   uint32_t *num_slots)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(num_slots);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -563,7 +654,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumSlots(const fpga_properties prop,
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -573,7 +664,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetNumSlots(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -597,12 +688,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBBSID(const fpga_properties prop,
 						uint64_t *bbs_id)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(bbs_id);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -621,7 +712,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBBSID(const fpga_properties prop,
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -631,7 +722,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetBBSID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -654,12 +745,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBBSVersion(const fpga_properties prop,
 						     fpga_version *bbs_version)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(bbs_version);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -678,7 +769,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetBBSVersion(const fpga_properties prop,
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -688,7 +779,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetBBSVersion(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -712,12 +803,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetVendorID(const fpga_properties prop,
 						   uint16_t *vendor_id)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(vendor_id);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -728,7 +819,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetVendorID(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -738,7 +829,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetVendorID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -808,12 +899,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetGUID(const fpga_properties prop,
 					       fpga_guid *guid)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(guid);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -824,7 +915,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetGUID(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -834,7 +925,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetGUID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -851,12 +942,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumMMIO(const fpga_properties prop,
 						  uint32_t *mmio_spaces)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(mmio_spaces);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -875,7 +966,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumMMIO(const fpga_properties prop,
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -885,7 +976,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetNumMMIO(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -909,12 +1000,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumInterrupts(
 	const fpga_properties prop, uint32_t *num_interrupts)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(num_interrupts);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -933,7 +1024,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumInterrupts(
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -943,7 +1034,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetNumInterrupts(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -967,12 +1058,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetAcceleratorState(
 	const fpga_properties prop, fpga_accelerator_state *state)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(state);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -990,7 +1081,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetAcceleratorState(
 		res = FPGA_INVALID_PARAM;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -1000,7 +1091,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetAcceleratorState(
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -1023,12 +1114,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetObjectID(const fpga_properties prop,
 						   uint64_t *object_id)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(object_id);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -1039,7 +1130,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetObjectID(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -1049,7 +1140,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetObjectID(fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
@@ -1065,12 +1156,12 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumErrors(const fpga_properties prop,
 						    uint32_t *num_errors)
 {
 	fpga_result res = FPGA_OK;
-	int err;
 	struct _fpga_properties *p;
+	bool locked;
 
 	ASSERT_NOT_NULL(num_errors);
 
-	p = opae_validate_and_lock_properties(prop);
+	p = opae_validate_and_lock_properties_ro(prop, &locked);
 
 	ASSERT_NOT_NULL(p);
 
@@ -1081,7 +1172,7 @@ fpga_result __OPAE_API__ fpgaPropertiesGetNumErrors(const fpga_properties prop,
 		res = FPGA_NOT_FOUND;
 	}
 
-	opae_mutex_unlock(err, &p->lock);
+	opae_unlock_properties_ro(p, locked);
 
 	return res;
 }
@@ -1091,7 +1182,7 @@ fpga_result __OPAE_API__ fpgaPropertiesSetNumErrors(const fpga_properties prop,
 {
 	fpga_result res = FPGA_OK;
 	int err;
-	struct _fpga_properties *p = opae_validate_and_lock_properties(prop);
+	struct _fpga_properties *p = opae_validate_and_lock_properties_rw(prop);
 
 	ASSERT_NOT_NULL(p);
 
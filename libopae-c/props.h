@@ -81,6 +81,7 @@
 struct _fpga_properties {
 	pthread_mutex_t lock;
 	uint64_t magic;
+	int frozen; // read-only, see fpgaPropertiesFreeze()
 	/* Common properties */
 	uint64_t valid_fields; // bitmap of valid fields
 	// valid here means the field has been set using the API
@@ -150,6 +151,55 @@ opae_validate_and_lock_properties(fpga_properties props)
 	return p;
 }
 
+// Like opae_validate_and_lock_properties(), but for read access:
+// a frozen object can't change, so it is returned without taking
+// its lock. *locked tells whether the lock was taken; pass it to
+// opae_unlock_properties_ro(), since the object may be frozen while
+// it is held.
+static inline struct _fpga_properties *
+opae_validate_and_lock_properties_ro(fpga_properties props, bool *locked)
+{
+	struct _fpga_properties *p = (struct _fpga_properties *)props;
+
+	*locked = false;
+
+	if (!p)
+		return NULL;
+
+	if (__atomic_load_n(&p->frozen, __ATOMIC_ACQUIRE))
+		return p->magic == FPGA_PROPERTY_MAGIC ? p : NULL;
+
+	p = opae_validate_and_lock_properties(props);
+	*locked = p != NULL;
+	return p;
+}
+
+static inline void opae_unlock_properties_ro(struct _fpga_properties *p,
+					     bool locked)
+{
+	int res;
+
+	if (locked)
+		opae_mutex_unlock(res, &p->lock);
+}
+
+// Like opae_validate_and_lock_properties(), but for write access:
+// returns NULL for a frozen object.
+static inline struct _fpga_properties *
+opae_validate_and_lock_properties_rw(fpga_properties props)
+{
+	int res;
+	struct _fpga_properties *p = opae_validate_and_lock_properties(props);
+
+	if (p && p->frozen) {
+		opae_mutex_unlock(res, &p->lock);
+		OPAE_MSG("properties are frozen");
+		return NULL;
+	}
+
+	return p;
+}
+
 struct _fpga_properties *opae_properties_create(void);
 
 #endif // ___OPAE_PROPS_H__
@@ -0,0 +1,151 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <time.h>
+
+#include <opae/types.h>
+
+// Measures what a short-lived process pays for libopae-c: the time to
+// load the library (which runs its constructor), the time to complete
+// the first fpgaEnumerate() (which performs platform detection and
+// plugin loading), and the time to unload it again.
+
+typedef fpga_result (*enumerate_t)(const fpga_properties *, uint32_t,
+				   fpga_token *, uint32_t, uint32_t *);
+
+#define DEFAULT_ITERATIONS 100
+#define DEFAULT_LIBRARY    "libopae-c.so"
+
+enum { STAGE_LOAD, STAGE_ENUM, STAGE_UNLOAD, STAGE_MAX };
+
+static const char *stage_names[STAGE_MAX] = {
+	"load", "first enumerate", "unload"
+};
+
+typedef struct _stats {
+	uint64_t min;
+	uint64_t max;
+	uint64_t total;
+} stats;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void record(stats *s, uint64_t ns)
+{
+	if (!s->min || ns < s->min)
+		s->min = ns;
+	if (ns > s->max)
+		s->max = ns;
+	s->total += ns;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *library = DEFAULT_LIBRARY;
+	unsigned long iterations = DEFAULT_ITERATIONS;
+	stats s[STAGE_MAX];
+	unsigned long i;
+	int j;
+
+	if (argc > 1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+		printf("usage: opaestartupbench [<iterations> [<library>]]\n");
+		printf("\n\tdefaults: %d iterations of %s\n",
+		       DEFAULT_ITERATIONS, DEFAULT_LIBRARY);
+		return 0;
+	}
+
+	if (argc > 1) {
+		iterations = strtoul(argv[1], NULL, 0);
+		if (!iterations) {
+			fprintf(stderr, "invalid iteration count: %s\n", argv[1]);
+			return 1;
+		}
+	}
+
+	if (argc > 2)
+		library = argv[2];
+
+	memset(s, 0, sizeof(s));
+
+	for (i = 0 ; i < iterations ; ++i) {
+		void *dl_handle;
+		enumerate_t enumerate;
+		uint32_t num_matches = 0;
+		uint64_t t0, t1;
+
+		t0 = now_ns();
+		dl_handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+		t1 = now_ns();
+
+		if (!dl_handle) {
+			fprintf(stderr, "dlopen(\"%s\") failed: %s\n",
+				library, dlerror());
+			return 1;
+		}
+		record(&s[STAGE_LOAD], t1 - t0);
+
+		enumerate = (enumerate_t)dlsym(dl_handle, "fpgaEnumerate");
+		if (!enumerate) {
+			fprintf(stderr, "fpgaEnumerate not found in %s\n",
+				library);
+			dlclose(dl_handle);
+			return 1;
+		}
+
+		t0 = now_ns();
+		enumerate(NULL, 0, NULL, 0, &num_matches);
+		t1 = now_ns();
+		record(&s[STAGE_ENUM], t1 - t0);
+
+		t0 = now_ns();
+		dlclose(dl_handle);
+		t1 = now_ns();
+		record(&s[STAGE_UNLOAD], t1 - t0);
+	}
+
+	printf("%lu iterations of %s\n", iterations, library);
+	printf("%-16s %12s %12s %12s\n", "stage", "min (us)", "avg (us)", "max (us)");
+	for (j = 0 ; j < STAGE_MAX ; ++j) {
+		printf("%-16s %12.1f %12.1f %12.1f\n",
+		       stage_names[j],
+		       s[j].min / 1000.0,
+		       s[j].total / (1000.0 * iterations),
+		       s[j].max / 1000.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,418 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <opae/cxx/core/async.h>
+#include <opae/cxx/core/except.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+namespace opae {
+namespace fpga {
+namespace types {
+
+executor::ptr_t executor::create(size_t max_workers) {
+  if (!max_workers) {
+    throw std::invalid_argument("executor needs at least one worker");
+  }
+  return executor::ptr_t(new executor(max_workers));
+}
+
+executor::ptr_t executor::get_default() {
+  static executor::ptr_t instance = executor::create();
+  return instance;
+}
+
+executor::executor(size_t max_workers)
+    : epoll_fd_(-1),
+      wake_fd_(-1),
+      timer_fd_(-1),
+      stop_(false),
+      max_workers_(max_workers),
+      idle_workers_(0) {
+  struct epoll_event ev;
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+
+  int err = 0;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 || timer_fd_ < 0) {
+    err = errno;
+  } else {
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev)) err = errno;
+    ev.data.fd = timer_fd_;
+    if (!err && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev))
+      err = errno;
+  }
+
+  if (err) {
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (timer_fd_ >= 0) close(timer_fd_);
+    throw std::system_error(err, std::system_category(), "executor");
+  }
+
+  loop_ = std::thread(&executor::run, this);
+}
+
+executor::~executor() {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    stop_ = true;
+  }
+  wake();
+  work_cv_.notify_all();
+
+  loop_.join();
+  for (auto &w : workers_) {
+    w.join();
+  }
+
+  close(timer_fd_);
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+void executor::post(std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    posted_.push_back(std::move(fn));
+  }
+  wake();
+}
+
+void executor::post_after(std::chrono::microseconds delay,
+                          std::function<void()> fn) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto it = timers_.emplace(clock_type::now() + delay, std::move(fn));
+  if (it == timers_.begin()) {
+    arm_timer();
+  }
+}
+
+void executor::watch(int fd, std::function<void()> fn) {
+  struct epoll_event ev;
+  ev.events = EPOLLIN | EPOLLONESHOT;
+  ev.data.fd = fd;
+
+  std::lock_guard<std::mutex> guard(lock_);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev)) {
+    throw std::system_error(errno, std::system_category(), "epoll_ctl");
+  }
+  // A stale entry here means fd was closed and reused while watched.
+  watches_[fd] = std::move(fn);
+}
+
+bool executor::unwatch(int fd) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto it = watches_.find(fd);
+  if (it == watches_.end()) {
+    return false;
+  }
+  watches_.erase(it);
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  return true;
+}
+
+void executor::offload(std::function<void()> fn, completion_t done) {
+  auto job = [this, fn, done]() {
+    std::exception_ptr error;
+    try {
+      fn();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    post([done, error]() { done(error); });
+  };
+
+  std::lock_guard<std::mutex> guard(lock_);
+  work_.push_back(std::move(job));
+  if (!idle_workers_ && workers_.size() < max_workers_) {
+    workers_.emplace_back(&executor::work, this);
+  }
+  work_cv_.notify_one();
+}
+
+void executor::wake() {
+  uint64_t one = 1;
+  if (write(wake_fd_, &one, sizeof(one)) < 0) {
+    // Already signaled: the counter is saturated and the loop will wake.
+  }
+}
+
+void executor::arm_timer() {
+  struct itimerspec its = {};
+
+  if (!timers_.empty()) {
+    auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        timers_.begin()->first - clock_type::now());
+    long long ns = delta.count() > 0 ? delta.count() : 1;
+    its.it_value.tv_sec = ns / 1000000000LL;
+    its.it_value.tv_nsec = ns % 1000000000LL;
+  }
+
+  timerfd_settime(timer_fd_, 0, &its, nullptr);
+}
+
+void executor::run() {
+  struct epoll_event events[16];
+  std::vector<std::function<void()>> ready;
+
+  while (true) {
+    int n = epoll_wait(epoll_fd_, events, 16, -1);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "executor: epoll_wait failed: " << strerror(errno) << "\n";
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      if (stop_) return;
+
+      for (int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        uint64_t count;
+
+        if (fd == wake_fd_ || fd == timer_fd_) {
+          if (read(fd, &count, sizeof(count)) < 0) {
+            // spurious wakeup; nothing to consume
+          }
+          continue;
+        }
+
+        auto it = watches_.find(fd);
+        if (it != watches_.end()) {
+          ready.push_back(std::move(it->second));
+          watches_.erase(it);
+          epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        }
+      }
+
+      while (!posted_.empty()) {
+        ready.push_back(std::move(posted_.front()));
+        posted_.pop_front();
+      }
+
+      auto now = clock_type::now();
+      while (!timers_.empty() && timers_.begin()->first <= now) {
+        ready.push_back(std::move(timers_.begin()->second));
+        timers_.erase(timers_.begin());
+      }
+      arm_timer();
+    }
+
+    for (auto &fn : ready) {
+      try {
+        fn();
+      } catch (std::exception &e) {
+        std::cerr << "executor: callback threw: " << e.what() << "\n";
+      } catch (...) {
+        std::cerr << "executor: callback threw\n";
+      }
+    }
+    ready.clear();
+  }
+}
+
+void executor::work() {
+  std::unique_lock<std::mutex> lk(lock_);
+  while (true) {
+    ++idle_workers_;
+    work_cv_.wait(lk, [this] { return stop_ || !work_.empty(); });
+    --idle_workers_;
+    if (stop_) return;
+
+    auto job = std::move(work_.front());
+    work_.pop_front();
+    lk.unlock();
+    job();
+    lk.lock();
+  }
+}
+
+static executor::ptr_t resolve(executor::ptr_t ex) {
+  return ex ? ex : executor::get_default();
+}
+
+static completion_t fulfill(std::shared_ptr<std::promise<void>> p) {
+  return [p](std::exception_ptr error) {
+    if (error) {
+      p->set_exception(error);
+    } else {
+      p->set_value();
+    }
+  };
+}
+
+void async_wait(event::ptr_t ev, completion_t done, executor::ptr_t ex) {
+  if (!ev) {
+    throw std::invalid_argument("event object is null");
+  }
+
+  int fd = ev->os_object();
+  resolve(ex)->watch(fd, [ev, fd, done]() {
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0) {
+      // not an eventfd, or already consumed; the wakeup still counts
+    }
+    done(nullptr);
+  });
+}
+
+std::future<void> async_wait(event::ptr_t ev, executor::ptr_t ex) {
+  auto p = std::make_shared<std::promise<void>>();
+  auto f = p->get_future();
+  async_wait(ev, fulfill(p), ex);
+  return f;
+}
+
+namespace {
+
+// One async_poll() operation. Each check re-arms a timer that owns the
+// poller, so it lives exactly as long as polling continues.
+class buffer_poll : public std::enable_shared_from_this<buffer_poll> {
+ public:
+  buffer_poll(shared_buffer::ptr_t buf, size_t offset, uint64_t mask,
+              uint64_t value, std::chrono::microseconds interval,
+              std::chrono::microseconds timeout, completion_t done,
+              executor *ex)
+      : buf_(buf),
+        word_(reinterpret_cast<volatile uint64_t *>(buf->c_type() + offset)),
+        mask_(mask),
+        value_(value),
+        interval_(interval),
+        deadline_(timeout.count()
+                      ? executor::clock_type::now() + timeout
+                      : executor::clock_type::time_point::max()),
+        done_(done),
+        ex_(ex) {}
+
+  void check() {
+    if ((*word_ & mask_) == value_) {
+      done_(nullptr);
+    } else if (executor::clock_type::now() >= deadline_) {
+      done_(std::make_exception_ptr(std::system_error(
+          std::make_error_code(std::errc::timed_out), "async_poll")));
+    } else {
+      auto self = shared_from_this();
+      ex_->post_after(interval_, [self]() { self->check(); });
+    }
+  }
+
+ private:
+  shared_buffer::ptr_t buf_;
+  volatile uint64_t *word_;
+  uint64_t mask_;
+  uint64_t value_;
+  std::chrono::microseconds interval_;
+  executor::clock_type::time_point deadline_;
+  completion_t done_;
+  executor *ex_;
+};
+
+}  // end of anonymous namespace
+
+void async_poll(shared_buffer::ptr_t buf, size_t offset, uint64_t mask,
+                uint64_t value, std::chrono::microseconds interval,
+                std::chrono::microseconds timeout, completion_t done,
+                executor::ptr_t ex) {
+  if (!buf) {
+    throw std::invalid_argument("buffer object is null");
+  }
+  if (offset + sizeof(uint64_t) > buf->size() || !buf->c_type()) {
+    throw except(OPAECXX_HERE);
+  }
+
+  ex = resolve(ex);
+  auto poll = std::make_shared<buffer_poll>(buf, offset, mask, value, interval,
+                                            timeout, done, ex.get());
+  ex->post([poll]() { poll->check(); });
+}
+
+std::future<void> async_poll(shared_buffer::ptr_t buf, size_t offset,
+                             uint64_t mask, uint64_t value,
+                             std::chrono::microseconds interval,
+                             std::chrono::microseconds timeout,
+                             executor::ptr_t ex) {
+  auto p = std::make_shared<std::promise<void>>();
+  auto f = p->get_future();
+  async_poll(buf, offset, mask, value, interval, timeout, fulfill(p), ex);
+  return f;
+}
+
+void async_reconfigure(handle::ptr_t h, uint32_t slot,
+                       std::vector<uint8_t> bitstream, int flags,
+                       completion_t done, executor::ptr_t ex) {
+  if (!h) {
+    throw std::invalid_argument("handle object is null");
+  }
+
+  auto bits = std::make_shared<std::vector<uint8_t>>(std::move(bitstream));
+  resolve(ex)->offload(
+      [h, slot, bits, flags]() {
+        h->reconfigure(slot, bits->data(), bits->size(), flags);
+      },
+      done);
+}
+
+std::future<void> async_reconfigure(handle::ptr_t h, uint32_t slot,
+                                    std::vector<uint8_t> bitstream, int flags,
+                                    executor::ptr_t ex) {
+  auto p = std::make_shared<std::promise<void>>();
+  auto f = p->get_future();
+  async_reconfigure(h, slot, std::move(bitstream), flags, fulfill(p), ex);
+  return f;
+}
+
+void async_reset(handle::ptr_t h, completion_t done, executor::ptr_t ex) {
+  if (!h) {
+    throw std::invalid_argument("handle object is null");
+  }
+
+  resolve(ex)->offload([h]() { h->reset(); }, done);
+}
+
+std::future<void> async_reset(handle::ptr_t h, executor::ptr_t ex) {
+  auto p = std::make_shared<std::promise<void>>();
+  auto f = p->get_future();
+  async_reset(h, fulfill(p), ex);
+  return f;
+}
+
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
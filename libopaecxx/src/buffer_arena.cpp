@@ -0,0 +1,113 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <opae/cxx/core/buffer_arena.h>
+#include <opae/utils.h>
+
+#include <iostream>
+
+namespace opae {
+namespace fpga {
+namespace types {
+
+namespace {
+
+// A piece of a buffer_arena. It has no handle, so that
+// shared_buffer::release() never frees the whole arena.
+class arena_buffer : public shared_buffer {
+ public:
+  arena_buffer(buffer_arena::ptr_t arena, size_t len, uint8_t *virt,
+               uint64_t io_address)
+      : shared_buffer(nullptr, len, virt, arena->wsid(), io_address),
+        arena_(arena) {}
+
+  virtual ~arena_buffer() {
+    auto res = fpgaBufferArenaFree(arena_->c_type(), virt_);
+    if (res != FPGA_OK) {
+      std::cerr << "Error while calling fpgaBufferArenaFree: "
+                << fpgaErrStr(res) << "\n";
+    }
+    virt_ = nullptr;
+  }
+
+ private:
+  buffer_arena::ptr_t arena_;
+};
+
+}  // end of anonymous namespace
+
+buffer_arena::~buffer_arena() {
+  auto res = fpgaDestroyBufferArena(&arena_);
+  if (res != FPGA_OK) {
+    std::cerr << "Error while calling fpgaDestroyBufferArena: "
+              << fpgaErrStr(res) << "\n";
+  }
+}
+
+buffer_arena::ptr_t buffer_arena::create(handle::ptr_t handle, size_t len,
+                                         bool read_only) {
+  if (!handle) {
+    throw std::invalid_argument("handle object is null");
+  }
+
+  int flags = 0;
+  if (read_only) {
+    flags |= FPGA_BUF_READ_ONLY;
+  }
+
+  fpga_buffer_arena arena = nullptr;
+  uint64_t wsid = 0;
+  ASSERT_FPGA_OK(fpgaCreateBufferArena(handle->c_type(), len, flags, &arena));
+  auto res = fpgaBufferArenaGetWSID(arena, &wsid);
+  if (res != FPGA_OK) {
+    fpgaDestroyBufferArena(&arena);
+    ASSERT_FPGA_OK(res);
+  }
+
+  return ptr_t(new buffer_arena(handle, arena, wsid));
+}
+
+shared_buffer::ptr_t buffer_arena::allocate(size_t len, size_t align) {
+  void *virt = nullptr;
+  uint64_t io_address = 0;
+  ASSERT_FPGA_OK(
+      fpgaBufferArenaAllocate(arena_, len, align, &virt, &io_address));
+
+  try {
+    return std::make_shared<arena_buffer>(
+        shared_from_this(), len, static_cast<uint8_t *>(virt), io_address);
+  } catch (...) {
+    fpgaBufferArenaFree(arena_, virt);
+    throw;
+  }
+}
+
+buffer_arena::buffer_arena(handle::ptr_t handle, fpga_buffer_arena arena,
+                           uint64_t wsid)
+    : handle_(handle), arena_(arena), wsid_(wsid) {}
+
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
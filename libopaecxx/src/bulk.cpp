@@ -0,0 +1,256 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include "bulk.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace opae {
+namespace fpga {
+namespace types {
+namespace detail {
+
+namespace {
+
+const size_t KiB = 1024;
+const size_t MiB = 1024 * KiB;
+
+// Work is split in page multiples so no two threads share a line.
+const size_t chunk_align = 4 * KiB;
+const size_t min_chunk = 1 * MiB;
+// Automatic threading starts here and gives each thread at least this.
+const size_t auto_threads_min = 64 * MiB;
+const size_t auto_chunk = 32 * MiB;
+const unsigned auto_threads_max = 16;
+// compare() polls for an early mismatch between slices this large.
+const size_t compare_slice = 1 * MiB;
+
+std::atomic<size_t> nt_threshold_override(0);
+
+size_t nt_threshold() {
+  static const size_t llc = [] {
+    long sz = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    sz = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    return sz > 0 ? static_cast<size_t>(sz) : 32 * MiB;
+  }();
+  size_t over = nt_threshold_override.load(std::memory_order_relaxed);
+  return over ? over : llc;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx512f"))) void stream_fill_avx512(uint8_t *d, int c,
+                                                            size_t n) {
+  __m512i v = _mm512_set1_epi8(static_cast<char>(c));
+  for (; n; n -= 64, d += 64) _mm512_stream_si512((__m512i *)d, v);
+}
+
+__attribute__((target("avx512f"))) void stream_copy_avx512(uint8_t *d,
+                                                            const uint8_t *s,
+                                                            size_t n) {
+  for (; n; n -= 64, d += 64, s += 64)
+    _mm512_stream_si512((__m512i *)d, _mm512_loadu_si512(s));
+}
+
+__attribute__((target("avx2"))) void stream_fill_avx2(uint8_t *d, int c,
+                                                      size_t n) {
+  __m256i v = _mm256_set1_epi8(static_cast<char>(c));
+  for (; n; n -= 32, d += 32) _mm256_stream_si256((__m256i *)d, v);
+}
+
+__attribute__((target("avx2"))) void stream_copy_avx2(uint8_t *d,
+                                                      const uint8_t *s,
+                                                      size_t n) {
+  for (; n; n -= 32, d += 32, s += 32)
+    _mm256_stream_si256((__m256i *)d,
+                        _mm256_loadu_si256((const __m256i *)s));
+}
+
+void stream_fill_sse2(uint8_t *d, int c, size_t n) {
+  __m128i v = _mm_set1_epi8(static_cast<char>(c));
+  for (; n; n -= 16, d += 16) _mm_stream_si128((__m128i *)d, v);
+}
+
+void stream_copy_sse2(uint8_t *d, const uint8_t *s, size_t n) {
+  for (; n; n -= 16, d += 16, s += 16)
+    _mm_stream_si128((__m128i *)d, _mm_loadu_si128((const __m128i *)s));
+}
+
+struct stream_kernels {
+  void (*fill)(uint8_t *, int, size_t);
+  void (*copy)(uint8_t *, const uint8_t *, size_t);
+};
+
+const stream_kernels &kernels() {
+  static const stream_kernels k = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return stream_kernels{stream_fill_avx512, stream_copy_avx512};
+    if (__builtin_cpu_supports("avx2"))
+      return stream_kernels{stream_fill_avx2, stream_copy_avx2};
+    return stream_kernels{stream_fill_sse2, stream_copy_sse2};
+  }();
+  return k;
+}
+
+// Bytes before d reaches a 64-byte boundary, and the 64-byte multiple
+// that follows. Every kernel's vector width divides 64.
+inline size_t head_bytes(const uint8_t *d, size_t n) {
+  return std::min(n, (64 - (reinterpret_cast<uintptr_t>(d) & 63)) & 63);
+}
+
+void nt_fill(uint8_t *d, int c, size_t n) {
+  size_t head = head_bytes(d, n);
+  size_t body = (n - head) & ~size_t(63);
+  memset(d, c, head);
+  kernels().fill(d + head, c, body);
+  memset(d + head + body, c, n - head - body);
+  _mm_sfence();
+}
+
+void nt_copy(uint8_t *d, const uint8_t *s, size_t n) {
+  size_t head = head_bytes(d, n);
+  size_t body = (n - head) & ~size_t(63);
+  memcpy(d, s, head);
+  kernels().copy(d + head, s + head, body);
+  memcpy(d + head + body, s + head + body, n - head - body);
+  _mm_sfence();
+}
+
+#else
+
+void nt_fill(uint8_t *d, int c, size_t n) { memset(d, c, n); }
+void nt_copy(uint8_t *d, const uint8_t *s, size_t n) { memcpy(d, s, n); }
+
+#endif  // __x86_64__
+
+unsigned thread_count(size_t len, unsigned threads) {
+  if (!threads) {
+    if (len < auto_threads_min) return 1;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(std::min(hw, auto_threads_max),
+                               len / auto_chunk);
+  }
+  return std::max<size_t>(1, std::min<size_t>(threads, len / min_chunk));
+}
+
+// Call fn(offset, size) over [0, len) split across threads, running
+// the last piece on the caller.
+void parallel_for(size_t len, unsigned threads,
+                  const std::function<void(size_t, size_t)> &fn) {
+  unsigned n = thread_count(len, threads);
+  if (n == 1) {
+    fn(0, len);
+    return;
+  }
+
+  size_t chunk = (len / n + chunk_align - 1) & ~(chunk_align - 1);
+  std::vector<std::thread> workers;
+  size_t off = 0;
+
+  for (; off + chunk < len; off += chunk) {
+    try {
+      workers.emplace_back(fn, off, chunk);
+    } catch (std::system_error &) {
+      // Out of threads: do the rest here.
+      break;
+    }
+  }
+  fn(off, len - off);
+
+  for (auto &w : workers) {
+    w.join();
+  }
+}
+
+}  // end of anonymous namespace
+
+void bulk_fill(uint8_t *dst, int c, size_t len, unsigned threads) {
+  if (len < nt_threshold()) {
+    parallel_for(len, threads,
+                 [=](size_t off, size_t n) { memset(dst + off, c, n); });
+  } else {
+    parallel_for(len, threads,
+                 [=](size_t off, size_t n) { nt_fill(dst + off, c, n); });
+  }
+}
+
+void bulk_copy(uint8_t *dst, const uint8_t *src, size_t len,
+               unsigned threads) {
+  if (len < nt_threshold()) {
+    parallel_for(len, threads, [=](size_t off, size_t n) {
+      memcpy(dst + off, src + off, n);
+    });
+  } else {
+    parallel_for(len, threads, [=](size_t off, size_t n) {
+      nt_copy(dst + off, src + off, n);
+    });
+  }
+}
+
+bool bulk_equal(const uint8_t *a, const uint8_t *b, size_t len,
+                unsigned threads) {
+  if (thread_count(len, threads) == 1) {
+    return !memcmp(a, b, len);
+  }
+
+  std::atomic<bool> differ(false);
+  parallel_for(len, threads, [&](size_t off, size_t n) {
+    while (n && !differ.load(std::memory_order_relaxed)) {
+      size_t slice = std::min(n, compare_slice);
+      if (memcmp(a + off, b + off, slice)) {
+        differ.store(true, std::memory_order_relaxed);
+      }
+      off += slice;
+      n -= slice;
+    }
+  });
+  return !differ.load();
+}
+
+size_t bulk_nt_threshold(size_t bytes) {
+  size_t prev = nt_threshold();
+  nt_threshold_override.store(bytes);
+  return prev;
+}
+
+}  // end of namespace detail
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
@@ -0,0 +1,57 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace opae {
+namespace fpga {
+namespace types {
+namespace detail {
+
+// Bulk memory kernels behind shared_buffer::fill/compare/copy.
+//
+// Buffers larger than the last-level cache are written with
+// non-temporal stores (AVX-512, AVX2 or SSE2, picked at run time) so
+// that they don't evict the working set. Smaller ones go through the C
+// library, which already dispatches on the CPU. threads == 1 runs on
+// the caller only; threads == 0 picks a count from the buffer size.
+
+void bulk_fill(uint8_t *dst, int c, size_t len, unsigned threads);
+void bulk_copy(uint8_t *dst, const uint8_t *src, size_t len,
+               unsigned threads);
+bool bulk_equal(const uint8_t *a, const uint8_t *b, size_t len,
+                unsigned threads);
+
+// Size above which stores bypass the cache. Returns the previous value;
+// 0 restores the default (the LLC size).
+size_t bulk_nt_threshold(size_t bytes);
+
+}  // end of namespace detail
+}  // end of namespace types
+}  // end of namespace fpga
+}  // end of namespace opae
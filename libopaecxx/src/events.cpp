@@ -57,7 +57,8 @@ event::ptr_t event::register_event(handle::ptr_t h, event::type_t t,
   event::ptr_t evptr;
   fpga_event_handle eh;
   ASSERT_FPGA_OK(fpgaCreateEventHandle(&eh));
-  ASSERT_FPGA_OK(fpgaRegisterEvent(*h, t, eh, flags));
+  handle::in_flight call(*h);
+  ASSERT_FPGA_OK(fpgaRegisterEvent(call.c_type(), t, eh, flags));
   evptr.reset(new event(h, t, eh));
   ASSERT_FPGA_OK(fpgaGetOSObjectFromEventHandle(eh, &evptr->os_object_));
   return evptr;
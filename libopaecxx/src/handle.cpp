@@ -35,7 +35,7 @@ namespace opae {
 namespace fpga {
 namespace types {
 
-handle::handle(fpga_handle h) : handle_(h), token_(nullptr) {}
+handle::handle(fpga_handle h) : handle_(h), token_(nullptr), busy_(0) {}
 
 handle::~handle() {
   close();
@@ -69,23 +69,38 @@ handle::ptr_t handle::open(token::ptr_t tok, int flags) {
 }
 
 fpga_result handle::close() {
-  if (handle_ != nullptr) {
-    auto res = fpgaClose(handle_);
-    ASSERT_FPGA_OK(res);
+  fpga_handle c_handle;
+  {
+    // Take handle_ away from new calls, and wait out those in flight.
+    std::unique_lock<std::mutex> g(lock_);
+    idle_.wait(g, [this] { return busy_ == 0; });
+    c_handle = handle_;
     handle_ = nullptr;
-    return FPGA_OK;
   }
 
-  return FPGA_EXCEPTION;
+  if (c_handle == nullptr) {
+    return FPGA_EXCEPTION;
+  }
+
+  auto res = fpgaClose(c_handle);
+  if (res != FPGA_OK) {
+    std::lock_guard<std::mutex> g(lock_);
+    handle_ = c_handle;
+  }
+  ASSERT_FPGA_OK(res);
+  return FPGA_OK;
 }
 
 void handle::reconfigure(uint32_t slot, const uint8_t *bitstream, size_t size,
                          int flags) {
-  ASSERT_FPGA_OK(fpgaReconfigureSlot(handle_, slot, bitstream, size, flags));
+  in_flight call(*this);
+  ASSERT_FPGA_OK(
+      fpgaReconfigureSlot(call.c_type(), slot, bitstream, size, flags));
 }
 
 void handle::reset() {
-  auto res = fpgaReset(handle_);
+  in_flight call(*this);
+  auto res = fpgaReset(call.c_type());
   ASSERT_FPGA_OK(res);
 }
 
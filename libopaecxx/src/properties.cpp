@@ -110,6 +110,14 @@ properties::ptr_t properties::get(token::ptr_t tok) {
   return get(tok->c_type());
 }
 
+fpga_properties_snapshot properties::snapshot() const {
+  fpga_properties_snapshot snap;
+  ASSERT_FPGA_OK(fpgaPropertiesGetSnapshot(props_, &snap));
+  return snap;
+}
+
+void properties::freeze() { ASSERT_FPGA_OK(fpgaPropertiesFreeze(props_)); }
+
 properties::~properties() {
   if (props_ != nullptr) {
     auto res = fpgaDestroyProperties(&props_);
@@ -25,6 +25,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 #include <opae/cxx/core/shared_buffer.h>
 
+#include "bulk.h"
+
 #include <algorithm>
 #include <cstring>
 #include <exception>
@@ -47,25 +49,75 @@ shared_buffer::ptr_t shared_buffer::allocate(handle::ptr_t handle, size_t len,
     throw except(OPAECXX_HERE);
   }
 
-  uint8_t *virt = nullptr;
-  uint64_t io_address = 0;
-  uint64_t wsid = 0;
-
   int flags = 0;
   if (read_only) {
     flags |= FPGA_BUF_READ_ONLY;
   }
 
-  fpga_result res = fpgaPrepareBuffer(
-      handle->c_type(), len, reinterpret_cast<void **>(&virt), &wsid, flags);
-  ASSERT_FPGA_OK(res);
-  res = fpgaGetIOAddress(handle->c_type(), wsid, &io_address);
+  // One call returns the IO address along with the wsid.
+  fpga_buffer_desc desc = {len, nullptr, 0, 0};
+  handle::in_flight call(*handle);
+  fpga_result res = fpgaPrepareBuffers(call.c_type(), 1, &desc, flags);
   ASSERT_FPGA_OK(res);
-  p.reset(new shared_buffer(handle, len, virt, wsid, io_address));
+  p.reset(new shared_buffer(handle, len, static_cast<uint8_t *>(desc.buf_addr),
+                            desc.wsid, desc.ioaddr));
 
   return p;
 }
 
+std::vector<shared_buffer::ptr_t> shared_buffer::allocate(
+    handle::ptr_t handle, const std::vector<size_t> &lens, bool read_only) {
+  std::vector<ptr_t> buffers;
+
+  if (!handle) {
+    throw std::invalid_argument("handle object is null");
+  }
+
+  if (lens.empty()) {
+    return buffers;
+  }
+
+  if (std::find(lens.begin(), lens.end(), 0) != lens.end()) {
+    throw except(OPAECXX_HERE);
+  }
+
+  int flags = 0;
+  if (read_only) {
+    flags |= FPGA_BUF_READ_ONLY;
+  }
+
+  std::vector<fpga_buffer_desc> descs(lens.size());
+  for (size_t i = 0; i < lens.size(); ++i) {
+    descs[i] = {lens[i], nullptr, 0, 0};
+  }
+
+  handle::in_flight call(*handle);
+  fpga_result res = fpgaPrepareBuffers(call.c_type(), descs.size(),
+                                       descs.data(), flags);
+  ASSERT_FPGA_OK(res);
+
+  // Once a buffer is owned by a shared_buffer, its destructor releases
+  // it. Release the ones not yet owned if we fail part way.
+  size_t i = 0;
+  try {
+    buffers.reserve(descs.size());
+    while (i < descs.size()) {
+      auto b = new shared_buffer(handle, lens[i],
+                                 static_cast<uint8_t *>(descs[i].buf_addr),
+                                 descs[i].wsid, descs[i].ioaddr);
+      ++i;
+      buffers.push_back(ptr_t(b));
+    }
+  } catch (...) {
+    for (; i < descs.size(); ++i) {
+      fpgaReleaseBuffer(call.c_type(), descs[i].wsid);
+    }
+    throw;
+  }
+
+  return buffers;
+}
+
 shared_buffer::ptr_t shared_buffer::attach(handle::ptr_t handle, uint8_t *base,
                                            size_t len, bool read_only) {
   ptr_t p;
@@ -79,11 +131,12 @@ shared_buffer::ptr_t shared_buffer::attach(handle::ptr_t handle, uint8_t *base,
     flags |= FPGA_BUF_READ_ONLY;
   }
 
+  handle::in_flight call(*handle);
   fpga_result res = fpgaPrepareBuffer(
-      handle->c_type(), len, reinterpret_cast<void **>(&virt), &wsid, flags);
+      call.c_type(), len, reinterpret_cast<void **>(&virt), &wsid, flags);
 
   ASSERT_FPGA_OK(res);
-  res = fpgaGetIOAddress(handle->c_type(), wsid, &io_address);
+  res = fpgaGetIOAddress(call.c_type(), wsid, &io_address);
   ASSERT_FPGA_OK(res);
   p.reset(new shared_buffer(handle, len, virt, wsid, io_address));
 
@@ -106,10 +159,33 @@ void shared_buffer::release() {
   }
 }
 
-void shared_buffer::fill(int c) { std::fill(virt_, virt_ + len_, c); }
+void shared_buffer::fill(int c) { fill(c, 1); }
+
+void shared_buffer::fill(int c, unsigned threads) {
+  detail::bulk_fill(virt_, c, len_, threads);
+}
 
 int shared_buffer::compare(shared_buffer::ptr_t other, size_t len) const {
-  return std::equal(virt_, virt_ + len, other->virt_) ? 0 : 1;
+  return compare(other, len, 1);
+}
+
+int shared_buffer::compare(shared_buffer::ptr_t other, size_t len,
+                           unsigned threads) const {
+  return detail::bulk_equal(virt_, other->virt_, len, threads) ? 0 : 1;
+}
+
+void shared_buffer::copy(shared_buffer::ptr_t other, size_t len,
+                         unsigned threads) const {
+  if (!other) {
+    throw std::invalid_argument("buffer object is null");
+  }
+  if (!len) {
+    len = len_;
+  }
+  if (len > len_ || len > other->len_) {
+    throw except(OPAECXX_HERE);
+  }
+  detail::bulk_copy(other->virt_, virt_, len, threads);
 }
 
 shared_buffer::shared_buffer(handle::ptr_t handle, size_t len, uint8_t *virt,
@@ -116,6 +116,16 @@ void sysobject::write64(uint64_t value, int flags) const {
   ASSERT_FPGA_OK(fpgaObjectWrite64(sysobject_, value, flags));
 }
 
+void sysobject::sync(int flags) const {
+  ASSERT_FPGA_OK(fpgaObjectSync(sysobject_, flags));
+}
+
+uint64_t sysobject::timestamp() const {
+  uint64_t ts = 0;
+  ASSERT_FPGA_OK(fpgaObjectGetTimestamp(sysobject_, &ts));
+  return ts;
+}
+
 std::vector<uint8_t> sysobject::bytes(int flags) const {
   uint32_t size;
   ASSERT_FPGA_OK(fpgaObjectGetSize(sysobject_, &size, flags));
@@ -44,32 +44,30 @@ std::vector<token::ptr_t> token::enumerate(
                    }
                    return p->c_type();
                  });
+  fpga_token *c_tokens = nullptr;
   uint32_t matches = 0;
-  auto res =
-      fpgaEnumerate(c_props.data(), c_props.size(), nullptr, 0, &matches);
-  if (res == FPGA_OK && matches > 0) {
-    std::vector<fpga_token> c_tokens(matches);
-    tokens.resize(matches);
-    res = fpgaEnumerate(c_props.data(), c_props.size(), c_tokens.data(),
-                        c_tokens.size(), &matches);
-
-    // throw exception (including not_found)
-    ASSERT_FPGA_OK(res);
-
-    // create a new c++ token object for each c token struct
-    std::transform(c_tokens.begin(), c_tokens.end(), tokens.begin(),
-                   [](fpga_token t) { return token::ptr_t(new token(t)); });
+  auto res = fpgaEnumerateAll(c_props.data(), c_props.size(), &c_tokens,
+                              &matches);
+  // not_found is an empty result, not an error
+  if (res == FPGA_NOT_FOUND) {
+    return tokens;
+  }
+  ASSERT_FPGA_OK(res);
 
-    // discard our c struct token objects
-    std::for_each(c_tokens.begin(), c_tokens.end(), [](fpga_token t) {
-      auto res = fpgaDestroyToken(&t);
-      ASSERT_FPGA_OK(res);
-    });
-  } else if (res != FPGA_NOT_FOUND) {
-    // throw exception except for not_found
-    // we don't want to throw not_found the frist time we enumerate
-    ASSERT_FPGA_OK(res);
+  // adopt each c token, clearing its slot so that only the
+  // ones not yet adopted are destroyed with the array
+  try {
+    tokens.reserve(matches);
+    for (uint32_t i = 0; i < matches; ++i) {
+      token *t = new token(c_tokens[i], true);
+      c_tokens[i] = nullptr;
+      tokens.push_back(token::ptr_t(t));
+    }
+  } catch (...) {
+    fpgaDestroyTokens(c_tokens, matches);
+    throw;
   }
+  fpgaDestroyTokens(c_tokens, matches);
   return tokens;
 }
 
@@ -86,6 +84,13 @@ token::token(fpga_token tok) {
   ASSERT_FPGA_OK(res);
 }
 
+token::token(fpga_token tok, bool adopt) : token_(tok) {
+  if (!adopt) {
+    auto res = fpgaCloneToken(tok, &token_);
+    ASSERT_FPGA_OK(res);
+  }
+}
+
 token::ptr_t token::get_parent() const {
   ptr_t p;
   fpga_token parent = nullptr;
@@ -0,0 +1,370 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <opae/mem_prefault.h>
+
+#define __SHORT_FILE__                                    \
+({                                                        \
+	const char *file = __FILE__;                      \
+	const char *p = file;                             \
+	while (*p)                                        \
+		++p;                                      \
+	while ((p > file) && ('/' != *p) && ('\\' != *p)) \
+		--p;                                      \
+	if (p > file)                                     \
+		++p;                                      \
+	p;                                                \
+})
+
+#define ERR(format, ...)                               \
+fprintf(stderr, "%s:%u:%s() **ERROR** [%s] : " format, \
+	__SHORT_FILE__, __LINE__, __func__, strerror(errno), ##__VA_ARGS__)
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+#define MPOL_PREFERRED_ 1
+#define MAX_NUMA_NODES 1024
+
+// Below this much memory per thread, another thread costs more to
+// start than it saves.
+#define MIN_BYTES_PER_THREAD (32UL * 1024 * 1024)
+
+#define MAX_THREADS 256
+
+struct prefault_run {
+	uint8_t *addr;
+	size_t len;
+	size_t page_size;
+	int flags;
+	int err;
+};
+
+// Set once the kernel has rejected MADV_POPULATE_*.
+static int populate_unsupported;
+
+static int touch_pages(struct prefault_run *r)
+{
+	uint8_t *p;
+
+	for (p = r->addr ; p < r->addr + r->len ; p += r->page_size) {
+		if (r->flags & MEM_PREFAULT_READ)
+			(void)*(volatile uint8_t *)p;
+		else // one write fault, contents unchanged
+			__atomic_fetch_add(p, 0, __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+static void *prefault_worker(void *arg)
+{
+	struct prefault_run *r = (struct prefault_run *)arg;
+	int advice;
+
+	if (r->flags & MEM_PREFAULT_ZERO) {
+		memset(r->addr, 0, r->len);
+		return NULL;
+	}
+
+	if (__atomic_load_n(&populate_unsupported, __ATOMIC_RELAXED)) {
+		r->err = touch_pages(r);
+		return NULL;
+	}
+
+	advice = (r->flags & MEM_PREFAULT_READ) ?
+		MADV_POPULATE_READ : MADV_POPULATE_WRITE;
+
+	if (madvise(r->addr, r->len, advice)) {
+		if (errno == EINVAL) {
+			// Kernels before 5.14 don't know the advice.
+			__atomic_store_n(&populate_unsupported, 1,
+					 __ATOMIC_RELAXED);
+			r->err = touch_pages(r);
+		} else {
+			r->err = errno;
+		}
+	}
+
+	return NULL;
+}
+
+// Parse a sysfs cpulist such as "0-3,8-11" into set.
+static int parse_cpulist(const char *s, cpu_set_t *set)
+{
+	char *end;
+	long first;
+	long last;
+
+	CPU_ZERO(set);
+
+	while (*s && *s != '\n') {
+		first = strtol(s, &end, 10);
+		if (end == s || first < 0)
+			return 1;
+		last = first;
+		s = end;
+		if (*s == '-') {
+			last = strtol(s + 1, &end, 10);
+			if (end == s + 1 || last < first)
+				return 1;
+			s = end;
+		}
+		for ( ; first <= last && first < CPU_SETSIZE ; ++first)
+			CPU_SET(first, set);
+		if (*s == ',')
+			++s;
+	}
+
+	return 0;
+}
+
+// The CPUs this process may use on numa_node, or all of them when
+// the node is unknown or has none.
+static void node_cpus(int numa_node, cpu_set_t *cpus)
+{
+	cpu_set_t allowed;
+	cpu_set_t node;
+	char path[PATH_MAX];
+	char list[4096];
+	FILE *fp;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed)) {
+		CPU_ZERO(&allowed);
+		CPU_SET(0, &allowed);
+	}
+
+	*cpus = allowed;
+
+	if (numa_node < 0)
+		return;
+
+	snprintf(path, sizeof(path),
+		 "/sys/devices/system/node/node%d/cpulist", numa_node);
+	fp = fopen(path, "r");
+	if (!fp)
+		return;
+
+	if (fgets(list, sizeof(list), fp) && !parse_cpulist(list, &node)) {
+		CPU_AND(&node, &node, &allowed);
+		if (CPU_COUNT(&node))
+			*cpus = node;
+	}
+
+	fclose(fp);
+}
+
+static void prefer_node(void *addr, size_t len, int numa_node)
+{
+#ifdef SYS_mbind
+	unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+	const size_t bits = 8 * sizeof(unsigned long);
+
+	if (numa_node < 0 || numa_node >= MAX_NUMA_NODES)
+		return;
+
+	memset(mask, 0, sizeof(mask));
+	mask[numa_node / bits] = 1UL << (numa_node % bits);
+
+	// Best effort: placement is an optimization, and mbind is
+	// commonly filtered in containers.
+	syscall(SYS_mbind, addr, len, MPOL_PREFERRED_,
+		mask, MAX_NUMA_NODES, 0);
+#else
+	(void)addr;
+	(void)len;
+	(void)numa_node;
+#endif // SYS_mbind
+}
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+int mem_prefault(void *addr,
+		 size_t len,
+		 size_t page_size,
+		 struct mem_prefault *p)
+{
+	struct prefault_run runs[MAX_THREADS];
+	pthread_t tids[MAX_THREADS];
+	uint8_t started[MAX_THREADS];
+	pthread_attr_t attr;
+	int have_attr;
+	cpu_set_t cpus;
+	uint64_t start;
+	size_t pages;
+	size_t first;
+	uint32_t threads;
+	uint32_t i;
+	int res = 0;
+
+	if (!addr || !p) {
+		errno = EINVAL;
+		ERR("NULL param\n");
+		return 1;
+	}
+
+	if (!page_size)
+		page_size = (size_t)sysconf(_SC_PAGE_SIZE);
+
+	if (((uint64_t)addr & (page_size - 1)) || (page_size & (page_size - 1))) {
+		errno = EINVAL;
+		ERR("%p is not aligned to page size 0x%lx\n", addr, page_size);
+		return 2;
+	}
+
+	start = now_nsec();
+
+	pages = (len + page_size - 1) / page_size;
+	if (!pages) {
+		p->threads = 0;
+		p->nsec = 0;
+		return 0;
+	}
+
+	node_cpus(p->numa_node, &cpus);
+
+	threads = p->threads;
+	if (!threads) {
+		threads = CPU_COUNT(&cpus);
+		if (threads > len / MIN_BYTES_PER_THREAD)
+			threads = len / MIN_BYTES_PER_THREAD;
+	}
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+	if (threads > pages)
+		threads = pages;
+	if (!threads)
+		threads = 1;
+
+	prefer_node(addr, pages * page_size, p->numa_node);
+
+	have_attr = !pthread_attr_init(&attr);
+	if (have_attr && p->numa_node >= 0)
+		pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
+	// Thread i faults pages [first, first + pages / threads), with
+	// the remainder spread over the first runs.
+	for (i = 0, first = 0 ; i < threads ; ++i) {
+		size_t count = pages / threads + (i < pages % threads);
+		size_t end = (first + count) * page_size;
+
+		runs[i].addr = (uint8_t *)addr + first * page_size;
+		runs[i].len = (end > len ? len : end) - first * page_size;
+		runs[i].page_size = page_size;
+		runs[i].flags = p->flags;
+		runs[i].err = 0;
+		first += count;
+
+		// The calling thread takes run 0.
+		started[i] = i && have_attr &&
+			!pthread_create(&tids[i], &attr,
+					prefault_worker, &runs[i]);
+	}
+
+	if (have_attr)
+		pthread_attr_destroy(&attr);
+
+	for (i = 0 ; i < threads ; ++i) {
+		if (!started[i])
+			prefault_worker(&runs[i]);
+	}
+
+	for (i = 0 ; i < threads ; ++i) {
+		if (started[i])
+			pthread_join(tids[i], NULL);
+		if (runs[i].err && !res) {
+			errno = runs[i].err;
+			ERR("prefault of %p/0x%lx failed\n",
+			    runs[i].addr, runs[i].len);
+			res = 3;
+		}
+	}
+
+	p->threads = threads;
+	p->nsec = now_nsec() - start;
+
+	return res;
+}
+
+int mem_prefault_numa_node(const char *sysfs_path)
+{
+	char path[PATH_MAX];
+	char attr[PATH_MAX + 16];
+	char *slash;
+	FILE *fp;
+	int node = -1;
+
+	if (!sysfs_path || !realpath(sysfs_path, path))
+		return -1;
+
+	while (path[0]) {
+		snprintf(attr, sizeof(attr), "%s/numa_node", path);
+		fp = fopen(attr, "r");
+		if (fp) {
+			if (fscanf(fp, "%d", &node) != 1)
+				node = -1;
+			fclose(fp);
+			break;
+		}
+
+		slash = strrchr(path, '/');
+		if (!slash)
+			break;
+		*slash = '\0';
+	}
+
+	return node < 0 ? -1 : node;
+}
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <sys/mman.h>
 #include <regex.h>
 #include <linux/pci_regs.h>
@@ -469,12 +470,25 @@ STATIC void opae_vfio_destroy_iova_range(struct opae_vfio_iova_range *r)
 STATIC void
 opae_vfio_destroy_buffer(struct opae_vfio *, struct opae_vfio_buffer *);
 
+/*
+ * The device that owns the container (and so its IOVA space and DMA
+ * buffers) that v is attached to.
+ */
+STATIC struct opae_vfio *opae_vfio_cont(struct opae_vfio *v)
+{
+	return v->cont_owner ? v->cont_owner : v;
+}
+
 STATIC void opae_vfio_destroy(struct opae_vfio *v)
 {
 	// destroy buffers before we close any FDs
 	opae_vfio_destroy_buffer(v, v->cont_buffers);
 	v->cont_buffers = NULL;
 
+	if (v->cont_users)
+		ERR("%u device(s) still attached to the container\n",
+		    v->cont_users);
+
 	opae_vfio_device_destroy(&v->device);
 	opae_vfio_group_destroy(&v->group);
 	opae_vfio_destroy_iova_range(v->cont_ranges);
@@ -487,6 +501,17 @@ STATIC void opae_vfio_destroy(struct opae_vfio *v)
 		v->cont_fd = -1;
 	}
 
+	if (v->cont_owner) {
+		if (pthread_mutex_lock(&v->cont_owner->lock)) {
+			ERR("pthread_mutex_lock() failed\n");
+		} else {
+			--v->cont_owner->cont_users;
+			if (pthread_mutex_unlock(&v->cont_owner->lock))
+				ERR("pthread_mutex_unlock() failed\n");
+		}
+		v->cont_owner = NULL;
+	}
+
 	if (v->cont_device) {
 		free(v->cont_device);
 		v->cont_device = NULL;
@@ -605,10 +630,59 @@ STATIC int opae_vfio_iova_reserve(struct opae_vfio *v,
 			     *size);
 }
 
+#define SIZE_2M (2UL * 1024 * 1024)
+#define SIZE_1G (1024UL * 1024 * 1024)
+#define ROUND_UP(__n, __m) (((__n) + (__m) - 1) & ~((__m) - 1))
+
+STATIC int opae_vfio_dma_map(struct opae_vfio *v,
+			     uint8_t *vaddr,
+			     uint64_t iova,
+			     size_t size,
+			     int flags)
+{
+	struct vfio_iommu_type1_dma_map dma_map;
+
+	memset(&dma_map, 0, sizeof(dma_map));
+
+	dma_map.argsz = sizeof(dma_map);
+	dma_map.vaddr = (uint64_t) vaddr;
+	dma_map.size = size;
+	dma_map.iova = iova;
+	dma_map.flags = VFIO_DMA_MAP_FLAG_READ;
+	if (!(flags & OPAE_VFIO_BUF_READ_ONLY))
+		dma_map.flags |= VFIO_DMA_MAP_FLAG_WRITE;
+
+	if (ioctl(v->cont_fd, VFIO_IOMMU_MAP_DMA, &dma_map) < 0) {
+		if (!(flags & OPAE_VFIO_BUF_QUIET))
+			ERR("ioctl(%d, VFIO_IOMMU_MAP_DMA, &dma_map)\n",
+			    v->cont_fd);
+		return 1;
+	}
+
+	return 0;
+}
+
+STATIC void opae_vfio_dma_unmap(struct opae_vfio *v,
+				uint64_t iova,
+				size_t size)
+{
+	struct vfio_iommu_type1_dma_unmap dma_unmap;
+
+	memset(&dma_unmap, 0, sizeof(dma_unmap));
+	dma_unmap.argsz = sizeof(dma_unmap);
+	dma_unmap.iova = iova;
+	dma_unmap.size = size;
+
+	if (ioctl(v->cont_fd, VFIO_IOMMU_UNMAP_DMA, &dma_unmap) < 0)
+		ERR("ioctl(%d, VFIO_IOMMU_UNMAP_DMA, &dma_unmap)\n",
+		    v->cont_fd);
+}
+
 STATIC struct opae_vfio_buffer *
 opae_vfio_create_buffer(uint8_t *vaddr,
 			size_t size,
-			uint64_t iova)
+			uint64_t iova,
+			int flags)
 {
 	struct opae_vfio_buffer *b;
 	b = malloc(sizeof(*b));
@@ -616,6 +690,7 @@ opae_vfio_create_buffer(uint8_t *vaddr,
 		b->buffer_ptr = vaddr;
 		b->buffer_size = size;
 		b->buffer_iova = iova;
+		b->flags = flags;
 		b->next = NULL;
 	}
 	return b;
@@ -625,22 +700,19 @@ STATIC void
 opae_vfio_destroy_buffer(struct opae_vfio *v,
 			 struct opae_vfio_buffer *b)
 {
-	struct vfio_iommu_type1_dma_unmap dma_unmap;
-
 	while (b) {
 		struct opae_vfio_buffer *trash = b;
 		b = b->next;
 
-		memset(&dma_unmap, 0, sizeof(dma_unmap));
-		dma_unmap.argsz = sizeof(dma_unmap);
-		dma_unmap.iova = trash->buffer_iova;
-		dma_unmap.size = trash->buffer_size;
+		// A composed buffer is covered by several DMA mappings,
+		// all of which lie wholly inside its IOVA window, so a
+		// single unmap of the window releases them all.
+		opae_vfio_dma_unmap(v, trash->buffer_iova,
+				    trash->buffer_size);
 
-		if (ioctl(v->cont_fd, VFIO_IOMMU_UNMAP_DMA, &dma_unmap) < 0)
-			ERR("ioctl(%d, VFIO_IOMMU_UNMAP_DMA, &dma_unmap)\n",
-			    v->cont_fd);
-
-		if (munmap(trash->buffer_ptr, trash->buffer_size) < 0)
+		// Registered user memory belongs to the caller.
+		if (!(trash->flags & OPAE_VFIO_BUF_PREALLOCATED) &&
+		    munmap(trash->buffer_ptr, trash->buffer_size) < 0)
 			ERR("munmap(%p, %lu) failed\n",
 			    trash->buffer_ptr, trash->buffer_size);
 
@@ -672,17 +744,222 @@ opae_vfio_destroy_buffer(struct opae_vfio *v,
 #define FLAGS_1G (FLAGS_4K|MAP_1G_HUGEPAGE|MAP_HUGETLB)
 #endif
 
+/*
+ * Build a buffer of size bytes (a multiple of 2MB) from individual
+ * huge pages placed back-to-back in one virtual address window, and
+ * map each page into the IOVA window starting at iova. 1GB pages are
+ * used for each 1GB-aligned run while they are available; the rest
+ * of the buffer is made of 2MB pages. Because the IOVA window is
+ * contiguous, the device sees a single buffer. When p is not NULL,
+ * the whole buffer is prefaulted before any of it is mapped.
+ *
+ * Returns the virtual address of the buffer, or MAP_FAILED.
+ */
+STATIC uint8_t *opae_vfio_compose_buffer(struct opae_vfio *v,
+					 size_t size,
+					 uint64_t iova,
+					 int flags,
+					 struct mem_prefault *p)
+{
+	size_t align = size >= SIZE_1G ? SIZE_1G : SIZE_2M;
+	int use_1g = size >= SIZE_1G;
+	uint8_t *window;
+	uint8_t *base;
+	size_t head;
+	size_t tail;
+	size_t offset = 0;
+	size_t split;
+	size_t mapped = 0;
+
+	// Reserve (but don't populate) enough address space to place
+	// the buffer at an address aligned for its largest page size.
+	window = mmap(ADDR, size + align, PROT_NONE,
+		      FLAGS_4K|MAP_NORESERVE, -1, 0);
+	if (window == MAP_FAILED) {
+		ERR("mmap() failed\n");
+		return MAP_FAILED;
+	}
+
+	base = (uint8_t *)ROUND_UP((uint64_t)window, align);
+	head = base - window;
+	tail = align - head;
+
+	if (head && munmap(window, head) < 0)
+		ERR("munmap(%p, %lu) failed\n", window, head);
+	if (tail && munmap(base + size, tail) < 0)
+		ERR("munmap(%p, %lu) failed\n", base + size, tail);
+
+	// The buffer is 1GB pages up to split and 2MB pages after it.
+	split = size;
+	while (offset < size) {
+		uint8_t *vaddr = MAP_FAILED;
+		size_t page = SIZE_2M;
+
+		if (use_1g &&
+		    (size - offset >= SIZE_1G) &&
+		    !((uint64_t)(base + offset) & (SIZE_1G - 1))) {
+			vaddr = mmap(base + offset, SIZE_1G,
+				     PROT_READ|PROT_WRITE,
+				     FLAGS_1G|MAP_FIXED, -1, 0);
+			if (vaddr == MAP_FAILED)
+				use_1g = 0; // pool exhausted, use 2MB pages.
+			else
+				page = SIZE_1G;
+		}
+
+		if (vaddr == MAP_FAILED) {
+			if (split == size)
+				split = offset;
+			vaddr = mmap(base + offset, SIZE_2M,
+				     PROT_READ|PROT_WRITE,
+				     FLAGS_2M|MAP_FIXED, -1, 0);
+			if (vaddr == MAP_FAILED) {
+				ERR("mmap() failed\n");
+				goto out_unmap;
+			}
+		}
+
+		offset += page;
+	}
+
+	if (p && mem_prefault(base, size,
+			       split == size ? SIZE_1G : SIZE_2M, p))
+		goto out_unmap;
+
+	while (mapped < size) {
+		size_t page = mapped < split ? SIZE_1G : SIZE_2M;
+
+		if (opae_vfio_dma_map(v, base + mapped, iova + mapped,
+				      page, flags))
+			goto out_unmap;
+
+		mapped += page;
+	}
+
+	return base;
+
+out_unmap:
+	if (mapped)
+		opae_vfio_dma_unmap(v, iova, mapped);
+	if (munmap(base, size) < 0)
+		ERR("munmap(%p, %lu) failed\n", base, size);
+	return MAP_FAILED;
+}
+
+STATIC struct opae_vfio_buffer *
+opae_vfio_find_overlap(struct opae_vfio *v, uint8_t *buf, size_t size)
+{
+	struct opae_vfio_buffer *b;
+
+	for (b = v->cont_buffers ; b ; b = b->next) {
+		if ((buf < b->buffer_ptr + b->buffer_size) &&
+		    (b->buffer_ptr < buf + size))
+			return b;
+	}
+
+	return NULL;
+}
+
+STATIC int opae_vfio_buffer_register(struct opae_vfio *v,
+				     size_t size,
+				     uint8_t *buf,
+				     uint64_t *iova,
+				     int flags)
+{
+	uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+	uint64_t ioaddr = 0;
+	uint64_t rsize = size;
+	struct opae_vfio_buffer *node;
+
+	if (!buf) {
+		ERR("NULL buffer\n");
+		return 2;
+	}
+
+	if (((uint64_t)buf & (page_size - 1)) || (size & (page_size - 1))) {
+		ERR("buffer %p/0x%lx is not page-aligned\n", buf, size);
+		return 2;
+	}
+
+	if (pthread_mutex_lock(&v->lock)) {
+		ERR("pthread_mutex_lock() failed\n");
+		return 3;
+	}
+
+	// The buffer list is keyed by virtual address, so a range
+	// may be registered only once.
+	if (opae_vfio_find_overlap(v, buf, size)) {
+		if (!(flags & OPAE_VFIO_BUF_QUIET))
+			ERR("%p/0x%lx overlaps a mapped buffer\n",
+			    buf, size);
+		pthread_mutex_unlock(&v->lock);
+		return 7;
+	}
+
+	if (opae_vfio_iova_reserve(v, &rsize, &ioaddr)) {
+		pthread_mutex_unlock(&v->lock);
+		return 4;
+	}
+
+	if (opae_vfio_dma_map(v, buf, ioaddr, size, flags))
+		goto out_put_iova;
+
+	node = opae_vfio_create_buffer(buf, size, ioaddr, flags);
+	if (!node) {
+		ERR("malloc failed\n");
+		opae_vfio_dma_unmap(v, ioaddr, size);
+		goto out_put_iova;
+	}
+
+	node->next = v->cont_buffers;
+	v->cont_buffers = node;
+
+	if (iova)
+		*iova = ioaddr;
+
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
+
+	return 0;
+
+out_put_iova:
+	if (mem_alloc_put(&v->iova_alloc, ioaddr))
+		ERR("mem_alloc_put(..., 0x%lx) failed\n", ioaddr);
+	if (pthread_mutex_unlock(&v->lock))
+		ERR("pthread_mutex_unlock() failed\n");
+	return 5;
+}
+
 int opae_vfio_buffer_allocate(struct opae_vfio *v,
 			      size_t *size,
 			      uint8_t **buf,
 			      uint64_t *iova)
+{
+	return opae_vfio_buffer_allocate_ex(v, size, buf, iova, 0);
+}
+
+int opae_vfio_buffer_allocate_ex(struct opae_vfio *v,
+				 size_t *size,
+				 uint8_t **buf,
+				 uint64_t *iova,
+				 int flags)
+{
+	return opae_vfio_buffer_allocate_prefault(v, size, buf, iova,
+						  flags, NULL);
+}
+
+int opae_vfio_buffer_allocate_prefault(struct opae_vfio *v,
+				       size_t *size,
+				       uint8_t **buf,
+				       uint64_t *iova,
+				       int flags,
+				       struct mem_prefault *p)
 {
 	int res = 0;
 	uint64_t ioaddr = 0;
 	uint8_t *vaddr;
-	struct vfio_iommu_type1_dma_map dma_map;
-	struct vfio_iommu_type1_dma_unmap dma_unmap;
 	struct opae_vfio_buffer *node;
+	char path[PATH_MAX];
 
 	if (!v || !size) {
 		ERR("NULL param\n");
@@ -694,6 +971,31 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 		return 2;
 	}
 
+	// Place the pages next to this device, rather than the one
+	// that owns the container.
+	if (p && p->numa_node < 0 && v->cont_pciaddr) {
+		snprintf(path, sizeof(path),
+			 "/sys/bus/pci/devices/%s", v->cont_pciaddr);
+		p->numa_node = mem_prefault_numa_node(path);
+	}
+
+	// Buffers belong to the container, so that they are visible
+	// to every device attached to it.
+	v = opae_vfio_cont(v);
+
+	if (flags & OPAE_VFIO_BUF_PREALLOCATED) {
+		if (!buf) {
+			ERR("NULL param\n");
+			return 1;
+		}
+		if (p && mem_prefault(*buf, *size, 0, p))
+			return 5;
+		return opae_vfio_buffer_register(v, *size, *buf, iova, flags);
+	}
+
+	if (*size > 4096)
+		*size = ROUND_UP(*size, SIZE_2M);
+
 	if (pthread_mutex_lock(&v->lock)) {
 		ERR("pthread_mutex_lock() failed\n");
 		return 3;
@@ -704,38 +1006,34 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 		return 4;
 	}
 
-	if (*size > (2 * 1024 * 1024))
-		vaddr = mmap(ADDR, *size, PROT_READ|PROT_WRITE,
-			     FLAGS_1G, 0, 0);
-	else if (*size > 4096)
-		vaddr = mmap(ADDR, *size, PROT_READ|PROT_WRITE,
-			     FLAGS_2M, 0, 0);
-	else
+	if (*size > SIZE_2M) {
+		vaddr = opae_vfio_compose_buffer(v, *size, ioaddr, flags, p);
+		if (vaddr == MAP_FAILED) {
+			res = 5;
+			goto out_put_iova;
+		}
+	} else {
 		vaddr = mmap(ADDR, *size, PROT_READ|PROT_WRITE,
-			     FLAGS_4K, 0, 0);
-
-	if (vaddr == MAP_FAILED) {
-		ERR("mmap() failed\n");
-		pthread_mutex_unlock(&v->lock);
-		return 5;
-	}
-
-	memset(&dma_map, 0, sizeof(dma_map));
+			     *size > 4096 ? FLAGS_2M : FLAGS_4K, -1, 0);
+		if (vaddr == MAP_FAILED) {
+			ERR("mmap() failed\n");
+			res = 5;
+			goto out_put_iova;
+		}
 
-	dma_map.argsz = sizeof(dma_map);
-	dma_map.vaddr = (uint64_t) vaddr;
-	dma_map.size = *size;
-	dma_map.iova = ioaddr;
-	dma_map.flags = VFIO_DMA_MAP_FLAG_READ|VFIO_DMA_MAP_FLAG_WRITE;
+		if (p && mem_prefault(vaddr, *size,
+				      *size > 4096 ? SIZE_2M : 0, p)) {
+			res = 5;
+			goto out_munmap;
+		}
 
-	if (ioctl(v->cont_fd, VFIO_IOMMU_MAP_DMA, &dma_map) < 0) {
-		ERR("ioctl(%d, VFIO_IOMMU_MAP_DMA, &dma_map)\n",
-		    v->cont_fd);
-		res = 5;
-		goto out_munmap;
+		if (opae_vfio_dma_map(v, vaddr, ioaddr, *size, flags)) {
+			res = 5;
+			goto out_munmap;
+		}
 	}
 
-	node = opae_vfio_create_buffer(vaddr, *size, ioaddr);
+	node = opae_vfio_create_buffer(vaddr, *size, ioaddr, flags);
 	if (!node) {
 		ERR("malloc failed\n");
 		res = 6;
@@ -756,13 +1054,12 @@ int opae_vfio_buffer_allocate(struct opae_vfio *v,
 	return 0;
 
 out_unmap_ioctl:
-	memset(&dma_unmap, 0, sizeof(dma_unmap));
-	dma_unmap.argsz = sizeof(dma_unmap);
-	dma_unmap.iova = ioaddr;
-	dma_unmap.size = *size;
-	ioctl(v->cont_fd, VFIO_IOMMU_UNMAP_DMA, &dma_unmap);
+	opae_vfio_dma_unmap(v, ioaddr, *size);
 out_munmap:
 	munmap(vaddr, *size);
+out_put_iova:
+	if (mem_alloc_put(&v->iova_alloc, ioaddr))
+		ERR("mem_alloc_put(..., 0x%lx) failed\n", ioaddr);
 	if (pthread_mutex_unlock(&v->lock))
 		ERR("pthread_mutex_unlock() failed\n");
 	return res;
@@ -780,6 +1077,8 @@ int opae_vfio_buffer_free(struct opae_vfio *v,
 		return 1;
 	}
 
+	v = opae_vfio_cont(v);
+
 	if (pthread_mutex_lock(&v->lock)) {
 		ERR("pthread_mutex_lock() failed\n");
 		return 2;
@@ -807,10 +1106,12 @@ out_unlock:
 	return res;
 }
 
-int opae_vfio_irq_enable(struct opae_vfio *v,
-			 uint32_t index,
-			 uint32_t subindex,
-			 int event_fd)
+STATIC int opae_vfio_irq_set_eventfds(struct opae_vfio *v,
+				      uint32_t index,
+				      uint32_t start,
+				      uint32_t count,
+				      const int *event_fds,
+				      const char *what)
 {
 	struct opae_vfio_device_irq *irq;
 
@@ -823,34 +1124,44 @@ int opae_vfio_irq_enable(struct opae_vfio *v,
 		if ((irq->index == index) &&
 		    (irq->flags & VFIO_IRQ_INFO_EVENTFD)) {
 			struct vfio_irq_set *i;
-			char buf[sizeof(*i) + sizeof(int32_t)];
+			size_t sz = sizeof(*i) + count * sizeof(int32_t);
 			int32_t *fdptr;
+			uint32_t n;
 			int res = 3;
 
-			i = (struct vfio_irq_set *)buf;
-			i->argsz = sizeof(buf);
+			if (!count || (start >= irq->count) ||
+			    (count > irq->count - start)) {
+				ERR("range %u+%u is out of range 0-%u\n",
+				    start, count, irq->count - 1);
+				return res;
+			}
+
+			i = malloc(sz);
+			if (!i) {
+				ERR("malloc() failed\n");
+				return 4;
+			}
+
+			i->argsz = sz;
 			i->flags = VFIO_IRQ_SET_DATA_EVENTFD |
 				   VFIO_IRQ_SET_ACTION_TRIGGER;
 			i->index = index;
-			i->start = subindex;
-			i->count = 1;
+			i->start = start;
+			i->count = count;
 
 			fdptr = (int32_t *)&i->data;
-			*fdptr = event_fd;
+			for (n = 0 ; n < count ; ++n)
+				fdptr[n] = event_fds ? event_fds[n] : -1;
 
-			if (subindex < irq->count) {
-				res = ioctl(v->device.device_fd,
-					    VFIO_DEVICE_SET_IRQS,
-					    i);
+			res = ioctl(v->device.device_fd,
+				    VFIO_DEVICE_SET_IRQS,
+				    i);
 
-				if (res < 0)
-					ERR("ioctl(fd, VFIO_DEVICE_SET_IRQS, i)"
-					    " [enable]\n");
-			} else {
-				ERR("subindex %u is out of range 0-%u\n",
-				    subindex, irq->count - 1);
-			}
+			if (res < 0)
+				ERR("ioctl(fd, VFIO_DEVICE_SET_IRQS, i)"
+				    " [%s]\n", what);
 
+			free(i);
 			return res;
 		}
 	}
@@ -858,6 +1169,30 @@ int opae_vfio_irq_enable(struct opae_vfio *v,
 	return 2;
 }
 
+int opae_vfio_irq_enable(struct opae_vfio *v,
+			 uint32_t index,
+			 uint32_t subindex,
+			 int event_fd)
+{
+	return opae_vfio_irq_set_eventfds(v, index, subindex, 1,
+					  &event_fd, "enable");
+}
+
+int opae_vfio_irq_enable_range(struct opae_vfio *v,
+			       uint32_t index,
+			       uint32_t start,
+			       uint32_t count,
+			       const int *event_fds)
+{
+	if (!event_fds) {
+		ERR("NULL param\n");
+		return 1;
+	}
+
+	return opae_vfio_irq_set_eventfds(v, index, start, count,
+					  event_fds, "enable");
+}
+
 int opae_vfio_irq_unmask(struct opae_vfio *v,
 			 uint32_t index,
 			 uint32_t subindex)
@@ -950,50 +1285,17 @@ int opae_vfio_irq_disable(struct opae_vfio *v,
 			  uint32_t index,
 			  uint32_t subindex)
 {
-	struct opae_vfio_device_irq *irq;
-
-	if (!v) {
-		ERR("NULL param\n");
-		return 1;
-	}
-
-	for (irq = v->device.irqs ; irq ; irq = irq->next) {
-		if ((irq->index == index) &&
-		    (irq->flags & VFIO_IRQ_INFO_EVENTFD)) {
-			struct vfio_irq_set *i;
-			char buf[sizeof(*i) + sizeof(int32_t)];
-			int32_t *fdptr;
-			int res = 3;
-
-			i = (struct vfio_irq_set *)buf;
-			i->argsz = sizeof(buf);
-			i->flags = VFIO_IRQ_SET_DATA_EVENTFD |
-				   VFIO_IRQ_SET_ACTION_TRIGGER;
-			i->index = index;
-			i->start = subindex;
-			i->count = 1;
-
-			fdptr = (int32_t *)&i->data;
-			*fdptr = -1;
-
-			if (subindex < irq->count) {
-				res = ioctl(v->device.device_fd,
-					    VFIO_DEVICE_SET_IRQS,
-					    i);
-
-				if (res < 0)
-					ERR("ioctl(fd, VFIO_DEVICE_SET_IRQS, i)"
-					    " [disable]\n");
-			} else {
-				ERR("subindex %u is out of range 0-%u\n",
-				    subindex, irq->count - 1);
-			}
-
-			return res;
-		}
-	}
+	return opae_vfio_irq_set_eventfds(v, index, subindex, 1,
+					  NULL, "disable");
+}
 
-	return 2;
+int opae_vfio_irq_disable_range(struct opae_vfio *v,
+				uint32_t index,
+				uint32_t start,
+				uint32_t count)
+{
+	return opae_vfio_irq_set_eventfds(v, index, start, count,
+					  NULL, "disable");
 }
 
 STATIC char *opae_vfio_group_for(const char *pciaddr)
@@ -1022,7 +1324,8 @@ STATIC char *opae_vfio_group_for(const char *pciaddr)
 
 STATIC int opae_vfio_init(struct opae_vfio *v,
 			  const char *pciaddr,
-			  const char *token)
+			  const char *token,
+			  struct opae_vfio *owner)
 {
 	int res = 0;
 	pthread_mutexattr_t mattr;
@@ -1054,6 +1357,65 @@ STATIC int opae_vfio_init(struct opae_vfio *v,
 
 	v->cont_device = strdup("/dev/vfio/vfio");
 	v->cont_pciaddr = strdup(pciaddr);
+
+	if (owner) {
+		owner = opae_vfio_cont(owner);
+		if (pthread_mutex_lock(&owner->lock)) {
+			ERR("pthread_mutex_lock() failed\n");
+			res = 4;
+			goto out_destroy_container;
+		}
+
+		// Our own descriptor for the owner's container, so that
+		// teardown is the same for owners and attached devices.
+		v->cont_fd = dup(owner->cont_fd);
+		if (v->cont_fd < 0) {
+			ERR("dup(%d)\n", owner->cont_fd);
+			pthread_mutex_unlock(&owner->lock);
+			res = 4;
+			goto out_destroy_container;
+		}
+
+		res = opae_vfio_group_init(&v->group,
+					   opae_vfio_group_for(pciaddr));
+		if (res) {
+			pthread_mutex_unlock(&owner->lock);
+			goto out_destroy_container;
+		}
+
+		// The IOMMU model was set when the owner's group was
+		// added. This fails if the group can't share its domain.
+		cont_fd = v->cont_fd;
+		if (ioctl(v->group.group_fd,
+			  VFIO_GROUP_SET_CONTAINER, &cont_fd)) {
+			ERR("ioctl(%d, VFIO_GROUP_SET_CONTAINER, &cont_fd)\n",
+			    v->group.group_fd);
+			pthread_mutex_unlock(&owner->lock);
+			res = 7;
+			goto out_destroy_container;
+		}
+
+		v->cont_owner = owner;
+		++owner->cont_users;
+
+		if (pthread_mutex_unlock(&owner->lock))
+			ERR("pthread_mutex_unlock() failed\n");
+
+		res = opae_vfio_device_init(&v->device,
+					    v->group.group_fd,
+					    pciaddr,
+					    token);
+		if (res)
+			goto out_destroy_container;
+
+		if (pthread_mutexattr_destroy(&mattr)) {
+			ERR("pthread_mutexattr_destroy()\n");
+			return 9;
+		}
+
+		return 0;
+	}
+
 	v->cont_fd = open(v->cont_device, O_RDWR);
 	if (v->cont_fd < 0) {
 		ERR("open(\"%s\")\n", v->cont_device);
@@ -1130,7 +1492,7 @@ int opae_vfio_open(struct opae_vfio *v,
 		return 1;
 	}
 
-	return opae_vfio_init(v, pciaddr, NULL);
+	return opae_vfio_init(v, pciaddr, NULL, NULL);
 }
 
 #define GUID_RE_PATTERN "[0-9a-fA-F]{8}-" \
@@ -1139,19 +1501,15 @@ int opae_vfio_open(struct opae_vfio *v,
 			"[0-9a-fA-F]{4}-" \
 			"[0-9a-fA-F]{12}"
 
-int opae_vfio_secure_open(struct opae_vfio *v,
-			  const char *pciaddr,
-			  const char *token)
+STATIC int opae_vfio_secure_init(struct opae_vfio *v,
+				 const char *pciaddr,
+				 const char *token,
+				 struct opae_vfio *owner)
 {
 	int reg_res;
 	regex_t re;
 	regmatch_t matches[2];
 
-	if (!v || !pciaddr || !token) {
-		ERR("NULL param\n");
-		return 1;
-	}
-
 	memset(&matches, 0, sizeof(matches));
 	reg_res = regcomp(&re, GUID_RE_PATTERN, REG_EXTENDED);
 
@@ -1170,7 +1528,44 @@ int opae_vfio_secure_open(struct opae_vfio *v,
 	}
 
 	regfree(&re);
-	return opae_vfio_init(v, pciaddr, token);
+	return opae_vfio_init(v, pciaddr, token, owner);
+}
+
+int opae_vfio_secure_open(struct opae_vfio *v,
+			  const char *pciaddr,
+			  const char *token)
+{
+	if (!v || !pciaddr || !token) {
+		ERR("NULL param\n");
+		return 1;
+	}
+
+	return opae_vfio_secure_init(v, pciaddr, token, NULL);
+}
+
+int opae_vfio_open_shared(struct opae_vfio *v,
+			  const char *pciaddr,
+			  struct opae_vfio *owner)
+{
+	if (!v || !pciaddr || !owner) {
+		ERR("NULL param\n");
+		return 1;
+	}
+
+	return opae_vfio_init(v, pciaddr, NULL, owner);
+}
+
+int opae_vfio_secure_open_shared(struct opae_vfio *v,
+				 const char *pciaddr,
+				 const char *token,
+				 struct opae_vfio *owner)
+{
+	if (!v || !pciaddr || !token || !owner) {
+		ERR("NULL param\n");
+		return 1;
+	}
+
+	return opae_vfio_secure_init(v, pciaddr, token, owner);
 }
 
 int opae_vfio_region_get(struct opae_vfio *v,
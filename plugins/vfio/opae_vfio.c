@@ -33,6 +33,7 @@
 #include <errno.h>
 #include <glob.h>
 #include <regex.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -47,6 +48,9 @@
 #include <opae/fpga.h>
 
 #include "props.h"
+#include "dfh_index.h"
+#include "filter_plan.h"
+#include "mmio_burst.h"
 #include "opae_vfio.h"
 #include "dfl.h"
 
@@ -89,6 +93,8 @@ typedef struct _vfio_buffer {
 
 
 static pci_device_t *_pci_devices;
+static pthread_mutex_t _devices_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static fpga_guid *fme_guids;
 static vfio_buffer *_vfio_buffers;
 static pthread_mutex_t _buffers_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 
@@ -203,6 +209,11 @@ void free_device_list(void)
 		free_token_list(p->tokens);
 		free(p);
 	}
+
+	if (fme_guids) {
+		free(fme_guids);
+		fme_guids = NULL;
+	}
 }
 
 void free_buffer_list(void)
@@ -465,6 +476,33 @@ static fpga_result vfio_reset(const pci_device_t *p, volatile uint8_t *port_base
 	return FPGA_OK;
 }
 
+STATIC int parse_fme_guids(void)
+{
+	size_t count = 0;
+	fpga_guid *guids;
+
+	while (fme_drivers[count])
+		++count;
+
+	// null-terminated, like fme_drivers
+	guids = calloc(count + 1, sizeof(fpga_guid));
+	if (!guids) {
+		OPAE_ERR("Failed to allocate memory for FME guids");
+		return 1;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		if (uuid_parse(fme_drivers[i], guids[i])) {
+			OPAE_ERR("error parsing uuid: %s", fme_drivers[i]);
+			free(guids);
+			return 1;
+		}
+	}
+
+	fme_guids = guids;
+	return 0;
+}
+
 int vfio_walk(pci_device_t *p)
 {
 	int res = 0;
@@ -496,15 +534,14 @@ int vfio_walk(pci_device_t *p)
 
 	// walk our known list of FME guids
 	// and compare each one to the one read into b0_guid
-	for (const char **u = fme_drivers; *u; u++) {
-		fpga_guid uuid;
-
-		res = uuid_parse(*u, uuid);
-		if (res) {
-			OPAE_ERR("error parsing uuid: %s", *u);
+	if (!fme_guids) {
+		res = parse_fme_guids();
+		if (res)
 			goto close;
-		}
-		if (!uuid_compare(uuid, b0_guid)) {
+	}
+
+	for (const fpga_guid *u = fme_guids; !uuid_is_null(*u); u++) {
+		if (!uuid_compare(*u, b0_guid)) {
 			// we found a legacy FME in BAR0, walk it
 			res = walk_fme(p, v, mmio, 0);
 			goto close;
@@ -542,6 +579,60 @@ close:
 	return res;
 }
 
+STATIC bool vfio_bound(const pci_device_t *p)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path),
+		 "/sys/bus/pci/drivers/vfio-pci/%s", p->addr);
+	return !access(path, F_OK);
+}
+
+/*
+ * Bring the cached DFL walk of p up to date. The walk opens the
+ * device, maps its BARs and resets its ports, so it is done once
+ * and then repeated only after the device has been invalidated
+ * (see vfio_invalidate) or has been unbound from vfio-pci and
+ * bound again. If a walk fails, the previous results are kept.
+ * Called with _devices_mutex held.
+ */
+STATIC int vfio_revalidate(pci_device_t *p)
+{
+	vfio_token *cached = p->tokens;
+
+	if (!vfio_bound(p)) {
+		free_token_list(p->tokens);
+		p->tokens = NULL;
+		p->walked = false;
+		return 1;
+	}
+
+	if (p->walked)
+		return 0;
+
+	p->tokens = NULL;
+	if (vfio_walk(p)) {
+		free_token_list(p->tokens);
+		p->tokens = cached;
+		return 2;
+	}
+
+	free_token_list(cached);
+	p->walked = true;
+	return 0;
+}
+
+STATIC void vfio_invalidate(pci_device_t *p)
+{
+	if (pthread_mutex_lock(&_devices_mutex)) {
+		OPAE_MSG("error locking devices mutex");
+		return;
+	}
+	p->walked = false;
+	if (pthread_mutex_unlock(&_devices_mutex))
+		OPAE_MSG("error unlocking devices mutex");
+}
+
 fpga_result vfio_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 {
 	fpga_result res = FPGA_EXCEPTION;
@@ -602,13 +693,20 @@ fpga_result vfio_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 	_handle->mmio_base = (volatile uint8_t *)(mmio);
 	_handle->mmio_size = size;
 
+	// An AFU id that differs from the enumerated one means the
+	// device was reprogrammed since it was walked.
+	if (_token->type == FPGA_ACCELERATOR &&
+	    _token->user_mmio[0] + 2 * sizeof(uint64_t) <= size) {
+		fpga_guid guid;
+
+		get_guid(1+(uint64_t *)(mmio+_token->user_mmio[0]), guid);
+		if (uuid_compare(guid, _token->guid))
+			vfio_invalidate(_token->device);
+	}
+
 	_handle->flags = 0;
-#if GCC_VERSION >= 40900
-	__builtin_cpu_init();
-	if (__builtin_cpu_supports("avx512f")) {
+	if (opae_mmio_line_atomic())
 		_handle->flags |= OPAE_FLAG_HAS_AVX512;
-	}
-#endif
 
 	*handle = _handle;
 	res = FPGA_OK;
@@ -636,6 +734,7 @@ fpga_result vfio_fpgaClose(fpga_handle handle)
 		OPAE_MSG("invalid token in handle");
 
 	close_vfio_pair(&h->vfio_pair);
+	opae_dfh_index_destroy(h->dfh_index);
 	if (pthread_mutex_unlock(&h->lock) ||
 	    pthread_mutex_destroy(&h->lock)) {
 		OPAE_MSG("error unlocking/destroying handle mutex");
@@ -841,6 +940,54 @@ fpga_result vfio_fpgaReadMMIO64(fpga_handle handle,
 	return FPGA_OK;
 }
 
+STATIC fpga_result dfh_read64(void *context, uint64_t offset, uint64_t *value)
+{
+	vfio_handle *h = (vfio_handle *)context;
+
+	if (h->token->user_mmio[0] + offset + sizeof(uint64_t) > h->mmio_size) {
+		OPAE_MSG("DFH offset 0x%lx out of bounds", offset);
+		return FPGA_EXCEPTION;
+	}
+
+	*value = *((volatile uint64_t *)get_user_offset(h, 0, offset));
+	return FPGA_OK;
+}
+
+fpga_result vfio_fpgaFindFeature(fpga_handle handle, fpga_guid guid,
+				 uint16_t id, fpga_feature_info *info)
+{
+	ASSERT_NOT_NULL(info);
+	vfio_handle *h = handle_check_and_lock(handle);
+
+	ASSERT_NOT_NULL(h);
+
+	fpga_result res = FPGA_OK;
+	const fpga_feature_info *feature;
+
+	if (h->token->type == FPGA_DEVICE) {
+		res = FPGA_NOT_SUPPORTED;
+		goto out_unlock;
+	}
+
+	if (!h->dfh_index) {
+		res = opae_dfh_index_build(&h->dfh_index, dfh_read64, h);
+		if (res)
+			goto out_unlock;
+	}
+
+	feature = opae_dfh_index_find(h->dfh_index, guid, id);
+	if (!feature) {
+		res = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	*info = *feature;
+
+out_unlock:
+	pthread_mutex_unlock(&h->lock);
+	return res;
+}
+
 fpga_result vfio_fpgaWriteMMIO32(fpga_handle handle,
 				 uint32_t mmio_num,
 				 uint64_t offset,
@@ -892,14 +1039,6 @@ fpga_result vfio_fpgaReadMMIO32(fpga_handle handle,
 	return FPGA_OK;
 }
 
-static inline void copy512(const void *src, void *dst)
-{
-    asm volatile("vmovdqu64 (%0), %%zmm0;"
-		 "vmovdqu64 %%zmm0, (%1);"
-		 :
-		 : "r"(src), "r"(dst));
-}
-
 fpga_result vfio_fpgaWriteMMIO512(fpga_handle handle,
 				 uint32_t mmio_num,
 				 uint64_t offset,
@@ -929,7 +1068,60 @@ fpga_result vfio_fpgaWriteMMIO512(fpga_handle handle,
 		return FPGA_EXCEPTION;
 	}
 
-	copy512(value, (uint8_t *)get_user_offset(h, mmio_num, offset));
+	opae_mmio_write_lines(get_user_offset(h, mmio_num, offset),
+			      value, 1, false);
+	pthread_mutex_unlock(&h->lock);
+	return FPGA_OK;
+}
+
+fpga_result vfio_fpgaWriteMMIOBurst(fpga_handle handle,
+				    uint32_t mmio_num,
+				    uint64_t offset,
+				    const void *lines,
+				    uint32_t num_lines,
+				    int flags)
+{
+	vfio_handle *h = handle_check(handle);
+	uint64_t start;
+	uint64_t len;
+
+	ASSERT_NOT_NULL(h);
+
+	vfio_token *t = h->token;
+
+	if (offset % 64 != 0) {
+		OPAE_MSG("Misaligned MMIO access");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!num_lines)
+		return FPGA_OK;
+
+	ASSERT_NOT_NULL(lines);
+
+	if ((flags & FPGA_MMIO_BURST_ATOMIC) && !opae_mmio_line_atomic())
+		return FPGA_NOT_SUPPORTED;
+
+	if (t->type == FPGA_DEVICE)
+		return FPGA_NOT_SUPPORTED;
+	if (mmio_num > t->user_mmio_count)
+		return FPGA_INVALID_PARAM;
+
+	len = (flags & FPGA_MMIO_BURST_FIXED) ? 64 : (uint64_t)num_lines * 64;
+	start = t->user_mmio[mmio_num];
+	if (start > h->mmio_size || offset > h->mmio_size - start ||
+	    len > h->mmio_size - start - offset) {
+		OPAE_MSG("MMIO burst out of bounds");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (pthread_mutex_lock(&h->lock)) {
+		OPAE_MSG("error locking handle mutex");
+		return FPGA_EXCEPTION;
+	}
+
+	opae_mmio_write_lines(get_user_offset(h, mmio_num, offset), lines,
+			      num_lines, (flags & FPGA_MMIO_BURST_FIXED) != 0);
 	pthread_mutex_unlock(&h->lock);
 	return FPGA_OK;
 }
@@ -1008,79 +1200,89 @@ vfio_token *get_token(pci_device_t *p, uint32_t region, int type)
 	return t;
 }
 
-bool pci_matches_filter(const fpga_properties *filter, pci_device_t *dev)
+// A parent is identified by its PCI address and region.
+typedef struct _vfio_parent_key {
+	uint32_t bdf;
+	uint32_t region;
+} vfio_parent_key;
+
+// The parent may be another plugin's token, which matches nothing here.
+STATIC void *vfio_parent_key_of(fpga_token parent, size_t *len)
 {
-	struct _fpga_properties *_prop = (struct _fpga_properties *)filter;
+	vfio_token *t = (vfio_token *)parent;
+	vfio_parent_key *key;
 
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_SEGMENT))
-		if (_prop->segment != dev->bdf.segment)
-			return false;
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_BUS))
-		if (_prop->bus != dev->bdf.bus)
-			return false;
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_DEVICE))
-		if (_prop->device != dev->bdf.device)
-			return false;
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_FUNCTION))
-		if (_prop->function != dev->bdf.function)
-			return false;
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_SOCKETID))
-		if (_prop->socket_id != dev->numa_node)
-			return false;
-	return true;
+	if (t->magic != VFIO_TOKEN_MAGIC)
+		return NULL;
 
-}
+	key = calloc(1, sizeof(vfio_parent_key));
 
-bool pci_matches_filters(const fpga_properties *filters, uint32_t num_filters,
-		 pci_device_t *dev)
-{
-	if (!filters)
-		return true;
-	for (uint32_t i = 0; i < num_filters; ++i) {
-		if (pci_matches_filter(filters[i], dev))
-			return true;
+	if (key) {
+		key->bdf = t->device->bdf.bdf;
+		key->region = t->region;
+		*len = sizeof(vfio_parent_key);
 	}
-	return false;
+	return key;
 }
 
-bool matches_filter(const fpga_properties *filter, vfio_token *t)
+STATIC const void *vfio_token_parent(void *context, size_t *len)
 {
-	struct _fpga_properties *_prop = (struct _fpga_properties *)filter;
+	*len = sizeof(vfio_parent_key);
+	return context;
+}
 
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_PARENT)) {
-		if (t->type == FPGA_DEVICE)
-			return false;
-		vfio_token *t_parent = (vfio_token *)t->parent;
-		vfio_token *f_parent = (vfio_token *)_prop->parent;
+#define PCI_FILTER_FIELDS \
+	(OPAE_FILTER_BIT(OPAE_FILTER_SEGMENT) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_BUS) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_DEVICE) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_FUNCTION) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_SOCKETID))
 
-		if (!t_parent)
-			return false;
-		if (t_parent->device->bdf.bdf != f_parent->device->bdf.bdf)
-			return false;
-		if (t_parent->region != f_parent->region)
-			return false;
-	}
+#define TOKEN_FILTER_FIELDS \
+	(OPAE_FILTER_BIT(OPAE_FILTER_PARENT) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_OBJTYPE) | \
+	 OPAE_FILTER_BIT(OPAE_FILTER_GUID))
 
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_OBJTYPE))
-		if (_prop->objtype != t->type)
-			return false;
-	if (FIELD_VALID(_prop, FPGA_PROPERTY_GUID)) {
-		if (memcmp(_prop->guid, t->guid, sizeof(fpga_guid)))
-			return false;
-	}
-	return true;
+STATIC void pci_candidate(pci_device_t *dev, opae_filter_candidate *c)
+{
+	memset(c, 0, sizeof(*c));
+	c->present = PCI_FILTER_FIELDS;
+	c->segment = dev->bdf.segment;
+	c->bus = dev->bdf.bus;
+	c->device = dev->bdf.device;
+	c->function = dev->bdf.function;
+	c->socket_id = dev->numa_node;
+}
+
+bool pci_matches_filters(const opae_filter_plan *plan, pci_device_t *dev)
+{
+	opae_filter_candidate c;
+
+	pci_candidate(dev, &c);
+	return opae_filter_plan_match(plan, &c);
 }
 
-bool matches_filters(const fpga_properties *filters, uint32_t num_filters,
-		     vfio_token *t)
+bool matches_filters(const opae_filter_plan *plan, vfio_token *t)
 {
-	if (!filters)
+	opae_filter_candidate c;
+	vfio_parent_key key = { 0, 0 };
+
+	if (!plan->count)
 		return true;
-	for (uint32_t i = 0; i < num_filters; ++i) {
-		if (matches_filter(filters[i], t))
-			return true;
+
+	pci_candidate(t->device, &c);
+	c.present |= TOKEN_FILTER_FIELDS;
+	c.objtype = t->type;
+	c.guid = t->guid;
+
+	if (t->parent) {
+		key.bdf = t->parent->device->bdf.bdf;
+		key.region = t->parent->region;
 	}
-	return false;
+	c.parent = t->parent ? vfio_token_parent : NULL;
+	c.context = &key;
+
+	return opae_filter_plan_match(plan, &c);
 }
 
 void dump_csr(uint8_t *begin, uint8_t *end, uint32_t index)
@@ -1121,34 +1323,109 @@ dfh *next_feature(dfh *h)
 	return NULL;
 }
 
-fpga_result vfio_fpgaEnumerate(const fpga_properties *filters,
-			       uint32_t num_filters, fpga_token *tokens,
-			       uint32_t max_tokens, uint32_t *num_matches)
+// When grow is set, *tokens is (re)allocated to hold every match.
+STATIC fpga_result vfio_enumerate(const fpga_properties *filters,
+				  uint32_t num_filters, fpga_token **tokens,
+				  uint32_t max_tokens, bool grow,
+				  uint32_t *num_matches)
 {
-	pci_device_t *dev = _pci_devices;
+	pci_device_t *dev;
 	uint32_t matches = 0;
+	opae_filter_plan *plan = NULL;
+	fpga_result res;
+
+	res = opae_filter_plan_compile(filters, num_filters,
+				       vfio_parent_key_of, &plan);
+	if (res != FPGA_OK)
+		return res;
+
+	if (pthread_mutex_lock(&_devices_mutex)) {
+		OPAE_MSG("error locking devices mutex");
+		opae_filter_plan_destroy(plan);
+		return FPGA_EXCEPTION;
+	}
 
-	while (dev) {
-		if (pci_matches_filters(filters, num_filters, dev)) {
-			vfio_walk(dev);
+	dev = _pci_devices;
+	while (dev && res == FPGA_OK) {
+		if (pci_matches_filters(plan, dev)) {
+			vfio_revalidate(dev);
 			vfio_token *ptr = dev->tokens;
 
 			while (ptr) {
-				if (matches_filters(filters, num_filters, ptr)) {
-					if (matches < max_tokens) {
-						tokens[matches] =
-							clone_token(ptr);
+				if (!matches_filters(plan, ptr)) {
+					ptr = ptr->next;
+					continue;
+				}
+
+				if (grow && matches == max_tokens) {
+					uint32_t max = max_tokens ?
+						max_tokens * 2 : 8;
+					fpga_token *t = realloc(*tokens,
+						max * sizeof(fpga_token));
+					if (!t) {
+						ERR("Failed to allocate memory for tokens");
+						res = FPGA_NO_MEMORY;
+						break;
+					}
+					*tokens = t;
+					max_tokens = max;
+				}
+
+				if (matches < max_tokens) {
+					(*tokens)[matches] = clone_token(ptr);
+					if (grow && !(*tokens)[matches]) {
+						res = FPGA_NO_MEMORY;
+						break;
 					}
-					++matches;
 				}
+				++matches;
 				ptr = ptr->next;
 			}
 		}
 		dev = dev->next;
 	}
+
+	if (pthread_mutex_unlock(&_devices_mutex))
+		OPAE_MSG("error unlocking devices mutex");
+
+	opae_filter_plan_destroy(plan);
+
+	if (res != FPGA_OK) {
+		while (matches)
+			free((*tokens)[--matches]);
+	}
+
 	*num_matches = matches;
-	return FPGA_OK;
+	return res;
+}
 
+fpga_result vfio_fpgaEnumerate(const fpga_properties *filters,
+			       uint32_t num_filters, fpga_token *tokens,
+			       uint32_t max_tokens, uint32_t *num_matches)
+{
+	return vfio_enumerate(filters, num_filters, &tokens,
+			      max_tokens, false, num_matches);
+}
+
+fpga_result vfio_fpgaEnumerateAll(const fpga_properties *filters,
+				  uint32_t num_filters, fpga_token **tokens,
+				  uint32_t *num_tokens)
+{
+	fpga_result res;
+
+	ASSERT_NOT_NULL(tokens);
+	ASSERT_NOT_NULL(num_tokens);
+
+	*tokens = NULL;
+
+	res = vfio_enumerate(filters, num_filters, tokens,
+			     0, true, num_tokens);
+	if (res != FPGA_OK || !*num_tokens) {
+		free(*tokens);
+		*tokens = NULL;
+	}
+
+	return res;
 }
 
 fpga_result vfio_fpgaCloneToken(fpga_token src, fpga_token *dst)
@@ -1190,32 +1467,95 @@ fpga_result vfio_fpgaDestroyToken(fpga_token *token)
 	return FPGA_INVALID_PARAM;
 }
 
-#define HUGE_1G (1*1024*1024*1024)
-#define HUGE_2M (2*1024*1024)
-#define ROUND_UP(N, M) ((N + M - 1) & -M)
-
-fpga_result vfio_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
-				   void **buf_addr, uint64_t *wsid,
-				   int flags)
+// Allocate or register one buffer and its metadata. The buffer is not
+// yet on the _vfio_buffers list. *out is NULL for the
+// FPGA_BUF_PREALLOCATED capability query.
+STATIC fpga_result vfio_buffer_create(vfio_handle *h, uint64_t len,
+				      void **buf_addr, int flags,
+				      vfio_buffer **out)
 {
-	ASSERT_NOT_NULL(buf_addr);
-	ASSERT_NOT_NULL(wsid);
-	vfio_handle *h = handle_check(handle);
+	bool preallocated = (flags & FPGA_BUF_PREALLOCATED);
+	bool quiet = (flags & FPGA_BUF_QUIET);
+	bool prefault = (flags & (FPGA_BUF_PREFAULT | FPGA_BUF_ZERO));
+	int vflags = 0;
+	struct mem_prefault p;
+
+	*out = NULL;
+
+	if (flags & (~(FPGA_BUF_PREALLOCATED | FPGA_BUF_QUIET |
+		       FPGA_BUF_READ_ONLY | FPGA_BUF_PREFAULT |
+		       FPGA_BUF_ZERO | FPGA_BUF_PREFAULT_THREADS_MASK)) ||
+	    (!prefault && (flags & FPGA_BUF_PREFAULT_THREADS_MASK))) {
+		OPAE_MSG("Unrecognized flags");
+		return FPGA_INVALID_PARAM;
+	}
 
-	ASSERT_NOT_NULL(h);
+	// A negative node places the buffer next to the device.
+	p.threads = ((unsigned)flags & FPGA_BUF_PREFAULT_THREADS_MASK) >>
+		FPGA_BUF_PREFAULT_THREADS_SHIFT;
+	p.numa_node = -1;
+	p.flags = 0;
+	p.nsec = 0;
+	if (preallocated) {
+		// Fresh buffers come zeroed from the kernel; memory
+		// owned by the caller may be mapped read-only.
+		if (flags & FPGA_BUF_ZERO)
+			p.flags |= MEM_PREFAULT_ZERO;
+		else if (flags & FPGA_BUF_READ_ONLY)
+			p.flags |= MEM_PREFAULT_READ;
+	}
 
-	(void)flags;
-	fpga_result res = FPGA_EXCEPTION;
+	if (flags & FPGA_BUF_READ_ONLY)
+		vflags |= OPAE_VFIO_BUF_READ_ONLY;
+	if (quiet)
+		vflags |= OPAE_VFIO_BUF_QUIET;
 
 	struct opae_vfio *v = h->vfio_pair->device;
 	uint8_t *virt = NULL;
 	uint64_t iova = 0;
-	size_t sz = len > HUGE_2M ? ROUND_UP(len, HUGE_1G) :
-		    len > 4096 ? ROUND_UP(len, HUGE_2M) : 4096;
-	if (opae_vfio_buffer_allocate(v, &sz, &virt, &iova)) {
-		OPAE_ERR("could not allocate buffer");
-		return FPGA_EXCEPTION;
+	// opae_vfio_buffer_allocate_ex() rounds sz to the page
+	// granularity it used to back the buffer.
+	size_t sz = len ? len : 4096;
+
+	if (preallocated) {
+		uint64_t pg_size = (uint64_t)sysconf(_SC_PAGE_SIZE);
+
+		/* A special case: respond FPGA_OK when !buf_addr and !len
+		 * as an indication that FPGA_BUF_PREALLOCATED is supported
+		 * by the plugin. */
+		if (!buf_addr && !len)
+			return FPGA_OK;
+
+		if (!buf_addr || !*buf_addr) {
+			OPAE_MSG("Preallocated buffer address is NULL");
+			return FPGA_INVALID_PARAM;
+		}
+
+		if (!len || (len & (pg_size - 1)) ||
+		    ((uint64_t)*buf_addr & (pg_size - 1))) {
+			OPAE_MSG("Preallocated buffer is not page-aligned");
+			return FPGA_INVALID_PARAM;
+		}
+
+		virt = (uint8_t *)*buf_addr;
+		sz = len;
+		vflags |= OPAE_VFIO_BUF_PREALLOCATED;
+	} else {
+		ASSERT_NOT_NULL(buf_addr);
 	}
+
+	if (opae_vfio_buffer_allocate_prefault(v, &sz, &virt, &iova, vflags,
+					       prefault ? &p : NULL)) {
+		if (!quiet)
+			OPAE_ERR("could not %s buffer",
+				 preallocated ? "register" : "allocate");
+		return preallocated ? FPGA_INVALID_PARAM : FPGA_EXCEPTION;
+	}
+
+	if (prefault)
+		OPAE_MSG("Prefaulted %lu bytes on node %d with %u threads "
+			 "in %lu us", sz, p.numa_node, p.threads,
+			 p.nsec / 1000);
 	vfio_buffer *buffer = (vfio_buffer *)malloc(sizeof(vfio_buffer));
 
 	if (!buffer) {
@@ -1223,80 +1563,196 @@ fpga_result vfio_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 		if (opae_vfio_buffer_free(v, virt)) {
 			OPAE_ERR("error freeing vfio buffer");
 		}
-		res = FPGA_NO_MEMORY;
-		goto out_free;
+		return FPGA_NO_MEMORY;
 	}
 	memset(buffer, 0, sizeof(vfio_buffer));
 	buffer->vfio_device = v;
 	buffer->virtual = virt;
 	buffer->iova = iova;
 	buffer->size = sz;
-	if (pthread_mutex_lock(&_buffers_mutex)) {
-		OPAE_MSG("error locking buffer mutex");
-		res = FPGA_EXCEPTION;
-		goto out_free;
+	*buf_addr = virt;
+	*out = buffer;
+	return FPGA_OK;
+}
+
+STATIC void vfio_buffer_destroy(vfio_buffer *buffer)
+{
+	if (opae_vfio_buffer_free(buffer->vfio_device, buffer->virtual)) {
+		OPAE_ERR("error freeing vfio buffer");
 	}
+	free(buffer);
+}
+
+// Called with _buffers_mutex held.
+STATIC void vfio_buffer_link(vfio_buffer *buffer)
+{
 	buffer->next = _vfio_buffers;
 	buffer->wsid = buffer->next ? buffer->next->wsid+1 : 0;
 	_vfio_buffers = buffer;
-	*buf_addr = virt;
+}
+
+fpga_result vfio_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
+				   void **buf_addr, uint64_t *wsid,
+				   int flags)
+{
+	ASSERT_NOT_NULL(wsid);
+	vfio_handle *h = handle_check(handle);
+
+	ASSERT_NOT_NULL(h);
+
+	vfio_buffer *buffer = NULL;
+	fpga_result res;
+
+	res = vfio_buffer_create(h, len, buf_addr, flags, &buffer);
+	if (res || !buffer)
+		return res;
+
+	if (pthread_mutex_lock(&_buffers_mutex)) {
+		OPAE_MSG("error locking buffer mutex");
+		vfio_buffer_destroy(buffer);
+		return FPGA_EXCEPTION;
+	}
+	vfio_buffer_link(buffer);
 	*wsid = buffer->wsid;
-	res = FPGA_OK;
 	if (pthread_mutex_unlock(&_buffers_mutex)) {
 		OPAE_MSG("error unlocking buffers");
 		res = FPGA_EXCEPTION;
 	}
-out_free:
-	if (res) {
-		if (buffer) {
-			free(buffer);
-			if (virt && opae_vfio_buffer_free(v, virt)) {
-				OPAE_ERR("error freeing vfio buffer");
-			}
+	return res;
+}
+
+fpga_result vfio_fpgaPrepareBuffers(fpga_handle handle, uint32_t count,
+				    fpga_buffer_desc *bufs, int flags)
+{
+	ASSERT_NOT_NULL(bufs);
+	vfio_handle *h = handle_check(handle);
+
+	ASSERT_NOT_NULL(h);
+
+	vfio_buffer **created;
+	fpga_result res = FPGA_OK;
+	uint32_t i;
+
+	if (!count) {
+		OPAE_MSG("count is zero");
+		return FPGA_INVALID_PARAM;
+	}
+
+	created = calloc(count, sizeof(vfio_buffer *));
+	if (!created) {
+		OPAE_ERR("error allocating buffer metadata");
+		return FPGA_NO_MEMORY;
+	}
+
+	for (i = 0 ; i < count ; ++i) {
+		res = vfio_buffer_create(h, bufs[i].len, &bufs[i].buf_addr,
+					 flags, &created[i]);
+		if (res)
+			goto out_destroy;
+		if (!created[i]) {
+			OPAE_MSG("buffer address is NULL");
+			res = FPGA_INVALID_PARAM;
+			goto out_destroy;
 		}
 	}
+
+	// Publish the whole batch under one lock acquisition.
+	if (pthread_mutex_lock(&_buffers_mutex)) {
+		OPAE_MSG("error locking buffer mutex");
+		res = FPGA_EXCEPTION;
+		goto out_destroy;
+	}
+	for (i = 0 ; i < count ; ++i) {
+		vfio_buffer_link(created[i]);
+		bufs[i].wsid = created[i]->wsid;
+		bufs[i].ioaddr = created[i]->iova;
+	}
+	if (pthread_mutex_unlock(&_buffers_mutex)) {
+		OPAE_MSG("error unlocking buffers");
+		res = FPGA_EXCEPTION;
+	}
+	free(created);
+	return res;
+
+out_destroy:
+	while (i--)
+		vfio_buffer_destroy(created[i]);
+	free(created);
 	return res;
 }
 
-fpga_result vfio_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
+STATIC int vfio_cmp_wsid(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+fpga_result vfio_fpgaReleaseBuffers(fpga_handle handle, uint32_t count,
+				    const uint64_t *wsids)
 {
 	vfio_handle *h = handle_check(handle);
 
 	ASSERT_NOT_NULL(h);
 
-	struct opae_vfio *v = h->vfio_pair->device;
+	if (!count)
+		return FPGA_OK;
 
-	vfio_buffer *ptr = _vfio_buffers;
-	vfio_buffer *prev = NULL;
+	ASSERT_NOT_NULL(wsids);
+
+	vfio_buffer *ptr;
+	vfio_buffer **prev;
+	uint64_t *sorted = NULL;
+	uint32_t found = 0;
+
+	// A single walk of the buffer list serves the whole batch.
+	if (count > 1) {
+		sorted = malloc(count * sizeof(uint64_t));
+		if (!sorted) {
+			OPAE_ERR("error allocating wsid list");
+			return FPGA_NO_MEMORY;
+		}
+		memcpy(sorted, wsids, count * sizeof(uint64_t));
+		qsort(sorted, count, sizeof(uint64_t), vfio_cmp_wsid);
+	}
 
 	if (pthread_mutex_lock(&_buffers_mutex)) {
 		OPAE_MSG("error locking buffer mutex");
+		free(sorted);
 		return FPGA_EXCEPTION;
 	}
-	fpga_result res = FPGA_NOT_FOUND;
 
-	while (ptr) {
-		if (ptr->wsid == wsid) {
-			if (opae_vfio_buffer_free(v, ptr->virtual)) {
-				OPAE_ERR("error freeing vfio buffer");
-			}
-			if (prev) {
-				prev->next = ptr->next;
-			} else {
-				_vfio_buffers = ptr->next;
-			}
-			free(ptr);
-			res = FPGA_OK;
-			goto out_unlock;
+	prev = &_vfio_buffers;
+	ptr = _vfio_buffers;
+	while (ptr && found < count) {
+		bool match = sorted ?
+			bsearch(&ptr->wsid, sorted, count, sizeof(uint64_t),
+				vfio_cmp_wsid) != NULL :
+			ptr->wsid == wsids[0];
+
+		if (match) {
+			vfio_buffer *trash = ptr;
+			*prev = ptr->next;
+			ptr = ptr->next;
+			vfio_buffer_destroy(trash);
+			++found;
+			continue;
 		}
-		prev = ptr;
+		prev = &ptr->next;
 		ptr = ptr->next;
 	}
-out_unlock:
+
 	if (pthread_mutex_unlock(&_buffers_mutex)) {
 		OPAE_MSG("error unlocking buffers mutex");
 	}
-	return res;
+	free(sorted);
+	return found == count ? FPGA_OK : FPGA_NOT_FOUND;
+}
+
+fpga_result vfio_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
+{
+	return vfio_fpgaReleaseBuffers(handle, 1, &wsid);
 }
 
 fpga_result vfio_fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
@@ -1560,3 +2016,168 @@ out_unlock_handle:
 			 strerror(errno));
 	return res;
 }
+
+/*
+ * Lock count event handles, in order, storing them in vehs. On failure,
+ * those already locked are unlocked again.
+ */
+STATIC fpga_result event_handles_check_and_lock(uint32_t count,
+					fpga_event_handle *event_handles,
+					vfio_event_handle **vehs)
+{
+	uint32_t i;
+
+	for (i = 0 ; i < count ; ++i) {
+		vehs[i] = event_handle_check_and_lock(event_handles[i]);
+		if (!vehs[i])
+			break;
+	}
+
+	if (i == count)
+		return FPGA_OK;
+
+	while (i--)
+		pthread_mutex_unlock(&vehs[i]->lock);
+
+	return FPGA_INVALID_PARAM;
+}
+
+STATIC void event_handles_unlock(uint32_t count, vfio_event_handle **vehs)
+{
+	uint32_t i;
+
+	for (i = 0 ; i < count ; ++i) {
+		if (pthread_mutex_unlock(&vehs[i]->lock))
+			OPAE_ERR("pthread_mutex_unlock() failed: %s",
+				 strerror(errno));
+	}
+}
+
+fpga_result vfio_fpgaRegisterInterruptEvents(fpga_handle handle,
+					     uint32_t start, uint32_t count,
+					     fpga_event_handle *event_handles)
+{
+	vfio_handle *_h;
+	vfio_event_handle **vehs;
+	int *fds = NULL;
+	fpga_result res;
+	uint32_t i;
+	int err;
+
+	ASSERT_NOT_NULL(handle);
+	ASSERT_NOT_NULL(event_handles);
+
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	vehs = calloc(count, sizeof(vfio_event_handle *));
+	fds = calloc(count, sizeof(int));
+	if (!vehs || !fds) {
+		OPAE_ERR("Could not allocate event handle arrays");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	_h = handle_check_and_lock(handle);
+	if (!_h) {
+		res = FPGA_INVALID_PARAM;
+		goto out_free;
+	}
+
+	res = event_handles_check_and_lock(count, event_handles, vehs);
+	if (res)
+		goto out_unlock_handle;
+
+	for (i = 0 ; i < count ; ++i)
+		fds[i] = vehs[i]->fd;
+
+	// One request enables the whole range.
+	if (opae_vfio_irq_enable_range(_h->vfio_pair->device,
+				       VFIO_PCI_MSIX_IRQ_INDEX,
+				       start, count, fds)) {
+		OPAE_ERR("Couldn't enable MSIX IRQs %u-%u : %s",
+			 start, start + count - 1, strerror(errno));
+		res = FPGA_EXCEPTION;
+	} else {
+		for (i = 0 ; i < count ; ++i)
+			vehs[i]->flags = start + i;
+	}
+
+	event_handles_unlock(count, vehs);
+out_unlock_handle:
+	err = pthread_mutex_unlock(&_h->lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s",
+			 strerror(errno));
+out_free:
+	free(fds);
+	free(vehs);
+	return res;
+}
+
+fpga_result vfio_fpgaUnregisterInterruptEvents(fpga_handle handle,
+					       uint32_t count,
+					       fpga_event_handle *event_handles)
+{
+	vfio_handle *_h;
+	vfio_event_handle **vehs;
+	fpga_result res;
+	uint32_t i;
+	uint32_t run;
+	int err;
+
+	ASSERT_NOT_NULL(handle);
+	ASSERT_NOT_NULL(event_handles);
+
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	vehs = calloc(count, sizeof(vfio_event_handle *));
+	if (!vehs) {
+		OPAE_ERR("Could not allocate event handle array");
+		return FPGA_NO_MEMORY;
+	}
+
+	_h = handle_check_and_lock(handle);
+	if (!_h) {
+		res = FPGA_INVALID_PARAM;
+		goto out_free;
+	}
+
+	res = event_handles_check_and_lock(count, event_handles, vehs);
+	if (res)
+		goto out_unlock_handle;
+
+	// Disable each run of consecutive vectors with one request. Keep
+	// going after a failure, and report the first one.
+	for (i = 0 ; i < count ; i += run) {
+		for (run = 1 ; i + run < count ; ++run) {
+			if (vehs[i + run]->flags != vehs[i]->flags + run)
+				break;
+		}
+
+		if (opae_vfio_irq_disable_range(_h->vfio_pair->device,
+						VFIO_PCI_MSIX_IRQ_INDEX,
+						vehs[i]->flags, run)) {
+			OPAE_ERR("Couldn't disable MSIX IRQs %u-%u : %s",
+				 vehs[i]->flags, vehs[i]->flags + run - 1,
+				 strerror(errno));
+			if (res == FPGA_OK)
+				res = FPGA_EXCEPTION;
+		}
+	}
+
+	event_handles_unlock(count, vehs);
+out_unlock_handle:
+	err = pthread_mutex_unlock(&_h->lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s",
+			 strerror(errno));
+out_free:
+	free(vehs);
+	return res;
+}
@@ -83,6 +83,7 @@ typedef struct _pci_device {
 	uint32_t vendor;
 	uint32_t device;
 	uint32_t numa_node;
+	bool walked;
 	struct _vfio_token *tokens;
 	struct _pci_device *next;
 } pci_device_t;
@@ -129,6 +130,7 @@ typedef struct _vfio_handle {
 	pthread_mutex_t lock;
 #define OPAE_FLAG_HAS_AVX512 (1u << 0)
 	uint32_t flags;
+	struct _opae_dfh_index *dfh_index;
 } vfio_handle;
 
 typedef struct _vfio_event_handle {
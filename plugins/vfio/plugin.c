@@ -82,12 +82,18 @@ int __VFIO_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaReadMMIO32");
 	adapter->fpgaWriteMMIO512 =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaWriteMMIO512");
+	adapter->fpgaWriteMMIOBurst =
+		dlsym(adapter->plugin.dl_handle, "vfio_fpgaWriteMMIOBurst");
 	adapter->fpgaMapMMIO =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaMapMMIO");
 	adapter->fpgaUnmapMMIO =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaUnmapMMIO");
+	adapter->fpgaFindFeature =
+		dlsym(adapter->plugin.dl_handle, "vfio_fpgaFindFeature");
 	adapter->fpgaEnumerate =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaEnumerate");
+	adapter->fpgaEnumerateAll =
+		dlsym(adapter->plugin.dl_handle, "vfio_fpgaEnumerateAll");
 	adapter->fpgaCloneToken =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaCloneToken");
 	adapter->fpgaDestroyToken =
@@ -98,6 +104,10 @@ int __VFIO_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaReleaseBuffer");
 	adapter->fpgaGetIOAddress =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaGetIOAddress");
+	adapter->fpgaPrepareBuffers =
+		dlsym(adapter->plugin.dl_handle, "vfio_fpgaPrepareBuffers");
+	adapter->fpgaReleaseBuffers =
+		dlsym(adapter->plugin.dl_handle, "vfio_fpgaReleaseBuffers");
 	adapter->fpgaCreateEventHandle =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaCreateEventHandle");
 	adapter->fpgaDestroyEventHandle =
@@ -108,6 +118,12 @@ int __VFIO_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaRegisterEvent");
 	adapter->fpgaUnregisterEvent =
 		dlsym(adapter->plugin.dl_handle, "vfio_fpgaUnregisterEvent");
+	adapter->fpgaRegisterInterruptEvents =
+		dlsym(adapter->plugin.dl_handle,
+		      "vfio_fpgaRegisterInterruptEvents");
+	adapter->fpgaUnregisterInterruptEvents =
+		dlsym(adapter->plugin.dl_handle,
+		      "vfio_fpgaUnregisterInterruptEvents");
 
 	adapter->initialize =
 		dlsym(adapter->plugin.dl_handle, "vfio_plugin_initialize");
@@ -34,6 +34,7 @@
 #include "intel-fpga.h"
 
 #include "opae_drv.h"
+#include "opae/mem_prefault.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -117,15 +118,61 @@ STATIC fpga_result buffer_release(void *addr, uint64_t len)
 	return FPGA_OK;
 }
 
-fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
-					   void **buf_addr, uint64_t *wsid,
-					   int flags)
+/*
+ * Fault in (and for FPGA_BUF_ZERO, clear) a buffer on the device's
+ * NUMA node before it is pinned, so that the DMA map doesn't fault it
+ * in one page at a time.
+ */
+STATIC fpga_result buffer_prefault(struct _fpga_handle *_handle, void *addr,
+				   uint64_t len, bool preallocated, int flags)
+{
+	struct _fpga_token *_token = (struct _fpga_token *)_handle->token;
+	struct mem_prefault p;
+	uint64_t pg_size;
+
+	p.threads = ((unsigned)flags & FPGA_BUF_PREFAULT_THREADS_MASK) >>
+		FPGA_BUF_PREFAULT_THREADS_SHIFT;
+	p.numa_node = mem_prefault_numa_node(_token->sysfspath);
+	p.flags = 0;
+	p.nsec = 0;
+
+	if (preallocated) {
+		/* Fresh mappings come zeroed from the kernel; memory
+		 * owned by the caller may be mapped read-only. */
+		if (flags & FPGA_BUF_ZERO)
+			p.flags |= MEM_PREFAULT_ZERO;
+		else if (flags & FPGA_BUF_READ_ONLY)
+			p.flags |= MEM_PREFAULT_READ;
+		pg_size = 0;
+	} else if (len > 2 * MB) {
+		pg_size = 1 * GB;
+	} else if (len > 4 * KB) {
+		pg_size = 2 * MB;
+	} else {
+		pg_size = 0;
+	}
+
+	if (mem_prefault(addr, len, pg_size, &p)) {
+		OPAE_MSG("Buffer prefault failed");
+		return FPGA_NO_MEMORY;
+	}
+
+	OPAE_MSG("Prefaulted %lu bytes on node %d with %u threads in %lu us",
+		 len, p.numa_node, p.threads, p.nsec / 1000);
+
+	return FPGA_OK;
+}
+
+/*
+ * Prepare one buffer. Called with the handle lock held.
+ */
+STATIC fpga_result prepare_buffer(struct _fpga_handle *_handle, uint64_t len,
+				  void **buf_addr, uint64_t *wsid,
+				  uint64_t *ioaddr, int flags)
 {
 	void *addr = NULL;
 	fpga_result result = FPGA_OK;
 	uint64_t io_addr = 0;
-	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
-	int err;
 
 	bool preallocated = (flags & FPGA_BUF_PREALLOCATED);
 	bool quiet = (flags & FPGA_BUF_QUIET);
@@ -133,24 +180,22 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 	bool read_only = (flags & FPGA_BUF_READ_ONLY);
 	uint32_t map_flags = (read_only ? FPGA_DMA_TO_DEV : 0);
 
-	uint64_t pg_size;
+	bool prefault = (flags & (FPGA_BUF_PREFAULT | FPGA_BUF_ZERO));
 
-	result = handle_check_and_lock(_handle);
-	if (result)
-		return result;
+	uint64_t pg_size;
 
 	/* Assure wsid is a valid pointer */
 	if (!wsid) {
 		OPAE_MSG("WSID is NULL");
-		result = FPGA_INVALID_PARAM;
-		goto out_unlock;
+		return FPGA_INVALID_PARAM;
 	}
 
 	if (flags & (~(FPGA_BUF_PREALLOCATED | FPGA_BUF_QUIET |
-		       FPGA_BUF_READ_ONLY))) {
+		       FPGA_BUF_READ_ONLY | FPGA_BUF_PREFAULT |
+		       FPGA_BUF_ZERO | FPGA_BUF_PREFAULT_THREADS_MASK)) ||
+	    (!prefault && (flags & FPGA_BUF_PREFAULT_THREADS_MASK))) {
 		OPAE_MSG("Unrecognized flags");
-		result = FPGA_INVALID_PARAM;
-		goto out_unlock;
+		return FPGA_INVALID_PARAM;
 	}
 
 	pg_size = (uint64_t) sysconf(_SC_PAGE_SIZE);
@@ -159,41 +204,34 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 		/* A special case: respond FPGA_OK when !buf_addr and !len
 		 * as an indication that FPGA_BUF_PREALLOCATED is supported
 		 * by the library. */
-		if (!buf_addr && !len) {
-			result = FPGA_OK;
-			goto out_unlock;
-		}
+		if (!buf_addr && !len)
+			return FPGA_OK;
 
 		/* buffer is already allocated, check addresses */
 		if (!buf_addr) {
 			OPAE_MSG("No preallocated buffer address given");
-			result = FPGA_INVALID_PARAM;
-			goto out_unlock;
+			return FPGA_INVALID_PARAM;
 		}
 		if (!(*buf_addr)) {
 			OPAE_MSG("Preallocated buffer address is NULL");
-			result = FPGA_INVALID_PARAM;
-			goto out_unlock;
+			return FPGA_INVALID_PARAM;
 		}
 		/* check length */
 		if (!len || (len & (pg_size - 1))) {
 			OPAE_MSG("Preallocated buffer size is not a non-zero multiple of page size");
-			result = FPGA_INVALID_PARAM;
-			goto out_unlock;
+			return FPGA_INVALID_PARAM;
 		}
 		addr = *buf_addr;
 	} else {
 
 		if (!buf_addr) {
 			OPAE_MSG("buffer address is NULL");
-			result = FPGA_INVALID_PARAM;
-			goto out_unlock;
+			return FPGA_INVALID_PARAM;
 		}
 
 		if (!len) {
 			OPAE_MSG("buffer length is zero");
-			result = FPGA_INVALID_PARAM;
-			goto out_unlock;
+			return FPGA_INVALID_PARAM;
 		}
 
 		/* round up to nearest page boundary */
@@ -202,8 +240,16 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 		}
 
 		result = buffer_allocate(&addr, len, flags);
+		if (result != FPGA_OK)
+			return result;
+	}
+
+	if (prefault) {
+		result = buffer_prefault(_handle, addr, len, preallocated, flags);
 		if (result != FPGA_OK) {
-			goto out_unlock;
+			if (!preallocated)
+				buffer_release(addr, len);
+			return result;
 		}
 	}
 
@@ -217,8 +263,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 				 strerror(errno));
 		}
 
-		result = FPGA_INVALID_PARAM;
-		goto out_unlock;
+		return FPGA_INVALID_PARAM;
 	}
 
 
@@ -228,52 +273,39 @@ fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t l
 	/* Add to workspace id in order to store buffer length */
 	if (!wsid_add(_handle->wsid_root, *wsid, (uint64_t)addr, io_addr, len,
 		      0, 0, flags)) {
+		opae_port_unmap(_handle->fddev, io_addr);
 		if (!preallocated) {
 			buffer_release(addr, len);
 		}
 
 		OPAE_MSG("Failed to add workspace id %lu", *wsid);
-		result = FPGA_NO_MEMORY;
-		goto out_unlock;
+		return FPGA_NO_MEMORY;
 	}
 
 
 	/* Update buf_addr */
-	if (buf_addr)
-		*buf_addr = addr;
+	*buf_addr = addr;
+	if (ioaddr)
+		*ioaddr = io_addr;
 
-	/* Return */
-	result = FPGA_OK;
-
-out_unlock:
-	err = pthread_mutex_unlock(&_handle->lock);
-	if (err) {
-		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
-	}
-	return result;
+	return FPGA_OK;
 }
 
-fpga_result __XFPGA_API__
-xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
+/*
+ * Release one buffer. Called with the handle lock held.
+ */
+STATIC fpga_result release_buffer(struct _fpga_handle *_handle, uint64_t wsid)
 {
 	void *buf_addr;
 	uint64_t iova;
 	uint64_t len;
-	int err;
-
-	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
 	fpga_result result = FPGA_NOT_FOUND;
 
-	result = handle_check_and_lock(_handle);
-	if (result)
-		return result;
-
 	/* Fetch the buffer physical address and length */
 	struct wsid_map *wm = wsid_find(_handle->wsid_root, wsid);
 	if (!wm) {
 		OPAE_MSG("WSID not found");
-		result = FPGA_INVALID_PARAM;
-		goto out_unlock;
+		return FPGA_INVALID_PARAM;
 	}
 
 	buf_addr = (void *) wm->addr;
@@ -307,7 +339,114 @@ ws_free:
 	/* Remove workspace */
 	wsid_del(_handle->wsid_root, wsid);
 
-out_unlock:
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
+					   void **buf_addr, uint64_t *wsid,
+					   int flags)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	fpga_result result;
+	int err;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	result = prepare_buffer(_handle, len, buf_addr, wsid, NULL, flags);
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaPrepareBuffers(fpga_handle handle,
+						   uint32_t count,
+						   fpga_buffer_desc *bufs,
+						   int flags)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	fpga_result result;
+	uint32_t i;
+	int err;
+
+	if (!bufs || !count) {
+		OPAE_MSG("bufs is NULL or count is zero");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	for (i = 0 ; i < count ; ++i) {
+		result = prepare_buffer(_handle, bufs[i].len,
+					&bufs[i].buf_addr, &bufs[i].wsid,
+					&bufs[i].ioaddr, flags);
+		if (result != FPGA_OK)
+			break;
+	}
+
+	/* All or nothing */
+	if (result != FPGA_OK) {
+		while (i--)
+			release_buffer(_handle, bufs[i].wsid);
+	}
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
+fpga_result __XFPGA_API__
+xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
+	int err;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	result = release_buffer(_handle, wsid);
+
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
+fpga_result __XFPGA_API__
+xfpga_fpgaReleaseBuffers(fpga_handle handle, uint32_t count,
+			 const uint64_t *wsids)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
+	uint32_t i;
+	int err;
+
+	if (!wsids && count) {
+		OPAE_MSG("wsids is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	for (i = 0 ; i < count ; ++i) {
+		fpga_result res = release_buffer(_handle, wsids[i]);
+		if (res != FPGA_OK && result == FPGA_OK)
+			result = res;
+	}
+
 	err = pthread_mutex_unlock(&_handle->lock);
 	if (err) {
 		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
@@ -32,6 +32,9 @@
 #include "common_int.h"
 #include "wsid_list_int.h"
 #include "metrics/metrics_int.h"
+#include "dfh_index.h"
+#include "power_thermal_int.h"
+#include "fpgad_conn_int.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -68,12 +71,19 @@ fpga_result __XFPGA_API__ xfpga_fpgaClose(fpga_handle handle)
 	wsid_tracker_cleanup(_handle->mmio_root, unmap_mmio_region);
 	free_umsg_buffer(handle);
 
+	power_thermal_release(handle);
+	fpgad_conn_release(handle);
+
 	// free metric enum vector
 	free_fpga_enum_metrics_vector(_handle);
 
+	opae_dfh_index_destroy(_handle->dfh_index);
+	_handle->dfh_index = NULL;
+
+	free(_handle->irq_set);
+	_handle->irq_set = NULL;
+
 	close(_handle->fddev);
-	if (_handle->fdfpgad >= 0)
-		close(_handle->fdfpgad);
 
 	// invalidate magic (just in case)
 	_handle->magic = FPGA_INVALID_MAGIC;
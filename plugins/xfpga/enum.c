@@ -42,6 +42,7 @@
 #include "error_int.h"
 #include "props.h"
 #include "opae_drv.h"
+#include "filter_plan.h"
 
 
 struct dev_list {
@@ -69,227 +70,100 @@ struct dev_list {
 	struct dev_list *fme;
 };
 
-STATIC bool matches_filter(const struct dev_list *attr, const fpga_properties filter)
-{
-	struct _fpga_properties *_filter = (struct _fpga_properties *)filter;
-	bool res = true;
-	int err = 0;
-	char buffer[PATH_MAX] = {0};
-
-	if (pthread_mutex_lock(&_filter->lock)) {
-		OPAE_MSG("Failed to lock filter mutex");
-		return false;
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_PARENT)) {
-		struct _fpga_token *_parent_tok =
-			(struct _fpga_token *)_filter->parent;
-		char spath[PATH_MAX] = {0};
-
-		if (FPGA_ACCELERATOR != attr->objtype) {
-			res = false; // Only accelerator can have a parent
-			goto out_unlock;
-		}
-
-		if (NULL == _parent_tok) {
-			res = false; // Reject search based on NULL parent token
-			goto out_unlock;
-		}
-
-		if (sysfs_get_fme_path(attr->sysfspath, spath) != FPGA_OK) {
-			res = false;
-			goto out_unlock;
-		}
-		// sysfs_get_fme_path returns the real path
-		// compare that agains the realpath of the parent_tok
-		if (!realpath(_parent_tok->sysfspath, buffer)) {
-			res = false;
-			goto out_unlock;
-		}
-		if (strcmp(spath, buffer)) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_OBJTYPE)) {
-		if (_filter->objtype != attr->objtype) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_SEGMENT)) {
-		if (_filter->segment != attr->segment) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_BUS)) {
-		if (_filter->bus != attr->bus) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_DEVICE)) {
-		if (_filter->device != attr->device) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_FUNCTION)) {
-		if (_filter->function != attr->function) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_SOCKETID)) {
-		if (_filter->socket_id != attr->socket_id) {
-			res = false;
-			goto out_unlock;
-		}
-	}
-
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_GUID)) {
-		if (0 != memcmp(attr->guid, _filter->guid, sizeof(fpga_guid))) {
-			res = false;
-			goto out_unlock;
-		}
-	}
+typedef struct _match_context {
+	const struct dev_list *attr;
+	bool fme_path_valid;
+	bool fme_path_ok;
+	char fme_path[PATH_MAX];
+} match_context;
 
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_OBJECTID)) {
-		uint64_t objid;
-		fpga_result result;
-		result = sysfs_objectid_from_path(attr->sysfspath, &objid);
-		if (result != FPGA_OK || _filter->object_id != objid) {
-			res = false;
-			goto out_unlock;
-		}
-	}
+// A parent is identified by the real path of its FME in sysfs.
+// The parent may be another plugin's token, which matches nothing here.
+STATIC void *parent_key(fpga_token parent, size_t *len)
+{
+	struct _fpga_token *_parent_tok = (struct _fpga_token *)parent;
+	char *path;
 
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_VENDORID)) {
-		if (_filter->vendor_id != attr->vendor_id) {
-			res = false;
-			goto out_unlock;
-		}
-	}
+	if (_parent_tok->magic != FPGA_TOKEN_MAGIC)
+		return NULL;
 
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_DEVICEID)) {
-		if (_filter->device_id != attr->device_id) {
-			res = false;
-			goto out_unlock;
-		}
-	}
+	path = realpath(_parent_tok->sysfspath, NULL);
 
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_NUM_ERRORS)) {
-		uint32_t errors;
-		char errpath[SYSFS_PATH_MAX] = { 0, };
+	if (path)
+		*len = strlen(path) + 1;
+	return path;
+}
 
-		if (snprintf(errpath, sizeof(errpath),
-			     "%s/errors", attr->sysfspath) < 0) {
-			OPAE_ERR("snprintf buffer overflow");
-			res = false;
-			goto out_unlock;
-		}
+STATIC const void *fme_key(void *context, size_t *len)
+{
+	match_context *ctx = (match_context *)context;
 
-		errors = count_error_files(errpath);
-		if (errors != _filter->num_errors) {
-			res = false;
-			goto out_unlock;
-		}
+	// sysfs_get_fme_path() globs, so resolve it once per device.
+	if (!ctx->fme_path_valid) {
+		ctx->fme_path_ok = sysfs_get_fme_path(ctx->attr->sysfspath,
+						      ctx->fme_path) == FPGA_OK;
+		ctx->fme_path_valid = true;
 	}
 
-	if (FIELD_VALID(_filter, FPGA_PROPERTY_OBJTYPE)
-	    && (FPGA_DEVICE == _filter->objtype)) {
-
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_NUM_SLOTS)) {
-			if ((FPGA_DEVICE != attr->objtype)
-			    || (attr->fpga_num_slots
-				!= _filter->u.fpga.num_slots)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
-
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_BBSID)) {
-			if ((FPGA_DEVICE != attr->objtype)
-			    || (attr->fpga_bitstream_id
-				!= _filter->u.fpga.bbs_id)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
+	if (!ctx->fme_path_ok)
+		return NULL;
 
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_BBSVERSION)) {
-			if ((FPGA_DEVICE != attr->objtype)
-			    || (attr->fpga_bbs_version.major
-				!= _filter->u.fpga.bbs_version.major)
-			    || (attr->fpga_bbs_version.minor
-				!= _filter->u.fpga.bbs_version.minor)
-			    || (attr->fpga_bbs_version.patch
-				!= _filter->u.fpga.bbs_version.patch)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
+	*len = strlen(ctx->fme_path) + 1;
+	return ctx->fme_path;
+}
 
-	} else if (FIELD_VALID(_filter, FPGA_PROPERTY_OBJTYPE)
-		   && (FPGA_ACCELERATOR == _filter->objtype)) {
+STATIC fpga_result fetch_attr(void *context, uint32_t field, uint64_t *value)
+{
+	match_context *ctx = (match_context *)context;
+	char errpath[SYSFS_PATH_MAX] = { 0, };
 
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_ACCELERATOR_STATE)) {
-			if ((FPGA_ACCELERATOR != attr->objtype)
-			    || (attr->accelerator_state
-				!= _filter->u.accelerator.state)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
+	if (field == OPAE_FILTER_OBJECTID)
+		return sysfs_objectid_from_path(ctx->attr->sysfspath, value);
 
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_NUM_MMIO)) {
-			if ((FPGA_ACCELERATOR != attr->objtype)
-			    || (attr->accelerator_num_mmios
-				!= _filter->u.accelerator.num_mmio)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
-
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_NUM_INTERRUPTS)) {
-			if ((FPGA_ACCELERATOR != attr->objtype)
-			    || (attr->accelerator_num_irqs
-				!= _filter->u.accelerator.num_interrupts)) {
-				res = false;
-				goto out_unlock;
-			}
-		}
+	if (snprintf(errpath, sizeof(errpath),
+		     "%s/errors", ctx->attr->sysfspath) < 0) {
+		OPAE_ERR("snprintf buffer overflow");
+		return FPGA_EXCEPTION;
 	}
 
-out_unlock:
-	err = pthread_mutex_unlock(&_filter->lock);
-	if (err) {
-		OPAE_ERR("pthread_mutex_unlock() failed: %S", strerror(err));
-	}
-	return res;
+	*value = count_error_files(errpath);
+	return FPGA_OK;
 }
 
-STATIC bool matches_filters(const struct dev_list *attr, const fpga_properties *filter,
-		     uint32_t num_filter)
+STATIC bool matches_filters(const struct dev_list *attr,
+			    const opae_filter_plan *plan)
 {
-	uint32_t i;
+	match_context ctx;
+	opae_filter_candidate c;
 
-	if (!num_filter) // no filter == match everything
+	if (!plan->count) // no filter == match everything
 		return true;
 
-	for (i = 0; i < num_filter; ++i) {
-		if (matches_filter(attr, filter[i])) {
-			return true;
-		}
-	}
-	return false;
+	ctx.attr = attr;
+	ctx.fme_path_valid = false;
+
+	memset(&c, 0, sizeof(c));
+	c.present = ~0U;
+	c.objtype = attr->objtype;
+	c.segment = attr->segment;
+	c.bus = attr->bus;
+	c.device = attr->device;
+	c.function = attr->function;
+	c.socket_id = attr->socket_id;
+	c.vendor_id = attr->vendor_id;
+	c.device_id = attr->device_id;
+	c.guid = attr->guid;
+	c.num_slots = attr->fpga_num_slots;
+	c.bbs_id = attr->fpga_bitstream_id;
+	c.bbs_version = attr->fpga_bbs_version;
+	c.state = attr->accelerator_state;
+	c.num_mmio = attr->accelerator_num_mmios;
+	c.num_interrupts = attr->accelerator_num_irqs;
+	c.fetch = fetch_attr;
+	c.parent = fme_key;
+	c.context = &ctx;
+
+	return opae_filter_plan_match(plan, &c);
 }
 
 STATIC struct dev_list *add_dev(const char *sysfspath, const char *devpath,
@@ -580,34 +454,97 @@ STATIC fpga_result enum_fpga_region_resources(struct dev_list *list,
 /// * At least one filter specifies FPGA_ACCELERATOR as object type
 /// * At least one filter does NOT specify an object type
 /// Return false otherwise
-bool include_afu(const fpga_properties *filters, uint32_t num_filters)
+STATIC bool include_afu(const opae_filter_plan *plan)
 {
-	size_t i = 0;
-	if (!num_filters)
+	uint32_t i, j;
+	if (!plan->count)
 		return true;
-	for (i = 0; i < num_filters; ++i) {
-		struct _fpga_properties *_filter =
-			(struct _fpga_properties *)filters[i];
-		if (FIELD_VALID(_filter, FPGA_PROPERTY_OBJTYPE)) {
-			if (_filter->objtype == FPGA_ACCELERATOR) {
-				return true;
-			}
-		} else {
-			return true;
+	for (i = 0; i < plan->count; ++i) {
+		const opae_filter_clause *clause = &plan->clauses[i];
+		for (j = 0; j < clause->count; ++j) {
+			if (clause->terms[j].field == OPAE_FILTER_OBJTYPE)
+				break;
 		}
+		if (j == clause->count ||
+		    clause->terms[j].value == FPGA_ACCELERATOR)
+			return true;
 	}
 	return false;
 }
 
+static struct _fpga_token *tokens;
+static pthread_mutex_t tokens_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Return the interned token for the device node, with a new reference,
+ * creating it if need be.
+ */
+STATIC struct _fpga_token *token_intern(const char *sysfspath,
+					const char *devpath,
+					uint32_t device_instance,
+					uint32_t subdev_instance)
+{
+	struct _fpga_token *_tok;
+	size_t slen = strnlen(sysfspath, SYSFS_PATH_MAX - 1);
+	size_t dlen = strnlen(devpath, DEV_PATH_MAX - 1);
+	char *p;
+
+	if (pthread_mutex_lock(&tokens_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return NULL;
+	}
+
+	for (_tok = tokens ; _tok ; _tok = _tok->next) {
+		if (!strncmp(_tok->sysfspath, sysfspath, slen) &&
+		    !_tok->sysfspath[slen] &&
+		    !strncmp(_tok->devpath, devpath, dlen) &&
+		    !_tok->devpath[dlen]) {
+			++_tok->ref_count;
+			goto out_unlock;
+		}
+	}
+
+	_tok = malloc(sizeof(struct _fpga_token) + slen + dlen + 2);
+	if (!_tok) {
+		OPAE_ERR("malloc failed");
+		goto out_unlock;
+	}
+
+	/* mark data structure as valid */
+	_tok->magic = FPGA_TOKEN_MAGIC;
+
+	_tok->device_instance = device_instance;
+	_tok->subdev_instance = subdev_instance;
+
+	p = (char *)(_tok + 1);
+	memcpy(p, sysfspath, slen);
+	p[slen] = '\0';
+	_tok->sysfspath = p;
+
+	p += slen + 1;
+	memcpy(p, devpath, dlen);
+	p[dlen] = '\0';
+	_tok->devpath = p;
+
+	_tok->errors = NULL;
+	_tok->errors_built = false;
+	_tok->ref_count = 1;
+
+	_tok->next = tokens;
+	tokens = _tok;
+
+out_unlock:
+	if (pthread_mutex_unlock(&tokens_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	return _tok;
+}
+
 struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 {
-	struct _fpga_token *_tok = NULL;
 	uint32_t device_instance;
 	uint32_t subdev_instance;
 	char *endptr = NULL;
 	const char *ptr;
-	size_t len;
-	char errpath[SYSFS_PATH_MAX] = { 0, };
 
 	//                                    11111111112
 	//                          012345678901234567890
@@ -650,84 +587,44 @@ struct _fpga_token *token_add(const char *sysfspath, const char *devpath)
 		return NULL;
 	}
 
-	_tok = (struct _fpga_token *)malloc(sizeof(struct _fpga_token));
-	if (!_tok) {
-		OPAE_ERR("malloc failed");
-		return NULL;
-	}
-
-	if (snprintf(errpath, sizeof(errpath),
-		     "%s/errors", sysfspath) < 0) {
-		OPAE_ERR("snprintf buffer overflow");
-		free(_tok);
-		return NULL;
-	}
-
-	_tok->errors = NULL;
-	build_error_list(errpath, &_tok->errors);
-
-	/* mark data structure as valid */
-	_tok->magic = FPGA_TOKEN_MAGIC;
-
-	/* assign the instances num from above */
-	_tok->device_instance = device_instance;
-	_tok->subdev_instance = subdev_instance;
-
-	/* deep copy token data */
-	len = strnlen(sysfspath, SYSFS_PATH_MAX - 1);
-	memcpy(_tok->sysfspath, sysfspath, len);
-	_tok->sysfspath[len] = '\0';
-
-	len = strnlen(devpath, DEV_PATH_MAX - 1);
-	memcpy(_tok->devpath, devpath, len);
-	_tok->devpath[len] = '\0';
-
-	return _tok;
+	return token_intern(sysfspath, devpath,
+			    device_instance, subdev_instance);
 }
 
-fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
-				       uint32_t num_filters, fpga_token *tokens,
-				       uint32_t max_tokens,
-				       uint32_t *num_matches)
+/*
+ * Walk the devices once, creating a token for each match. When grow is
+ * set, *tokens is (re)allocated to hold every match and max_tokens is
+ * ignored; otherwise at most max_tokens are stored in the caller's array.
+ */
+STATIC fpga_result enumerate_tokens(const fpga_properties *filters,
+				    uint32_t num_filters, fpga_token **tokens,
+				    uint32_t max_tokens, bool grow,
+				    uint32_t *num_matches)
 {
 	fpga_result result = FPGA_NOT_FOUND;
 
 	struct dev_list head;
 	struct dev_list *lptr;
-
-	if (NULL == num_matches) {
-		OPAE_MSG("num_matches is NULL");
-		return FPGA_INVALID_PARAM;
-	}
-
-	/* requiring a max number of tokens, but not providing a pointer to
-	 * return them through is invalid */
-	if ((max_tokens > 0) && (NULL == tokens)) {
-		OPAE_MSG("max_tokens > 0 with NULL tokens");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if ((num_filters > 0) && (NULL == filters)) {
-		OPAE_MSG("num_filters > 0 with NULL filters");
-		return FPGA_INVALID_PARAM;
-	}
-
-	if (!num_filters && (NULL != filters)) {
-		OPAE_MSG("num_filters == 0 with non-NULL filters");
-		return FPGA_INVALID_PARAM;
-	}
+	opae_filter_plan *plan = NULL;
+	uint32_t i;
 
 	*num_matches = 0;
 
+	// Snapshot the filters once, rather than locking each one
+	// for every device checked.
+	result = opae_filter_plan_compile(filters, num_filters,
+					  parent_key, &plan);
+	if (result != FPGA_OK)
+		return result;
+
 	memset(&head, 0, sizeof(head));
 
 	// enum FPGA regions & resources
-	result = enum_fpga_region_resources(&head,
-				include_afu(filters, num_filters));
+	result = enum_fpga_region_resources(&head, include_afu(plan));
 
 	if (result != FPGA_OK) {
 		OPAE_MSG("No FPGA resources found");
-		return result;
+		goto out_free_trash;
 	}
 
 	/* create and populate token data structures */
@@ -744,28 +641,44 @@ fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
 			continue;
 		}
 
-		if (matches_filters(lptr, filters, num_filters)) {
-			if (*num_matches < max_tokens) {
-
-				tokens[*num_matches] = token_add(lptr->sysfspath, lptr->devpath);
+		if (!matches_filters(lptr, plan))
+			continue;
 
-				if (!tokens[*num_matches]) {
-					uint32_t i;
-					OPAE_ERR("Failed to allocate memory for token");
-					result = FPGA_NO_MEMORY;
+		if (grow && *num_matches == max_tokens) {
+			uint32_t max = max_tokens ? max_tokens * 2 : 8;
+			fpga_token *t = realloc(*tokens,
+						max * sizeof(fpga_token));
+			if (!t) {
+				OPAE_ERR("Failed to allocate memory for tokens");
+				result = FPGA_NO_MEMORY;
+				goto out_free_tokens;
+			}
+			*tokens = t;
+			max_tokens = max;
+		}
 
-					for (i = 0 ; i < *num_matches ; ++i)
-						free(tokens[i]);
-					*num_matches = 0;
+		if (*num_matches < max_tokens) {
 
-					goto out_free_trash;
-				}
+			(*tokens)[*num_matches] =
+				token_add(lptr->sysfspath, lptr->devpath);
 
+			if (!(*tokens)[*num_matches]) {
+				OPAE_ERR("Failed to allocate memory for token");
+				result = FPGA_NO_MEMORY;
+				goto out_free_tokens;
 			}
-			++(*num_matches);
+
 		}
+		++(*num_matches);
 	}
 
+	goto out_free_trash;
+
+out_free_tokens:
+	for (i = 0 ; i < *num_matches ; ++i)
+		xfpga_fpgaDestroyToken(&(*tokens)[i]);
+	*num_matches = 0;
+
 out_free_trash:
 	for (lptr = head.next; NULL != lptr;) {
 		struct dev_list *trash = lptr;
@@ -773,6 +686,73 @@ out_free_trash:
 		free(trash);
 	}
 
+	opae_filter_plan_destroy(plan);
+
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaEnumerate(const fpga_properties *filters,
+				       uint32_t num_filters, fpga_token *tokens,
+				       uint32_t max_tokens,
+				       uint32_t *num_matches)
+{
+	if (NULL == num_matches) {
+		OPAE_MSG("num_matches is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	/* requiring a max number of tokens, but not providing a pointer to
+	 * return them through is invalid */
+	if ((max_tokens > 0) && (NULL == tokens)) {
+		OPAE_MSG("max_tokens > 0 with NULL tokens");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if ((num_filters > 0) && (NULL == filters)) {
+		OPAE_MSG("num_filters > 0 with NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!num_filters && (NULL != filters)) {
+		OPAE_MSG("num_filters == 0 with non-NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	return enumerate_tokens(filters, num_filters, &tokens,
+				max_tokens, false, num_matches);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaEnumerateAll(const fpga_properties *filters,
+						 uint32_t num_filters,
+						 fpga_token **tokens,
+						 uint32_t *num_tokens)
+{
+	fpga_result result;
+
+	if (NULL == tokens || NULL == num_tokens) {
+		OPAE_MSG("tokens or num_tokens is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if ((num_filters > 0) && (NULL == filters)) {
+		OPAE_MSG("num_filters > 0 with NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!num_filters && (NULL != filters)) {
+		OPAE_MSG("num_filters == 0 with non-NULL filters");
+		return FPGA_INVALID_PARAM;
+	}
+
+	*tokens = NULL;
+
+	result = enumerate_tokens(filters, num_filters, tokens,
+				  0, true, num_tokens);
+	if (result != FPGA_OK || !*num_tokens) {
+		free(*tokens);
+		*tokens = NULL;
+	}
+
 	return result;
 }
 
@@ -780,7 +760,6 @@ fpga_result __XFPGA_API__ xfpga_fpgaCloneToken(fpga_token src, fpga_token *dst)
 {
 	struct _fpga_token *_src = (struct _fpga_token *)src;
 	struct _fpga_token *_dst;
-	size_t len;
 
 	if (NULL == src || NULL == dst) {
 		OPAE_MSG("src or dst in NULL");
@@ -792,24 +771,14 @@ fpga_result __XFPGA_API__ xfpga_fpgaCloneToken(fpga_token src, fpga_token *dst)
 		return FPGA_INVALID_PARAM;
 	}
 
-	_dst = calloc(1, sizeof(struct _fpga_token));
+	// A clone is another reference to the same interned token.
+	_dst = token_intern(_src->sysfspath, _src->devpath,
+			    _src->device_instance, _src->subdev_instance);
 	if (NULL == _dst) {
 		OPAE_MSG("Failed to allocate memory for token");
 		return FPGA_NO_MEMORY;
 	}
 
-	_dst->magic = FPGA_TOKEN_MAGIC;
-	_dst->device_instance = _src->device_instance;
-	_dst->subdev_instance = _src->subdev_instance;
-
-	len = strnlen(_src->sysfspath, sizeof(_src->sysfspath) - 1);
-	strncpy(_dst->sysfspath, _src->sysfspath, len + 1);
-
-	len = strnlen(_src->devpath, sizeof(_src->devpath) - 1);
-	strncpy(_dst->devpath, _src->devpath, len + 1);
-
-	_dst->errors = clone_error_list(_src->errors);
-
 	*dst = _dst;
 
 	return FPGA_OK;
@@ -817,8 +786,8 @@ fpga_result __XFPGA_API__ xfpga_fpgaCloneToken(fpga_token src, fpga_token *dst)
 
 fpga_result __XFPGA_API__ xfpga_fpgaDestroyToken(fpga_token *token)
 {
-	struct error_list *err;
 	struct _fpga_token *_token;
+	struct _fpga_token **prev;
 
 	if (NULL == token || NULL == *token) {
 		OPAE_MSG("Invalid token pointer");
@@ -832,13 +801,29 @@ fpga_result __XFPGA_API__ xfpga_fpgaDestroyToken(fpga_token *token)
 		return FPGA_INVALID_PARAM;
 	}
 
-	err = _token->errors;
-	while (err) {
-		struct error_list *trash = err;
-		err = err->next;
-		free(trash);
+	if (_token->ref_count) {
+		if (pthread_mutex_lock(&tokens_lock)) {
+			OPAE_ERR("pthread_mutex_lock() failed");
+			return FPGA_EXCEPTION;
+		}
+
+		if (--_token->ref_count) {
+			if (pthread_mutex_unlock(&tokens_lock))
+				OPAE_ERR("pthread_mutex_unlock() failed");
+			*token = NULL;
+			return FPGA_OK;
+		}
+
+		for (prev = &tokens ; *prev != _token ; prev = &(*prev)->next)
+			;
+		*prev = _token->next;
+
+		if (pthread_mutex_unlock(&tokens_lock))
+			OPAE_ERR("pthread_mutex_unlock() failed");
 	}
 
+	destroy_error_list(_token->errors);
+
 	// invalidate magic (just in case)
 	_token->magic = FPGA_INVALID_MAGIC;
 
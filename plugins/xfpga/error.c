@@ -53,7 +53,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaReadError(fpga_token token, uint32_t error_n
 		return FPGA_INVALID_PARAM;
 	}
 
-	struct error_list *p = _token->errors;
+	struct error_list *p = token_get_errors(_token);
 	while (p) {
 		if (i == error_num) {
 			// test if file exists
@@ -92,7 +92,7 @@ xfpga_fpgaClearError(fpga_token token, uint32_t error_num)
 		return FPGA_INVALID_PARAM;
 	}
 
-	struct error_list *p = _token->errors;
+	struct error_list *p = token_get_errors(_token);
 	while (p) {
 		if (i == error_num) {
 			if (!p->info.can_clear) {
@@ -141,7 +141,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaClearAllErrors(fpga_token token)
 		return FPGA_INVALID_PARAM;
 	}
 
-	struct error_list *p = _token->errors;
+	struct error_list *p = token_get_errors(_token);
 	while (p) {
 		// if error can be cleared
 		if (p->info.can_clear) {
@@ -175,7 +175,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaGetErrorInfo(fpga_token token,
 		return FPGA_INVALID_PARAM;
 	}
 
-	struct error_list *p = _token->errors;
+	struct error_list *p = token_get_errors(_token);
 	while (p) {
 		if (i == error_num) {
 			memcpy(error_info, &p->info, sizeof(struct fpga_error_info));
@@ -210,10 +210,8 @@ const char *errors_clearable[] = {
 };
 
 /* Walks the given directory and adds error entries to `list`.
- * This function is called during enumeration when adding tokens to
- * the global tokens list. When tokens are cloned, their error
- * lists are only shallowly copied (which works because errors of
- * a token never change).
+ * This function is called by token_get_errors() the first time a
+ * token's errors are needed. Clones share the token, and so its list.
  * Note that build_error_list() does not check for dupliates; if
  * called again on the same list, it will add all found errors again.
  * Returns the number of error entries added to `list` */
@@ -372,34 +370,57 @@ uint32_t count_error_files(const char *path)
 	return build_error_list(path, NULL);
 }
 
-struct error_list *clone_error_list(struct error_list *src)
+void destroy_error_list(struct error_list *list)
 {
-	struct error_list *clone = NULL;
-	struct error_list **plist = &clone;
-
-	while (src) {
-		struct error_list *p = malloc(sizeof(struct error_list));
-		if (!p) {
-			OPAE_ERR("malloc failed");
-			goto free_list;
-		}
+	while (list) {
+		struct error_list *trash = list;
+		list = list->next;
+		free(trash);
+	}
+}
 
-		*p = *src;
-		p->next = NULL;
+static pthread_mutex_t errors_lock = PTHREAD_MUTEX_INITIALIZER;
 
-		*plist = p;
-		plist = &p->next;
+struct error_list *token_get_errors(struct _fpga_token *_token)
+{
+	struct error_list *list = NULL;
+	char errpath[SYSFS_PATH_MAX];
+	bool built;
 
-		src = src->next;
+	if (pthread_mutex_lock(&errors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return NULL;
 	}
+	built = _token->errors_built;
+	if (pthread_mutex_unlock(&errors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	if (built)
+		return _token->errors;
+
+	// Walk sysfs without the lock; should another thread get there
+	// first, keep its list and drop this one.
+	if (snprintf(errpath, sizeof(errpath),
+		     "%s/errors", _token->sysfspath) < 0) {
+		OPAE_ERR("snprintf buffer overflow");
+		return NULL;
+	}
+	build_error_list(errpath, &list);
 
-	return clone;
-
-free_list:
-	while (clone) {
-		struct error_list *trash = clone;
-		clone = clone->next;
-		free(trash);
+	if (pthread_mutex_lock(&errors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		destroy_error_list(list);
+		return NULL;
+	}
+	if (!_token->errors_built) {
+		_token->errors = list;
+		list = NULL;
 	}
-	return NULL;
+	_token->errors_built = true;
+	if (pthread_mutex_unlock(&errors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	destroy_error_list(list);
+
+	return _token->errors;
 }
@@ -42,9 +42,13 @@ struct error_list {
 	char clear_file[SYSFS_PATH_MAX];
 };
 
+struct _fpga_token;
+
 uint32_t count_error_files(const char *path);
 uint32_t build_error_list(const char *path, struct error_list **list);
-struct error_list *clone_error_list(struct error_list *src);
+void destroy_error_list(struct error_list *list);
+// The token's errors, built on first use.
+struct error_list *token_get_errors(struct _fpga_token *_token);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -33,8 +33,6 @@
 #endif // _GNU_SOURCE
 
 #include <string.h>
-#include <sys/socket.h>
-#include <sys/un.h>
 #include <sys/eventfd.h>
 #include <errno.h>
 
@@ -44,54 +42,8 @@
 #include "opae_drv.h"
 #include "types_int.h"
 #include "intel-fpga.h"
-
-#define EVENT_SOCKET_NAME "/tmp/fpga_event_socket"
-#define EVENT_SOCKET_NAME_LEN 23
-
-enum request_type { REGISTER_EVENT = 0, UNREGISTER_EVENT = 1 };
-
-struct event_request {
-	enum request_type type;
-	fpga_event_type event;
-	uint64_t object_id;
-};
-
-fpga_result send_event_request(int conn_socket, int fd,
-			       struct event_request *req)
-{
-	struct msghdr mh;
-	struct cmsghdr *cmh;
-	struct iovec iov[1];
-	char buf[CMSG_SPACE(sizeof(int))];
-	ssize_t n;
-	int *fd_ptr;
-
-	/* set up ancillary data message header */
-	iov[0].iov_base = req;
-	iov[0].iov_len = sizeof(*req);
-	memset(buf, 0, sizeof(buf));
-	mh.msg_name = NULL;
-	mh.msg_namelen = 0;
-	mh.msg_iov = iov;
-	mh.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
-	mh.msg_control = buf;
-	mh.msg_controllen = CMSG_LEN(sizeof(int));
-	mh.msg_flags = 0;
-	cmh = CMSG_FIRSTHDR(&mh);
-	cmh->cmsg_len = CMSG_LEN(sizeof(int));
-	cmh->cmsg_level = SOL_SOCKET;
-	cmh->cmsg_type = SCM_RIGHTS;
-	fd_ptr = (int *)CMSG_DATA(cmh);
-	*fd_ptr = fd;
-	/* send ancillary data */
-	n = sendmsg(conn_socket, &mh, 0);
-	if (n < 0) {
-		OPAE_ERR("sendmsg failed: %s", strerror(errno));
-		return FPGA_EXCEPTION;
-	}
-
-	return FPGA_OK;
-}
+#include "power_thermal_int.h"
+#include "fpgad_conn_int.h"
 
 STATIC fpga_result send_fme_event_request(fpga_handle handle,
 					  fpga_event_handle event_handle,
@@ -164,6 +116,53 @@ STATIC fpga_result send_port_event_request(fpga_handle handle,
 	return res;
 }
 
+/*
+ * Learn how many user interrupts the port has, once per handle, and
+ * allocate the bitmap of assigned vectors.
+ */
+STATIC fpga_result uafu_irqs_probe(struct _fpga_handle *_handle)
+{
+	fpga_result res;
+	uint32_t num_irqs = 0;
+
+	if (_handle->num_irqs)
+		return FPGA_OK;
+
+	res = opae_dfl_port_get_user_irq(_handle->fddev, &num_irqs);
+	if (res) {
+		OPAE_ERR("Invalid param or not supported");
+		return res;
+	}
+	if (!num_irqs) {
+		OPAE_ERR("Port user interrupts not supported in hw");
+		return FPGA_NOT_SUPPORTED;
+	}
+
+	_handle->irq_set = calloc((num_irqs + 63) / 64, sizeof(uint64_t));
+	if (!_handle->irq_set) {
+		OPAE_ERR("Could not allocate IRQ bitmap");
+		return FPGA_NO_MEMORY;
+	}
+	_handle->num_irqs = num_irqs;
+
+	return FPGA_OK;
+}
+
+static inline bool irq_is_set(const struct _fpga_handle *_handle,
+			      uint32_t irq)
+{
+	return _handle->irq_set[irq / 64] & (1ULL << (irq % 64));
+}
+
+static inline void irq_mark(struct _fpga_handle *_handle, uint32_t irq,
+			    bool set)
+{
+	if (set)
+		_handle->irq_set[irq / 64] |= 1ULL << (irq % 64);
+	else
+		_handle->irq_set[irq / 64] &= ~(1ULL << (irq % 64));
+}
+
 STATIC fpga_result send_uafu_event_request(fpga_handle handle,
 					   fpga_event_handle event_handle,
 					   uint32_t flags, int uafu_operation)
@@ -174,9 +173,7 @@ STATIC fpga_result send_uafu_event_request(fpga_handle handle,
 	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
 	struct _fpga_event_handle *_eh =
 		(struct _fpga_event_handle *)event_handle;
-	uint32_t num_irqs = 0;
 	int32_t neg = -1;
-	UNUSED_PARAM(flags);
 
 	if (uafu_operation != FPGA_IRQ_ASSIGN
 	    && uafu_operation != FPGA_IRQ_DEASSIGN) {
@@ -184,18 +181,9 @@ STATIC fpga_result send_uafu_event_request(fpga_handle handle,
 		return FPGA_INVALID_PARAM;
 	}
 
-	if (!_handle->num_irqs) {
-		res = opae_dfl_port_get_user_irq(_handle->fddev, &num_irqs);
-		if (res) {
-			OPAE_ERR("Invalid param or not supported");
-			return res;
-		}
-		if (!num_irqs) {
-			OPAE_ERR("Port user interrupts not supported in hw");
-			return FPGA_NOT_SUPPORTED;
-		}
-		_handle->num_irqs = num_irqs;
-	}
+	res = uafu_irqs_probe(_handle);
+	if (res)
+		return res;
 
 	switch (uafu_operation) {
 	case FPGA_IRQ_ASSIGN:
@@ -203,27 +191,24 @@ STATIC fpga_result send_uafu_event_request(fpga_handle handle,
 			OPAE_ERR("Max IRQs reached");
 			return FPGA_INVALID_PARAM;
 		}
-		if (_handle->irq_set & (1 << flags)) {
+		if (irq_is_set(_handle, flags)) {
 			OPAE_ERR("IRQ index already in use");
 			return FPGA_INVALID_PARAM;
 		}
-		data = &fd;
 		// assigning irq uses flags as the irq num.
-		// set the bit in the handle irq set
-		// and stash the number in the event handle
-		_handle->irq_set |= (1 << flags);
-		_eh->flags = flags;
+		data = &fd;
 		break;
 	case FPGA_IRQ_DEASSIGN:
 		// unassigning has flags set to 0
 		// get the irq number from the event handle
 		flags = _eh->flags;
-		if (!(_handle->irq_set & (1 << flags))) {
+		if (flags >= _handle->num_irqs ||
+		    !irq_is_set(_handle, flags)) {
 			OPAE_DBG("IRQ not assigned");
 			return FPGA_INVALID_PARAM;
 		}
 		data = &neg;
-		_handle->irq_set &= ~(1 << flags);
+		irq_mark(_handle, flags, false);
 		break;
 	default:
 		OPAE_ERR("Invalid uafu operation");
@@ -233,59 +218,36 @@ STATIC fpga_result send_uafu_event_request(fpga_handle handle,
 
 	if (res) {
 		OPAE_ERR("Could not set eventfd");
-		res = FPGA_EXCEPTION;
+		return FPGA_EXCEPTION;
+	}
+
+	if (uafu_operation == FPGA_IRQ_ASSIGN) {
+		// set the bit in the handle irq set
+		// and stash the number in the event handle
+		irq_mark(_handle, flags, true);
+		_eh->flags = flags;
 	}
 
 	return res;
 }
 
+/*
+ * Only accelerators have user interrupts. The object type is cached in
+ * the handle, and the vector count after the first call.
+ */
 STATIC fpga_result check_user_interrupts_supported(fpga_handle handle,
 	fpga_objtype *objtype)
 {
-	fpga_result res = FPGA_OK;
-	fpga_result destroy_res = FPGA_OK;
-	fpga_properties prop = NULL;
 	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
-	uint32_t num_irqs = 0;
 
-	res = xfpga_fpgaGetPropertiesFromHandle(handle, &prop);
-	if (res != FPGA_OK) {
-		OPAE_ERR("Could not get FPGA properties from handle");
-		return res;
-	}
-
-	res = fpgaPropertiesGetObjectType(prop, objtype);
-	if (res != FPGA_OK) {
-		OPAE_ERR("Could not determine FPGA object type");
-		goto destroy_prop;
-	}
+	*objtype = _handle->objtype;
 
 	if (*objtype == FPGA_DEVICE) {
-			OPAE_MSG("Interrupts not supported in hw");
-			res = FPGA_NOT_SUPPORTED;
-	} else if (*objtype == FPGA_ACCELERATOR) {
-		res = opae_dfl_port_get_user_irq(_handle->fddev, &num_irqs);
-		if (res) {
-			OPAE_ERR("Interrupts not supported in hw: %d", res);
-			goto destroy_prop;
-		}
-
-		if (num_irqs > 0) {
-			res = FPGA_OK;
-		} else {
-			OPAE_ERR("Interrupts not supported in hw: %d", res);
-			res = FPGA_NOT_SUPPORTED;
-		}
-	}
-
-destroy_prop:
-	destroy_res = fpgaDestroyProperties(&prop);
-	if (destroy_res != FPGA_OK) {
-		OPAE_MSG("Could not destroy FPGA properties");
-		return destroy_res;
+		OPAE_MSG("Interrupts not supported in hw");
+		return FPGA_NOT_SUPPORTED;
 	}
 
-	return res;
+	return uafu_irqs_probe(_handle);
 }
 
 /*
@@ -394,7 +356,7 @@ STATIC fpga_result driver_register_event(fpga_handle handle,
 		return send_uafu_event_request(handle, event_handle, flags,
 					       FPGA_IRQ_ASSIGN);
 	case FPGA_EVENT_POWER_THERMAL:
-		OPAE_MSG("Thermal interrupts not supported");
+		// No driver interrupt; see daemon_register_event().
 		return FPGA_NOT_SUPPORTED;
 	default:
 		OPAE_ERR("Invalid event type");
@@ -444,7 +406,6 @@ STATIC fpga_result driver_unregister_event(fpga_handle handle,
 		return send_uafu_event_request(handle, event_handle, 0,
 					       FPGA_IRQ_DEASSIGN);
 	case FPGA_EVENT_POWER_THERMAL:
-		OPAE_MSG("Thermal interrupts not supported");
 		return FPGA_NOT_SUPPORTED;
 	default:
 		OPAE_ERR("Invalid event type");
@@ -452,135 +413,77 @@ STATIC fpga_result driver_unregister_event(fpga_handle handle,
 	}
 }
 
-STATIC fpga_result daemon_register_event(fpga_handle handle,
-					 fpga_event_type event_type,
-					 fpga_event_handle event_handle,
-					 uint32_t flags)
+/*
+ * Look up the object ID by which fpgad knows the handle's resource.
+ */
+STATIC fpga_result daemon_object_id(fpga_handle handle, uint64_t *object_id)
 {
-	int fd = FILE_DESCRIPTOR(event_handle);
-	fpga_result result = FPGA_OK;
-	struct sockaddr_un addr;
-	struct event_request req;
-	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	fpga_result result;
 	fpga_properties prop = NULL;
-	uint64_t object_id = (uint64_t) -1;
-
-	UNUSED_PARAM(flags);
-
-	if (_handle->fdfpgad < 0) {
-
-		/* connect to event socket */
-		_handle->fdfpgad = socket(AF_UNIX, SOCK_STREAM, 0);
-		if (_handle->fdfpgad < 0) {
-			OPAE_ERR("socket: %s", strerror(errno));
-			return FPGA_EXCEPTION;
-		}
 
-		addr.sun_family = AF_UNIX;
-		strncpy(addr.sun_path, EVENT_SOCKET_NAME,
-			EVENT_SOCKET_NAME_LEN);
-
-		if (connect(_handle->fdfpgad, (struct sockaddr *)&addr,
-			    sizeof(addr))
-		    < 0) {
-			OPAE_DBG("connect: %s", strerror(errno));
-			result = FPGA_NO_DAEMON;
-			goto out_close_conn;
-		}
-	}
-
-	/* get the requestor's object ID */
 	result = xfpga_fpgaGetPropertiesFromHandle(handle, &prop);
 	if (result != FPGA_OK) {
 		OPAE_ERR("failed to get props");
-		goto out_close_conn;
+		return result;
 	}
 
-	result = fpgaPropertiesGetObjectID(prop, &object_id);
+	result = fpgaPropertiesGetObjectID(prop, object_id);
 	if (result != FPGA_OK) {
 		fpgaDestroyProperties(&prop);
 		OPAE_ERR("failed to get object ID");
-		goto out_close_conn;
+		return result;
 	}
 
 	result = fpgaDestroyProperties(&prop);
-	if (result != FPGA_OK) {
+	if (result != FPGA_OK)
 		OPAE_ERR("failed to destroy props");
-		goto out_close_conn;
-	}
-
-	/* create event registration request */
-	req.type = REGISTER_EVENT;
-	req.event = event_type;
-	req.object_id = object_id;
-
-	/* send event packet */
-	result = send_event_request(_handle->fdfpgad, fd, &req);
-	if (result != FPGA_OK) {
-		OPAE_ERR("send_event_request failed");
-		goto out_close_conn;
-	}
-
-	return result;
 
-out_close_conn:
-	close(_handle->fdfpgad);
-	_handle->fdfpgad = -1;
 	return result;
 }
 
-STATIC fpga_result daemon_unregister_event(fpga_handle handle,
-					   fpga_event_type event_type)
+STATIC fpga_result daemon_register_event(fpga_handle handle,
+					 fpga_event_type event_type,
+					 fpga_event_handle event_handle,
+					 uint32_t flags)
 {
-	fpga_result result = FPGA_OK;
-	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
-	struct event_request req;
-	ssize_t n;
-	fpga_properties prop = NULL;
+	fpga_result result;
 	uint64_t object_id = (uint64_t) -1;
 
-	if (_handle->fdfpgad < 0) {
-		OPAE_MSG("No fpgad connection");
-		return FPGA_INVALID_PARAM;
-	}
-
 	/* get the requestor's object ID */
-	result = xfpga_fpgaGetPropertiesFromHandle(handle, &prop);
-	if (result != FPGA_OK) {
-		OPAE_ERR("failed to get properties");
-		goto out_close_conn;
-	}
+	result = daemon_object_id(handle, &object_id);
+	if (result != FPGA_OK)
+		return result;
 
-	result = fpgaPropertiesGetObjectID(prop, &object_id);
-	if (result != FPGA_OK) {
-		fpgaDestroyProperties(&prop);
-		OPAE_ERR("failed to get object ID");
-		goto out_close_conn;
+	result = fpgad_conn_register(handle, event_handle, event_type,
+				     object_id);
+	if (result == FPGA_NO_DAEMON &&
+	    event_type == FPGA_EVENT_POWER_THERMAL) {
+		// Without fpgad, poll the sensors in-process instead.
+		result = power_thermal_register(handle, event_handle, flags);
+		if (result == FPGA_NOT_SUPPORTED)
+			result = FPGA_NO_DAEMON;
+	} else if (result == FPGA_NO_DAEMON) {
+		OPAE_DBG("no fpgad to proxy the event");
+	} else if (result != FPGA_OK) {
+		OPAE_ERR("fpgad registration failed");
 	}
 
-	result = fpgaDestroyProperties(&prop);
-	if (result != FPGA_OK) {
-		OPAE_ERR("failed to destroy properties");
-		goto out_close_conn;
-	}
+	return result;
+}
 
-	req.type = UNREGISTER_EVENT;
-	req.event = event_type;
-	req.object_id = object_id;
+STATIC fpga_result daemon_unregister_event(fpga_handle handle,
+					   fpga_event_type event_type,
+					   fpga_event_handle event_handle)
+{
+	fpga_result result;
 
-	n = send(_handle->fdfpgad, &req, sizeof(req), 0);
-	if (n < 0) {
-		OPAE_ERR("send : %s", strerror(errno));
-		result = FPGA_EXCEPTION;
-		goto out_close_conn;
+	if (event_type == FPGA_EVENT_POWER_THERMAL) {
+		result = power_thermal_unregister(handle, event_handle);
+		if (result != FPGA_NOT_FOUND)
+			return result;
 	}
 
-	return result;
-
-out_close_conn:
-	close(_handle->fdfpgad);
-	_handle->fdfpgad = -1;
-	return result;
+	return fpgad_conn_unregister(handle, event_handle, event_type);
 }
 
 fpga_result __XFPGA_API__
@@ -816,7 +719,8 @@ xfpga_fpgaUnregisterEvent(fpga_handle handle, fpga_event_type event_type,
 	/* try driver first */
 	result = driver_unregister_event(handle, event_type, event_handle);
 	if (result == FPGA_NOT_SUPPORTED) {
-		result = daemon_unregister_event(handle, event_type);
+		result = daemon_unregister_event(handle, event_type,
+						 event_handle);
 	}
 
 out_unlock:
@@ -831,3 +735,225 @@ out_unlock_handle:
 
 	return result;
 }
+
+/*
+ * Lock count event handles, in order. On failure, those already locked
+ * are unlocked again.
+ */
+STATIC fpga_result event_handles_check_and_lock(uint32_t count,
+					fpga_event_handle *event_handles)
+{
+	fpga_result result;
+	uint32_t i;
+
+	for (i = 0 ; i < count ; ++i) {
+		result = event_handle_check_and_lock(
+			(struct _fpga_event_handle *)event_handles[i]);
+		if (result)
+			break;
+	}
+
+	if (i == count)
+		return FPGA_OK;
+
+	while (i--)
+		pthread_mutex_unlock(
+			&((struct _fpga_event_handle *)event_handles[i])->lock);
+
+	return result;
+}
+
+STATIC void event_handles_unlock(uint32_t count,
+				 fpga_event_handle *event_handles)
+{
+	uint32_t i;
+	int err;
+
+	for (i = 0 ; i < count ; ++i) {
+		err = pthread_mutex_unlock(
+			&((struct _fpga_event_handle *)event_handles[i])->lock);
+		if (err)
+			OPAE_ERR("pthread_mutex_unlock() failed: %s",
+				 strerror(err));
+	}
+}
+
+fpga_result __XFPGA_API__
+xfpga_fpgaRegisterInterruptEvents(fpga_handle handle,
+				  uint32_t start, uint32_t count,
+				  fpga_event_handle *event_handles)
+{
+	fpga_result result = FPGA_OK;
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	int32_t *fds = NULL;
+	uint32_t i;
+	int err;
+
+	ASSERT_NOT_NULL(event_handles);
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	if (_handle->objtype != FPGA_ACCELERATOR) {
+		OPAE_MSG("Handle does not refer to accelerator object");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock_handle;
+	}
+
+	result = uafu_irqs_probe(_handle);
+	if (result)
+		goto out_unlock_handle;
+
+	if (start >= _handle->num_irqs ||
+	    count > _handle->num_irqs - start) {
+		OPAE_ERR("IRQ range [%u, %u) exceeds the %u vectors",
+			 start, start + count, _handle->num_irqs);
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock_handle;
+	}
+
+	for (i = start ; i < start + count ; ++i) {
+		if (irq_is_set(_handle, i)) {
+			OPAE_ERR("IRQ index %u already in use", i);
+			result = FPGA_INVALID_PARAM;
+			goto out_unlock_handle;
+		}
+	}
+
+	fds = calloc(count, sizeof(int32_t));
+	if (!fds) {
+		OPAE_ERR("Could not allocate eventfd array");
+		result = FPGA_NO_MEMORY;
+		goto out_unlock_handle;
+	}
+
+	result = event_handles_check_and_lock(count, event_handles);
+	if (result)
+		goto out_free;
+
+	for (i = 0 ; i < count ; ++i)
+		fds[i] = FILE_DESCRIPTOR(event_handles[i]);
+
+	// One request assigns the whole range.
+	if (opae_dfl_port_set_user_irq(_handle->fddev, start, count, fds)) {
+		OPAE_ERR("Could not set eventfds");
+		result = FPGA_EXCEPTION;
+		goto out_unlock;
+	}
+
+	for (i = 0 ; i < count ; ++i) {
+		irq_mark(_handle, start + i, true);
+		((struct _fpga_event_handle *)event_handles[i])->flags =
+			start + i;
+	}
+
+out_unlock:
+	event_handles_unlock(count, event_handles);
+
+out_free:
+	free(fds);
+
+out_unlock_handle:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+
+	return result;
+}
+
+fpga_result __XFPGA_API__
+xfpga_fpgaUnregisterInterruptEvents(fpga_handle handle,
+				    uint32_t count,
+				    fpga_event_handle *event_handles)
+{
+	fpga_result result = FPGA_OK;
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	uint32_t *irqs = NULL;
+	int32_t *neg = NULL;
+	uint32_t i;
+	uint32_t run;
+	int err;
+
+	ASSERT_NOT_NULL(event_handles);
+	if (!count) {
+		OPAE_ERR("count is 0");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	if (_handle->objtype != FPGA_ACCELERATOR) {
+		OPAE_MSG("Handle does not refer to accelerator object");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock_handle;
+	}
+
+	if (!_handle->num_irqs) {
+		OPAE_DBG("IRQ not assigned");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock_handle;
+	}
+
+	irqs = calloc(count, sizeof(uint32_t));
+	neg = malloc(count * sizeof(int32_t));
+	if (!irqs || !neg) {
+		OPAE_ERR("Could not allocate IRQ arrays");
+		result = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+	memset(neg, 0xff, count * sizeof(int32_t));
+
+	result = event_handles_check_and_lock(count, event_handles);
+	if (result)
+		goto out_free;
+
+	for (i = 0 ; i < count ; ++i) {
+		irqs[i] = ((struct _fpga_event_handle *)event_handles[i])->flags;
+		if (irqs[i] >= _handle->num_irqs ||
+		    !irq_is_set(_handle, irqs[i])) {
+			OPAE_DBG("IRQ not assigned");
+			result = FPGA_INVALID_PARAM;
+			goto out_unlock;
+		}
+	}
+
+	// Release each run of consecutive vectors with one request. Keep
+	// going after a failure, and report the first one.
+	for (i = 0 ; i < count ; i += run) {
+		for (run = 1 ; i + run < count ; ++run) {
+			if (irqs[i + run] != irqs[i] + run)
+				break;
+		}
+
+		if (opae_dfl_port_set_user_irq(_handle->fddev, irqs[i],
+					       run, neg)) {
+			OPAE_ERR("Could not clear eventfds");
+			if (result == FPGA_OK)
+				result = FPGA_EXCEPTION;
+		}
+	}
+
+	for (i = 0 ; i < count ; ++i)
+		irq_mark(_handle, irqs[i], false);
+
+out_unlock:
+	event_handles_unlock(count, event_handles);
+
+out_free:
+	free(neg);
+	free(irqs);
+
+out_unlock_handle:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err)
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+
+	return result;
+}
@@ -0,0 +1,757 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "common_int.h"
+#include "types_int.h"
+#include "fpgad_conn_int.h"
+
+// How long a new shared connection waits for the daemon's hello. Only
+// paid when batching was asked for, and once per connection.
+#define FPGAD_HELLO_TIMEOUT_MS 50
+
+struct fpgad_reg {
+	fpga_handle handle;
+	fpga_event_handle event_handle;
+	fpga_event_type event;
+	uint64_t object_id;
+	uint64_t cookie;
+	uint32_t seq; // of the batch that registered it
+	int fd; // dup() of the eventfd, kept for registering again
+	struct fpgad_peer *peer; // for an fpgad without batches, or NULL
+	struct fpgad_reg *next;
+};
+
+/*
+ * A handle's own connection to an fpgad without batches. Such a daemon
+ * unregisters by event and object ID within a connection, so as before
+ * batching, each handle talks to it on a connection of its own.
+ */
+struct fpgad_peer {
+	fpga_handle handle;
+	int sock;
+	uint32_t refs; // registrations made on it
+	struct fpgad_peer *next;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int sock;      // shared connection, used only for batches
+	bool batched;  // the daemon said hello
+	bool greeting; // connecting, and expecting the hello
+	bool legacy;   // the daemon did not say hello; don't wait again
+	uint32_t seq;
+	uint8_t rx[sizeof(struct fpgad_event_reply)];
+	size_t rx_len;
+	uint64_t next_cookie;
+	struct fpgad_reg *regs;
+	struct fpgad_peer *peers;
+} conn = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.sock = -1,
+};
+
+static void fpgad_conn_close(void)
+{
+	if (conn.sock >= 0)
+		close(conn.sock);
+	conn.sock = -1;
+	conn.batched = false;
+	conn.rx_len = 0;
+}
+
+static void fpgad_reg_free(struct fpgad_reg *r)
+{
+	close(r->fd);
+	free(r);
+}
+
+/*
+ * The daemon refused a batch, which it then applied none of. Forget
+ * the registrations the batch carried, so that they are not replayed
+ * and unregistering them reports that they are not registered.
+ */
+static void fpgad_conn_refused(uint32_t seq, int32_t result)
+{
+	struct fpgad_reg **pr = &conn.regs;
+	struct fpgad_reg *r;
+	uint32_t dropped = 0;
+
+	while (*pr) {
+		r = *pr;
+		if (!r->peer && r->seq == seq) {
+			*pr = r->next;
+			fpgad_reg_free(r);
+			++dropped;
+		} else {
+			pr = &r->next;
+		}
+	}
+
+	OPAE_ERR("fpgad failed request batch %u: %s",
+		 seq, fpgaErrStr((fpga_result)result));
+	if (dropped)
+		OPAE_ERR("dropped %u event registration(s) refused by fpgad",
+			 dropped);
+}
+
+static void fpgad_conn_reply(const struct fpgad_event_reply *reply)
+{
+	if (reply->magic != FPGAD_EVENT_MAGIC) {
+		OPAE_ERR("bad reply from fpgad");
+		fpgad_conn_close();
+		return;
+	}
+
+	switch (reply->kind) {
+	case FPGAD_REPLY_HELLO:
+		if (conn.greeting) {
+			conn.batched = reply->value >= FPGAD_EVENT_VERSION;
+		} else {
+			OPAE_MSG("ignoring late hello from fpgad");
+		}
+		break;
+	case FPGAD_REPLY_ACK:
+		if (reply->result != FPGA_OK)
+			fpgad_conn_refused(reply->value, reply->result);
+		break;
+	default:
+		OPAE_DBG("ignoring fpgad reply kind %u", reply->kind);
+		break;
+	}
+}
+
+/*
+ * Consume whatever the daemon has sent on the shared connection,
+ * waiting up to timeout_ms for the first of it. Notices a closed
+ * connection.
+ */
+static void fpgad_conn_drain(int timeout_ms)
+{
+	struct pollfd pfd;
+	ssize_t n;
+
+	pfd.fd = conn.sock;
+	pfd.events = POLLIN;
+
+	while (conn.sock >= 0) {
+		pfd.revents = 0;
+		if (poll(&pfd, 1, timeout_ms) <= 0)
+			return;
+		timeout_ms = 0;
+
+		n = recv(conn.sock, conn.rx + conn.rx_len,
+			 sizeof(conn.rx) - conn.rx_len, MSG_DONTWAIT);
+		if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+			OPAE_DBG("fpgad connection closed");
+			fpgad_conn_close();
+			return;
+		}
+		if (n < 0)
+			continue;
+
+		conn.rx_len += n;
+		if (conn.rx_len == sizeof(conn.rx)) {
+			conn.rx_len = 0;
+			fpgad_conn_reply((struct fpgad_event_reply *)conn.rx);
+		}
+	}
+}
+
+// Connect a new socket to fpgad.
+static fpga_result fpgad_conn_open(int *sock)
+{
+	struct sockaddr_un addr;
+	const char *path = getenv(FPGAD_EVENT_SOCKET_ENV);
+
+	if (!path)
+		path = FPGAD_EVENT_SOCKET;
+
+	*sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (*sock < 0) {
+		OPAE_ERR("socket: %s", strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+	if (connect(*sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		OPAE_DBG("connect: %s", strerror(errno));
+		close(*sock);
+		*sock = -1;
+		return FPGA_NO_DAEMON;
+	}
+
+	return FPGA_OK;
+}
+
+/*
+ * Open the shared connection. A daemon that doesn't greet it within
+ * FPGAD_HELLO_TIMEOUT_MS predates batching: remember that, and return
+ * FPGA_NOT_SUPPORTED so that the caller uses a connection of its own.
+ */
+static fpga_result fpgad_conn_connect(void)
+{
+	fpga_result res;
+
+	res = fpgad_conn_open(&conn.sock);
+	if (res != FPGA_OK)
+		return res;
+
+	conn.greeting = true;
+	fpgad_conn_drain(FPGAD_HELLO_TIMEOUT_MS);
+	conn.greeting = false;
+	if (conn.sock < 0)
+		return FPGA_NO_DAEMON;
+
+	if (!conn.batched) {
+		OPAE_MSG("fpgad does not batch; using a connection per handle");
+		fpgad_conn_close();
+		conn.legacy = true;
+		return FPGA_NOT_SUPPORTED;
+	}
+
+	return FPGA_OK;
+}
+
+// Whether new registrations go out in batches on the shared connection.
+static bool fpgad_conn_batching(void)
+{
+	const char *batch = getenv(FPGAD_EVENT_BATCH_ENV);
+
+	return !conn.legacy && batch && *batch && strcmp(batch, "0");
+}
+
+static fpga_result fpgad_conn_sendmsg(int sock, void *data, size_t len,
+				      const int *fds, uint32_t num_fds)
+{
+	union {
+		char buf[CMSG_SPACE(sizeof(int) * FPGAD_EVENT_BATCH_MAX)];
+		struct cmsghdr align;
+	} u;
+	struct msghdr mh;
+	struct cmsghdr *cmh;
+	struct iovec iov;
+	ssize_t n;
+
+	iov.iov_base = data;
+	iov.iov_len = len;
+	memset(&mh, 0, sizeof(mh));
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+
+	if (num_fds) {
+		memset(u.buf, 0, sizeof(u.buf));
+		mh.msg_control = u.buf;
+		mh.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
+		cmh = CMSG_FIRSTHDR(&mh);
+		cmh->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
+		cmh->cmsg_level = SOL_SOCKET;
+		cmh->cmsg_type = SCM_RIGHTS;
+		memcpy(CMSG_DATA(cmh), fds, sizeof(int) * num_fds);
+	}
+
+	n = sendmsg(sock, &mh, MSG_NOSIGNAL);
+	if (n != (ssize_t)len) {
+		OPAE_DBG("sendmsg failed: %s", strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+
+	return FPGA_OK;
+}
+
+/*
+ * The connection of handle to an fpgad without batches, connected if
+ * need be, with a reference taken for one registration. Called with
+ * conn.lock held.
+ */
+static struct fpgad_peer *fpgad_peer_get(fpga_handle handle,
+					 fpga_result *res)
+{
+	struct fpgad_peer *p;
+
+	for (p = conn.peers ; p ; p = p->next) {
+		if (p->handle == handle)
+			break;
+	}
+
+	if (!p) {
+		p = calloc(1, sizeof(struct fpgad_peer));
+		if (!p) {
+			OPAE_ERR("Could not allocate fpgad connection");
+			*res = FPGA_NO_MEMORY;
+			return NULL;
+		}
+		p->handle = handle;
+		p->sock = -1;
+		p->next = conn.peers;
+		conn.peers = p;
+	}
+
+	++p->refs;
+
+	*res = FPGA_OK;
+	if (p->sock < 0)
+		*res = fpgad_conn_open(&p->sock);
+
+	return p;
+}
+
+// Drop a registration's reference, closing the last one's connection.
+static void fpgad_peer_put(struct fpgad_peer *p)
+{
+	struct fpgad_peer **pp;
+
+	if (--p->refs)
+		return;
+
+	for (pp = &conn.peers ; *pp != p ; pp = &(*pp)->next)
+		;
+	*pp = p->next;
+
+	if (p->sock >= 0)
+		close(p->sock);
+	free(p);
+}
+
+// One fpgad_event_request on r's handle's connection, which any fpgad
+// understands.
+static fpga_result fpgad_conn_send_single(enum fpgad_request_type type,
+					  struct fpgad_reg *r)
+{
+	struct fpgad_event_request req;
+
+	memset(&req, 0, sizeof(req));
+	req.type = type;
+	req.event = r->event;
+	req.object_id = r->object_id;
+
+	return fpgad_conn_sendmsg(r->peer->sock, &req, sizeof(req), &r->fd,
+				  type == FPGAD_REGISTER_EVENT ? 1 : 0);
+}
+
+static fpga_result fpgad_conn_send_batches(enum fpgad_request_type type,
+					   struct fpgad_reg **regs,
+					   uint32_t count)
+{
+	struct {
+		struct fpgad_event_batch hdr;
+		struct fpgad_event_entry entries[FPGAD_EVENT_BATCH_MAX];
+	} msg;
+	int fds[FPGAD_EVENT_BATCH_MAX];
+	fpga_result res;
+	uint32_t done;
+	uint32_t n;
+	uint32_t i;
+
+	for (done = 0 ; done < count ; done += n) {
+		n = count - done;
+		if (n > FPGAD_EVENT_BATCH_MAX)
+			n = FPGAD_EVENT_BATCH_MAX;
+
+		memset(&msg, 0, sizeof(msg.hdr) + n * sizeof(msg.entries[0]));
+		msg.hdr.magic = FPGAD_EVENT_MAGIC;
+		msg.hdr.type = type;
+		msg.hdr.seq = conn.seq++;
+		msg.hdr.count = n;
+
+		for (i = 0 ; i < n ; ++i) {
+			struct fpgad_reg *r = regs[done + i];
+
+			msg.entries[i].event = r->event;
+			msg.entries[i].object_id = r->object_id;
+			msg.entries[i].cookie = r->cookie;
+			fds[i] = r->fd;
+			if (type == FPGAD_REGISTER_EVENT)
+				r->seq = msg.hdr.seq;
+		}
+
+		res = fpgad_conn_sendmsg(conn.sock, &msg,
+			sizeof(msg.hdr) + n * sizeof(msg.entries[0]),
+			fds, type == FPGAD_REGISTER_EVENT ? n : 0);
+		if (res != FPGA_OK)
+			return res;
+	}
+
+	return FPGA_OK;
+}
+
+// Count (and, unless regs is NULL, list) what is on the shared connection.
+static uint32_t fpgad_conn_shared(struct fpgad_reg **regs)
+{
+	struct fpgad_reg *r;
+	uint32_t count = 0;
+
+	for (r = conn.regs ; r ; r = r->next) {
+		if (r->peer)
+			continue;
+		if (regs)
+			regs[count] = r;
+		++count;
+	}
+
+	return count;
+}
+
+// Register again everything still registered, on a new connection.
+static fpga_result fpgad_conn_replay(void)
+{
+	struct fpgad_reg **regs;
+	fpga_result res;
+	uint32_t count;
+
+	count = fpgad_conn_shared(NULL);
+	if (!count)
+		return FPGA_OK;
+
+	regs = calloc(count, sizeof(struct fpgad_reg *));
+	if (!regs) {
+		OPAE_ERR("Could not allocate registration list");
+		return FPGA_NO_MEMORY;
+	}
+
+	fpgad_conn_shared(regs);
+
+	res = fpgad_conn_send_batches(FPGAD_REGISTER_EVENT, regs, count);
+	if (res == FPGA_OK)
+		OPAE_MSG("registered %u event(s) again with fpgad", count);
+
+	free(regs);
+	return res;
+}
+
+/*
+ * Send count batched requests of the given type on the shared
+ * connection, (re)connecting as needed. Called with conn.lock held.
+ * Unregistered entries must already be off conn.regs, so that a new
+ * connection doesn't register them.
+ */
+static fpga_result fpgad_conn_send(enum fpgad_request_type type,
+				   struct fpgad_reg **regs,
+				   uint32_t count)
+{
+	fpga_result res = FPGA_NO_DAEMON;
+	bool fresh;
+	int attempt;
+
+	for (attempt = 0 ; attempt < 2 ; ++attempt) {
+		fresh = false;
+
+		if (conn.sock >= 0) {
+			fpgad_conn_drain(0);
+		} else if (type == FPGAD_UNREGISTER_EVENT &&
+			   (conn.legacy || !fpgad_conn_shared(NULL))) {
+			// Nothing outlived the connection; nothing to undo.
+			return FPGA_OK;
+		}
+
+		if (conn.sock < 0) {
+			res = fpgad_conn_connect();
+			if (res != FPGA_OK)
+				break;
+			fresh = true;
+
+			res = fpgad_conn_replay();
+			if (res != FPGA_OK) {
+				fpgad_conn_close();
+				continue;
+			}
+
+			// A new daemon never had what is being unregistered.
+			if (type == FPGAD_UNREGISTER_EVENT)
+				return FPGA_OK;
+		}
+
+		res = fpgad_conn_send_batches(type, regs, count);
+		if (res == FPGA_OK)
+			return FPGA_OK;
+
+		fpgad_conn_close();
+		if (fresh)
+			break;
+	}
+
+	if (type == FPGAD_UNREGISTER_EVENT && res == FPGA_NOT_SUPPORTED)
+		return FPGA_OK; // nor did one that doesn't batch
+	if (res == FPGA_NO_DAEMON || res == FPGA_NOT_SUPPORTED)
+		return res;
+	return FPGA_EXCEPTION;
+}
+
+fpga_result fpgad_conn_register(fpga_handle handle,
+				fpga_event_handle event_handle,
+				fpga_event_type event,
+				uint64_t object_id)
+{
+	struct fpgad_reg *r;
+	fpga_result res = FPGA_NOT_SUPPORTED;
+
+	r = calloc(1, sizeof(struct fpgad_reg));
+	if (!r) {
+		OPAE_ERR("Could not allocate registration");
+		return FPGA_NO_MEMORY;
+	}
+
+	r->handle = handle;
+	r->event_handle = event_handle;
+	r->event = event;
+	r->object_id = object_id;
+	r->fd = dup(FILE_DESCRIPTOR(event_handle));
+	if (r->fd < 0) {
+		OPAE_ERR("dup: %s", strerror(errno));
+		free(r);
+		return FPGA_EXCEPTION;
+	}
+
+	if (pthread_mutex_lock(&conn.lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		fpgad_reg_free(r);
+		return FPGA_EXCEPTION;
+	}
+
+	r->cookie = conn.next_cookie++;
+
+	if (fpgad_conn_batching())
+		res = fpgad_conn_send(FPGAD_REGISTER_EVENT, &r, 1);
+
+	if (res == FPGA_NOT_SUPPORTED) {
+		r->peer = fpgad_peer_get(handle, &res);
+		if (res == FPGA_OK &&
+		    fpgad_conn_send_single(FPGAD_REGISTER_EVENT, r) != FPGA_OK) {
+			// Let the next registration connect again.
+			close(r->peer->sock);
+			r->peer->sock = -1;
+			res = FPGA_EXCEPTION;
+		}
+	}
+
+	if (res == FPGA_OK) {
+		r->next = conn.regs;
+		conn.regs = r;
+	} else if (r->peer) {
+		fpgad_peer_put(r->peer);
+	}
+
+	if (pthread_mutex_unlock(&conn.lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	if (res != FPGA_OK)
+		fpgad_reg_free(r);
+
+	return res;
+}
+
+/*
+ * Move the registrations of handle (matching event_handle and event,
+ * unless event_handle is NULL) from conn.regs into a new array.
+ */
+static uint32_t fpgad_conn_take(fpga_handle handle,
+				fpga_event_handle event_handle,
+				fpga_event_type event,
+				struct fpgad_reg ***taken)
+{
+	struct fpgad_reg **pr;
+	struct fpgad_reg *r;
+	uint32_t count = 0;
+
+	*taken = NULL;
+
+	for (r = conn.regs ; r ; r = r->next) {
+		if (r->handle == handle &&
+		    (!event_handle || (r->event_handle == event_handle &&
+				       r->event == event)))
+			++count;
+	}
+	if (!count)
+		return 0;
+
+	*taken = calloc(count, sizeof(struct fpgad_reg *));
+	if (!*taken) {
+		OPAE_ERR("Could not allocate registration list");
+		return 0;
+	}
+
+	count = 0;
+	pr = &conn.regs;
+	while (*pr) {
+		r = *pr;
+		if (r->handle == handle &&
+		    (!event_handle || (r->event_handle == event_handle &&
+				       r->event == event))) {
+			*pr = r->next;
+			(*taken)[count++] = r;
+			// One registration per call to fpgad_conn_unregister().
+			if (event_handle)
+				break;
+		} else {
+			pr = &r->next;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Unregister regs, taken off conn.regs: those on a handle's connection
+ * one by one, the rest in batches on the shared connection.
+ */
+static fpga_result fpgad_conn_send_unregister(struct fpgad_reg **regs,
+					      uint32_t count)
+{
+	struct fpgad_reg *r;
+	uint32_t shared = 0;
+	uint32_t i;
+
+	for (i = 0 ; i < count ; ++i) {
+		r = regs[i];
+		if (!r->peer) {
+			// Gather the shared ones at the front.
+			regs[i] = regs[shared];
+			regs[shared++] = r;
+			continue;
+		}
+
+		if (r->peer->sock >= 0 &&
+		    fpgad_conn_send_single(FPGAD_UNREGISTER_EVENT,
+					   r) != FPGA_OK) {
+			// The registration went with the connection.
+			OPAE_DBG("fpgad connection already closed");
+		}
+		fpgad_peer_put(r->peer);
+		r->peer = NULL;
+	}
+
+	if (!shared)
+		return FPGA_OK;
+
+	return fpgad_conn_send(FPGAD_UNREGISTER_EVENT, regs, shared);
+}
+
+static void fpgad_conn_free_regs(struct fpgad_reg **regs, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0 ; i < count ; ++i)
+		fpgad_reg_free(regs[i]);
+	free(regs);
+}
+
+fpga_result fpgad_conn_unregister(fpga_handle handle,
+				  fpga_event_handle event_handle,
+				  fpga_event_type event)
+{
+	struct fpgad_reg **regs;
+	fpga_result res;
+	uint32_t count;
+
+	if (pthread_mutex_lock(&conn.lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return FPGA_EXCEPTION;
+	}
+
+	// Take in any refusal of the registration first.
+	if (conn.sock >= 0)
+		fpgad_conn_drain(0);
+
+	count = fpgad_conn_take(handle, event_handle, event, &regs);
+	if (!count) {
+		OPAE_MSG("Event not registered with fpgad");
+		res = FPGA_INVALID_PARAM;
+	} else {
+		res = fpgad_conn_send_unregister(regs, count);
+	}
+
+	if (pthread_mutex_unlock(&conn.lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	fpgad_conn_free_regs(regs, count);
+	return res;
+}
+
+void fpgad_conn_release(fpga_handle handle)
+{
+	struct fpgad_reg **regs;
+	uint32_t count;
+
+	if (pthread_mutex_lock(&conn.lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return;
+	}
+
+	count = fpgad_conn_take(handle, NULL, FPGA_EVENT_ERROR, &regs);
+	if (count && fpgad_conn_send_unregister(regs, count) != FPGA_OK)
+		OPAE_MSG("Could not unregister events from fpgad");
+
+	if (pthread_mutex_unlock(&conn.lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	fpgad_conn_free_regs(regs, count);
+}
+
+void fpgad_conn_finalize(void)
+{
+	struct fpgad_reg *r;
+	struct fpgad_peer *p;
+
+	if (pthread_mutex_lock(&conn.lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return;
+	}
+
+	fpgad_conn_close();
+	conn.legacy = false;
+
+	while (conn.regs) {
+		r = conn.regs;
+		conn.regs = r->next;
+		fpgad_reg_free(r);
+	}
+
+	while (conn.peers) {
+		p = conn.peers;
+		conn.peers = p->next;
+		if (p->sock >= 0)
+			close(p->sock);
+		free(p);
+	}
+
+	if (pthread_mutex_unlock(&conn.lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+}
@@ -0,0 +1,141 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __FPGA_FPGAD_CONN_INT_H__
+#define __FPGA_FPGAD_CONN_INT_H__
+
+#include <stdint.h>
+#include <opae/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Connection to the fpgad event daemon.
+ *
+ * Every fpgad understands single requests: a struct fpgad_event_request,
+ * with the eventfd attached as SCM_RIGHTS when registering. Such a
+ * daemon unregisters by event and object ID within a connection, so
+ * each handle gets a connection of its own, opened by its first
+ * registration and closed with its last.
+ *
+ * Batching is for an fpgad that speaks the protocol below; the fpgad
+ * in this tree does not yet, and only the tests' stand-in does. When
+ * FPGAD_EVENT_BATCH_ENV is set, registrations instead share one
+ * connection per process, which briefly awaits a FPGAD_REPLY_HELLO
+ * from the daemon when opened. To a daemon that says hello, several
+ * registrations go out as one struct fpgad_event_batch header followed
+ * by its entries and fds, and each batch is answered by a
+ * FPGAD_REPLY_ACK. Acks are read whenever the connection is next used,
+ * so requests do not wait for them; the registrations of a refused
+ * batch are dropped then. A daemon that doesn't say hello gets single
+ * requests, and is not waited on again.
+ *
+ * If the daemon goes away, the next request reconnects the shared
+ * connection and registers again everything that was registered on it.
+ */
+
+#define FPGAD_EVENT_SOCKET     "/tmp/fpga_event_socket"
+// Overrides FPGAD_EVENT_SOCKET, mainly for tests.
+#define FPGAD_EVENT_SOCKET_ENV "OPAE_FPGAD_EVENT_SOCKET"
+// Set (and not "0") to batch registrations on a shared connection.
+#define FPGAD_EVENT_BATCH_ENV  "OPAE_FPGAD_EVENT_BATCH"
+
+enum fpgad_request_type {
+	FPGAD_REGISTER_EVENT = 0,
+	FPGAD_UNREGISTER_EVENT = 1
+};
+
+struct fpgad_event_request {
+	enum fpgad_request_type type;
+	fpga_event_type event;
+	uint64_t object_id;
+};
+
+//                             F P G E
+#define FPGAD_EVENT_MAGIC   0x45475046
+#define FPGAD_EVENT_VERSION 2
+// Entries per batch, within the kernel's SCM_RIGHTS limit of 253 fds.
+#define FPGAD_EVENT_BATCH_MAX 250
+
+struct fpgad_event_batch {
+	uint32_t magic;
+	uint32_t type;  // enum fpgad_request_type
+	uint32_t seq;
+	uint32_t count; // number of struct fpgad_event_entry that follow
+};
+
+struct fpgad_event_entry {
+	uint32_t event; // fpga_event_type
+	uint32_t reserved;
+	uint64_t object_id;
+	// Names one registration, so that unregistering removes exactly it.
+	uint64_t cookie;
+};
+
+enum fpgad_reply_kind {
+	FPGAD_REPLY_HELLO = 0,
+	FPGAD_REPLY_ACK = 1
+};
+
+struct fpgad_event_reply {
+	uint32_t magic;
+	uint32_t kind;   // enum fpgad_reply_kind
+	uint32_t value;  // HELLO: protocol version. ACK: batch seq.
+	// ACK: FPGA_OK, or why the batch was refused. A refused register
+	// batch registers none of its entries.
+	int32_t result;
+};
+
+/*
+ * Register event_handle for event on object_id with fpgad. Returns
+ * FPGA_NO_DAEMON if fpgad cannot be reached.
+ */
+fpga_result fpgad_conn_register(fpga_handle handle,
+				fpga_event_handle event_handle,
+				fpga_event_type event,
+				uint64_t object_id);
+
+/*
+ * Unregister what handle registered for event with event_handle.
+ * Returns FPGA_INVALID_PARAM if there is no such registration.
+ */
+fpga_result fpgad_conn_unregister(fpga_handle handle,
+				  fpga_event_handle event_handle,
+				  fpga_event_type event);
+
+// Unregister everything registered through handle, which is closing.
+void fpgad_conn_release(fpga_handle handle);
+
+// Close the connection and forget all registrations.
+void fpgad_conn_finalize(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // __FPGA_FPGAD_CONN_INT_H__
@@ -46,6 +46,7 @@
 #include "types_int.h"
 #include "opae/metrics.h"
 #include "metrics/vector.h"
+#include "dfh_index.h"
 
 // AFU BBB GUID
 #define METRICS_BBB_GUID            "87816958-C148-4CD0-9D73-E8F258E9E3D7"
@@ -61,66 +62,33 @@
 fpga_result discover_afu_metrics_feature(fpga_handle handle, uint64_t *offset)
 {
 	fpga_result result               = FPGA_OK;
-	feature_definition feature_def;
-	uint64_t bbs_offset              = 0;
+	fpga_feature_info feature;
+	fpga_guid metrics_guid;
 
 	if (offset == NULL) {
 		OPAE_ERR("Invalid Input Paramters");
 		return FPGA_INVALID_PARAM;
 	}
 
-	memset(&feature_def, 0, sizeof(feature_def));
+	opae_dfh_guid(METRICS_BBB_ID_L, METRICS_BBB_ID_H, metrics_guid);
 
-	// Read AFU DFH
-	result = xfpga_fpgaReadMMIO64(handle, 0, 0x0, &(feature_def.dfh.csr));
-	if (result != FPGA_OK) {
+	// Search the handle's feature index for the AFU Metrics BBB
+	result = xfpga_fpgaFindFeature(handle, metrics_guid, 0, &feature);
+	if (result == FPGA_NOT_FOUND) {
+		OPAE_ERR("AFU Metrics BBB Not Found \n ");
+		return FPGA_NOT_FOUND;
+	} else if (result != FPGA_OK) {
 		OPAE_ERR("Invalid handle file descriptor");
-		result = FPGA_NOT_SUPPORTED;
-		return result;
+		return FPGA_NOT_SUPPORTED;
 	}
 
-	// Serach for AFU Metrics BBB DFH
-	while (feature_def.dfh.eol != 0 && feature_def.dfh.next_header_offset != 0) {
-
-		bbs_offset = feature_def.dfh.next_header_offset;
-
-		result = xfpga_fpgaReadMMIO64(handle, 0, feature_def.dfh.next_header_offset, &(feature_def.dfh.csr));
-		if (result != FPGA_OK) {
-			OPAE_ERR("Invalid handle file descriptor");
-			result = FPGA_NOT_SUPPORTED;
-			return result;
-		}
-
-		if (feature_def.dfh.type == FEATURE_TYPE_BBB) {
-
-			result = xfpga_fpgaReadMMIO64(handle, 0, bbs_offset +0x8, &(feature_def.guid[0]));
-			if (result != FPGA_OK) {
-				OPAE_ERR("Invalid handle file descriptor");
-				result = FPGA_NOT_SUPPORTED;
-				return result;
-			}
-
-			result = xfpga_fpgaReadMMIO64(handle, 0, bbs_offset + 0x10, &(feature_def.guid[1]));
-			if (result != FPGA_OK) {
-				OPAE_ERR("Invalid handle file descriptor");
-				result = FPGA_NOT_SUPPORTED;
-				return result;
-			}
-
-			if (feature_def.guid[0] == METRICS_BBB_ID_L &&
-				feature_def.guid[1] == METRICS_BBB_ID_H) {
-				*offset = bbs_offset;
-				return FPGA_OK;
-			} else	{
-				OPAE_ERR(" Metrics BBB Not Found \n ");
-			}
-
-		}
-
+	if (feature.type != FEATURE_TYPE_BBB) {
+		OPAE_ERR(" Metrics BBB Not Found \n ");
+		return FPGA_NOT_FOUND;
 	}
 
-	OPAE_ERR("AFU Metrics BBB Not Found \n ");
-	return FPGA_NOT_FOUND;
+	*offset = feature.offset;
+	return FPGA_OK;
 }
 
 
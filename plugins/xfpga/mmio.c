@@ -33,6 +33,8 @@
 #include "common_int.h"
 #include "opae_drv.h"
 #include "intel-fpga.h"
+#include "dfh_index.h"
+#include "mmio_burst.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -319,14 +321,6 @@ out_unlock:
 	return result;
 }
 
-static inline void copy512(const void *src, void *dst)
-{
-    asm volatile("vmovdqu64 (%0), %%zmm0;"
-		 "vmovdqu64 %%zmm0, (%1);"
-		 :
-		 : "r"(src), "r"(dst));
-}
-
 fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO512(fpga_handle handle,
 					 uint32_t mmio_num,
 					 uint64_t offset,
@@ -361,7 +355,60 @@ fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIO512(fpga_handle handle,
 		goto out_unlock;
 	}
 
-	copy512(value, (uint8_t *)wm->offset + offset);
+	opae_mmio_write_lines((uint8_t *)wm->offset + offset, value, 1, false);
+
+out_unlock:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaWriteMMIOBurst(fpga_handle handle,
+					   uint32_t mmio_num,
+					   uint64_t offset,
+					   const void *lines,
+					   uint32_t num_lines,
+					   int flags)
+{
+	int err;
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct wsid_map *wm = NULL;
+	fpga_result result = FPGA_OK;
+	bool fixed = (flags & FPGA_MMIO_BURST_FIXED) != 0;
+	uint64_t len;
+
+	if (offset % 64 != 0) {
+		OPAE_MSG("Misaligned MMIO access");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!num_lines)
+		return FPGA_OK;
+
+	ASSERT_NOT_NULL(lines);
+
+	if ((flags & FPGA_MMIO_BURST_ATOMIC) && !opae_mmio_line_atomic())
+		return FPGA_NOT_SUPPORTED;
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	result = find_or_map_wm(handle, mmio_num, &wm);
+	if (result)
+		goto out_unlock;
+
+	len = fixed ? 64 : (uint64_t)num_lines * 64;
+	if (offset > wm->len || len > wm->len - offset) {
+		OPAE_MSG("burst out of bounds");
+		result = FPGA_INVALID_PARAM;
+		goto out_unlock;
+	}
+
+	opae_mmio_write_lines((uint8_t *)wm->offset + offset, lines,
+			      num_lines, fixed);
 
 out_unlock:
 	err = pthread_mutex_unlock(&_handle->lock);
@@ -439,3 +486,63 @@ out_unlock:
 	}
 	return result;
 }
+
+STATIC fpga_result dfh_read64(void *context, uint64_t offset, uint64_t *value)
+{
+	struct wsid_map *wm = (struct wsid_map *)context;
+
+	if (offset + sizeof(uint64_t) > wm->len) {
+		OPAE_MSG("DFH offset 0x%lx out of bounds", offset);
+		return FPGA_EXCEPTION;
+	}
+
+	*value = *((volatile uint64_t *) ((uint8_t *)wm->offset + offset));
+	return FPGA_OK;
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaFindFeature(fpga_handle handle,
+						fpga_guid guid,
+						uint16_t id,
+						fpga_feature_info *info)
+{
+	int err;
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	struct wsid_map *wm = NULL;
+	const fpga_feature_info *feature;
+	fpga_result result = FPGA_OK;
+
+	if (!info) {
+		OPAE_MSG("info is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	result = handle_check_and_lock(_handle);
+	if (result)
+		return result;
+
+	if (!_handle->dfh_index) {
+		result = find_or_map_wm(handle, 0, &wm);
+		if (result)
+			goto out_unlock;
+
+		result = opae_dfh_index_build(&_handle->dfh_index,
+					      dfh_read64, wm);
+		if (result)
+			goto out_unlock;
+	}
+
+	feature = opae_dfh_index_find(_handle->dfh_index, guid, id);
+	if (!feature) {
+		result = FPGA_NOT_FOUND;
+		goto out_unlock;
+	}
+
+	*info = *feature;
+
+out_unlock:
+	err = pthread_mutex_unlock(&_handle->lock);
+	if (err) {
+		OPAE_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
+	}
+	return result;
+}
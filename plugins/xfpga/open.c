@@ -32,6 +32,7 @@
 #include <opae/access.h>
 #include <opae/utils.h>
 #include "types_int.h"
+#include "mmio_burst.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -83,7 +84,10 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 
 	_handle->token = token;
 
-	_handle->fdfpgad = -1;
+	// Cached for event registration, which would otherwise build
+	// the handle's properties just to learn this.
+	_handle->objtype = strstr(_token->sysfspath, FPGA_SYSFS_AFU) ?
+		FPGA_ACCELERATOR : FPGA_DEVICE;
 
 	// Init MMIO table
 	_handle->mmio_root = wsid_tracker_init(4);
@@ -93,7 +97,7 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 	}
 
 	// Init workspace table
-	_handle->wsid_root = wsid_tracker_init(16384);
+	_handle->wsid_root = wsid_tracker_init(16);
 	if (NULL == _handle->wsid_root) {
 		result = FPGA_NO_MEMORY;
 		goto out_free2;
@@ -142,12 +146,8 @@ xfpga_fpgaOpen(fpga_token token, fpga_handle *handle, int flags)
 	pthread_mutexattr_destroy(&mattr);
 
 	_handle->flags = 0;
-#if GCC_VERSION >= 40900
-	__builtin_cpu_init();
-	if (__builtin_cpu_supports("avx512f")) {
+	if (opae_mmio_line_atomic())
 		_handle->flags |= OPAE_FLAG_HAS_MMX512;
-	}
-#endif
 
 	// set handle return value
 	*handle = (void *)_handle;
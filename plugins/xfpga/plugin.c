@@ -35,6 +35,8 @@
 #include "common_int.h"
 #include "sysfs_int.h"
 #include "opae_drv.h"
+#include "power_thermal_int.h"
+#include "fpgad_conn_int.h"
 
 int __XFPGA_API__ xfpga_plugin_initialize(void)
 {
@@ -52,6 +54,8 @@ int __XFPGA_API__ xfpga_plugin_initialize(void)
 
 int __XFPGA_API__ xfpga_plugin_finalize(void)
 {
+	power_thermal_finalize();
+	fpgad_conn_finalize();
 	sysfs_finalize();
 	return 0;
 }
@@ -82,12 +86,18 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReadMMIO32");
 	adapter->fpgaWriteMMIO512 =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaWriteMMIO512");
+	adapter->fpgaWriteMMIOBurst =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaWriteMMIOBurst");
 	adapter->fpgaMapMMIO =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaMapMMIO");
 	adapter->fpgaUnmapMMIO =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaUnmapMMIO");
+	adapter->fpgaFindFeature =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaFindFeature");
 	adapter->fpgaEnumerate =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaEnumerate");
+	adapter->fpgaEnumerateAll =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaEnumerateAll");
 	adapter->fpgaCloneToken =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaCloneToken");
 	adapter->fpgaDestroyToken =
@@ -106,6 +116,10 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReleaseBuffer");
 	adapter->fpgaGetIOAddress =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaGetIOAddress");
+	adapter->fpgaPrepareBuffers =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaPrepareBuffers");
+	adapter->fpgaReleaseBuffers =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaReleaseBuffers");
 	/*
 	**	adapter->fpgaGetOPAECVersion = dlsym(adapter->plugin.dl_handle,
 	*"xfpga_fpgaGetOPAECVersion");
@@ -133,6 +147,12 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaRegisterEvent");
 	adapter->fpgaUnregisterEvent =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaUnregisterEvent");
+	adapter->fpgaRegisterInterruptEvents =
+		dlsym(adapter->plugin.dl_handle,
+		      "xfpga_fpgaRegisterInterruptEvents");
+	adapter->fpgaUnregisterInterruptEvents =
+		dlsym(adapter->plugin.dl_handle,
+		      "xfpga_fpgaUnregisterInterruptEvents");
 	adapter->fpgaAssignPortToInterface = dlsym(
 		adapter->plugin.dl_handle, "xfpga_fpgaAssignPortToInterface");
 	adapter->fpgaAssignToInterface =
@@ -161,6 +181,10 @@ int __XFPGA_API__ opae_plugin_configure(opae_api_adapter_table *adapter,
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectGetType");
 	adapter->fpgaObjectWrite64 =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectWrite64");
+	adapter->fpgaObjectSync =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectSync");
+	adapter->fpgaObjectGetTimestamp =
+		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaObjectGetTimestamp");
 	adapter->fpgaSetUserClock =
 		dlsym(adapter->plugin.dl_handle, "xfpga_fpgaSetUserClock");
 	adapter->fpgaGetUserClock =
@@ -0,0 +1,585 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "xfpga.h"
+#include "common_int.h"
+#include "types_int.h"
+#include "power_thermal_int.h"
+
+STATIC struct power_thermal_monitor *monitors;
+static pthread_mutex_t monitors_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline bool upper_tripped(const threshold *t, double value,
+				 double hyst, bool was)
+{
+	if (!t->is_valid)
+		return false;
+	return was ? value > t->value - hyst : value >= t->value;
+}
+
+static inline bool lower_tripped(const threshold *t, double value,
+				 double hyst, bool was)
+{
+	if (!t->is_valid)
+		return false;
+	return was ? value < t->value + hyst : value <= t->value;
+}
+
+bool power_thermal_evaluate(const metric_threshold *t, double value,
+			    uint32_t *tripped)
+{
+	double hyst = t->hysteresis.is_valid ? t->hysteresis.value : 0.0;
+	uint32_t old = *tripped;
+	uint32_t now = 0;
+
+#define EVALUATE(__which, __t, __bit)                                     \
+	if (__which##_tripped(&t->__t, value, hyst, old & (__bit)))       \
+		now |= (__bit)
+
+	EVALUATE(upper, upper_nr_threshold, POWER_THERMAL_UPPER_NR);
+	EVALUATE(upper, upper_c_threshold, POWER_THERMAL_UPPER_C);
+	EVALUATE(upper, upper_nc_threshold, POWER_THERMAL_UPPER_NC);
+	EVALUATE(lower, lower_nr_threshold, POWER_THERMAL_LOWER_NR);
+	EVALUATE(lower, lower_c_threshold, POWER_THERMAL_LOWER_C);
+	EVALUATE(lower, lower_nc_threshold, POWER_THERMAL_LOWER_NC);
+
+#undef EVALUATE
+
+	*tripped = now;
+	return (now & ~old) != 0;
+}
+
+static inline bool threshold_any_valid(const metric_threshold *t)
+{
+	return t->upper_nr_threshold.is_valid ||
+	       t->upper_c_threshold.is_valid ||
+	       t->upper_nc_threshold.is_valid ||
+	       t->lower_nr_threshold.is_valid ||
+	       t->lower_c_threshold.is_valid ||
+	       t->lower_nc_threshold.is_valid;
+}
+
+static double metric_to_double(enum fpga_metric_datatype datatype,
+			       metric_value v)
+{
+	switch (datatype) {
+	case FPGA_METRIC_DATATYPE_INT:
+		return (double)v.ivalue;
+	case FPGA_METRIC_DATATYPE_FLOAT:
+		return (double)v.fvalue;
+	case FPGA_METRIC_DATATYPE_BOOL:
+		return v.bvalue ? 1.0 : 0.0;
+	default:
+		return v.dvalue;
+	}
+}
+
+/*
+ * Pair each power and thermal metric read through handle with the
+ * thresholds of the sensor of the same name. Metric numbers come from
+ * the device's sysfs tree, so they hold for every handle to it.
+ */
+STATIC fpga_result power_thermal_find_sensors(struct power_thermal_monitor *m,
+					      fpga_handle handle)
+{
+	fpga_result res;
+	uint64_t num_metrics = 0;
+	uint32_t num_thresholds = 0;
+	fpga_metric_info *info = NULL;
+	metric_threshold *thresholds = NULL;
+	uint64_t i;
+	uint32_t j;
+
+	res = xfpga_fpgaGetNumMetrics(handle, &num_metrics);
+	if (res != FPGA_OK || !num_metrics)
+		return FPGA_NOT_SUPPORTED;
+
+	res = xfpga_fpgaGetMetricsThresholdInfo(handle, NULL,
+						&num_thresholds);
+	if (res != FPGA_OK || !num_thresholds)
+		return FPGA_NOT_SUPPORTED;
+
+	info = calloc(num_metrics, sizeof(fpga_metric_info));
+	thresholds = calloc(num_thresholds, sizeof(metric_threshold));
+	m->sensors = calloc(num_thresholds,
+			    sizeof(struct power_thermal_sensor));
+	if (!info || !thresholds || !m->sensors) {
+		OPAE_ERR("Could not allocate sensor tables");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	res = xfpga_fpgaGetMetricsInfo(handle, info, &num_metrics);
+	if (res != FPGA_OK)
+		goto out_free;
+
+	res = xfpga_fpgaGetMetricsThresholdInfo(handle, thresholds,
+						&num_thresholds);
+	if (res != FPGA_OK)
+		goto out_free;
+
+	for (i = 0 ; i < num_metrics ; ++i) {
+		if (info[i].metric_type != FPGA_METRIC_TYPE_POWER &&
+		    info[i].metric_type != FPGA_METRIC_TYPE_THERMAL)
+			continue;
+
+		for (j = 0 ; j < num_thresholds ; ++j) {
+			if (!strcmp(info[i].metric_name,
+				    thresholds[j].metric_name) &&
+			    threshold_any_valid(&thresholds[j]))
+				break;
+		}
+		if (j == num_thresholds ||
+		    m->num_sensors == num_thresholds)
+			continue;
+
+		m->sensors[m->num_sensors].metric_num = info[i].metric_num;
+		m->sensors[m->num_sensors].datatype = info[i].metric_datatype;
+		m->sensors[m->num_sensors].threshold = thresholds[j];
+		++m->num_sensors;
+	}
+
+	if (!m->num_sensors) {
+		OPAE_MSG("No power or thermal sensor has a threshold");
+		res = FPGA_NOT_SUPPORTED;
+		goto out_free;
+	}
+
+	m->metric_nums = calloc(m->num_sensors, sizeof(uint64_t));
+	m->values = calloc(m->num_sensors, sizeof(fpga_metric));
+	if (!m->metric_nums || !m->values) {
+		OPAE_ERR("Could not allocate sensor tables");
+		res = FPGA_NO_MEMORY;
+		goto out_free;
+	}
+
+	for (j = 0 ; j < m->num_sensors ; ++j)
+		m->metric_nums[j] = m->sensors[j].metric_num;
+
+	free(thresholds);
+	free(info);
+	return FPGA_OK;
+
+out_free:
+	free(thresholds);
+	free(info);
+	return res;
+}
+
+/*
+ * Read every sensor once, through the first registering handle that is
+ * not locked, and signal the registrations on a new crossing. Called
+ * with m->lock held. Busy handles are skipped rather than waited on:
+ * their owner may be registering or closing, and so waiting on m->lock.
+ */
+STATIC void power_thermal_sample(struct power_thermal_monitor *m)
+{
+	struct _fpga_handle *_handle = NULL;
+	struct power_thermal_reg *r;
+	const uint64_t one = 1;
+	bool signal = false;
+	fpga_result res;
+	uint32_t i;
+
+	for (r = m->regs ; r ; r = r->next) {
+		_handle = (struct _fpga_handle *)r->handle;
+		if (!pthread_mutex_trylock(&_handle->lock))
+			break;
+	}
+
+	if (!r)
+		return; // try again next interval
+
+	res = xfpga_fpgaGetMetricsByIndex(r->handle, m->metric_nums,
+					  m->num_sensors, m->values);
+
+	if (pthread_mutex_unlock(&_handle->lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	if (res != FPGA_OK)
+		return;
+
+	for (i = 0 ; i < m->num_sensors ; ++i) {
+		struct power_thermal_sensor *s = &m->sensors[i];
+		double value;
+
+		if (!m->values[i].isvalid)
+			continue;
+
+		value = metric_to_double(s->datatype, m->values[i].value);
+		if (power_thermal_evaluate(&s->threshold, value, &s->tripped)) {
+			OPAE_MSG("%s: %s crossed a threshold at %f",
+				 m->sysfspath, s->threshold.metric_name, value);
+			signal = true;
+		}
+	}
+
+	if (!signal)
+		return;
+
+	for (r = m->regs ; r ; r = r->next) {
+		if (write(r->fd, &one, sizeof(one)) < 0) {
+			OPAE_DBG("eventfd write failed: %s", strerror(errno));
+		}
+	}
+}
+
+static void *power_thermal_thread(void *arg)
+{
+	struct power_thermal_monitor *m = (struct power_thermal_monitor *)arg;
+	struct pollfd pfd;
+	int timeout;
+	int n;
+
+	pfd.fd = m->wake_fd;
+	pfd.events = POLLIN;
+
+	while (1) {
+		if (pthread_mutex_lock(&m->lock)) {
+			OPAE_ERR("pthread_mutex_lock() failed");
+			break;
+		}
+		power_thermal_sample(m);
+		timeout = (int)m->interval_ms;
+		if (pthread_mutex_unlock(&m->lock))
+			OPAE_ERR("pthread_mutex_unlock() failed");
+
+		pfd.revents = 0;
+		n = poll(&pfd, 1, timeout);
+		if (n > 0 || (n < 0 && errno != EINTR))
+			break; // woken to stop
+	}
+
+	return NULL;
+}
+
+static void power_thermal_monitor_free(struct power_thermal_monitor *m)
+{
+	if (m->wake_fd >= 0)
+		close(m->wake_fd);
+	pthread_mutex_destroy(&m->lock);
+	free(m->values);
+	free(m->metric_nums);
+	free(m->sensors);
+	free(m);
+}
+
+// Stop the thread of a monitor that has been unlinked, and free it.
+static void power_thermal_monitor_destroy(struct power_thermal_monitor *m)
+{
+	const uint64_t one = 1;
+	struct power_thermal_reg *r;
+
+	if (write(m->wake_fd, &one, sizeof(one)) < 0)
+		OPAE_ERR("eventfd write failed: %s", strerror(errno));
+	pthread_join(m->thread, NULL);
+
+	while (m->regs) {
+		r = m->regs;
+		m->regs = r->next;
+		close(r->fd);
+		free(r);
+	}
+
+	power_thermal_monitor_free(m);
+}
+
+STATIC fpga_result
+power_thermal_monitor_create(struct _fpga_handle *_handle,
+			     uint32_t interval_ms,
+			     struct power_thermal_monitor **monitor)
+{
+	struct _fpga_token *_token = (struct _fpga_token *)_handle->token;
+	struct power_thermal_monitor *m;
+	fpga_result res;
+	size_t len;
+	int err;
+
+	m = calloc(1, sizeof(struct power_thermal_monitor));
+	if (!m) {
+		OPAE_ERR("Could not allocate power/thermal monitor");
+		return FPGA_NO_MEMORY;
+	}
+
+	m->wake_fd = -1;
+	m->interval_ms = interval_ms;
+	len = strnlen(_token->sysfspath, sizeof(m->sysfspath) - 1);
+	memcpy(m->sysfspath, _token->sysfspath, len);
+
+	if (pthread_mutex_init(&m->lock, NULL)) {
+		OPAE_ERR("pthread_mutex_init() failed");
+		free(m);
+		return FPGA_EXCEPTION;
+	}
+
+	res = power_thermal_find_sensors(m, _handle);
+	if (res != FPGA_OK)
+		goto out_free;
+
+	m->wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (m->wake_fd < 0) {
+		OPAE_ERR("eventfd: %s", strerror(errno));
+		res = FPGA_EXCEPTION;
+		goto out_free;
+	}
+
+	err = pthread_create(&m->thread, NULL, power_thermal_thread, m);
+	if (err) {
+		OPAE_ERR("pthread_create() failed: %s", strerror(err));
+		res = FPGA_EXCEPTION;
+		goto out_free;
+	}
+
+	*monitor = m;
+	return FPGA_OK;
+
+out_free:
+	power_thermal_monitor_free(m);
+	return res;
+}
+
+static struct power_thermal_monitor *power_thermal_find(const char *sysfspath)
+{
+	struct power_thermal_monitor *m;
+
+	for (m = monitors ; m ; m = m->next) {
+		if (!strncmp(m->sysfspath, sysfspath, sizeof(m->sysfspath)))
+			break;
+	}
+
+	return m;
+}
+
+fpga_result power_thermal_register(fpga_handle handle,
+				   fpga_event_handle event_handle,
+				   uint32_t flags)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *)handle;
+	struct _fpga_token *_token = (struct _fpga_token *)_handle->token;
+	struct power_thermal_monitor *m;
+	struct power_thermal_reg *r;
+	uint32_t interval_ms = flags ? flags : POWER_THERMAL_DEFAULT_INTERVAL_MS;
+	fpga_result res = FPGA_OK;
+
+	if (_handle->objtype != FPGA_DEVICE) {
+		OPAE_MSG("Power/thermal events need an FPGA_DEVICE handle");
+		return FPGA_NOT_SUPPORTED;
+	}
+
+	r = calloc(1, sizeof(struct power_thermal_reg));
+	if (!r) {
+		OPAE_ERR("Could not allocate registration");
+		return FPGA_NO_MEMORY;
+	}
+
+	r->handle = handle;
+	r->event_handle = event_handle;
+	r->interval_ms = interval_ms;
+	r->fd = dup(FILE_DESCRIPTOR(event_handle));
+	if (r->fd < 0) {
+		OPAE_ERR("dup: %s", strerror(errno));
+		free(r);
+		return FPGA_EXCEPTION;
+	}
+
+	if (pthread_mutex_lock(&monitors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		res = FPGA_EXCEPTION;
+		goto out_free;
+	}
+
+	m = power_thermal_find(_token->sysfspath);
+	if (!m) {
+		res = power_thermal_monitor_create(_handle, interval_ms, &m);
+		if (res != FPGA_OK)
+			goto out_unlock;
+		m->next = monitors;
+		monitors = m;
+	}
+
+	if (pthread_mutex_lock(&m->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		res = FPGA_EXCEPTION;
+		goto out_unlock;
+	}
+
+	r->next = m->regs;
+	m->regs = r;
+	r = NULL;
+	if (interval_ms < m->interval_ms)
+		m->interval_ms = interval_ms;
+
+	if (pthread_mutex_unlock(&m->lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+out_unlock:
+	if (pthread_mutex_unlock(&monitors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+out_free:
+	if (r) {
+		close(r->fd);
+		free(r);
+	}
+	return res;
+}
+
+/*
+ * Remove the registrations matching handle (and event_handle, unless
+ * NULL) from every monitor. The others' shortest interval becomes the
+ * monitor's. Monitors left without registrations are unlinked and
+ * returned through *idle, so that their threads are joined once
+ * monitors_lock is dropped.
+ */
+static uint32_t power_thermal_remove(fpga_handle handle,
+				     fpga_event_handle event_handle,
+				     struct power_thermal_monitor **idle)
+{
+	struct power_thermal_monitor **pm = &monitors;
+	uint32_t removed = 0;
+	uint32_t interval_ms;
+
+	while (*pm) {
+		struct power_thermal_monitor *m = *pm;
+		struct power_thermal_reg **pr;
+
+		if (pthread_mutex_lock(&m->lock)) {
+			OPAE_ERR("pthread_mutex_lock() failed");
+			pm = &m->next;
+			continue;
+		}
+
+		interval_ms = UINT32_MAX;
+		pr = &m->regs;
+		while (*pr) {
+			struct power_thermal_reg *r = *pr;
+
+			if (r->handle == handle &&
+			    (!event_handle || r->event_handle == event_handle)) {
+				*pr = r->next;
+				close(r->fd);
+				free(r);
+				++removed;
+			} else {
+				if (r->interval_ms < interval_ms)
+					interval_ms = r->interval_ms;
+				pr = &r->next;
+			}
+		}
+		if (m->regs)
+			m->interval_ms = interval_ms;
+
+		if (pthread_mutex_unlock(&m->lock))
+			OPAE_ERR("pthread_mutex_unlock() failed");
+
+		if (!m->regs) {
+			*pm = m->next;
+			m->next = *idle;
+			*idle = m;
+		} else {
+			pm = &m->next;
+		}
+	}
+
+	return removed;
+}
+
+static void power_thermal_destroy_list(struct power_thermal_monitor *m)
+{
+	struct power_thermal_monitor *next;
+
+	for ( ; m ; m = next) {
+		next = m->next;
+		power_thermal_monitor_destroy(m);
+	}
+}
+
+fpga_result power_thermal_unregister(fpga_handle handle,
+				     fpga_event_handle event_handle)
+{
+	struct power_thermal_monitor *idle = NULL;
+	uint32_t removed;
+
+	if (pthread_mutex_lock(&monitors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return FPGA_EXCEPTION;
+	}
+
+	removed = power_thermal_remove(handle, event_handle, &idle);
+
+	if (pthread_mutex_unlock(&monitors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	power_thermal_destroy_list(idle);
+
+	return removed ? FPGA_OK : FPGA_NOT_FOUND;
+}
+
+void power_thermal_release(fpga_handle handle)
+{
+	struct power_thermal_monitor *idle = NULL;
+
+	if (pthread_mutex_lock(&monitors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return;
+	}
+
+	power_thermal_remove(handle, NULL, &idle);
+
+	if (pthread_mutex_unlock(&monitors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	power_thermal_destroy_list(idle);
+}
+
+void power_thermal_finalize(void)
+{
+	struct power_thermal_monitor *all;
+
+	if (pthread_mutex_lock(&monitors_lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return;
+	}
+
+	all = monitors;
+	monitors = NULL;
+
+	if (pthread_mutex_unlock(&monitors_lock))
+		OPAE_ERR("pthread_mutex_unlock() failed");
+
+	power_thermal_destroy_list(all);
+}
@@ -0,0 +1,129 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __FPGA_POWER_THERMAL_INT_H__
+#define __FPGA_POWER_THERMAL_INT_H__
+
+#include <stdint.h>
+#include <pthread.h>
+#include <opae/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Software source of FPGA_EVENT_POWER_THERMAL, used when no fpgad is
+ * running to proxy the event.
+ *
+ * One monitor thread per device reads the device's power and thermal
+ * sensors once per interval, compares them against the thresholds
+ * reported by xfpga_fpgaGetMetricsThresholdInfo(), and signals every
+ * registered event handle when a sensor crosses into a threshold. The
+ * monitor opens nothing of its own: it reads through one of the
+ * handles its events were registered with.
+ */
+
+#define POWER_THERMAL_DEFAULT_INTERVAL_MS 1000
+
+// Bits of the tripped mask kept per sensor.
+#define POWER_THERMAL_UPPER_NR 0x01
+#define POWER_THERMAL_UPPER_C  0x02
+#define POWER_THERMAL_UPPER_NC 0x04
+#define POWER_THERMAL_LOWER_NR 0x08
+#define POWER_THERMAL_LOWER_C  0x10
+#define POWER_THERMAL_LOWER_NC 0x20
+
+struct power_thermal_sensor {
+	uint64_t metric_num;
+	enum fpga_metric_datatype datatype;
+	metric_threshold threshold;
+	uint32_t tripped;
+};
+
+// One event handle registered through one fpga_handle.
+struct power_thermal_reg {
+	fpga_handle handle;
+	fpga_event_handle event_handle;
+	int fd; // dup() of the event handle's eventfd
+	uint32_t interval_ms;
+	struct power_thermal_reg *next;
+};
+
+struct power_thermal_monitor {
+	char sysfspath[SYSFS_PATH_MAX];
+	struct power_thermal_sensor *sensors;
+	uint64_t *metric_nums;
+	fpga_metric *values;
+	uint32_t num_sensors;
+	pthread_mutex_t lock; // protects regs, interval_ms and sampling
+	struct power_thermal_reg *regs;
+	uint32_t interval_ms; // shortest interval among regs
+	int wake_fd;
+	pthread_t thread;
+	struct power_thermal_monitor *next;
+};
+
+/*
+ * Register event_handle with the monitor of handle's device, starting
+ * the monitor if needed. flags is the polling interval in ms; 0
+ * selects POWER_THERMAL_DEFAULT_INTERVAL_MS. A monitor shared by
+ * several registrations polls at the shortest interval asked for.
+ *
+ * Returns FPGA_NOT_SUPPORTED when handle is not an FPGA_DEVICE or the
+ * device has no sensor with a threshold.
+ */
+fpga_result power_thermal_register(fpga_handle handle,
+				   fpga_event_handle event_handle,
+				   uint32_t flags);
+
+/*
+ * Remove the registration of event_handle made through handle. The
+ * monitor stops with its last registration. Returns FPGA_NOT_FOUND if
+ * there is no such registration.
+ */
+fpga_result power_thermal_unregister(fpga_handle handle,
+				     fpga_event_handle event_handle);
+
+// Drop every registration made through handle, which is being closed.
+void power_thermal_release(fpga_handle handle);
+
+// Stop all monitors.
+void power_thermal_finalize(void);
+
+/*
+ * Update *tripped for a sensor reading of value against t. A tripped
+ * threshold stays tripped until the value is back past it by the
+ * sensor's hysteresis. Returns true if any threshold became tripped.
+ */
+bool power_thermal_evaluate(const metric_threshold *t, double value,
+			    uint32_t *tripped);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // __FPGA_POWER_THERMAL_INT_H__
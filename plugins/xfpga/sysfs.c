@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <regex.h>
+#include <time.h>
 #undef _GNU_SOURCE
 
 #include <opae/types.h>
@@ -1915,6 +1916,50 @@ ssize_t eintr_write(int fd, void *buf, size_t count)
 	return total_written;
 }
 
+ssize_t eintr_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	ssize_t bytes_read = 0, total_read = 0;
+	char *ptr = buf;
+	while (total_read < (ssize_t)count) {
+		bytes_read = pread(fd, ptr + total_read, count - total_read,
+				   offset + total_read);
+		if (bytes_read < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return bytes_read;
+		} else if (bytes_read == 0) {
+			break;
+		}
+		total_read += bytes_read;
+	}
+	return total_read;
+}
+
+ssize_t eintr_pwrite(int fd, void *buf, size_t count, off_t offset)
+{
+	ssize_t bytes_written = 0, total_written = 0;
+	char *ptr = buf;
+
+	if (!buf) {
+		return -1;
+	}
+
+	while (total_written < (ssize_t)count) {
+		bytes_written = pwrite(fd, ptr + total_written,
+				       count - total_written,
+				       offset + total_written);
+		if (bytes_written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return bytes_written;
+		}
+		total_written += bytes_written;
+	}
+	return total_written;
+}
+
 fpga_result cat_token_sysfs_path(char *dest, fpga_token token, const char *path)
 {
 	struct _fpga_token *_token = (struct _fpga_token *)token;
@@ -2022,6 +2067,8 @@ struct _fpga_object *alloc_fpga_object(const char *sysfspath, const char *name)
 		obj->max_size = 0;
 		obj->buffer = NULL;
 		obj->objects = NULL;
+		obj->fd = -1;
+		obj->sync_time = 0;
 	}
 	return obj;
 out_err:
@@ -2035,6 +2082,10 @@ out_err:
 fpga_result destroy_fpga_object(struct _fpga_object *obj)
 {
 	fpga_result res = FPGA_OK;
+	if (obj->fd >= 0) {
+		close(obj->fd);
+		obj->fd = -1;
+	}
 	FREE_IF(obj->path);
 	FREE_IF(obj->name);
 	FREE_IF(obj->buffer);
@@ -2144,26 +2195,161 @@ out_free:
 	return res;
 }
 
+STATIC uint64_t monotonic_nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+STATIC fpga_result read_object(struct _fpga_object *_obj, int fd)
+{
+	ssize_t bytes_read;
+
+	bytes_read = eintr_pread(fd, _obj->buffer, _obj->max_size, 0);
+	if (bytes_read < 0) {
+		OPAE_ERR("Error reading %s: %s", _obj->path, strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+	// don't leave a stale tail from a previous, longer value
+	if ((size_t)bytes_read < _obj->size)
+		memset(_obj->buffer + bytes_read, 0,
+		       _obj->size - (size_t)bytes_read);
+	_obj->size = bytes_read;
+	_obj->sync_time = monotonic_nsec();
+	return FPGA_OK;
+}
+
+// Open the descriptor kept for the life of the object.
+// Called with the object lock held.
+STATIC fpga_result open_object_fd(struct _fpga_object *_obj)
+{
+	if (_obj->fd >= 0)
+		return FPGA_OK;
+
+	_obj->fd = open(_obj->path, _obj->perm);
+	if (_obj->fd < 0) {
+		OPAE_ERR("Error opening %s: %s", _obj->path, strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+	return FPGA_OK;
+}
+
+STATIC void close_object_fd(struct _fpga_object *_obj)
+{
+	if (_obj->fd >= 0) {
+		close(_obj->fd);
+		_obj->fd = -1;
+	}
+}
+
+STATIC fpga_result load_object(struct _fpga_object *_obj)
+{
+	fpga_result res;
+	int fd = open(_obj->path, _obj->perm);
+	if (fd < 0) {
+		OPAE_ERR("Error opening %s: %s", _obj->path, strerror(errno));
+		return FPGA_EXCEPTION;
+	}
+	res = read_object(_obj, fd);
+	close(fd);
+	return res;
+}
+
 fpga_result sync_object(fpga_object obj)
 {
 	struct _fpga_object *_obj;
-	int fd = -1;
-	ssize_t bytes_read = 0;
+	fpga_result res;
 	ASSERT_NOT_NULL(obj);
 	_obj = (struct _fpga_object *)obj;
-	fd = open(_obj->path, _obj->perm);
-	if (fd < 0) {
-		OPAE_ERR("Error opening %s: %s", _obj->path, strerror(errno));
+
+	if (pthread_mutex_lock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
 		return FPGA_EXCEPTION;
 	}
-	bytes_read = eintr_read(fd, _obj->buffer, _obj->max_size);
-	if (bytes_read < 0) {
-		close(fd);
+
+	res = open_object_fd(_obj);
+	if (res == FPGA_OK) {
+		res = read_object(_obj, _obj->fd);
+		// the attribute may have been removed and recreated
+		if (res)
+			close_object_fd(_obj);
+	}
+
+	if (pthread_mutex_unlock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	}
+	return res;
+}
+
+fpga_result sync_object_tree(fpga_object obj, int flags)
+{
+	struct _fpga_object *_obj;
+	struct _fpga_object *child;
+	fpga_result res = FPGA_OK;
+	fpga_result cres;
+	size_t i;
+	ASSERT_NOT_NULL(obj);
+	_obj = (struct _fpga_object *)obj;
+
+	if (_obj->type == FPGA_SYSFS_FILE)
+		return sync_object(obj);
+
+	if (pthread_mutex_lock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
 		return FPGA_EXCEPTION;
 	}
-	_obj->size = bytes_read;
-	close(fd);
-	return FPGA_OK;
+
+	for (i = 0; i < _obj->size; ++i) {
+		child = (struct _fpga_object *)_obj->objects[i];
+		cres = FPGA_OK;
+		if (child->type == FPGA_SYSFS_FILE) {
+			if (child->perm != O_WRONLY)
+				cres = sync_object(child);
+		} else if (flags & FPGA_OBJECT_RECURSE_ALL) {
+			cres = sync_object_tree(child, flags);
+		}
+		// keep going; report the first failure
+		if (cres && !res)
+			res = cres;
+	}
+	_obj->sync_time = monotonic_nsec();
+
+	if (pthread_mutex_unlock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	}
+	return res;
+}
+
+fpga_result write_object(fpga_object obj)
+{
+	struct _fpga_object *_obj;
+	fpga_result res;
+	ssize_t bytes_written;
+	ASSERT_NOT_NULL(obj);
+	_obj = (struct _fpga_object *)obj;
+
+	if (pthread_mutex_lock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return FPGA_EXCEPTION;
+	}
+
+	res = open_object_fd(_obj);
+	if (res == FPGA_OK) {
+		bytes_written = eintr_pwrite(_obj->fd, _obj->buffer,
+					     _obj->size, 0);
+		if (bytes_written < 0 || (size_t)bytes_written != _obj->size) {
+			OPAE_ERR("Did not write 64-bit value: %s",
+				 strerror(errno));
+			close_object_fd(_obj);
+			res = FPGA_EXCEPTION;
+		}
+	}
+
+	if (pthread_mutex_unlock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	}
+	return res;
 }
 
 fpga_result make_sysfs_group(char *sysfspath, const char *name,
@@ -2396,7 +2582,10 @@ fpga_result make_sysfs_object(char *sysfspath, const char *name,
 	}
 	*object = (fpga_object)obj;
 	if (obj->perm == O_RDONLY || obj->perm == O_RDWR) {
-		return sync_object((fpga_object)obj);
+		// Initial read uses a transient descriptor, so that only
+		// objects that are synced again (eg. polled attributes) keep
+		// one open. Recursive containers can hold many attributes.
+		return load_object(obj);
 	}
 
 	return FPGA_OK;
@@ -133,6 +133,7 @@ xfpga_fpgaCloneObject(fpga_object src, fpga_object *dst)
 	_dst->size = _src->size;
 	_dst->type = _src->type;
 	_dst->max_size = _src->max_size;
+	_dst->sync_time = _src->sync_time;
 	if (_src->type == FPGA_SYSFS_FILE) {
 		_dst->buffer = calloc(_dst->max_size, sizeof(uint8_t));
 		memcpy(_dst->buffer, _src->buffer, _src->max_size);
@@ -283,8 +284,6 @@ fpga_result __XFPGA_API__ xfpga_fpgaObjectWrite64(fpga_object obj,
 						 int flags)
 {
 	struct _fpga_object *_obj = (struct _fpga_object *)obj;
-	size_t bytes_written = 0;
-	int fd = -1;
 	fpga_result res = FPGA_OK;
 	int err;
 	ASSERT_NOT_NULL(obj);
@@ -307,21 +306,7 @@ fpga_result __XFPGA_API__ xfpga_fpgaObjectWrite64(fpga_object obj,
 			     value);
 		_obj->size = (size_t)strlen((const char *)_obj->buffer);
 	}
-	fd = open(_obj->path, _obj->perm);
-	if (fd < 0) {
-		OPAE_ERR("Error opening %s: %s", _obj->path, strerror(errno));
-		res = FPGA_EXCEPTION;
-		goto out_unlock;
-	}
-	lseek(fd, 0, SEEK_SET);
-	bytes_written = eintr_write(fd, _obj->buffer, _obj->size);
-	if (bytes_written != _obj->size) {
-		OPAE_ERR("Did not write 64-bit value: %s", strerror(errno));
-		res = FPGA_EXCEPTION;
-	}
-out_unlock:
-	if (fd >= 0)
-		close(fd);
+	res = write_object(obj);
 	err = pthread_mutex_unlock(
 		&((struct _fpga_handle *)_obj->handle)->lock);
 	if (err) {
@@ -331,6 +316,31 @@ out_unlock:
 	return res;
 }
 
+fpga_result __XFPGA_API__ xfpga_fpgaObjectSync(fpga_object obj, int flags)
+{
+	ASSERT_NOT_NULL(obj);
+	return sync_object_tree(obj, flags);
+}
+
+fpga_result __XFPGA_API__ xfpga_fpgaObjectGetTimestamp(fpga_object obj,
+						      uint64_t *timestamp)
+{
+	struct _fpga_object *_obj = (struct _fpga_object *)obj;
+	ASSERT_NOT_NULL(obj);
+	ASSERT_NOT_NULL(timestamp);
+	if (pthread_mutex_lock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_lock() failed");
+		return FPGA_EXCEPTION;
+	}
+
+	*timestamp = _obj->sync_time;
+
+	if (pthread_mutex_unlock(&_obj->lock)) {
+		OPAE_ERR("pthread_mutex_unlock() failed");
+	}
+	return FPGA_OK;
+}
+
 fpga_result __XFPGA_API__ xfpga_fpgaObjectGetType(fpga_object obj,
 						 enum fpga_sysobject_type *type)
 {
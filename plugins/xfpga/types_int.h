@@ -97,14 +97,23 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-/** System-wide unique FPGA resource identifier */
+/** System-wide unique FPGA resource identifier
+ *
+ * Enumerated tokens are interned: there is one per device node, shared
+ * by every enumeration and clone of it and freed with its last
+ * reference. The paths are stored just past the struct.
+ */
 struct _fpga_token {
 	uint32_t device_instance;
 	uint32_t subdev_instance;
 	uint64_t magic;
-	char sysfspath[SYSFS_PATH_MAX];
-	char devpath[DEV_PATH_MAX];
+	const char *sysfspath;
+	const char *devpath;
+	// Built on first use by token_get_errors().
 	struct error_list *errors;
+	bool errors_built;
+	uint32_t ref_count; // 0 for tokens not in the table
+	struct _fpga_token *next;
 };
 
 enum fpga_hw_type {
@@ -157,9 +166,9 @@ struct _fpga_handle {
 	fpga_token token;
 
 	int fddev;                      // file descriptor for the device.
-	int fdfpgad;                    // file descriptor for the event daemon.
+	fpga_objtype objtype;           // FPGA_DEVICE or FPGA_ACCELERATOR
 	uint32_t num_irqs;              // number of interrupts supported
-	uint32_t irq_set;               // bitmask of irqs set
+	uint64_t *irq_set;              // bitmap of irqs set, num_irqs bits
 	struct wsid_tracker *wsid_root; // wsid information (list)
 	struct wsid_tracker *mmio_root; // MMIO information (list)
 	void *umsg_virt;	        // umsg Virtual Memory pointer
@@ -174,6 +183,8 @@ struct _fpga_handle {
 	uint64_t num_bmc_metric;                             // num of bmc values
 #define OPAE_FLAG_HAS_MMX512 (1u << 0)
 	uint32_t flags;
+
+	struct _opae_dfh_index *dfh_index;  // feature index, built on first lookup
 };
 
 /*
@@ -199,25 +210,29 @@ struct wsid_map {
 	uint64_t offset;
 	uint32_t index;
 	int flags;
-	struct wsid_map *next;
 };
 
-/*
- * Hash table to store wsid_maps
- */
-struct wsid_tracker {
-	uint64_t          n_hash_buckets;
-	struct wsid_map **table;
-};
+/* Entries with index below this are reachable through the region index */
+#define WSID_MAX_INDEX 8
 
 /*
- * Global list to store tokens received during enumeration
- * Since tokens as seen by the API are only void*, we need to keep the actual
- * structs somewhere.
+ * Open-addressed hash table to store wsid_maps
+ * While the table grows, entries are drained from old_table into table.
  */
-struct token_map {
-	struct _fpga_token _token;
-	struct token_map *next;
+struct wsid_tracker {
+	struct wsid_map *table;         // inline entries, NULL until first add
+	uint8_t         *state;         // per-slot state, follows table
+	uint32_t         capacity;      // power of two
+	uint32_t         count;         // entries in both tables
+	uint32_t         initial_capacity;
+	struct wsid_map *old_table;     // table being drained, or NULL
+	uint8_t         *old_state;
+	uint32_t         old_capacity;
+	uint32_t         old_count;
+	uint32_t         migrated;      // next old slot to drain
+	uint32_t         index_valid;   // bit i set if index_wsid[i] is current
+	uint32_t         index_count[WSID_MAX_INDEX];
+	uint64_t         index_wsid[WSID_MAX_INDEX];
 };
 
 typedef enum {
@@ -237,6 +252,8 @@ struct _fpga_object {
 	size_t max_size;
 	uint8_t *buffer;
 	fpga_object *objects;
+	int fd;             // persistent descriptor, -1 until first sync/write
+	uint64_t sync_time; // CLOCK_MONOTONIC nsec of the last sync
 };
 
 typedef char max_path_t[PATH_MAX];
@@ -29,6 +29,7 @@
 #endif // HAVE_CONFIG_H
 
 #include <stdio.h>
+#include <string.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include "wsid_list_int.h"
@@ -36,50 +37,212 @@
 /*
  * The code here assumes the caller handles any required mutexes.
  * The logic here is not thread safe on its own.
+ *
+ * Entries live inline in an open-addressed table (linear probing,
+ * power-of-two capacity). The table is allocated on the first
+ * wsid_add(), so handles that never map anything pay only for the
+ * tracker itself. When the load factor would exceed 3/4, a table of
+ * twice the capacity is allocated and the previous one is drained a
+ * few slots at a time by subsequent adds and deletes.
+ *
+ * Because entries move on resize and delete, a struct wsid_map pointer
+ * returned by wsid_find() or wsid_find_by_index() is valid only until
+ * the next wsid_add() or wsid_del() on the same tracker.
  */
 
+#define WSID_MAX_HINT     16384
+#define WSID_MIN_CAPACITY 8
+#define WSID_MIGRATE_STEP 8
+
+#define WSID_SLOT_EMPTY   0
+#define WSID_SLOT_USED    1
+#define WSID_SLOT_DELETED 2
+
 /**
- * @brief Initialize a wsid tracker hash table
- * @param n_hash_buckets
+ * @brief Initialize a wsid tracker
+ * @param n_entries expected number of entries, used to size the
+ *                  table when it is first allocated
  *
  * @return
  */
-struct wsid_tracker *wsid_tracker_init(uint32_t n_hash_buckets)
+struct wsid_tracker *wsid_tracker_init(uint32_t n_entries)
 {
-	if (!n_hash_buckets || (n_hash_buckets > 16384))
+	if (!n_entries || (n_entries > WSID_MAX_HINT))
 		return NULL;
 
-	struct wsid_tracker *root = malloc(sizeof(struct wsid_tracker));
+	struct wsid_tracker *root = calloc(1, sizeof(struct wsid_tracker));
 	if (!root)
 		return NULL;
 
-	root->n_hash_buckets = n_hash_buckets;
-	root->table = calloc(n_hash_buckets, sizeof(struct wsid_map *));
-	if (!root->table) {
-		free(root);
-		return NULL;
-	}
+	root->initial_capacity = WSID_MIN_CAPACITY;
+	while (root->initial_capacity * 3 < n_entries * 4)
+		root->initial_capacity <<= 1;
 
 	return root;
 }
 
 /**
- * @brief Map WSID to hash bucket index
- * @param root
+ * @brief Map WSID to its home slot
+ * @param wsid
+ * @param capacity
+ *
+ * @return slot index
+ */
+static inline uint32_t wsid_hash(uint64_t wsid, uint32_t capacity)
+{
+	/* WSIDs are mostly sequential; mix all bits into the low ones. */
+	wsid ^= wsid >> 33;
+	wsid *= 0xff51afd7ed558ccdULL;
+	wsid ^= wsid >> 33;
+	return (uint32_t)wsid & (capacity - 1);
+}
+
+/**
+ * @brief Allocate an empty table
+ *        The slot states follow the entries in the same allocation.
+ * @param capacity
+ * @param state receives the slot state array
+ *
+ * @return table, or NULL on allocation failure
+ */
+static struct wsid_map *wsid_table_alloc(uint32_t capacity, uint8_t **state)
+{
+	struct wsid_map *table = malloc(capacity *
+				(sizeof(struct wsid_map) + sizeof(uint8_t)));
+
+	if (!table)
+		return NULL;
+
+	*state = (uint8_t *)(table + capacity);
+	memset(*state, WSID_SLOT_EMPTY, capacity);
+	return table;
+}
+
+/**
+ * @brief Locate a WSID in one table
+ * @param table
+ * @param state
+ * @param capacity
  * @param wsid
  *
- * @return bucket index
+ * @return slot index, or capacity if not found
+ */
+static uint32_t wsid_probe(struct wsid_map *table, uint8_t *state,
+			   uint32_t capacity, uint64_t wsid)
+{
+	uint32_t mask = capacity - 1;
+	uint32_t i = wsid_hash(wsid, capacity);
+
+	if (!table)
+		return capacity;
+
+	while (state[i] != WSID_SLOT_EMPTY) {
+		if ((state[i] == WSID_SLOT_USED) && (table[i].wsid == wsid))
+			return i;
+		i = (i + 1) & mask;
+	}
+
+	return capacity;
+}
+
+/**
+ * @brief Place an entry in the current table
+ *        The caller guarantees a free slot.
+ * @param root
+ * @param wm
+ */
+static void wsid_insert(struct wsid_tracker *root, const struct wsid_map *wm)
+{
+	uint32_t mask = root->capacity - 1;
+	uint32_t i = wsid_hash(wm->wsid, root->capacity);
+
+	while (root->state[i] == WSID_SLOT_USED)
+		i = (i + 1) & mask;
+
+	root->table[i] = *wm;
+	root->state[i] = WSID_SLOT_USED;
+}
+
+/**
+ * @brief Move up to n slots from the previous table into the current one
+ * @param root
+ * @param n number of old slots to visit, or 0 for all of them
  */
-static inline uint32_t wsid_hash(struct wsid_tracker *root, uint64_t wsid)
+static void wsid_migrate(struct wsid_tracker *root, uint32_t n)
 {
-	uint64_t h = wsid % 17659;
-	return h % root->n_hash_buckets;
+	if (!root->old_table)
+		return;
+
+	if (!n)
+		n = root->old_capacity;
+
+	while (n-- && root->old_count && (root->migrated < root->old_capacity)) {
+		uint32_t i = root->migrated++;
+
+		if (root->old_state[i] != WSID_SLOT_USED)
+			continue;
+
+		wsid_insert(root, &root->old_table[i]);
+		/* tombstone, so probes for later old entries don't stop here */
+		root->old_state[i] = WSID_SLOT_DELETED;
+		--root->old_count;
+	}
+
+	if (!root->old_count) {
+		free(root->old_table);
+		root->old_table = NULL;
+		root->old_state = NULL;
+		root->old_capacity = 0;
+		root->migrated = 0;
+	}
 }
 
+/**
+ * @brief Make room for one more entry
+ *        Starts an incremental resize when the load factor would
+ *        exceed 3/4.
+ * @param root
+ *
+ * @return true if success, false otherwise
+ */
+static bool wsid_reserve(struct wsid_tracker *root)
+{
+	struct wsid_map *table;
+	uint8_t *state;
+	uint32_t capacity;
+
+	while (!root->table || ((root->count + 1) * 4 > root->capacity * 3)) {
+		if (root->old_table) {
+			/* a resize is already in flight; finish it first */
+			wsid_migrate(root, 0);
+			continue;
+		}
+
+		capacity = root->table ?
+			root->capacity << 1 : root->initial_capacity;
+		table = wsid_table_alloc(capacity, &state);
+		if (!table)
+			return false;
+
+		if (root->table) {
+			root->old_table = root->table;
+			root->old_state = root->state;
+			root->old_capacity = root->capacity;
+			root->old_count = root->count;
+			root->migrated = 0;
+		}
+
+		root->table = table;
+		root->state = state;
+		root->capacity = capacity;
+	}
+
+	return true;
+}
 
 /**
  * @brief Add entry to WSID tracker
- *        Will allocate memory (which is freed by wsid_del() or
+ *        May grow the tracker (which is freed by
  *        wsid_tracker_cleanup())
  * @param root
  * @param wsid
@@ -99,25 +262,65 @@ bool wsid_add(struct wsid_tracker *root,
 	      uint64_t index,
 	      int flags)
 {
-	uint32_t idx = wsid_hash(root, wsid);
-	struct wsid_map *tmp = malloc(sizeof(struct wsid_map));
+	struct wsid_map wm;
 
-	if (!tmp)
+	if (!wsid_reserve(root))
 		return false;
 
-	tmp->wsid   = wsid;
-	tmp->addr   = addr;
-	tmp->phys   = phys;
-	tmp->len    = len;
-	tmp->offset = offset;
-	tmp->index  = index;
-	tmp->flags  = flags;
-	tmp->next   = root->table[idx];
+	wm.wsid   = wsid;
+	wm.addr   = addr;
+	wm.phys   = phys;
+	wm.len    = len;
+	wm.offset = offset;
+	wm.index  = index;
+	wm.flags  = flags;
+
+	wsid_insert(root, &wm);
+	++root->count;
+
+	if (wm.index < WSID_MAX_INDEX) {
+		if (!root->index_count[wm.index]++) {
+			root->index_wsid[wm.index] = wsid;
+			root->index_valid |= 1u << wm.index;
+		}
+	}
 
-	root->table[idx] = tmp;
+	wsid_migrate(root, WSID_MIGRATE_STEP);
 	return true;
 }
 
+/**
+ * @brief Remove the entry at slot i of the current table
+ *        Shifts later members of the probe sequence back so that
+ *        the current table never needs tombstones.
+ * @param root
+ * @param i
+ */
+static void wsid_remove_slot(struct wsid_tracker *root, uint32_t i)
+{
+	uint32_t mask = root->capacity - 1;
+	uint32_t j = i;
+	uint32_t home;
+
+	while (1) {
+		j = (j + 1) & mask;
+		if (root->state[j] == WSID_SLOT_EMPTY)
+			break;
+
+		home = wsid_hash(root->table[j].wsid, root->capacity);
+
+		/* leave j alone if its home lies cyclically in (i, j] */
+		if ((i <= j) ? ((i < home) && (home <= j)) :
+			       ((i < home) || (home <= j)))
+			continue;
+
+		root->table[i] = root->table[j];
+		i = j;
+	}
+
+	root->state[i] = WSID_SLOT_EMPTY;
+}
+
 /**
  * @brief Remove entry from tracker
  *
@@ -128,34 +331,38 @@ bool wsid_add(struct wsid_tracker *root,
  */
 bool wsid_del(struct wsid_tracker *root, uint64_t wsid)
 {
-	uint32_t idx = wsid_hash(root, wsid);
-	struct wsid_map *tmp = root->table[idx];
-
-	if (!tmp)
-		return false; /* empty list */
-
-	if (tmp->wsid == wsid) { /* first entry */
-		root->table[idx] = root->table[idx]->next;
-		free(tmp);
-		return true;
-	}
-
-	while (tmp->next && tmp->next->wsid != wsid) { /* find */
-		tmp = tmp->next;
+	uint32_t index;
+	uint32_t i = wsid_probe(root->table, root->state,
+				root->capacity, wsid);
+
+	if (i < root->capacity) {
+		index = root->table[i].index;
+		wsid_remove_slot(root, i);
+	} else {
+		i = wsid_probe(root->old_table, root->old_state,
+			       root->old_capacity, wsid);
+		if (i >= root->old_capacity)
+			return false; /* not found */
+
+		index = root->old_table[i].index;
+		root->old_state[i] = WSID_SLOT_DELETED;
+		--root->old_count;
 	}
 
-	if (!tmp->next)
-		return false; /* not found */
+	--root->count;
 
-	struct wsid_map *tmp2 = tmp->next;
-	tmp->next = tmp->next->next;
-	free(tmp2);
+	if (index < WSID_MAX_INDEX) {
+		--root->index_count[index];
+		if (root->index_wsid[index] == wsid)
+			root->index_valid &= ~(1u << index);
+	}
 
+	wsid_migrate(root, WSID_MIGRATE_STEP);
 	return true;
 }
 
 /**
- * @brief Clean up remaining entries in linked list
+ * @brief Clean up remaining entries in the tracker
  *        Will delete all remaining entries
  *
  * @param root
@@ -163,29 +370,30 @@ bool wsid_del(struct wsid_tracker *root, uint64_t wsid)
 void wsid_tracker_cleanup(struct wsid_tracker *root,
 			  void (*clean)(struct wsid_map *))
 {
-	uint32_t idx;
+	uint32_t i;
 
 	if (!root)
 		return;
 
-	for (idx = 0; idx < root->n_hash_buckets; idx += 1) {
-		struct wsid_map *tmp = root->table[idx];
+	if (clean) {
+		for (i = 0; i < root->capacity; ++i) {
+			if (root->state[i] == WSID_SLOT_USED)
+				clean(&root->table[i]);
+		}
 
-		while (tmp) {
-			struct wsid_map *tmp2 = tmp->next;
-			if (clean)
-				clean(tmp);
-			free(tmp);
-			tmp = tmp2;
+		for (i = 0; i < root->old_capacity; ++i) {
+			if (root->old_state[i] == WSID_SLOT_USED)
+				clean(&root->old_table[i]);
 		}
 	}
 
+	free(root->old_table);
 	free(root->table);
 	free(root);
 }
 
 /**
- * @ brief Find entry in linked list
+ * @ brief Find entry in tracker
  *
  * @param root
  * @param wsid
@@ -194,40 +402,76 @@ void wsid_tracker_cleanup(struct wsid_tracker *root,
  */
 struct wsid_map *wsid_find(struct wsid_tracker *root, uint64_t wsid)
 {
-	uint32_t idx = wsid_hash(root, wsid);
-	struct wsid_map *tmp = root->table[idx];
+	uint32_t i = wsid_probe(root->table, root->state,
+				root->capacity, wsid);
+
+	if (i < root->capacity)
+		return &root->table[i];
 
-	while (tmp && tmp->wsid != wsid)
-		tmp = tmp->next;
+	i = wsid_probe(root->old_table, root->old_state,
+		       root->old_capacity, wsid);
 
-	return tmp;
+	return (i < root->old_capacity) ? &root->old_table[i] : NULL;
 }
 
 /**
- * @ brief Find entry in linked list
+ * @brief Find the first entry with the given index by visiting every slot
  *
  * @param root
  * @param index
  *
  * @return
  */
-struct wsid_map *wsid_find_by_index(struct wsid_tracker *root, uint32_t index)
+static struct wsid_map *wsid_scan_index(struct wsid_tracker *root,
+					uint32_t index)
 {
-    /*
-     * The hash table isn't set up for finding by index, but this search is
-     * used only for MMIO spaces, which should have a small number of entries.
-     */
-	uint32_t idx;
-	for (idx = 0; idx < root->n_hash_buckets; idx += 1) {
-		struct wsid_map *tmp = root->table[idx];
-
-		while (tmp && tmp->index != index)
-			tmp = tmp->next;
-
-		if (tmp)
-			return tmp;
+	uint32_t i;
+
+	for (i = 0; i < root->capacity; ++i) {
+		if ((root->state[i] == WSID_SLOT_USED) &&
+		    (root->table[i].index == index))
+			return &root->table[i];
+	}
+
+	for (i = 0; i < root->old_capacity; ++i) {
+		if ((root->old_state[i] == WSID_SLOT_USED) &&
+		    (root->old_table[i].index == index))
+			return &root->old_table[i];
 	}
 
 	return NULL;
 }
 
+/**
+ * @ brief Find entry by index (MMIO region number)
+ *
+ * @param root
+ * @param index
+ *
+ * @return
+ */
+struct wsid_map *wsid_find_by_index(struct wsid_tracker *root, uint32_t index)
+{
+	struct wsid_map *wm;
+
+	if (index >= WSID_MAX_INDEX)
+		return wsid_scan_index(root, index);
+
+	if (!root->index_count[index])
+		return NULL;
+
+	if (root->index_valid & (1u << index))
+		return wsid_find(root, root->index_wsid[index]);
+
+	/*
+	 * The indexed entry was deleted while others with the same index
+	 * remain. Pick one of them and remember it.
+	 */
+	wm = wsid_scan_index(root, index);
+	if (wm) {
+		root->index_wsid[index] = wm->wsid;
+		root->index_valid |= 1u << index;
+	}
+
+	return wm;
+}
@@ -33,7 +33,7 @@
 /*
  * WSID tracking structure manipulation functions
  */
-struct wsid_tracker *wsid_tracker_init(uint32_t n_hash_buckets);
+struct wsid_tracker *wsid_tracker_init(uint32_t n_entries);
 void wsid_tracker_cleanup(struct wsid_tracker *root, void (*clean)(struct wsid_map *));
 
 bool wsid_add(struct wsid_tracker *root,
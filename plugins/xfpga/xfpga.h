@@ -52,12 +52,20 @@ fpga_result xfpga_fpgaReadMMIO32(fpga_handle handle, uint32_t mmio_num,
 				 uint64_t offset, uint32_t *value);
 fpga_result xfpga_fpgaWriteMMIO512(fpga_handle handle, uint32_t mmio_num,
 				  uint64_t offset, const void *value);
+fpga_result xfpga_fpgaWriteMMIOBurst(fpga_handle handle, uint32_t mmio_num,
+				    uint64_t offset, const void *lines,
+				    uint32_t num_lines, int flags);
 fpga_result xfpga_fpgaMapMMIO(fpga_handle handle, uint32_t mmio_num,
 			      uint64_t **mmio_ptr);
 fpga_result xfpga_fpgaUnmapMMIO(fpga_handle handle, uint32_t mmio_num);
+fpga_result xfpga_fpgaFindFeature(fpga_handle handle, fpga_guid guid,
+				  uint16_t id, fpga_feature_info *info);
 fpga_result xfpga_fpgaEnumerate(const fpga_properties *filters,
 				uint32_t num_filters, fpga_token *tokens,
 				uint32_t max_tokens, uint32_t *num_matches);
+fpga_result xfpga_fpgaEnumerateAll(const fpga_properties *filters,
+				   uint32_t num_filters, fpga_token **tokens,
+				   uint32_t *num_tokens);
 fpga_result xfpga_fpgaCloneToken(fpga_token src, fpga_token *dst);
 fpga_result xfpga_fpgaDestroyToken(fpga_token *token);
 fpga_result xfpga_fpgaGetNumUmsg(fpga_handle handle, uint64_t *value);
@@ -67,6 +75,10 @@ fpga_result xfpga_fpgaGetUmsgPtr(fpga_handle handle, uint64_t **umsg_ptr);
 fpga_result xfpga_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 				    void **buf_addr, uint64_t *wsid, int flags);
 fpga_result xfpga_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid);
+fpga_result xfpga_fpgaPrepareBuffers(fpga_handle handle, uint32_t count,
+				     fpga_buffer_desc *bufs, int flags);
+fpga_result xfpga_fpgaReleaseBuffers(fpga_handle handle, uint32_t count,
+				     const uint64_t *wsids);
 fpga_result xfpga_fpgaGetIOAddress(fpga_handle handle, uint64_t wsid,
 				   uint64_t *ioaddr);
 fpga_result xfpga_fpgaGetOPAECVersion(fpga_version *version);
@@ -89,6 +101,12 @@ fpga_result xfpga_fpgaRegisterEvent(fpga_handle handle,
 fpga_result xfpga_fpgaUnregisterEvent(fpga_handle handle,
 				      fpga_event_type event_type,
 				      fpga_event_handle event_handle);
+fpga_result xfpga_fpgaRegisterInterruptEvents(fpga_handle handle,
+					      uint32_t start, uint32_t count,
+					      fpga_event_handle *event_handles);
+fpga_result xfpga_fpgaUnregisterInterruptEvents(fpga_handle handle,
+					uint32_t count,
+					fpga_event_handle *event_handles);
 fpga_result xfpga_fpgaAssignPortToInterface(fpga_handle fpga,
 					    uint32_t interface_num,
 					    uint32_t slot_num, int flags);
@@ -119,6 +137,8 @@ fpga_result xfpga_fpgaObjectRead(fpga_object obj, uint8_t *buffer,
 				 size_t offset, size_t len, int flags);
 fpga_result xfpga_fpgaObjectRead64(fpga_object obj, uint64_t *value, int flags);
 fpga_result xfpga_fpgaObjectWrite64(fpga_object obj, uint64_t value, int flags);
+fpga_result xfpga_fpgaObjectSync(fpga_object obj, int flags);
+fpga_result xfpga_fpgaObjectGetTimestamp(fpga_object obj, uint64_t *timestamp);
 fpga_result xfpga_fpgaSetUserClock(fpga_handle handle, uint64_t low_clk,
 				   uint64_t high_clk, int flags);
 fpga_result xfpga_fpgaGetUserClock(fpga_handle handle, uint64_t *low_clk,
@@ -44,6 +44,7 @@ using opae::fpga::types::properties;
 using opae::fpga::types::token;
 using opae::fpga::types::handle;
 using opae::fpga::types::shared_buffer;
+using opae::fpga::types::buffer_arena;
 using opae::fpga::types::event;
 using opae::fpga::types::error;
 using opae::fpga::types::sysobject;
@@ -184,7 +185,8 @@ PYBIND11_MODULE(_opae, m) {
         []() { std::atomic_thread_fence(std::memory_order_release); },
         memory_barrier_doc);
   // define token class
-  m.def("enumerate", &token::enumerate, token_doc_enumerate())
+  m.def("enumerate", &token::enumerate, token_doc_enumerate(),
+        py::call_guard<py::gil_scoped_release>())
       .def("enumerate", token_enumerate_kwargs, token_doc_enumerate_kwargs());
   py::class_<token, token::ptr_t> pytoken(m, "token", token_doc());
   pytoken.def("__getattr__", token_get_sysobject, sysobject_doc_token_get())
@@ -194,15 +196,17 @@ PYBIND11_MODULE(_opae, m) {
 
   // define handle class
   m.def("open", handle_open, handle_doc_open(), py::arg("tok"),
-        py::arg("flags") = 0);
+        py::arg("flags") = 0, py::call_guard<py::gil_scoped_release>());
   py::class_<handle, handle::ptr_t> pyhandle(m, "handle");
   pyhandle.def("__enter__", handle_context_enter, handle_doc_context_enter())
       .def("__exit__", handle_context_exit, handle_doc_context_exit())
       .def("reconfigure", handle_reconfigure, handle_doc_reconfigure(),
            py::arg("slot"), py::arg("fd"), py::arg("flags") = 0)
       .def("__bool__", handle_valid, handle_doc_valid())
-      .def("close", &handle::close, handle_doc_close())
-      .def("reset", &handle::reset, handle_doc_reset())
+      .def("close", &handle::close, handle_doc_close(),
+           py::call_guard<py::gil_scoped_release>())
+      .def("reset", &handle::reset, handle_doc_reset(),
+           py::call_guard<py::gil_scoped_release>())
       .def("read_csr32", &handle::read_csr32, handle_doc_read_csr32(),
            py::arg("offset"), py::arg("csr_space") = 0)
       .def("read_csr64", &handle::read_csr64, handle_doc_read_csr64(),
@@ -216,31 +220,55 @@ PYBIND11_MODULE(_opae, m) {
       .def("find", handle_find_sysobject, sysobject_doc_handle_find(),
            py::arg("name"), py::arg("flags") = FPGA_OBJECT_GLOB);
 
+  // define buffer_arena class
+  m.def("create_buffer_arena", buffer_arena_create, buffer_arena_doc_create(),
+        py::call_guard<py::gil_scoped_release>());
+  py::class_<buffer_arena, buffer_arena::ptr_t> pyarena(m, "buffer_arena",
+                                                        buffer_arena_doc());
+  pyarena
+      .def("allocate", &buffer_arena::allocate, buffer_arena_doc_allocate(),
+           py::arg("len"), py::arg("align") = 0)
+      .def("wsid", &buffer_arena::wsid, buffer_arena_doc_wsid());
+
   // define shared_buffer class
   m.def("allocate_shared_buffer", shared_buffer_allocate,
-        shared_buffer_doc_allocate());
+        shared_buffer_doc_allocate(),
+        py::call_guard<py::gil_scoped_release>());
   py::class_<shared_buffer, shared_buffer::ptr_t> pybuffer(
       m, "shared_buffer", py::buffer_protocol(), shared_buffer_doc());
   pybuffer.def("size", &shared_buffer::size, shared_buffer_doc_size())
       .def("wsid", &shared_buffer::wsid, shared_buffer_doc_wsid())
       .def("io_address", &shared_buffer::io_address,
            shared_buffer_doc_io_address())
-      .def("fill", &shared_buffer::fill, shared_buffer_doc_fill())
+      .def("fill",
+           static_cast<void (shared_buffer::*)(int, unsigned)>(
+               &shared_buffer::fill),
+           shared_buffer_doc_fill(), py::arg("value"), py::arg("threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
       .def("poll", shared_buffer_poll<uint8_t>,
            "Poll for an 8-bit value being set at given offset",
            py::arg("offset"), py::arg("value"), py::arg("mask") = 0,
-           py::arg("timeout_usec") = 1000)
+           py::arg("timeout_usec") = 1000,
+           py::call_guard<py::gil_scoped_release>())
       .def("poll32", shared_buffer_poll<uint32_t>,
            "Poll for a 32-bit value being set at given offset",
            py::arg("offset"), py::arg("value"), py::arg("mask") = 0,
-           py::arg("timeout_usec") = 1000)
+           py::arg("timeout_usec") = 1000,
+           py::call_guard<py::gil_scoped_release>())
       .def("poll64", shared_buffer_poll<uint64_t>,
            "Poll for a 64-bit value being set at given offset",
            py::arg("offset"), py::arg("value"), py::arg("mask"),
-           py::arg("timeout_usec") = 1000)
-      .def("compare", &shared_buffer::compare, shared_buffer_doc_compare())
+           py::arg("timeout_usec") = 1000,
+           py::call_guard<py::gil_scoped_release>())
+      .def("compare",
+           static_cast<int (shared_buffer::*)(shared_buffer::ptr_t, size_t,
+                                              unsigned) const>(
+               &shared_buffer::compare),
+           shared_buffer_doc_compare(), py::arg("other"), py::arg("size"),
+           py::arg("threads") = 1, py::call_guard<py::gil_scoped_release>())
       .def("copy", shared_buffer_copy, shared_buffer_doc_copy(),
-           py::arg("other"), py::arg("size") = 0)
+           py::arg("other"), py::arg("size") = 0, py::arg("threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
       .def_buffer([](shared_buffer &b) -> py::buffer_info {
         return py::buffer_info(
             const_cast<uint8_t *>(b.c_type()), sizeof(uint8_t),
@@ -259,10 +287,13 @@ PYBIND11_MODULE(_opae, m) {
 
   // define event class
   m.def("register_event", event_register_event, event_doc_register_event(),
-        py::arg("handle"), py::arg("event_type"), py::arg("flags") = 0);
+        py::arg("handle"), py::arg("event_type"), py::arg("flags") = 0,
+        py::call_guard<py::gil_scoped_release>());
   py::class_<event, event::ptr_t> pyevent(m, "event", event_doc());
 
-  pyevent.def("os_object", event_os_object, event_doc_os_object());
+  pyevent.def("os_object", event_os_object, event_doc_os_object())
+      .def("wait", event_wait, event_doc_wait(), py::arg("timeout_msec") = -1,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<error, error::ptr_t> pyerror(m, "error", error_doc());
   pyerror.def_property_readonly("name", &error::name, error_doc_name())
@@ -281,8 +312,10 @@ PYBIND11_MODULE(_opae, m) {
       .def("find", sysobject_find_sysobject, sysobject_doc_object_find(),
            py::arg("name"), py::arg("flags") = 0)
       .def("read64",
-           [](sysobject::ptr_t obj) { return obj->read64(FPGA_OBJECT_SYNC); })
-      .def("write64", &sysobject::write64)
+           [](sysobject::ptr_t obj) { return obj->read64(FPGA_OBJECT_SYNC); },
+           py::call_guard<py::gil_scoped_release>())
+      .def("write64", &sysobject::write64,
+           py::call_guard<py::gil_scoped_release>())
       .def("size", &sysobject::size)
       .def("bytes", sysobject_bytes, sysobject_doc_bytes())
       .def("__getitem__", sysobject_getitem, sysobject_doc_getitem())
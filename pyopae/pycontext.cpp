@@ -26,33 +26,38 @@
 
 #include "pycontext.h"
 
-buffer_registry* buffer_registry::instance_ = nullptr;
-
-buffer_registry::buffer_registry() : buffers_() {}
+buffer_registry::buffer_registry() : lock_(), buffers_() {}
 
 buffer_registry& buffer_registry::instance() {
-  if (buffer_registry::instance_ == nullptr) {
-    buffer_registry::instance_ = new buffer_registry();
-  }
-  return *buffer_registry::instance_;
+  // function-local static initialization is thread-safe
+  static buffer_registry *instance_ = new buffer_registry();
+  return *instance_;
 }
 
 void buffer_registry::register_handle(handle_t handle) {
+  std::lock_guard<std::mutex> guard(lock_);
   buffers_[handle] = buffer_list_t();
 }
 
 void buffer_registry::add_buffer(handle_t handle, shared_buffer_t buffer) {
+  std::lock_guard<std::mutex> guard(lock_);
   buffers_[handle].push_back(buffer);
 }
 
 void buffer_registry::unregister_handle(handle_t handle) {
   // find the handle in the internal map
   // and release all buffers associated with the handle
-  auto it = buffers_.find(handle);
-  if (it != buffers_.end()) {
-    for (auto b : it->second) {
-      b->release();
+  buffer_list_t buffers;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = buffers_.find(handle);
+    if (it == buffers_.end()) {
+      return;
     }
+    buffers.swap(it->second);
     buffers_.erase(it);
   }
+  for (auto b : buffers) {
+    b->release();
+  }
 }
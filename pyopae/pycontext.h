@@ -25,6 +25,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <map>
+#include <mutex>
 #include <vector>
 #include <opae/cxx/core/handle.h>
 #include <opae/cxx/core/shared_buffer.h>
@@ -43,8 +44,9 @@ public:
 
 private:
   buffer_registry();
+  // Registry methods may be called with the GIL released.
+  std::mutex lock_;
   buffer_map_t buffers_;
-  static buffer_registry *instance_;
 
 };
 
@@ -24,6 +24,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 #include "pyevents.h"
+#include <poll.h>
+#include <cerrno>
+#include <system_error>
 namespace py = pybind11;
 using opae::fpga::types::event;
 
@@ -65,3 +68,34 @@ const char *event_doc_os_object() {
 int event_os_object(opae::fpga::types::event::ptr_t evnt) {
   return evnt->os_object();
 }
+
+const char *event_doc_wait() {
+  return R"opaedoc(
+    Wait for the event to be signaled. The Python interpreter lock is
+    released while waiting so that other Python threads may continue to run.
+
+    Args:
+      timeout_msec: Maximum time in milliseconds to wait for the event.
+                    A negative value (the default) waits indefinitely.
+
+    Returns True if the event was signaled, False if the wait timed out.
+  )opaedoc";
+}
+
+bool event_wait(opae::fpga::types::event::ptr_t evnt, int timeout_msec) {
+  struct pollfd pfd;
+  int res;
+
+  pfd.fd = evnt->os_object();
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  do {
+    res = poll(&pfd, 1, timeout_msec);
+  } while (res < 0 && errno == EINTR);
+
+  if (res < 0) {
+    throw std::system_error(errno, std::system_category(), "poll");
+  }
+  return res > 0;
+}
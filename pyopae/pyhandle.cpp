@@ -76,6 +76,10 @@ void handle_reconfigure(handle::ptr_t handle, uint32_t slot, py::object file,
   }
   // PyFile_IncUseCount(obj);
   // is fd object already holding a reference count while in this function?
+
+  // Reading the GBS and programming it may take several seconds.
+  // Let other Python threads run in the meantime.
+  py::gil_scoped_release release;
   fseek(fp, 0L, SEEK_END);
   size_t size = ftell(fp);
   fseek(fp, 0L, SEEK_SET);
@@ -121,6 +125,7 @@ const char *handle_doc_context_exit() {
 void handle_context_exit(opae::fpga::types::handle::ptr_t hnd, py::args args) {
   // TODO: Use args for logging exceptions
   (void)args;
+  py::gil_scoped_release release;
   buffer_registry::instance().unregister_handle(hnd);
   hnd->close();
 }
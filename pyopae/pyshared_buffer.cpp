@@ -29,6 +29,7 @@
 
 namespace py = pybind11;
 using opae::fpga::types::shared_buffer;
+using opae::fpga::types::buffer_arena;
 using opae::fpga::types::handle;
 
 const char *shared_buffer_doc() {
@@ -54,6 +55,43 @@ shared_buffer::ptr_t shared_buffer_allocate(handle::ptr_t hndl, size_t size) {
   return buf;
 }
 
+const char *buffer_arena_doc() {
+  return R"opaedoc(
+    buffer_arena carves one large shared buffer into many smaller
+    shared_buffer objects, without a driver call for each one.
+  )opaedoc";
+}
+
+const char *buffer_arena_doc_create() {
+  return R"opaedoc(
+    buffer_arena factory method - create an arena of shared memory.
+    Args:
+      handle: An accelerator handle object that identifies an open accelerator
+      obect to share the arena with.
+      len: The size in bytes of the arena.
+  )opaedoc";
+}
+
+buffer_arena::ptr_t buffer_arena_create(handle::ptr_t hndl, size_t size) {
+  return buffer_arena::create(hndl, size);
+}
+
+const char *buffer_arena_doc_allocate() {
+  return R"opaedoc(
+    Allocate a shared_buffer from the arena. It returns to the arena
+    when it is no longer referenced.
+    Args:
+      len: The length in bytes of the requested buffer.
+      align: The required alignment, a power of two, or 0 for 64 bytes.
+  )opaedoc";
+}
+
+const char *buffer_arena_doc_wsid() {
+  return R"opaedoc(
+    Get the workspace ID shared by the arena's buffers.
+  )opaedoc";
+}
+
 const char *shared_buffer_doc_size() {
   return R"opaedoc(
     Get the length of the buffer in bytes.
@@ -79,6 +117,8 @@ const char *shared_buffer_doc_fill() {
 
     Args:
       value: The value to use when filling the buffer.
+      threads: Number of threads to use. 0 picks a count based on
+               the buffer size.
   )opaedoc";
 }
 
@@ -86,6 +126,12 @@ const char *shared_buffer_doc_compare() {
   return R"opaedoc(
     Compare this shared_buffer (the first len bytes)  object with another one.
     Returns 0 if the two buffers (up to len) are equal.
+
+    Args:
+      other: The buffer to compare against.
+      size: Number of bytes to compare.
+      threads: Number of threads to use. 0 picks a count based on
+               the size.
   )opaedoc";
 }
 
@@ -162,15 +208,18 @@ const char *shared_buffer_doc_write64() {
 const char *shared_buffer_doc_copy() {
   return R"opaedoc(
     Copy the given number of bytes from the current buffer to the buffer in the argument.
+
+    Args:
+      other: The destination buffer.
+      size: Number of bytes to copy. 0 (the default) copies the whole buffer.
+      threads: Number of threads to use. 0 picks a count based on
+               the size.
   )opaedoc";
 }
 
 void shared_buffer_copy(shared_buffer::ptr_t self, shared_buffer::ptr_t other,
-                        size_t size) {
-  uint8_t *src = const_cast<uint8_t *>(self->c_type());
-  uint8_t *dst = const_cast<uint8_t *>(other->c_type());
-
-  std::copy(src, src + (size ? size : self->size()), dst);
+                        size_t size, unsigned threads) {
+  self->copy(other, size, threads);
 }
 
 const char *shared_buffer_doc_split() {
@@ -25,6 +25,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <Python.h>
+#include <opae/cxx/core/buffer_arena.h>
 #include <opae/cxx/core/shared_buffer.h>
 #include <pybind11/pybind11.h>
 #include <chrono>
@@ -37,6 +38,13 @@ opae::fpga::types::shared_buffer::ptr_t shared_buffer_allocate(
     opae::fpga::types::handle::ptr_t hndl, size_t size);
 const char *shared_buffer_doc_size();
 
+const char *buffer_arena_doc();
+const char *buffer_arena_doc_create();
+opae::fpga::types::buffer_arena::ptr_t buffer_arena_create(
+    opae::fpga::types::handle::ptr_t hndl, size_t size);
+const char *buffer_arena_doc_allocate();
+const char *buffer_arena_doc_wsid();
+
 const char *shared_buffer_doc_wsid();
 
 const char *shared_buffer_doc_io_address();
@@ -64,7 +72,7 @@ const char *shared_buffer_doc_write64();
 const char *shared_buffer_doc_copy();
 void shared_buffer_copy(opae::fpga::types::shared_buffer::ptr_t self,
                         opae::fpga::types::shared_buffer::ptr_t other,
-                        size_t size);
+                        size_t size, unsigned threads);
 const char *shared_buffer_doc_split();
 std::vector<opae::fpga::types::shared_buffer::ptr_t> shared_buffer_split(
     opae::fpga::types::shared_buffer::ptr_t buf, pybind11::args args);
@@ -99,6 +99,15 @@ int {driver}_init({driver} *{var}, fpga_handle h)
 templates = {'c': c_struct_templ,
              'cpp': cpp_class_tmpl}
 
+csr_access_modes = {'ro': 'ro', 'rsv': 'ro', 'rsvd': 'ro',
+                    'rw': 'rw', 'wo': 'wo',
+                    'w1c': 'w1c', 'rw1c': 'w1c'}
+
+# names that would hide members of csr::reg in a generated register type
+csr_reserved_names = {'offset', 'reset', 'w1c_mask', 'wo_mask', 'value_type',
+                      'auto', 'class', 'default', 'delete', 'enum', 'new',
+                      'register', 'struct', 'template', 'union'}
+
 
 class ofs_field(object):
     def __init__(self, name, bits, access, default, description):
@@ -289,6 +298,56 @@ class ofs_driver_writer(object):
                 writer.writeline('#endif\n')
                 writer.writeline(f'#endif //  __{self.name}__')
 
+    def write_csr_header(self, output):
+        self.name = self.data['name']
+        self.registers = self.data['registers']
+        filepath = os.path.join(output, f'{self.name}_csr.h')
+        with ofs_header_writer.open(filepath, 'w') as writer:
+            writer.writeline(
+                f'// these structures were auto-generated using {__file__}')
+            writer.writeline(
+                '// modification of these structures may break the software\n')
+            writer.writeline('#pragma once')
+            writer.writeline('#include <opae/cxx/core/csr.h>\n')
+            writer.writeline(f'namespace {self.name} {{')
+            writer.writeline('namespace csr = opae::fpga::types::csr;')
+            for r in self.registers:
+                self.write_csr_register(writer, r)
+            writer.writeline(f'\n}}  // end of namespace {self.name}')
+
+    def write_csr_register(self, fp, r):
+        top = max([f.max() for f in r.fields], default=63)
+        pod = 'uint64_t' if top > 31 else 'uint32_t'
+        w1c = 0
+        wo = 0
+        fields = []
+        for f in sorted(r.fields, key=ofs_field.max, reverse=True):
+            mode = csr_access_modes.get(str(f.access).lower())
+            if mode is None:
+                raise ValueError(f'{r.name}.{f.name}: unknown access '
+                                 f'mode "{f.access}"')
+            name = f.name
+            if name in csr_reserved_names:
+                name = f'{name}_'
+            mask = ((1 << (f.max() - f.min() + 1)) - 1) << f.min()
+            if mode == 'w1c':
+                w1c |= mask
+            elif mode == 'wo':
+                wo |= mask
+            fields.append((name, f, mode))
+
+        fp.writeline('')
+        for line in r.description.split('\n'):
+            fp.writeline(f'// {line}')
+        fp.writeline(f'struct {r.name} : csr::reg<0x{r.offset:04x}, {pod}, '
+                     f'0x{r.default:x}ULL, 0x{w1c:x}ULL, 0x{wo:x}ULL> {{')
+        for name, f, _ in fields:
+            fp.writeline(f'  struct {name};  // {f.description}')
+        fp.writeline('};')
+        for name, f, mode in fields:
+            fp.writeline(f'struct {r.name}::{name} : csr::field<{r.name}, '
+                         f'{f.max()}, {f.min()}, csr::access::{mode}> {{}};')
+
     def write_structures(self, fp, tmpl):
         for r in self.registers:
             r.width = 64 if max(r.fields, key=ofs_field.max).max() > 32 else 32
@@ -386,12 +445,17 @@ def make_headers(args):
         if args.list:
             print(f'{name}.h')
         elif args.driver is None or args.driver == name:
-            writer = ofs_driver_writer(driver)
-            writer.write_header(args.output, args.language)
+            write_language_header(ofs_driver_writer(driver), args)
     else:
         if 'name' in data and 'registers' in data:
-            writer = ofs_driver_writer(data)
-            writer.write_header(args.output, args.language)
+            write_language_header(ofs_driver_writer(data), args)
+
+
+def write_language_header(writer, args):
+    if args.language == 'csr':
+        writer.write_csr_header(args.output)
+    else:
+        writer.write_header(args.output, args.language)
 
 
 def main():
@@ -399,7 +463,7 @@ def main():
     parser.add_argument("input", type=argparse.FileType('r'))
     parsers = parser.add_subparsers()
     headers_parser = parsers.add_parser('headers')
-    headers_parser.add_argument('language', choices=['c', 'cpp'])
+    headers_parser.add_argument('language', choices=['c', 'cpp', 'csr'])
     headers_parser.add_argument('output',
                                 nargs='?',
                                 default=os.getcwd())
@@ -156,4 +156,117 @@ TEST(libofs, wait_for_eq_timeout)
 
   delta_usec = wait_test<uint64_t>(ofs_wait_for_eq64, false, modify_usec, timeout_usec);
   EXPECT_GE(delta_usec, timeout_usec);
-}
\ No newline at end of file
+}
+
+template<typename T>
+uint64_t adaptive_wait_test(int(*wait_fn)(volatile T*, T, uint64_t,
+                                          const struct ofs_wait_policy *,
+                                          uint64_t *),
+                            const struct ofs_wait_policy *policy,
+                            T start, T value, bool modify,
+                            uint64_t modify_usec, uint64_t timeout_usec)
+{
+  volatile T bit = start;
+  auto modify_fn =
+    [&bit, value](int sleep_usec, bool do_modify) {
+      struct timespec ts = {
+        .tv_sec = 0,
+        .tv_nsec = sleep_usec * 1000
+      };
+      nanosleep(&ts, nullptr);
+      if (do_modify) bit = value;
+    };
+
+  uint64_t elapsed_nsec = 0;
+  std::future<void> f = std::async(std::launch::async, modify_fn, modify_usec, modify);
+  auto begin = hrc::now();
+  auto status = wait_fn(&bit, 0b111, timeout_usec, policy, &elapsed_nsec);
+  auto end = hrc::now();
+  f.wait();
+  EXPECT_EQ(status, modify ? 0 : 1);
+  auto delta_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  EXPECT_LE(elapsed_nsec, static_cast<uint64_t>(delta_nsec));
+  return elapsed_nsec / 1000;
+}
+
+/**
+ * @test    adaptive_wait_for_eq
+ * @brief   Tests: ofs_adaptive_wait_for_eq32, ofs_adaptive_wait_for_eq64
+ * @details Have the variable changed in a separate thread before the timeout
+ *          with both the default and a custom policy.
+ *          Verify that the reported wait time is greater than the modify
+ *          time but less than the timeout.
+ * */
+TEST(libofs, adaptive_wait_for_eq)
+{
+  uint64_t modify_usec = 1000;
+  uint64_t timeout_usec = 5000;
+  uint64_t delta_usec = 0;
+  struct ofs_wait_policy policy = { 0, 10, 10, OFS_WAIT_UMWAIT };
+
+  delta_usec = adaptive_wait_test<uint32_t>(ofs_adaptive_wait_for_eq32, nullptr,
+                                            0b101, 0b111, true, modify_usec,
+                                            timeout_usec);
+  EXPECT_GE(delta_usec, modify_usec);
+  EXPECT_LT(delta_usec, timeout_usec);
+
+  delta_usec = adaptive_wait_test<uint64_t>(ofs_adaptive_wait_for_eq64, &policy,
+                                            0b101, 0b111, true, modify_usec,
+                                            timeout_usec);
+  EXPECT_GE(delta_usec, modify_usec);
+  EXPECT_LT(delta_usec, timeout_usec);
+}
+
+/**
+ * @test    adaptive_wait_for_ne
+ * @brief   Tests: ofs_adaptive_wait_for_ne32, ofs_adaptive_wait_for_ne64
+ * @details Start with the variable equal to the compare value and change it
+ *          in a separate thread before the timeout.
+ *          Verify that the reported wait time is greater than the modify
+ *          time but less than the timeout.
+ * */
+TEST(libofs, adaptive_wait_for_ne)
+{
+  uint64_t modify_usec = 1000;
+  uint64_t timeout_usec = 5000;
+  uint64_t delta_usec = 0;
+
+  delta_usec = adaptive_wait_test<uint32_t>(ofs_adaptive_wait_for_ne32, nullptr,
+                                            0b111, 0b101, true, modify_usec,
+                                            timeout_usec);
+  EXPECT_GE(delta_usec, modify_usec);
+  EXPECT_LT(delta_usec, timeout_usec);
+
+  delta_usec = adaptive_wait_test<uint64_t>(ofs_adaptive_wait_for_ne64, nullptr,
+                                            0b111, 0b101, true, modify_usec,
+                                            timeout_usec);
+  EXPECT_GE(delta_usec, modify_usec);
+  EXPECT_LT(delta_usec, timeout_usec);
+}
+
+/**
+ * @test    adaptive_wait_timeout
+ * @brief   Tests: ofs_adaptive_wait_for_eq32, OFS_ADAPTIVE_WAIT_FOR_EQ
+ * @details Leave the variable unchanged.
+ *          Verify that the wait times out and that the reported wait time
+ *          is greater than or equal to the timeout.
+ * */
+TEST(libofs, adaptive_wait_timeout)
+{
+  uint64_t modify_usec = 1000;
+  uint64_t timeout_usec = 1500;
+  uint64_t delta_usec = 0;
+
+  delta_usec = adaptive_wait_test<uint32_t>(ofs_adaptive_wait_for_eq32, nullptr,
+                                            0b101, 0b111, false, modify_usec,
+                                            timeout_usec);
+  EXPECT_GE(delta_usec, timeout_usec);
+
+  volatile uint32_t bit = 0b101;
+  uint64_t elapsed_nsec = 0;
+  EXPECT_EQ(OFS_ADAPTIVE_WAIT_FOR_EQ(bit, 0b111, timeout_usec, nullptr,
+                                     &elapsed_nsec), 1);
+  EXPECT_GE(elapsed_nsec, timeout_usec * 1000);
+  EXPECT_EQ(OFS_ADAPTIVE_WAIT_FOR_NE(bit, 0b111, timeout_usec, nullptr,
+                                     nullptr), 0);
+}
@@ -0,0 +1,140 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <cstring>
+#include "gtest/gtest.h"
+#include "ofs_test_csr.h"
+
+namespace csr = opae::fpga::types::csr;
+
+// A register with every access mode, laid out by hand.
+struct ctl : csr::reg<0x18, uint64_t, 0, 0xf0, 0x100> {
+  struct mode;
+  struct status;
+  struct go;
+  struct busy;
+};
+struct ctl::mode : csr::field<ctl, 3, 0, csr::access::rw> {};
+struct ctl::status : csr::field<ctl, 7, 4, csr::access::w1c> {};
+struct ctl::go : csr::field<ctl, 8, 8, csr::access::wo> {};
+struct ctl::busy : csr::field<ctl, 63, 63, csr::access::ro> {};
+
+struct ctl32 : csr::reg<0x20, uint32_t> {
+  struct lo;
+};
+struct ctl32::lo : csr::field<ctl32, 15, 0> {};
+
+/**
+ * @test    csr_layout
+ * @brief   Tests: csr::reg, csr::field
+ * @details The register types generated from ofs_test.yml carry their
+ *          offsets, reset values and field masks as compile-time
+ *          constants.
+ * */
+TEST(ofs_csr, csr_layout)
+{
+  static_assert(ofs_test::id_hi::offset == 0x10, "id_hi offset");
+  static_assert(ofs_test::fme_dfh::feature_type::mask ==
+                0xf000000000000000ULL, "feature_type mask");
+  static_assert(ofs_test::fme_dfh::eol::width == 1, "eol width");
+  static_assert(!ofs_test::fme_dfh::next_offset::writable, "ro field");
+  static_assert(ofs_test::id_lo::bits::mask == ~0ULL, "full-width field");
+
+  constexpr uint64_t dfh = ofs_test::fme_dfh::reset;
+  EXPECT_EQ(0x5u, ofs_test::fme_dfh::feature_type::get(dfh));
+  EXPECT_EQ(0x1u, ofs_test::fme_dfh::dfh_version::get(dfh));
+}
+
+/**
+ * @test    csr_block_read
+ * @brief   Tests: csr::block::read, csr::block::get
+ * @details Reads through a csr::block come from base + the register
+ *          offset and are decoded by field.
+ * */
+TEST(ofs_csr, csr_block_read)
+{
+  uint64_t mmio[8] = {};
+  mmio[0] = ofs_test::fme_dfh::reset;
+  mmio[1] = 0x1122334455667788ULL;
+
+  csr::block b(reinterpret_cast<uint8_t *>(mmio));
+  EXPECT_EQ(0x1122334455667788ULL, b.read<ofs_test::id_lo>());
+  EXPECT_EQ(0x5u, b.get<ofs_test::fme_dfh::feature_type>());
+  EXPECT_EQ(0x1u, b.get<ofs_test::fme_dfh::dfh_version>());
+}
+
+/**
+ * @test    csr_block_modify
+ * @brief   Tests: csr::block::modify, csr::update
+ * @details A batched update loads once, stores once, preserves the
+ *          bits it does not touch and never writes back pending
+ *          write-1-to-clear bits unless asked to.
+ * */
+TEST(ofs_csr, csr_block_modify)
+{
+  uint64_t mmio[8] = {};
+  mmio[3] = 0x80000000000000f5ULL;  // busy, all status bits, mode 5
+  csr::block b(reinterpret_cast<uint8_t *>(mmio));
+
+  {
+    auto u = b.modify<ctl>();
+    EXPECT_EQ(5u, u.get<ctl::mode>());
+    u.set<ctl::mode>(0xa).set<ctl::go>(1);
+    EXPECT_EQ(0x80000000000000f5ULL, mmio[3]);
+  }
+  EXPECT_EQ(0x800000000000010aULL, mmio[3]);
+
+  mmio[3] = 0xf0;
+  b.set<ctl::status>(0x2);
+  EXPECT_EQ(0x20u, mmio[3]);
+
+  uint32_t *mmio32 = reinterpret_cast<uint32_t *>(mmio);
+  mmio32[8] = 0xdead0000;
+  b.set<ctl32::lo>(0xbeef);
+  EXPECT_EQ(0xdeadbeefu, b.read<ctl32>());
+}
+
+/**
+ * @test    csr_block_modify_side_effects
+ * @brief   Tests: csr::update
+ * @details A batched update reports write-1-to-clear fields as loaded,
+ *          and writes write-only bits back only when they are set.
+ * */
+TEST(ofs_csr, csr_block_modify_side_effects)
+{
+  uint64_t mmio[8] = {};
+  mmio[3] = 0x1f5;  // go read back as 1, all status bits, mode 5
+  csr::block b(reinterpret_cast<uint8_t *>(mmio));
+
+  {
+    auto u = b.modify<ctl>();
+    EXPECT_EQ(0xfu, u.get<ctl::status>());
+    u.set<ctl::mode>(0x3);
+  }
+  EXPECT_EQ(0x3u, mmio[3]);
+
+  b.modify<ctl>().set<ctl::go>(1);
+  EXPECT_EQ(0x103u, mmio[3]);
+}
@@ -152,8 +152,11 @@ int __attribute__((visibility("default"))) opae_plugin_configure(opae_api_adapte
 	adapter->fpgaWriteMMIO32 = NULL;
 	adapter->fpgaReadMMIO32 = NULL;
 	adapter->fpgaWriteMMIO512 = NULL;
+	adapter->fpgaWriteMMIOBurst = NULL;
 	adapter->fpgaMapMMIO = NULL;
 	adapter->fpgaUnmapMMIO = NULL;
+	adapter->fpgaFindFeature = NULL;
+	adapter->fpgaEnumerateAll = NULL;
 	adapter->fpgaCloneToken = NULL;
 	adapter->fpgaGetNumUmsg = NULL;
 	adapter->fpgaSetUmsgAttributes = NULL;
@@ -162,6 +165,8 @@ int __attribute__((visibility("default"))) opae_plugin_configure(opae_api_adapte
 	adapter->fpgaPrepareBuffer = NULL;
 	adapter->fpgaReleaseBuffer = NULL;
 	adapter->fpgaGetIOAddress = NULL;
+	adapter->fpgaPrepareBuffers = NULL;
+	adapter->fpgaReleaseBuffers = NULL;
 	/*
 	**	adapter->fpgaGetOPAECVersion = NULL;
 	**	adapter->fpgaGetOPAECVersionString = NULL;
@@ -176,6 +181,8 @@ int __attribute__((visibility("default"))) opae_plugin_configure(opae_api_adapte
 	adapter->fpgaGetOSObjectFromEventHandle = NULL;
 	adapter->fpgaRegisterEvent = NULL;
 	adapter->fpgaUnregisterEvent = NULL;
+	adapter->fpgaRegisterInterruptEvents = NULL;
+	adapter->fpgaUnregisterInterruptEvents = NULL;
 	adapter->fpgaAssignPortToInterface = NULL;
 	adapter->fpgaAssignToInterface = NULL;
 	adapter->fpgaReleaseFromInterface = NULL;
@@ -188,6 +195,8 @@ int __attribute__((visibility("default"))) opae_plugin_configure(opae_api_adapte
 	adapter->fpgaObjectRead64 = NULL;
 	adapter->fpgaObjectGetSize = NULL;
 	adapter->fpgaObjectWrite64 = NULL;
+	adapter->fpgaObjectSync = NULL;
+	adapter->fpgaObjectGetTimestamp = NULL;
 	adapter->fpgaSetUserClock = NULL;
 	adapter->fpgaGetUserClock = NULL;
 	adapter->fpgaGetNumMetrics = NULL;
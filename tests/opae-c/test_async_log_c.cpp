@@ -0,0 +1,204 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+extern "C" {
+
+#include "opae_int.h"
+#include "async_log.h"
+
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+int queue(int loglevel, const char *fmt, ...)
+{
+  va_list argp;
+  va_start(argp, fmt);
+  int res = opae_log_async_print(loglevel, fmt, argp);
+  va_end(argp);
+  return res;
+}
+
+std::string read_all(FILE *fp)
+{
+  std::string s;
+  char buf[256];
+  size_t n;
+  fflush(fp);
+  rewind(fp);
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    s.append(buf, n);
+  return s;
+}
+
+} // namespace
+
+class async_log_c : public ::testing::Test {
+ protected:
+  async_log_c() : fp_(nullptr) {}
+
+  virtual void SetUp() override {
+    fp_ = tmpfile();
+    ASSERT_NE(nullptr, fp_);
+    ASSERT_EQ(0, opae_log_async_start(fp_));
+  }
+
+  virtual void TearDown() override {
+    opae_log_async_stop();
+    fclose(fp_);
+  }
+
+  FILE *fp_;
+};
+
+/**
+ * @test       not_running
+ * @brief      Test: opae_log_async_print
+ * @details    When the asynchronous logger is stopped,<br>
+ *             then opae_log_async_print returns non-zero,<br>
+ *             so that the caller prints synchronously.<br>
+ */
+TEST_F(async_log_c, not_running) {
+  opae_log_async_stop();
+  EXPECT_NE(0, queue(OPAE_LOG_MESSAGE, "hello\n"));
+}
+
+/**
+ * @test       deferred_format
+ * @brief      Test: opae_log_async_print
+ * @details    Given messages that use each supported conversion,<br>
+ *             when the logger is stopped,<br>
+ *             then the file holds the same text snprintf produces.<br>
+ */
+TEST_F(async_log_c, deferred_format) {
+  char buf[64] = "a stack buffer";
+  std::string expected;
+  char line[256];
+
+  EXPECT_EQ(0, queue(OPAE_LOG_MESSAGE, "%s:%u:%s() : %d%% %5.2f\n",
+                     "file.c", 42u, "func", -7, 3.14159));
+  snprintf(line, sizeof(line), "%s:%u:%s() : %d%% %5.2f\n",
+           "file.c", 42u, "func", -7, 3.14159);
+  expected += line;
+
+  EXPECT_EQ(0, queue(OPAE_LOG_MESSAGE, "0x%016lx %hhx %zu %lld %c|%-6s|\n",
+                     0xdeadbeefUL, 0x1ff, (size_t)123, -5LL, 'z', buf));
+  snprintf(line, sizeof(line), "0x%016lx %hhx %zu %lld %c|%-6s|\n",
+           0xdeadbeefUL, 0x1ff, (size_t)123, -5LL, 'z', buf);
+  expected += line;
+  // The copy must not depend on the caller's buffer.
+  buf[0] = 'X';
+
+  // '*' widths are formatted immediately.
+  EXPECT_EQ(0, queue(OPAE_LOG_MESSAGE, "[%*d]\n", 4, 9));
+  snprintf(line, sizeof(line), "[%*d]\n", 4, 9);
+  expected += line;
+
+  opae_log_async_stop();
+  EXPECT_EQ(expected, read_all(fp_));
+}
+
+/**
+ * @test       threads
+ * @brief      Test: opae_log_async_print
+ * @details    When several threads log concurrently,<br>
+ *             then every message is either written or counted<br>
+ *             as dropped.<br>
+ */
+TEST_F(async_log_c, threads) {
+  const int num_threads = 4;
+  const int per_thread = 1000;
+  uint64_t dropped = opae_log_async_dropped();
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < per_thread; ++i)
+        queue(OPAE_LOG_MESSAGE, "thread %d message %d\n", t, i);
+    });
+  }
+  for (auto &thr : threads)
+    thr.join();
+
+  opae_log_async_stop();
+  dropped = opae_log_async_dropped() - dropped;
+
+  std::string out = read_all(fp_);
+  uint64_t lines = 0;
+  for (char c : out)
+    if (c == '\n')
+      ++lines;
+
+  EXPECT_EQ((uint64_t)(num_threads * per_thread), lines + dropped);
+}
+
+/**
+ * @test       stop_while_logging
+ * @brief      Test: opae_log_async_stop
+ * @details    When the logger is stopped while threads are logging,<br>
+ *             then every message it accepted is either written<br>
+ *             or counted as dropped.<br>
+ */
+TEST_F(async_log_c, stop_while_logging) {
+  const int num_threads = 4;
+  const int per_thread = 1000;
+  uint64_t dropped = opae_log_async_dropped();
+  std::atomic<uint64_t> accepted(0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([t, &accepted]() {
+      for (int i = 0; i < per_thread; ++i)
+        if (!queue(OPAE_LOG_MESSAGE, "thread %d message %d\n", t, i))
+          ++accepted;
+    });
+  }
+
+  opae_log_async_stop();
+  for (auto &thr : threads)
+    thr.join();
+  dropped = opae_log_async_dropped() - dropped;
+
+  // Count only the messages, not the drop reports.
+  std::string out = read_all(fp_);
+  uint64_t lines = 0;
+  for (size_t pos = 0; (pos = out.find("thread ", pos)) != std::string::npos;
+       ++pos)
+    ++lines;
+
+  EXPECT_EQ(accepted.load(), lines + dropped);
+}
@@ -0,0 +1,257 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+extern "C" {
+
+#include <json-c/json.h>
+#include <uuid/uuid.h>
+#include "opae_int.h"
+
+}
+
+#include <opae/fpga.h>
+
+#include <algorithm>
+#include <array>
+#include <set>
+#include <thread>
+#include <vector>
+#include "mock/mock_opae.h"
+
+using namespace opae::testing;
+
+class buffer_arena_c_p : public mock_opae_p<2> {
+ protected:
+  buffer_arena_c_p() {}
+
+  virtual void test_setup() override {
+    ASSERT_EQ(fpgaInitialize(NULL), FPGA_OK);
+    ASSERT_EQ(fpgaGetProperties(nullptr, &filter_), FPGA_OK);
+    ASSERT_EQ(fpgaPropertiesSetObjectType(filter_, FPGA_ACCELERATOR), FPGA_OK);
+    auto device_id = platform_.devices[0].device_id;
+    if (platform_.devices[0].num_vfs) {
+      device_id++;
+    }
+
+    ASSERT_EQ(fpgaPropertiesSetDeviceID(filter_, device_id), FPGA_OK);
+    num_matches_ = 0;
+    ASSERT_EQ(fpgaEnumerate(&filter_, 1, tokens_.data(), tokens_.size(),
+                            &num_matches_), FPGA_OK);
+
+    accel_ = nullptr;
+    ASSERT_EQ(fpgaOpen(tokens_[0], &accel_, 0), FPGA_OK);
+
+    arena_ = nullptr;
+    ASSERT_EQ(fpgaCreateBufferArena(accel_, arena_size, 0, &arena_), FPGA_OK);
+  }
+
+  virtual void test_teardown() override {
+    if (arena_) {
+      EXPECT_EQ(fpgaDestroyBufferArena(&arena_), FPGA_OK);
+    }
+    EXPECT_EQ(fpgaDestroyProperties(&filter_), FPGA_OK);
+    if (accel_) {
+        EXPECT_EQ(fpgaClose(accel_), FPGA_OK);
+        accel_ = nullptr;
+    }
+    fpgaFinalize();
+  }
+
+  static const uint64_t arena_size = 2 * 1024 * 1024;
+
+  fpga_properties filter_;
+  fpga_handle accel_;
+  fpga_buffer_arena arena_;
+  uint32_t num_matches_;
+};
+
+/**
+ * @test       alloc_free
+ * @brief      Test: fpgaBufferArenaAllocate, fpgaBufferArenaFree
+ * @details    Sub-buffers are aligned as requested, do not overlap,<br>
+ *             and their IO addresses are at the same offsets from the<br>
+ *             arena's IO address as their virtual addresses.<br>
+ */
+TEST_P(buffer_arena_c_p, alloc_free) {
+  uint64_t wsid = 0;
+  uint64_t arena_io = 0;
+  ASSERT_EQ(fpgaBufferArenaGetWSID(arena_, &wsid), FPGA_OK);
+  ASSERT_EQ(fpgaGetIOAddress(accel_, wsid, &arena_io), FPGA_OK);
+
+  std::vector<std::pair<uint8_t *, uint64_t>> bufs;
+  uint8_t *first = nullptr;
+  uint64_t first_io = 0;
+  for (uint64_t len : {1, 64, 100, 4096, 5000, 65536, 200000}) {
+    void *p = nullptr;
+    uint64_t io = 0;
+    ASSERT_EQ(fpgaBufferArenaAllocate(arena_, len, 0, &p, &io), FPGA_OK);
+    EXPECT_EQ(reinterpret_cast<uint64_t>(p) % 64, 0);
+    EXPECT_EQ(io % 64, 0);
+    if (!first) {
+      first = static_cast<uint8_t *>(p);
+      first_io = io;
+    } else {
+      EXPECT_EQ(io - first_io,
+                static_cast<uint64_t>(static_cast<uint8_t *>(p) - first));
+    }
+    bufs.emplace_back(static_cast<uint8_t *>(p), len);
+  }
+
+  std::sort(bufs.begin(), bufs.end());
+  for (size_t i = 1; i < bufs.size(); ++i) {
+    EXPECT_LE(bufs[i - 1].first + bufs[i - 1].second, bufs[i].first);
+  }
+
+  void *p = nullptr;
+  ASSERT_EQ(fpgaBufferArenaAllocate(arena_, 256, 4096, &p, nullptr), FPGA_OK);
+  EXPECT_EQ(reinterpret_cast<uint64_t>(p) % 4096, 0);
+  EXPECT_EQ(fpgaBufferArenaFree(arena_, p), FPGA_OK);
+
+  for (auto &b : bufs) {
+    EXPECT_EQ(fpgaBufferArenaFree(arena_, b.first), FPGA_OK);
+  }
+}
+
+/**
+ * @test       exhaust
+ * @brief      Test: fpgaBufferArenaAllocate, fpgaBufferArenaFree
+ * @details    When the arena is full, fpgaBufferArenaAllocate returns<br>
+ *             FPGA_NO_MEMORY. Freed sub-buffers are reused.<br>
+ */
+TEST_P(buffer_arena_c_p, exhaust) {
+  std::vector<void *> bufs;
+  void *p = nullptr;
+  while (fpgaBufferArenaAllocate(arena_, 1024, 0, &p, nullptr) == FPGA_OK) {
+    bufs.push_back(p);
+  }
+  EXPECT_EQ(bufs.size(), arena_size / 1024);
+  EXPECT_EQ(fpgaBufferArenaAllocate(arena_, 64, 0, &p, nullptr),
+            FPGA_NO_MEMORY);
+
+  for (auto b : bufs) {
+    EXPECT_EQ(fpgaBufferArenaFree(arena_, b), FPGA_OK);
+  }
+  ASSERT_EQ(fpgaBufferArenaAllocate(arena_, 1024, 0, &p, nullptr), FPGA_OK);
+  EXPECT_EQ(fpgaBufferArenaFree(arena_, p), FPGA_OK);
+}
+
+/**
+ * @test       reuse_slabs
+ * @brief      Test: fpgaBufferArenaAllocate, fpgaBufferArenaFree
+ * @details    Memory freed by one size of sub-buffer can be<br>
+ *             allocated again at another size.<br>
+ */
+TEST_P(buffer_arena_c_p, reuse_slabs) {
+  std::vector<void *> bufs;
+  void *p = nullptr;
+  while (fpgaBufferArenaAllocate(arena_, 64, 0, &p, nullptr) == FPGA_OK) {
+    bufs.push_back(p);
+  }
+  EXPECT_EQ(bufs.size(), arena_size / 64);
+  for (auto b : bufs) {
+    EXPECT_EQ(fpgaBufferArenaFree(arena_, b), FPGA_OK);
+  }
+  bufs.clear();
+
+  // The thread's cache of 64-byte blocks may still hold a slab or two.
+  while (fpgaBufferArenaAllocate(arena_, 32768, 0, &p, nullptr) == FPGA_OK) {
+    bufs.push_back(p);
+  }
+  EXPECT_GE(bufs.size(), arena_size / 32768 - 4);
+  for (auto b : bufs) {
+    EXPECT_EQ(fpgaBufferArenaFree(arena_, b), FPGA_OK);
+  }
+}
+
+/**
+ * @test       threads
+ * @brief      Test: fpgaBufferArenaAllocate, fpgaBufferArenaFree
+ * @details    Sub-buffers allocated concurrently are all distinct,<br>
+ *             including ones freed by a different thread.<br>
+ */
+TEST_P(buffer_arena_c_p, threads) {
+  const size_t per_thread = 1000;
+  std::array<std::vector<void *>, 4> bufs;
+  std::vector<std::thread> threads;
+
+  for (auto &v : bufs) {
+    threads.emplace_back([this, &v, per_thread]() {
+      for (size_t i = 0; i < per_thread; ++i) {
+        void *p = nullptr;
+        ASSERT_EQ(fpgaBufferArenaAllocate(arena_, 64 + (i % 3) * 64, 0, &p,
+                                          nullptr), FPGA_OK);
+        v.push_back(p);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  std::set<void *> unique;
+  for (auto &v : bufs) {
+    unique.insert(v.begin(), v.end());
+    for (auto p : v) {
+      EXPECT_EQ(fpgaBufferArenaFree(arena_, p), FPGA_OK);
+    }
+  }
+  EXPECT_EQ(unique.size(), bufs.size() * per_thread);
+}
+
+/**
+ * @test       invalid
+ * @brief      Test: fpgaCreateBufferArena, fpgaBufferArenaAllocate,
+ *             fpgaBufferArenaFree
+ * @details    Invalid parameters return FPGA_INVALID_PARAM.<br>
+ */
+TEST_P(buffer_arena_c_p, invalid) {
+  fpga_buffer_arena arena = nullptr;
+  void *p = nullptr;
+  uint8_t local = 0;
+
+  EXPECT_EQ(fpgaCreateBufferArena(accel_, 0, 0, &arena), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaCreateBufferArena(accel_, 4096, FPGA_BUF_PREALLOCATED,
+                                  &arena), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaCreateBufferArena(nullptr, 4096, 0, &arena),
+            FPGA_INVALID_PARAM);
+
+  EXPECT_EQ(fpgaBufferArenaAllocate(arena_, 0, 0, &p, nullptr),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaBufferArenaAllocate(arena_, 64, 48, &p, nullptr),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaBufferArenaAllocate(nullptr, 64, 0, &p, nullptr),
+            FPGA_INVALID_PARAM);
+
+  EXPECT_EQ(fpgaBufferArenaFree(arena_, &local), FPGA_INVALID_PARAM);
+  ASSERT_EQ(fpgaBufferArenaAllocate(arena_, 128, 0, &p, nullptr), FPGA_OK);
+  EXPECT_EQ(fpgaBufferArenaFree(arena_, static_cast<uint8_t *>(p) + 64),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaBufferArenaFree(arena_, p), FPGA_OK);
+}
+
+INSTANTIATE_TEST_CASE_P(buffer_arena_c, buffer_arena_c_p,
+                        ::testing::ValuesIn(test_platform::platforms({})));
@@ -122,4 +122,53 @@ TEST_P(buffer_c_p, ioaddr) {
   EXPECT_EQ(fpgaReleaseBuffer(accel_, wsid), FPGA_OK);
 }
 
+/**
+ * @test       prep_rel_batch
+ * @brief      Test: fpgaPrepareBuffers, fpgaReleaseBuffers
+ * @details    fpgaPrepareBuffers returns a distinct wsid for each buffer,<br>
+ *             along with the IO address that fpgaGetIOAddress reports,<br>
+ *             and fpgaReleaseBuffers releases them all.<br>
+ */
+TEST_P(buffer_c_p, prep_rel_batch) {
+  std::array<fpga_buffer_desc, 4> bufs;
+  std::array<uint64_t, 4> wsids;
+
+  for (auto &b : bufs) {
+    b = {(uint64_t) pg_size_, nullptr, 0, 0};
+  }
+  ASSERT_EQ(fpgaPrepareBuffers(accel_, bufs.size(), bufs.data(), 0), FPGA_OK);
+
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    uint64_t io = 0;
+    EXPECT_NE(bufs[i].buf_addr, nullptr);
+    EXPECT_EQ(fpgaGetIOAddress(accel_, bufs[i].wsid, &io), FPGA_OK);
+    EXPECT_EQ(io, bufs[i].ioaddr);
+    wsids[i] = bufs[i].wsid;
+    for (size_t j = 0; j < i; ++j) {
+      EXPECT_NE(wsids[i], wsids[j]);
+    }
+  }
+
+  EXPECT_EQ(fpgaReleaseBuffers(accel_, wsids.size(), wsids.data()), FPGA_OK);
+  EXPECT_NE(fpgaReleaseBuffer(accel_, wsids[0]), FPGA_OK);
+}
+
+/**
+ * @test       prep_batch_neg
+ * @brief      Test: fpgaPrepareBuffers
+ * @details    When any buffer of the batch is invalid,<br>
+ *             fpgaPrepareBuffers fails and prepares none of them.<br>
+ */
+TEST_P(buffer_c_p, prep_batch_neg) {
+  std::array<fpga_buffer_desc, 2> bufs;
+  bufs[0] = {(uint64_t) pg_size_, nullptr, 0, 0};
+  bufs[1] = {0, nullptr, 0, 0};
+
+  EXPECT_EQ(fpgaPrepareBuffers(accel_, bufs.size(), bufs.data(), 0),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaPrepareBuffers(accel_, 0, bufs.data(), 0),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaPrepareBuffers(accel_, 1, nullptr, 0), FPGA_INVALID_PARAM);
+}
+
 INSTANTIATE_TEST_CASE_P(buffer_c, buffer_c_p, ::testing::ValuesIn(test_platform::platforms({})));
@@ -0,0 +1,156 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+extern "C" {
+
+#include "opae_int.h"
+#include "dfh_index.h"
+
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <map>
+#include "gtest/gtest.h"
+
+namespace {
+
+// A fake MMIO space 0: offset -> register value.
+typedef std::map<uint64_t, uint64_t> csr_map;
+
+fpga_result read_csr(void *context, uint64_t offset, uint64_t *value)
+{
+  csr_map *csrs = static_cast<csr_map *>(context);
+  auto it = csrs->find(offset);
+  if (it == csrs->end())
+    return FPGA_EXCEPTION;
+  *value = it->second;
+  return FPGA_OK;
+}
+
+uint64_t make_dfh(uint64_t type, uint64_t next, bool eol,
+                  uint64_t rev, uint64_t id)
+{
+  return (type << 60) | ((eol ? 1ULL : 0ULL) << 40) |
+         (next << 16) | (rev << 12) | id;
+}
+
+const uint64_t BBB_GUID_L = 0x9D73E8F258E9E3D7;
+const uint64_t BBB_GUID_H = 0x87816958C1484CD0;
+
+} // namespace
+
+class dfh_index_c : public ::testing::Test {
+ protected:
+  dfh_index_c() : index_(nullptr) {}
+
+  virtual void SetUp() override {
+    // AFU at 0x0, private feature at 0x100, BBB at 0x200,
+    // private feature sharing an id at 0x300 (end of list).
+    csrs_[0x000] = make_dfh(1, 0x100, false, 0, 0x0);
+    csrs_[0x008] = 0x1111111111111111;
+    csrs_[0x010] = 0x2222222222222222;
+    csrs_[0x100] = make_dfh(3, 0x100, false, 1, 0x13);
+    csrs_[0x200] = make_dfh(2, 0x100, false, 2, 0x0);
+    csrs_[0x208] = BBB_GUID_L;
+    csrs_[0x210] = BBB_GUID_H;
+    csrs_[0x300] = make_dfh(3, 0x100, true, 3, 0x13);
+  }
+
+  virtual void TearDown() override {
+    opae_dfh_index_destroy(index_);
+  }
+
+  csr_map csrs_;
+  opae_dfh_index *index_;
+};
+
+/**
+ * @test       build
+ * @brief      Test: opae_dfh_index_build
+ * @details    When the DFH chain is well-formed,<br>
+ *             then the index holds every feature in list order,<br>
+ *             stopping at the feature marked end-of-list.<br>
+ */
+TEST_F(dfh_index_c, build) {
+  ASSERT_EQ(opae_dfh_index_build(&index_, read_csr, &csrs_), FPGA_OK);
+  ASSERT_EQ(index_->count, 4);
+  EXPECT_EQ(index_->features[0].type, 1);
+  EXPECT_EQ(index_->features[1].offset, 0x100);
+  EXPECT_EQ(index_->features[1].revision, 1);
+  EXPECT_EQ(index_->features[3].offset, 0x300);
+}
+
+/**
+ * @test       find_guid
+ * @brief      Test: opae_dfh_index_find
+ * @details    When a GUID is given,<br>
+ *             then the feature carrying that GUID is returned,<br>
+ *             and an unknown GUID returns NULL.<br>
+ */
+TEST_F(dfh_index_c, find_guid) {
+  fpga_guid guid;
+  ASSERT_EQ(opae_dfh_index_build(&index_, read_csr, &csrs_), FPGA_OK);
+
+  opae_dfh_guid(BBB_GUID_L, BBB_GUID_H, guid);
+  const fpga_feature_info *f = opae_dfh_index_find(index_, guid, 0);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->offset, 0x200);
+  EXPECT_EQ(f->type, 2);
+  EXPECT_EQ(guid[0], 0x87);
+  EXPECT_EQ(guid[15], 0xD7);
+
+  guid[0] ^= 0xff;
+  EXPECT_EQ(opae_dfh_index_find(index_, guid, 0), nullptr);
+}
+
+/**
+ * @test       find_id
+ * @brief      Test: opae_dfh_index_find
+ * @details    When guid is NULL,<br>
+ *             then the first feature with the given id is returned.<br>
+ */
+TEST_F(dfh_index_c, find_id) {
+  ASSERT_EQ(opae_dfh_index_build(&index_, read_csr, &csrs_), FPGA_OK);
+
+  const fpga_feature_info *f = opae_dfh_index_find(index_, nullptr, 0x13);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->offset, 0x100);
+  EXPECT_EQ(opae_dfh_index_find(index_, nullptr, 0x42), nullptr);
+}
+
+/**
+ * @test       read_err
+ * @brief      Test: opae_dfh_index_build
+ * @details    When a register read fails during the walk,<br>
+ *             then the error is returned and no index is built.<br>
+ */
+TEST_F(dfh_index_c, read_err) {
+  csrs_.erase(0x208);
+  EXPECT_EQ(opae_dfh_index_build(&index_, read_csr, &csrs_), FPGA_EXCEPTION);
+  EXPECT_EQ(index_, nullptr);
+}
@@ -330,6 +330,48 @@ TEST_P(enum_c_p, parent) {
   EXPECT_EQ(fpgaDestroyToken(&tok), FPGA_OK);
 }
 
+TEST_P(enum_c_p, enumerate_all) {
+  fpga_token *tokens = nullptr;
+  uint32_t num_tokens = 0;
+
+  EXPECT_EQ(fpgaEnumerateAll(nullptr, 0, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, GetNumFpgas() * 2);
+  ASSERT_NE(tokens, nullptr);
+  EXPECT_EQ(fpgaDestroyTokens(tokens, num_tokens), FPGA_OK);
+
+  ASSERT_EQ(fpgaPropertiesSetObjectType(filter_, FPGA_ACCELERATOR), FPGA_OK);
+  EXPECT_EQ(fpgaEnumerateAll(&filter_, 1, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, GetNumFpgas());
+
+  // Keep the first token; the rest go with the array.
+  fpga_token tok = tokens[0];
+  tokens[0] = nullptr;
+  EXPECT_EQ(fpgaDestroyTokens(tokens, num_tokens), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyToken(&tok), FPGA_OK);
+}
+
+TEST_P(enum_c_p, enumerate_all_neg) {
+  fpga_token *tokens = nullptr;
+  uint32_t num_tokens = 0;
+
+  EXPECT_EQ(fpgaEnumerateAll(nullptr, 1, &tokens, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAll(&filter_, 0, &tokens, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAll(&filter_, 1, nullptr, &num_tokens),
+            FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaEnumerateAll(&filter_, 1, &tokens, nullptr),
+            FPGA_INVALID_PARAM);
+
+  ASSERT_EQ(fpgaPropertiesSetBus(filter_, 0xff), FPGA_OK);
+  EXPECT_EQ(fpgaEnumerateAll(&filter_, 1, &tokens, &num_tokens), FPGA_OK);
+  EXPECT_EQ(num_tokens, 0);
+  EXPECT_EQ(tokens, nullptr);
+
+  EXPECT_EQ(fpgaDestroyTokens(nullptr, 0), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyTokens(nullptr, 1), FPGA_INVALID_PARAM);
+}
+
 TEST_P(enum_c_p, segment) {
   auto device = platform_.devices[0];
 
@@ -0,0 +1,206 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+extern "C" {
+
+#include "opae_int.h"
+#include "props.h"
+#include "filter_plan.h"
+
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <cstring>
+#include "gtest/gtest.h"
+
+namespace {
+
+int fetch_calls;
+
+fpga_result fetch_objectid(void *context, uint32_t field, uint64_t *value)
+{
+  (void)context;
+  (void)field;
+  ++fetch_calls;
+  *value = 0xbeef;
+  return FPGA_OK;
+}
+
+void *parent_key(fpga_token parent, size_t *len)
+{
+  uint64_t *key = (uint64_t *)malloc(sizeof(uint64_t));
+  *key = (uint64_t)(uintptr_t)parent;
+  *len = sizeof(uint64_t);
+  return key;
+}
+
+const void *candidate_parent(void *context, size_t *len)
+{
+  *len = sizeof(uint64_t);
+  return context;
+}
+
+} // namespace
+
+class filter_plan_c : public ::testing::Test {
+ protected:
+  filter_plan_c() : filter_(nullptr), plan_(nullptr) {}
+
+  virtual void SetUp() override {
+    ASSERT_EQ(FPGA_OK, fpgaGetProperties(nullptr, &filter_));
+    memset(&c_, 0, sizeof(c_));
+    c_.present = ~0U;
+    c_.objtype = FPGA_ACCELERATOR;
+    c_.bus = 0x5e;
+    c_.fetch = fetch_objectid;
+    fetch_calls = 0;
+  }
+
+  virtual void TearDown() override {
+    opae_filter_plan_destroy(plan_);
+    EXPECT_EQ(FPGA_OK, fpgaDestroyProperties(&filter_));
+  }
+
+  fpga_properties filter_;
+  opae_filter_plan *plan_;
+  opae_filter_candidate c_;
+};
+
+/**
+ * @test       empty
+ * @brief      Test: opae_filter_plan_match
+ * @details    When the plan has no filters,<br>
+ *             then every candidate matches.<br>
+ */
+TEST_F(filter_plan_c, empty) {
+  ASSERT_EQ(FPGA_OK, opae_filter_plan_compile(nullptr, 0, nullptr, &plan_));
+  EXPECT_TRUE(opae_filter_plan_match(plan_, &c_));
+}
+
+/**
+ * @test       order
+ * @brief      Test: opae_filter_plan_compile
+ * @details    Given a filter on object ID, object type and bus,<br>
+ *             then the plan compares the bus first and fetches<br>
+ *             the object ID only when the other terms match.<br>
+ */
+TEST_F(filter_plan_c, order) {
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetObjectID(filter_, 0xbeef));
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetObjectType(filter_, FPGA_ACCELERATOR));
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetBus(filter_, 0x5e));
+  ASSERT_EQ(FPGA_OK, opae_filter_plan_compile(&filter_, 1, nullptr, &plan_));
+
+  ASSERT_EQ(3, plan_->clauses[0].count);
+  EXPECT_EQ(OPAE_FILTER_BUS, plan_->clauses[0].terms[0].field);
+  EXPECT_EQ(OPAE_FILTER_OBJTYPE, plan_->clauses[0].terms[1].field);
+  EXPECT_EQ(OPAE_FILTER_OBJECTID, plan_->clauses[0].terms[2].field);
+  EXPECT_TRUE(opae_filter_plan_needs(plan_, OPAE_FILTER_OBJECTID));
+  EXPECT_FALSE(opae_filter_plan_needs(plan_, OPAE_FILTER_GUID));
+
+  EXPECT_TRUE(opae_filter_plan_match(plan_, &c_));
+  EXPECT_EQ(1, fetch_calls);
+
+  c_.bus = 0x5f;
+  EXPECT_FALSE(opae_filter_plan_match(plan_, &c_));
+  EXPECT_EQ(1, fetch_calls);
+}
+
+/**
+ * @test       snapshot
+ * @brief      Test: opae_filter_plan_compile
+ * @details    When a filter changes after compilation,<br>
+ *             then the plan keeps the compiled values.<br>
+ */
+TEST_F(filter_plan_c, snapshot) {
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetBus(filter_, 0x5e));
+  ASSERT_EQ(FPGA_OK, opae_filter_plan_compile(&filter_, 1, nullptr, &plan_));
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetBus(filter_, 0x01));
+  EXPECT_TRUE(opae_filter_plan_match(plan_, &c_));
+}
+
+/**
+ * @test       present
+ * @brief      Test: opae_filter_plan_match
+ * @details    When the candidate doesn't provide a field,<br>
+ *             then terms on that field are ignored.<br>
+ */
+TEST_F(filter_plan_c, present) {
+  EXPECT_EQ(FPGA_OK, fpgaPropertiesSetDeviceID(filter_, 0xbcc0));
+  ASSERT_EQ(FPGA_OK, opae_filter_plan_compile(&filter_, 1, nullptr, &plan_));
+  EXPECT_FALSE(opae_filter_plan_match(plan_, &c_));
+  c_.present &= ~OPAE_FILTER_BIT(OPAE_FILTER_DEVICEID);
+  EXPECT_TRUE(opae_filter_plan_match(plan_, &c_));
+}
+
+/**
+ * @test       parent
+ * @brief      Test: opae_filter_plan_match
+ * @details    Given a filter with a parent,<br>
+ *             then only accelerators with the same parent<br>
+ *             identity match.<br>
+ */
+TEST_F(filter_plan_c, parent) {
+  uint64_t parent = 0x1000;
+  uint64_t other = 0x2000;
+  struct _fpga_properties *p = (struct _fpga_properties *)filter_;
+
+  p->parent = (fpga_token)(uintptr_t)parent;
+  SET_FIELD_VALID(p, FPGA_PROPERTY_PARENT);
+  ASSERT_EQ(FPGA_OK,
+            opae_filter_plan_compile(&filter_, 1, parent_key, &plan_));
+
+  c_.parent = candidate_parent;
+  c_.context = &parent;
+  EXPECT_TRUE(opae_filter_plan_match(plan_, &c_));
+
+  c_.context = &other;
+  EXPECT_FALSE(opae_filter_plan_match(plan_, &c_));
+
+  c_.context = &parent;
+  c_.objtype = FPGA_DEVICE;
+  EXPECT_FALSE(opae_filter_plan_match(plan_, &c_));
+
+  p->parent = nullptr;
+}
+
+/**
+ * @test       null_parent
+ * @brief      Test: opae_filter_plan_compile
+ * @details    When a filter's parent is NULL,<br>
+ *             then its clause never matches.<br>
+ */
+TEST_F(filter_plan_c, null_parent) {
+  struct _fpga_properties *p = (struct _fpga_properties *)filter_;
+
+  SET_FIELD_VALID(p, FPGA_PROPERTY_PARENT);
+  ASSERT_EQ(FPGA_OK,
+            opae_filter_plan_compile(&filter_, 1, parent_key, &plan_));
+  EXPECT_TRUE(plan_->clauses[0].never);
+  EXPECT_FALSE(opae_filter_plan_match(plan_, &c_));
+}
@@ -0,0 +1,195 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+extern "C" {
+
+#include "adapter.h"
+#include "opae_int.h"
+
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+const uint32_t num_events = 40;
+
+// A fake plugin that records registrations by vector.
+struct fake_events {
+  std::vector<uint32_t> registered;
+  uint32_t unregistered = 0;
+  uint32_t batches = 0;
+  uint32_t fail_at = UINT32_MAX;
+  int handles[num_events];
+  uint32_t created = 0;
+};
+
+fake_events *fake;
+
+fpga_result fake_create(fpga_event_handle *event_handle)
+{
+  *event_handle = &fake->handles[fake->created++];
+  return FPGA_OK;
+}
+
+fpga_result fake_register(fpga_handle, fpga_event_type type,
+                          fpga_event_handle, uint32_t flags)
+{
+  if (type != FPGA_EVENT_INTERRUPT || flags == fake->fail_at)
+    return FPGA_INVALID_PARAM;
+  fake->registered.push_back(flags);
+  return FPGA_OK;
+}
+
+fpga_result fake_unregister(fpga_handle, fpga_event_type,
+                            fpga_event_handle)
+{
+  ++fake->unregistered;
+  fake->registered.pop_back();
+  return FPGA_OK;
+}
+
+fpga_result fake_register_batch(fpga_handle, uint32_t start,
+                                uint32_t count,
+                                fpga_event_handle *event_handles)
+{
+  ++fake->batches;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (event_handles[i] != &fake->handles[i])
+      return FPGA_EXCEPTION;
+    fake->registered.push_back(start + i);
+  }
+  return FPGA_OK;
+}
+
+class interrupt_events_c_p : public ::testing::Test {
+ protected:
+  virtual void SetUp() override {
+    std::memset(&adapter_, 0, sizeof(adapter_));
+    adapter_.fpgaCreateEventHandle = fake_create;
+    adapter_.fpgaRegisterEvent = fake_register;
+    adapter_.fpgaUnregisterEvent = fake_unregister;
+    std::memset(&wh_, 0, sizeof(wh_));
+    wh_.magic = OPAE_WRAPPED_HANDLE_MAGIC;
+    wh_.adapter_table = &adapter_;
+    for (uint32_t i = 0; i < num_events; ++i)
+      ehs_[i] = opae_allocate_wrapped_event_handle(nullptr, nullptr);
+    fake = &fake_;
+  }
+
+  virtual void TearDown() override {
+    for (uint32_t i = 0; i < num_events; ++i)
+      opae_destroy_wrapped_event_handle(
+        reinterpret_cast<opae_wrapped_event_handle *>(ehs_[i]));
+    fake = nullptr;
+  }
+
+  opae_api_adapter_table adapter_;
+  opae_wrapped_handle wh_;
+  fpga_event_handle ehs_[num_events];
+  fake_events fake_;
+};
+
+} // namespace
+
+/**
+ * @test       fallback
+ * @brief      Test: fpgaRegisterInterruptEvents
+ * @details    Without a batch entry point, every handle is registered
+ *             with its own vector, past the old 32-vector limit, and
+ *             fpgaUnregisterInterruptEvents releases them all.<br>
+ */
+TEST_F(interrupt_events_c_p, fallback) {
+  ASSERT_EQ(FPGA_OK,
+            fpgaRegisterInterruptEvents(&wh_, 2, num_events, ehs_));
+  ASSERT_EQ(num_events, fake_.registered.size());
+  for (uint32_t i = 0; i < num_events; ++i)
+    EXPECT_EQ(2 + i, fake_.registered[i]);
+  EXPECT_EQ(num_events, fake_.created);
+
+  EXPECT_EQ(FPGA_OK,
+            fpgaUnregisterInterruptEvents(&wh_, num_events, ehs_));
+  EXPECT_EQ(num_events, fake_.unregistered);
+  EXPECT_TRUE(fake_.registered.empty());
+}
+
+/**
+ * @test       unwind
+ * @brief      Test: fpgaRegisterInterruptEvents
+ * @details    When one vector fails in the fallback, those registered
+ *             before it are unregistered again.<br>
+ */
+TEST_F(interrupt_events_c_p, unwind) {
+  fake_.fail_at = 10;
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaRegisterInterruptEvents(&wh_, 0, num_events, ehs_));
+  EXPECT_EQ(10u, fake_.unregistered);
+  EXPECT_TRUE(fake_.registered.empty());
+}
+
+/**
+ * @test       batch
+ * @brief      Test: fpgaRegisterInterruptEvents
+ * @details    A plugin batch entry point is called once, with the
+ *             plugin's own event handles.<br>
+ */
+TEST_F(interrupt_events_c_p, batch) {
+  adapter_.fpgaRegisterInterruptEvents = fake_register_batch;
+  ASSERT_EQ(FPGA_OK,
+            fpgaRegisterInterruptEvents(&wh_, 0, num_events, ehs_));
+  EXPECT_EQ(1u, fake_.batches);
+  EXPECT_EQ(num_events, fake_.registered.size());
+}
+
+/**
+ * @test       invalid
+ * @brief      Test: fpgaRegisterInterruptEvents
+ * @details    A zero count, a NULL array, or an invalid event handle
+ *             is rejected, and unregistering handles that were never
+ *             registered fails.<br>
+ */
+TEST_F(interrupt_events_c_p, invalid) {
+  fpga_event_handle bad[2] = { ehs_[0], &fake_ };
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaRegisterInterruptEvents(&wh_, 0, 0, ehs_));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaRegisterInterruptEvents(&wh_, 0, 1, nullptr));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaRegisterInterruptEvents(&wh_, 0, 2, bad));
+  EXPECT_TRUE(fake_.registered.empty());
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaUnregisterInterruptEvents(&wh_, 2, ehs_ + 4));
+
+  adapter_.fpgaRegisterEvent = nullptr;
+  EXPECT_EQ(FPGA_NOT_SUPPORTED,
+            fpgaRegisterInterruptEvents(&wh_, 0, 1, ehs_));
+}
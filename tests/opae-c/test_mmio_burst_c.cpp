@@ -0,0 +1,199 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+extern "C" {
+
+#include "adapter.h"
+#include "opae_int.h"
+#include "mmio_burst.h"
+
+}
+
+#include <config.h>
+#include <opae/fpga.h>
+
+#include <cstring>
+#include <map>
+#include "gtest/gtest.h"
+
+namespace {
+
+const uint32_t num_lines = 16;
+
+// Source lines, deliberately misaligned by one byte.
+struct burst_source {
+  burst_source() {
+    for (size_t i = 0; i < sizeof(raw); ++i)
+      raw[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  const uint8_t *lines() const { return raw + 1; }
+  uint8_t raw[num_lines * 64 + 1];
+};
+
+// A fake MMIO space that records 64-bit and 512-bit writes.
+struct fake_mmio {
+  std::map<uint64_t, uint64_t> qwords;
+  uint32_t writes64 = 0;
+  uint32_t writes512 = 0;
+  fpga_result result512 = FPGA_OK;
+};
+
+fake_mmio *mmio;
+
+fpga_result fake_write64(fpga_handle, uint32_t, uint64_t offset,
+                         uint64_t value)
+{
+  ++mmio->writes64;
+  mmio->qwords[offset] = value;
+  return FPGA_OK;
+}
+
+fpga_result fake_write512(fpga_handle, uint32_t, uint64_t offset,
+                          void *value)
+{
+  if (mmio->result512 != FPGA_OK)
+    return mmio->result512;
+  ++mmio->writes512;
+  for (int i = 0; i < 8; ++i) {
+    uint64_t q;
+    std::memcpy(&q, static_cast<uint8_t *>(value) + i * 8, sizeof(q));
+    mmio->qwords[offset + i * 8] = q;
+  }
+  return FPGA_OK;
+}
+
+} // namespace
+
+/**
+ * @test       method
+ * @brief      Test: opae_mmio_line_method_get
+ * @details    The chosen method is stable and agrees with
+ *             opae_mmio_line_atomic().<br>
+ */
+TEST(mmio_burst, method) {
+  opae_mmio_line_method m = opae_mmio_line_method_get();
+  EXPECT_LE(m, OPAE_MMIO_LINE_QWORD);
+  EXPECT_EQ(m, opae_mmio_line_method_get());
+  EXPECT_EQ(m <= OPAE_MMIO_LINE_AVX512, opae_mmio_line_atomic());
+}
+
+/**
+ * @test       sequential
+ * @brief      Test: opae_mmio_write_lines
+ * @details    Without fixed, consecutive lines land at consecutive
+ *             addresses and nothing past the burst is touched.<br>
+ */
+TEST(mmio_burst, sequential) {
+  burst_source src;
+  alignas(64) uint8_t dst[(num_lines + 1) * 64];
+
+  std::memset(dst, 0xa5, sizeof(dst));
+  opae_mmio_write_lines(dst, src.lines(), num_lines, false);
+  EXPECT_EQ(0, std::memcmp(dst, src.lines(), num_lines * 64));
+  for (size_t i = num_lines * 64; i < sizeof(dst); ++i)
+    ASSERT_EQ(0xa5, dst[i]);
+}
+
+/**
+ * @test       fixed
+ * @brief      Test: opae_mmio_write_lines
+ * @details    With fixed, every line is written to dst, so the last
+ *             line is what remains.<br>
+ */
+TEST(mmio_burst, fixed) {
+  burst_source src;
+  alignas(64) uint8_t dst[2 * 64];
+
+  std::memset(dst, 0xa5, sizeof(dst));
+  opae_mmio_write_lines(dst, src.lines(), num_lines, true);
+  EXPECT_EQ(0, std::memcmp(dst, src.lines() + (num_lines - 1) * 64, 64));
+  for (size_t i = 64; i < sizeof(dst); ++i)
+    ASSERT_EQ(0xa5, dst[i]);
+}
+
+/**
+ * @test       fallback
+ * @brief      Test: fpgaWriteMMIOBurst
+ * @details    When the plugin has no burst entry point, the API writes
+ *             one fpgaWriteMMIO512 per line, drops to fpgaWriteMMIO64
+ *             when that is unsupported, and fails if
+ *             FPGA_MMIO_BURST_ATOMIC was asked for.<br>
+ */
+TEST(mmio_burst, fallback) {
+  opae_api_adapter_table adapter;
+  opae_wrapped_handle wh;
+  fake_mmio fake;
+  burst_source src;
+  const uint64_t base = 0x1000;
+
+  std::memset(&adapter, 0, sizeof(adapter));
+  adapter.fpgaWriteMMIO64 = fake_write64;
+  adapter.fpgaWriteMMIO512 = fake_write512;
+  std::memset(&wh, 0, sizeof(wh));
+  wh.magic = OPAE_WRAPPED_HANDLE_MAGIC;
+  wh.adapter_table = &adapter;
+  mmio = &fake;
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaWriteMMIOBurst(&wh, 0, base + 8, src.lines(), 1, 0));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgaWriteMMIOBurst(&wh, 0, base, nullptr, 1, 0));
+
+  ASSERT_EQ(FPGA_OK,
+            fpgaWriteMMIOBurst(&wh, 0, base, src.lines(), num_lines, 0));
+  EXPECT_EQ(num_lines, fake.writes512);
+  EXPECT_EQ(0u, fake.writes64);
+  ASSERT_EQ(num_lines * 8, fake.qwords.size());
+  for (uint32_t i = 0; i < num_lines * 8; ++i) {
+    uint64_t q;
+    std::memcpy(&q, src.lines() + i * 8, sizeof(q));
+    ASSERT_EQ(q, fake.qwords[base + i * 8]);
+  }
+
+  fake = fake_mmio();
+  fake.result512 = FPGA_NOT_SUPPORTED;
+  EXPECT_EQ(FPGA_NOT_SUPPORTED,
+            fpgaWriteMMIOBurst(&wh, 0, base, src.lines(), num_lines,
+                               FPGA_MMIO_BURST_ATOMIC));
+  EXPECT_EQ(0u, fake.writes64);
+
+  ASSERT_EQ(FPGA_OK,
+            fpgaWriteMMIOBurst(&wh, 0, base, src.lines(), num_lines,
+                               FPGA_MMIO_BURST_FIXED));
+  EXPECT_EQ(num_lines * 8, fake.writes64);
+  ASSERT_EQ(8u, fake.qwords.size());
+  for (uint32_t i = 0; i < 8; ++i) {
+    uint64_t q;
+    std::memcpy(&q, src.lines() + (num_lines - 1) * 64 + i * 8, sizeof(q));
+    ASSERT_EQ(q, fake.qwords[base + i * 8]);
+  }
+
+  adapter.fpgaWriteMMIO512 = nullptr;
+  EXPECT_EQ(FPGA_NOT_SUPPORTED,
+            fpgaWriteMMIOBurst(&wh, 0, base, src.lines(), 1,
+                               FPGA_MMIO_BURST_ATOMIC));
+  mmio = nullptr;
+}
@@ -202,6 +202,45 @@ TEST_P(object_c_p, obj_get_obj_at0) {
   EXPECT_EQ(fpgaDestroyObject(&obj), FPGA_OK);
 }
 
+/**
+ * @test       obj_sync
+ * @brief      Test: fpgaObjectSync, fpgaObjectGetTimestamp
+ * @details    When fpgaObjectSync is called on a container object,<br>
+ *             the fn updates every attribute in the container<br>
+ *             and records the time of the sync on each object.<br>
+ */
+TEST_P(object_c_p, obj_sync) {
+  fpga_object obj = nullptr;
+  fpga_object child_obj = nullptr;
+  uint64_t ts = 1;
+  uint64_t child_ts = 0;
+
+  ASSERT_EQ(fpgaHandleGetObject(accel_,
+                                "power",
+                                &obj,
+                                FPGA_OBJECT_RECURSE_ONE),
+            FPGA_OK);
+
+  EXPECT_EQ(fpgaObjectGetTimestamp(obj, &ts), FPGA_OK);
+  EXPECT_EQ(ts, 0);
+
+  EXPECT_EQ(fpgaObjectSync(obj, 0), FPGA_OK);
+  EXPECT_EQ(fpgaObjectGetTimestamp(obj, &ts), FPGA_OK);
+  EXPECT_NE(ts, 0);
+
+  ASSERT_EQ(fpgaObjectGetObjectAt(obj, 0, &child_obj), FPGA_OK);
+  EXPECT_EQ(fpgaObjectGetTimestamp(child_obj, &child_ts), FPGA_OK);
+  EXPECT_NE(child_ts, 0);
+  EXPECT_LE(child_ts, ts);
+
+  EXPECT_EQ(fpgaObjectSync(child_obj, 0), FPGA_OK);
+  EXPECT_EQ(fpgaObjectGetTimestamp(child_obj, &child_ts), FPGA_OK);
+  EXPECT_GE(child_ts, ts);
+
+  EXPECT_EQ(fpgaDestroyObject(&child_obj), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyObject(&obj), FPGA_OK);
+}
+
 /**
  * @test       obj_get_type0
  * @brief      Test: fpgaObjectGetType
@@ -25,6 +25,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
+#include <thread>
 
 #include "gtest/gtest.h"
 #include "mock/test_system.h"
@@ -3404,3 +3405,95 @@ TEST_P(properties_c_mock_p, fpga_clone_properties02) {
 INSTANTIATE_TEST_CASE_P(properties_c, properties_c_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({})));
 
+
+/**
+ * @test    snapshot01
+ * @brief   Tests: fpgaPropertiesGetSnapshot
+ * @details Only the fields that were set are reported in valid_fields,<br>
+ *          and their values match the individual getters.<br>
+ */
+TEST(properties_c, snapshot01) {
+  fpga_properties props = nullptr;
+  fpga_properties_snapshot snap;
+  ASSERT_EQ(fpgaGetProperties(NULL, &props), FPGA_OK);
+  EXPECT_EQ(fpgaPropertiesGetSnapshot(props, &snap), FPGA_OK);
+  EXPECT_EQ(snap.valid_fields, 0);
+
+  ASSERT_EQ(fpgaPropertiesSetObjectType(props, FPGA_ACCELERATOR), FPGA_OK);
+  ASSERT_EQ(fpgaPropertiesSetBus(props, 0x5e), FPGA_OK);
+  ASSERT_EQ(fpgaPropertiesSetGUID(props, known_guid), FPGA_OK);
+  ASSERT_EQ(fpgaPropertiesSetNumMMIO(props, 2), FPGA_OK);
+  EXPECT_EQ(fpgaPropertiesGetSnapshot(props, &snap), FPGA_OK);
+  EXPECT_EQ(snap.valid_fields,
+            FPGA_SNAPSHOT_OBJTYPE | FPGA_SNAPSHOT_BUS | FPGA_SNAPSHOT_GUID |
+            FPGA_SNAPSHOT_NUM_MMIO);
+  EXPECT_EQ(snap.objtype, FPGA_ACCELERATOR);
+  EXPECT_EQ(snap.bus, 0x5e);
+  EXPECT_EQ(memcmp(snap.guid, known_guid, sizeof(fpga_guid)), 0);
+  EXPECT_EQ(snap.u.accelerator.num_mmio, 2);
+
+  EXPECT_EQ(fpgaPropertiesGetSnapshot(props, NULL), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaPropertiesGetSnapshot(NULL, &snap), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaDestroyProperties(&props), FPGA_OK);
+}
+
+/**
+ * @test    freeze01
+ * @brief   Tests: fpgaPropertiesFreeze
+ * @details Once frozen, getters still succeed while setters,<br>
+ *          fpgaClearProperties return FPGA_INVALID_PARAM. A clone of a frozen object is writable.<br>
+ */
+TEST(properties_c, freeze01) {
+  fpga_properties props = nullptr;
+  fpga_properties clone = nullptr;
+  uint8_t bus = 0;
+  ASSERT_EQ(fpgaGetProperties(NULL, &props), FPGA_OK);
+  ASSERT_EQ(fpgaPropertiesSetBus(props, 0x5e), FPGA_OK);
+  ASSERT_EQ(fpgaPropertiesFreeze(props), FPGA_OK);
+
+  EXPECT_EQ(fpgaPropertiesGetBus(props, &bus), FPGA_OK);
+  EXPECT_EQ(bus, 0x5e);
+  EXPECT_EQ(fpgaPropertiesSetBus(props, 0x3b), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaClearProperties(props), FPGA_INVALID_PARAM);
+  EXPECT_EQ(fpgaPropertiesFreeze(props), FPGA_OK);
+
+  ASSERT_EQ(fpgaCloneProperties(props, &clone), FPGA_OK);
+  EXPECT_EQ(fpgaPropertiesSetBus(clone, 0x3b), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyProperties(&clone), FPGA_OK);
+  EXPECT_EQ(fpgaDestroyProperties(&props), FPGA_OK);
+  EXPECT_EQ(fpgaPropertiesFreeze(NULL), FPGA_INVALID_PARAM);
+}
+
+/**
+ * @test    freeze02
+ * @brief   Tests: opae_validate_and_lock_properties_ro
+ * @details A reader that took the lock before the object was frozen<br>
+ *          still releases it, so another thread can take it after.<br>
+ */
+TEST(properties_c, freeze02) {
+  fpga_properties props = nullptr;
+  bool locked = false;
+  ASSERT_EQ(fpgaGetProperties(NULL, &props), FPGA_OK);
+
+  struct _fpga_properties *p =
+      opae_validate_and_lock_properties_ro(props, &locked);
+  ASSERT_NE(p, nullptr);
+  EXPECT_TRUE(locked);
+  ASSERT_EQ(fpgaPropertiesFreeze(props), FPGA_OK);
+  opae_unlock_properties_ro(p, locked);
+
+  int err = -1;
+  std::thread other([&] {
+    err = pthread_mutex_trylock(&p->lock);
+    if (!err)
+      pthread_mutex_unlock(&p->lock);
+  });
+  other.join();
+  EXPECT_EQ(err, 0);
+
+  p = opae_validate_and_lock_properties_ro(props, &locked);
+  ASSERT_NE(p, nullptr);
+  EXPECT_FALSE(locked);
+  opae_unlock_properties_ro(p, locked);
+  EXPECT_EQ(fpgaDestroyProperties(&props), FPGA_OK);
+}
@@ -0,0 +1,150 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+#include <opae/cxx/core/async.h>
+
+using namespace opae::fpga::types;
+using namespace std::chrono;
+
+/**
+ * @test post_order
+ * Given an executor<br>
+ * When I post callbacks and delayed callbacks to it<br>
+ * Then they run on the executor thread<br>
+ * And the delayed ones run in deadline order after the others<br>
+ */
+TEST(async_cxx_core, post_order) {
+  auto ex = executor::create();
+  std::vector<int> order;
+  std::promise<std::thread::id> done;
+
+  ex->post_after(microseconds(20000), [&]() {
+    order.push_back(3);
+    done.set_value(std::this_thread::get_id());
+  });
+  ex->post_after(microseconds(5000), [&]() { order.push_back(2); });
+  ex->post([&]() { order.push_back(1); });
+
+  auto f = done.get_future();
+  ASSERT_EQ(f.wait_for(seconds(5)), std::future_status::ready);
+  EXPECT_NE(f.get(), std::this_thread::get_id());
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+/**
+ * @test watch_fd
+ * Given an executor watching an eventfd<br>
+ * When the eventfd is signaled<br>
+ * Then the watch callback runs exactly once<br>
+ * And unwatch() reports that nothing is pending<br>
+ */
+TEST(async_cxx_core, watch_fd) {
+  auto ex = executor::create();
+  int fd = eventfd(0, 0);
+  ASSERT_GE(fd, 0);
+
+  std::atomic<int> fired(0);
+  std::promise<void> done;
+  ex->watch(fd, [&]() {
+    ++fired;
+    done.set_value();
+  });
+  EXPECT_THROW(ex->watch(fd, []() {}), std::system_error);
+
+  uint64_t one = 1;
+  ASSERT_EQ(write(fd, &one, sizeof(one)), (ssize_t)sizeof(one));
+  ASSERT_EQ(done.get_future().wait_for(seconds(5)),
+            std::future_status::ready);
+
+  std::this_thread::sleep_for(milliseconds(10));
+  EXPECT_EQ(fired, 1);
+  EXPECT_FALSE(ex->unwatch(fd));
+
+  ex->watch(fd, []() {});
+  EXPECT_TRUE(ex->unwatch(fd));
+  close(fd);
+}
+
+/**
+ * @test offload
+ * Given an executor with one worker<br>
+ * When I offload work that succeeds and work that throws<br>
+ * Then each completion receives the matching exception_ptr<br>
+ */
+TEST(async_cxx_core, offload) {
+  auto ex = executor::create(1);
+  std::promise<void> ok, bad;
+
+  ex->offload([]() {},
+              [&](std::exception_ptr e) {
+                if (e) ok.set_exception(e);
+                else ok.set_value();
+              });
+  ex->offload([]() { throw std::runtime_error("boom"); },
+              [&](std::exception_ptr e) {
+                if (e) bad.set_exception(e);
+                else bad.set_value();
+              });
+
+  EXPECT_NO_THROW(ok.get_future().get());
+  EXPECT_THROW(bad.get_future().get(), std::runtime_error);
+}
+
+/**
+ * @test destroy_pending
+ * Given an executor with a pending delayed callback<br>
+ * When the executor is destroyed<br>
+ * Then the callback is dropped without running<br>
+ */
+TEST(async_cxx_core, destroy_pending) {
+  bool ran = false;
+  {
+    auto ex = executor::create();
+    ex->post_after(seconds(60), [&]() { ran = true; });
+  }
+  EXPECT_FALSE(ran);
+}
+
+/**
+ * @test null_args
+ * When I pass null objects to the async functions<br>
+ * Then std::invalid_argument is thrown<br>
+ */
+TEST(async_cxx_core, null_args) {
+  EXPECT_THROW(async_wait(nullptr), std::invalid_argument);
+  EXPECT_THROW(async_poll(nullptr, 0, 1, 1), std::invalid_argument);
+  EXPECT_THROW(async_reset(nullptr), std::invalid_argument);
+  EXPECT_THROW(async_reconfigure(nullptr, 0, std::vector<uint8_t>()),
+               std::invalid_argument);
+  EXPECT_THROW(executor::create(0), std::invalid_argument);
+}
@@ -0,0 +1,85 @@
+// Copyright(c) 2018, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "libopaecxx/src/bulk.h"
+
+using namespace opae::fpga::types::detail;
+
+class bulk_cxx_core : public ::testing::TestWithParam<size_t> {
+ protected:
+  virtual void SetUp() override {
+    // Force the streaming path for anything over 64 KiB.
+    threshold_ = bulk_nt_threshold(64 * 1024);
+  }
+
+  virtual void TearDown() override { bulk_nt_threshold(threshold_); }
+
+  size_t threshold_;
+};
+
+/**
+ * @test fill_copy_equal
+ * Given buffers of sizes around the streaming threshold<br>
+ * And start addresses that are not vector aligned<br>
+ * When I fill, copy and compare them on 1, 4 and automatic threads<br>
+ * Then every byte matches memset/memcpy/memcmp<br>
+ */
+TEST_P(bulk_cxx_core, fill_copy_equal) {
+  size_t len = GetParam();
+  std::vector<uint8_t> a(len + 64), b(len + 64);
+  uint8_t *src = a.data() + 3;
+  uint8_t *dst = b.data() + 17;
+
+  for (unsigned threads : {1u, 4u, 0u}) {
+    bulk_fill(src, 0xa5 + threads, len, threads);
+    for (size_t i = 0; i < len; ++i) {
+      ASSERT_EQ(src[i], uint8_t(0xa5 + threads)) << i;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+      src[i] = uint8_t(i * 7 + threads);
+    }
+    bulk_copy(dst, src, len, threads);
+    ASSERT_EQ(0, memcmp(dst, src, len));
+    EXPECT_TRUE(bulk_equal(dst, src, len, threads));
+
+    if (len) {
+      dst[len - 1] ^= 1;
+      EXPECT_FALSE(bulk_equal(dst, src, len, threads));
+      dst[len - 1] ^= 1;
+      dst[0] ^= 1;
+      EXPECT_FALSE(bulk_equal(dst, src, len, threads));
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(bulk, bulk_cxx_core,
+                        ::testing::Values(0, 1, 63, 4096, 64 * 1024 - 1,
+                                          64 * 1024 + 129,
+                                          8 * 1024 * 1024 + 5));
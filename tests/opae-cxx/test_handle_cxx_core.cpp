@@ -31,7 +31,10 @@
 #include "mock/test_system.h"
 
 #include <linux/ioctl.h>
+#include <atomic>
 #include <cstdarg>
+#include <thread>
+#include <vector>
 #include "fpga-dfl.h"
 #include "intel-fpga.h"
 
@@ -158,6 +161,29 @@ TEST_P(handle_cxx_core, reconfigure_null) {
                invalid_param);
 }
 
+/**
+ * @test close_threads
+ * Given a handle closed from several threads at once, exactly one<br>
+ * close succeeds and the others find it already closed.<br>
+ */
+TEST_P(handle_cxx_core, close_threads) {
+  handle_ = handle::open(tokens_[0], FPGA_OPEN_SHARED);
+  ASSERT_NE(nullptr, handle_.get());
+
+  std::atomic<int> closed(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      if (handle_->close() == FPGA_OK) ++closed;
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  EXPECT_EQ(1, closed.load());
+  EXPECT_EQ(nullptr, handle_->c_type());
+  EXPECT_THROW(handle_->reset(), invalid_param);
+}
+
 /**
  * @test mmio_32
  * write_csr32 should be able to write a value and read_csr32
@@ -0,0 +1,179 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "gtest/gtest.h"
+
+#include <opae/mem_prefault.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+class mem_prefault_c_p : public ::testing::TestWithParam<uint32_t> {
+ protected:
+  void SetUp() override {
+    page_ = sysconf(_SC_PAGE_SIZE);
+    len_ = 64 * page_ + 123;
+    buf_ = static_cast<uint8_t *>(mmap(nullptr, len_, PROT_READ|PROT_WRITE,
+                                       MAP_PRIVATE|MAP_ANONYMOUS, -1, 0));
+    ASSERT_NE(MAP_FAILED, buf_);
+  }
+
+  void TearDown() override {
+    munmap(buf_, len_);
+  }
+
+  size_t resident() {
+    size_t pages = (len_ + page_ - 1) / page_;
+    std::vector<unsigned char> vec(pages);
+    size_t count = 0;
+    EXPECT_EQ(0, mincore(buf_, len_, vec.data()));
+    for (auto v : vec)
+      count += v & 1;
+    return count;
+  }
+
+  size_t page_;
+  size_t len_;
+  uint8_t *buf_;
+};
+
+/**
+ * @test    populate
+ * @brief   Test: mem_prefault()
+ * @details Every page of a fresh mapping is resident afterwards, and<br>
+ *          the thread count is the one asked for, capped by the page count.
+ */
+TEST_P(mem_prefault_c_p, populate)
+{
+  struct mem_prefault p = { GetParam(), -1, 0, 0 };
+
+  ASSERT_EQ(0u, resident());
+  ASSERT_EQ(0, mem_prefault(buf_, len_, 0, &p));
+  EXPECT_EQ(65u, resident());
+  EXPECT_EQ(GetParam() ? std::min(GetParam(), 65u) : 1u, p.threads);
+  EXPECT_EQ(0, buf_[0]);
+  EXPECT_EQ(0, buf_[len_ - 1]);
+}
+
+/**
+ * @test    zero
+ * @brief   Test: mem_prefault()
+ * @details MEM_PREFAULT_ZERO clears existing data, while a plain<br>
+ *          prefault leaves it as it was.
+ */
+TEST_P(mem_prefault_c_p, zero)
+{
+  struct mem_prefault p = { GetParam(), 0, 0, 0 };
+
+  memset(buf_, 0x5a, len_);
+  ASSERT_EQ(0, mem_prefault(buf_, len_, 0, &p));
+  for (size_t i = 0; i < len_; ++i)
+    ASSERT_EQ(0x5a, buf_[i]);
+
+  p.flags = MEM_PREFAULT_ZERO;
+  ASSERT_EQ(0, mem_prefault(buf_, len_, 0, &p));
+  for (size_t i = 0; i < len_; ++i)
+    ASSERT_EQ(0, buf_[i]);
+}
+
+INSTANTIATE_TEST_CASE_P(mem_prefault_c, mem_prefault_c_p,
+                        ::testing::Values(0, 1, 3, 8, 100));
+
+/**
+ * @test    read_only
+ * @brief   Test: mem_prefault()
+ * @details MEM_PREFAULT_READ can fault in a mapping that may not be<br>
+ *          written.
+ */
+TEST(mem_prefault_c, read_only)
+{
+  size_t page = sysconf(_SC_PAGE_SIZE);
+  void *buf = mmap(nullptr, 4 * page, PROT_READ,
+                   MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+  struct mem_prefault p = { 2, -1, MEM_PREFAULT_READ, 0 };
+
+  ASSERT_NE(MAP_FAILED, buf);
+  EXPECT_EQ(0, mem_prefault(buf, 4 * page, 0, &p));
+  EXPECT_EQ(2u, p.threads);
+  munmap(buf, 4 * page);
+}
+
+/**
+ * @test    invalid
+ * @brief   Test: mem_prefault()
+ * @details NULL parameters and misaligned addresses are rejected.
+ */
+TEST(mem_prefault_c, invalid)
+{
+  struct mem_prefault p = { 0, -1, 0, 0 };
+  alignas(4096) static uint8_t buf[2 * 4096];
+
+  EXPECT_NE(0, mem_prefault(nullptr, 4096, 0, &p));
+  EXPECT_NE(0, mem_prefault(buf, sizeof(buf), 0, nullptr));
+  EXPECT_NE(0, mem_prefault(buf + 1, 4096, 0, &p));
+  EXPECT_NE(0, mem_prefault(buf, 4096, 3000, &p));
+  EXPECT_EQ(0, mem_prefault(buf, 0, 0, &p));
+  EXPECT_EQ(0u, p.threads);
+}
+
+/**
+ * @test    numa_node
+ * @brief   Test: mem_prefault_numa_node()
+ * @details The search walks up from a path below the device, and<br>
+ *          paths that don't exist give -1.
+ */
+TEST(mem_prefault_c, numa_node)
+{
+  EXPECT_EQ(-1, mem_prefault_numa_node(nullptr));
+  EXPECT_EQ(-1, mem_prefault_numa_node("/no/such/device"));
+
+  char tmpl[] = "/tmp/mem_prefault_c.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(tmpl));
+  std::string dev = std::string(tmpl) + "/0000:00:00.0";
+  std::string sub = dev + "/fpga_region";
+  ASSERT_EQ(0, mkdir(dev.c_str(), 0700));
+  ASSERT_EQ(0, mkdir(sub.c_str(), 0700));
+  FILE *fp = fopen((dev + "/numa_node").c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "1\n");
+  fclose(fp);
+
+  EXPECT_EQ(1, mem_prefault_numa_node(sub.c_str()));
+  EXPECT_EQ(1, mem_prefault_numa_node(dev.c_str()));
+
+  unlink((dev + "/numa_node").c_str());
+  rmdir(sub.c_str());
+  rmdir(dev.c_str());
+  rmdir(tmpl);
+}
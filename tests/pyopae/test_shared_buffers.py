@@ -25,6 +25,8 @@
 # POSSIBILITY OF SUCH DAMAGE.
 import struct
 import sys
+import threading
+import time
 
 # pylint: disable=E0602, E0603
 
@@ -72,6 +74,16 @@ class TestSharedBuffer(unittest.TestCase):
         buff1[42] = int(65536)
         assert struct.unpack('<L', (bytearray(buff1[42:46])))[0] == 65536
 
+    def test_threaded_bulk_ops(self):
+        size = 4 * 1024 * 1024
+        buff1 = opae.fpga.allocate_shared_buffer(self.handle, size)
+        buff2 = opae.fpga.allocate_shared_buffer(self.handle, size)
+        buff1.fill(0x5a, threads=4)
+        buff1.copy(buff2, threads=4)
+        assert not buff1.compare(buff2, size, threads=4)
+        buff2[size - 1] = 0
+        assert buff1.compare(buff2, size, threads=0)
+
     def test_conext_release(self):
         assert self.handle
         self.handle.close()
@@ -84,3 +96,17 @@ class TestSharedBuffer(unittest.TestCase):
         assert buff.size() == 0
         assert buff.wsid() == 0
 
+    def test_poll_releases_gil(self):
+        with opae.fpga.open(self.toks[0], opae.fpga.OPEN_SHARED) as h:
+            buff = opae.fpga.allocate_shared_buffer(h, 4096)
+            buff.fill(0)
+
+            def writer():
+                time.sleep(0.1)
+                buff[0] = 1
+
+            t = threading.Thread(target=writer)
+            t.start()
+            # poll must not hold the GIL or the writer can never run
+            assert buff.poll(0, 1, 0xff, 2000000)
+            t.join()
@@ -0,0 +1,301 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+extern "C" {
+#include <opae/types.h>
+#include "fpgad_conn_int.h"
+}
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <cstring>
+
+#include "fake_fpgad.h"
+
+fake_fpgad::fake_fpgad(const std::string &path, bool batching)
+  : path_(path), batching_(batching), listen_fd_(-1), wake_fd_(-1),
+    connections_(0), messages_(0), batches_(0), acks_(0), drop_(false),
+    refuse_(false) {}
+
+fake_fpgad::~fake_fpgad() { stop(); }
+
+bool fake_fpgad::start() {
+  struct sockaddr_un addr;
+
+  unlink(path_.c_str());
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0)
+    return false;
+
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+  if (bind(listen_fd_, (struct sockaddr *)&addr, sizeof(addr)) ||
+      listen(listen_fd_, 16)) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+
+  wake_fd_ = eventfd(0, EFD_CLOEXEC);
+  thread_ = std::thread(&fake_fpgad::run, this);
+  return true;
+}
+
+void fake_fpgad::stop() {
+  if (listen_fd_ < 0)
+    return;
+
+  uint64_t one = 1;
+  if (write(wake_fd_, &one, sizeof(one)) < 0)
+    return;
+  thread_.join();
+
+  for (auto c : clients_)
+    remove_client(c);
+  clients_.clear();
+  close(listen_fd_);
+  close(wake_fd_);
+  listen_fd_ = wake_fd_ = -1;
+  unlink(path_.c_str());
+}
+
+void fake_fpgad::drop_clients() {
+  uint64_t one = 1;
+  drop_ = true;
+  if (write(wake_fd_, &one, sizeof(one)) < 0)
+    return;
+  while (drop_)
+    std::this_thread::yield();
+}
+
+void fake_fpgad::signal_all() {
+  std::lock_guard<std::mutex> g(lock_);
+  uint64_t one = 1;
+  for (auto &r : regs_)
+    if (write(r.fd, &one, sizeof(one)) < 0)
+      continue;
+}
+
+size_t fake_fpgad::num_registered() {
+  std::lock_guard<std::mutex> g(lock_);
+  return regs_.size();
+}
+
+std::vector<fake_fpgad::registration> fake_fpgad::registered() {
+  std::lock_guard<std::mutex> g(lock_);
+  return regs_;
+}
+
+void fake_fpgad::remove_client(int client) {
+  std::lock_guard<std::mutex> g(lock_);
+  auto end = std::remove_if(regs_.begin(), regs_.end(),
+                            [client](const registration &r) {
+                              if (r.client != client)
+                                return false;
+                              close(r.fd);
+                              return true;
+                            });
+  regs_.erase(end, regs_.end());
+  close(client);
+}
+
+void fake_fpgad::run() {
+  while (true) {
+    std::vector<struct pollfd> pfds(2 + clients_.size());
+    pfds[0].fd = wake_fd_;
+    pfds[1].fd = listen_fd_;
+    for (size_t i = 0; i < clients_.size(); ++i)
+      pfds[2 + i].fd = clients_[i];
+    for (auto &p : pfds) {
+      p.events = POLLIN;
+      p.revents = 0;
+    }
+
+    if (poll(pfds.data(), pfds.size(), -1) < 0)
+      continue;
+
+    if (pfds[0].revents) {
+      uint64_t v;
+      if (read(wake_fd_, &v, sizeof(v)) < 0)
+        continue;
+      if (!drop_)
+        return;
+      for (auto c : clients_)
+        remove_client(c);
+      clients_.clear();
+      drop_ = false;
+      continue;
+    }
+
+    if (pfds[1].revents) {
+      int c = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (c >= 0) {
+        ++connections_;
+        clients_.push_back(c);
+        if (batching_) {
+          struct fpgad_event_reply hello = {
+            FPGAD_EVENT_MAGIC, FPGAD_REPLY_HELLO, FPGAD_EVENT_VERSION, 0
+          };
+          if (send(c, &hello, sizeof(hello), MSG_NOSIGNAL) < 0)
+            continue;
+        }
+      }
+    }
+
+    for (size_t i = 2; i < pfds.size(); ++i) {
+      if (pfds[i].revents && !serve(pfds[i].fd)) {
+        remove_client(pfds[i].fd);
+        clients_.erase(std::find(clients_.begin(), clients_.end(),
+                                 pfds[i].fd));
+      }
+    }
+  }
+}
+
+// Read one request or batch from client. Returns false when it is gone.
+bool fake_fpgad::serve(int client) {
+  union {
+    struct fpgad_event_request req;
+    struct {
+      struct fpgad_event_batch hdr;
+      struct fpgad_event_entry entries[FPGAD_EVENT_BATCH_MAX];
+    } batch;
+  } msg;
+  union {
+    char buf[CMSG_SPACE(sizeof(int) * FPGAD_EVENT_BATCH_MAX)];
+    struct cmsghdr align;
+  } u;
+  struct msghdr mh;
+  struct iovec iov;
+  std::vector<int> fds;
+
+  // The first word tells a batch from a single request.
+  uint32_t first;
+  ssize_t n = recv(client, &first, sizeof(first), MSG_PEEK);
+  if (n <= 0)
+    return false;
+
+  bool is_batch = batching_ && first == FPGAD_EVENT_MAGIC;
+
+  iov.iov_base = &msg;
+  iov.iov_len = is_batch ? sizeof(msg.batch.hdr) : sizeof(msg.req);
+  std::memset(&mh, 0, sizeof(mh));
+  mh.msg_iov = &iov;
+  mh.msg_iovlen = 1;
+  mh.msg_control = u.buf;
+  mh.msg_controllen = sizeof(u.buf);
+
+  n = recvmsg(client, &mh, MSG_CMSG_CLOEXEC);
+  if (n != (ssize_t)iov.iov_len)
+    return false;
+
+  for (struct cmsghdr *cmh = CMSG_FIRSTHDR(&mh); cmh;
+       cmh = CMSG_NXTHDR(&mh, cmh)) {
+    if (cmh->cmsg_level == SOL_SOCKET && cmh->cmsg_type == SCM_RIGHTS) {
+      size_t nfds = (cmh->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      int *p = (int *)CMSG_DATA(cmh);
+      fds.assign(p, p + nfds);
+    }
+  }
+
+  ++messages_;
+  std::lock_guard<std::mutex> g(lock_);
+
+  if (!is_batch) {
+    if (msg.req.type == FPGAD_REGISTER_EVENT) {
+      if (fds.size() != 1)
+        return false;
+      regs_.push_back({ client, (uint32_t)msg.req.event,
+                        msg.req.object_id, 0, fds[0] });
+    } else {
+      // Without a cookie, the first match goes.
+      auto it = std::find_if(regs_.begin(), regs_.end(),
+                             [&](const registration &r) {
+                               return r.client == client &&
+                                      r.event == (uint32_t)msg.req.event &&
+                                      r.object_id == msg.req.object_id;
+                             });
+      if (it != regs_.end()) {
+        close(it->fd);
+        regs_.erase(it);
+      }
+    }
+    return true;
+  }
+
+  uint32_t count = msg.batch.hdr.count;
+  if (count > FPGAD_EVENT_BATCH_MAX)
+    return false;
+  size_t len = count * sizeof(msg.batch.entries[0]);
+  if (recv(client, msg.batch.entries, len, MSG_WAITALL) != (ssize_t)len)
+    return false;
+
+  ++batches_;
+  int32_t result = FPGA_OK;
+  bool is_register = msg.batch.hdr.type == FPGAD_REGISTER_EVENT;
+  // A refused register batch registers nothing.
+  if (is_register && (refuse_ || fds.size() < count)) {
+    result = FPGA_INVALID_PARAM;
+    for (auto fd : fds)
+      close(fd);
+    count = 0;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    const struct fpgad_event_entry &e = msg.batch.entries[i];
+    if (is_register) {
+      regs_.push_back({ client, e.event, e.object_id, e.cookie, fds[i] });
+    } else {
+      auto it = std::find_if(regs_.begin(), regs_.end(),
+                             [&](const registration &r) {
+                               return r.client == client &&
+                                      r.cookie == e.cookie;
+                             });
+      if (it == regs_.end()) {
+        if (result == FPGA_OK)
+          result = FPGA_INVALID_PARAM;
+        continue;
+      }
+      close(it->fd);
+      regs_.erase(it);
+    }
+  }
+
+  struct fpgad_event_reply ack = {
+    FPGAD_EVENT_MAGIC, FPGAD_REPLY_ACK, msg.batch.hdr.seq, result
+  };
+  if (send(client, &ack, sizeof(ack), MSG_NOSIGNAL) != sizeof(ack))
+    return false;
+  ++acks_;
+  return true;
+}
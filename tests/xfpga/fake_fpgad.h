@@ -0,0 +1,91 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * A stand-in for the fpgad event socket, for testing the event
+ * daemon connection. It records registrations and can signal them,
+ * speaks both single requests and batches, and can pretend to be an
+ * fpgad that predates batching (no hello, no acks).
+ */
+class fake_fpgad {
+ public:
+  struct registration {
+    int client;
+    uint32_t event;
+    uint64_t object_id;
+    uint64_t cookie;
+    int fd;
+  };
+
+  fake_fpgad(const std::string &path, bool batching);
+  ~fake_fpgad();
+
+  bool start();
+  void stop();
+
+  // Close every client connection, as a restarted daemon would.
+  void drop_clients();
+
+  // Write to every registered eventfd.
+  void signal_all();
+
+  // Refuse register batches with FPGA_INVALID_PARAM.
+  void refuse_batches(bool refuse) { refuse_ = refuse; }
+
+  size_t num_registered();
+  std::vector<registration> registered();
+  uint32_t connections() const { return connections_; }
+  uint32_t messages() const { return messages_; }
+  uint32_t batches() const { return batches_; }
+  uint32_t acks() const { return acks_; }
+
+ private:
+  void run();
+  bool serve(int client);
+  void remove_client(int client);
+
+  std::string path_;
+  bool batching_;
+  int listen_fd_;
+  int wake_fd_;
+  std::thread thread_;
+  std::mutex lock_;
+  std::vector<int> clients_;
+  std::vector<registration> regs_;
+  std::atomic<uint32_t> connections_;
+  std::atomic<uint32_t> messages_;
+  std::atomic<uint32_t> batches_;
+  std::atomic<uint32_t> acks_;
+  std::atomic<bool> drop_;
+  std::atomic<bool> refuse_;
+};
@@ -198,6 +198,45 @@ TEST_P(buffer_prepare, prepare_buf_err) {
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaReleaseBuffer(handle_, 0x10001));
 }
 
+/**
+ * @test       prefault
+ *
+ * @brief      FPGA_BUF_ZERO clears a preallocated buffer before it is
+ *             pinned, and FPGA_BUF_PREFAULT_THREADS is only accepted
+ *             along with FPGA_BUF_PREFAULT or FPGA_BUF_ZERO.
+ *
+ */
+TEST_P(buffer_prepare, prefault) {
+  uint64_t buf_len = 64 * 4096;
+  uint8_t *buf_addr;
+  uint64_t wsid = 0;
+
+  buf_addr = (uint8_t *)mmap(ADDR, buf_len, PROTECTION, FLAGS_4K, 0, 0);
+  ASSERT_NE(MAP_FAILED, (void *)buf_addr);
+  memset(buf_addr, 0xa5, buf_len);
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaPrepareBuffer(handle_, buf_len, (void **)&buf_addr,
+                                    &wsid, FPGA_BUF_PREALLOCATED |
+                                    FPGA_BUF_PREFAULT_THREADS(2)));
+
+  ASSERT_EQ(FPGA_OK,
+            xfpga_fpgaPrepareBuffer(handle_, buf_len, (void **)&buf_addr,
+                                    &wsid, FPGA_BUF_PREALLOCATED |
+                                    FPGA_BUF_ZERO |
+                                    FPGA_BUF_PREFAULT_THREADS(2)));
+  for (uint64_t i = 0; i < buf_len; ++i)
+    ASSERT_EQ(0, buf_addr[i]);
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReleaseBuffer(handle_, wsid));
+  munmap(buf_addr, buf_len);
+
+  void *fresh = nullptr;
+  ASSERT_EQ(FPGA_OK,
+            xfpga_fpgaPrepareBuffer(handle_, 4096, &fresh, &wsid,
+                                    FPGA_BUF_PREFAULT));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaReleaseBuffer(handle_, wsid));
+}
+
 TEST_P(buffer_prepare, xfpga_fpgaPrepareBuffer) {
   buffer_params params = std::get<1>(GetParam());
   void *buf_addr = nullptr;
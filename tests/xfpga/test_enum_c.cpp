@@ -53,6 +53,7 @@ extern "C" {
 extern "C" {
 int xfpga_plugin_initialize(void);
 int xfpga_plugin_finalize(void);
+void *parent_key(fpga_token parent, size_t *len);
 }
 
 using namespace opae::testing;
@@ -322,6 +323,33 @@ TEST_P(enum_c_p, parent_neg) {
   EXPECT_EQ(num_matches_, 0);
 }
 
+/**
+ * @test       parent_foreign
+ *
+ * @brief      When the filter's parent is a token of another plugin,
+ *             fpgaEnumerate returns zero matches without using the
+ *             parent as an xfpga token.
+ */
+TEST_P(enum_c_p, parent_foreign) {
+  // Shaped like a vfio token: a 32-bit magic, then a device pointer.
+  struct {
+    uint32_t magic;
+    uint8_t guid[32];
+    void *device;
+    uint8_t pad[256];
+  } foreign;
+  memset(&foreign, 0xff, sizeof(foreign));
+  foreign.magic = 0xEF1010FE;
+  foreign.device = nullptr;
+
+  EXPECT_EQ(fpgaPropertiesSetParent(filter_, &foreign), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaEnumerate(&filter_, 1, tokens_.data(), tokens_.size(),
+                                &num_matches_), FPGA_OK);
+  EXPECT_EQ(num_matches_, 0);
+
+  EXPECT_EQ(parent_key(&foreign, nullptr), nullptr);
+}
+
 /**
  * @test       segment
  *
@@ -755,6 +783,33 @@ TEST_P(enum_c_p, clone_token) {
   EXPECT_EQ(xfpga_fpgaDestroyToken(&dst), FPGA_OK);
 }
 
+/**
+ * @test       clone_token_shared
+ *
+ * @brief      Tokens are interned: a clone, or another enumeration,
+ *             of a token is the same token, which stays valid until
+ *             its last reference is destroyed.
+ */
+TEST_P(enum_c_p, clone_token_shared) {
+  ASSERT_EQ(
+      xfpga_fpgaEnumerate(nullptr, 0, tokens_.data(), tokens_.size(), &num_matches_),
+      FPGA_OK);
+  ASSERT_GT(num_matches_, 0);
+  fpga_token src = tokens_[0];
+  fpga_token dst = nullptr;
+  ASSERT_EQ(xfpga_fpgaCloneToken(src, &dst), FPGA_OK);
+  EXPECT_EQ(dst, src);
+
+  fpga_token again = nullptr;
+  uint32_t matches = 0;
+  ASSERT_EQ(xfpga_fpgaEnumerate(nullptr, 0, &again, 1, &matches), FPGA_OK);
+  EXPECT_EQ(again, src);
+
+  EXPECT_EQ(xfpga_fpgaDestroyToken(&dst), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaDestroyToken(&again), FPGA_OK);
+  EXPECT_EQ(((struct _fpga_token *)src)->magic, FPGA_TOKEN_MAGIC);
+}
+
 /**
  * @test       clone_token_neg
  *
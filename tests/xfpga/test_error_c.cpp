@@ -86,20 +86,16 @@ class error_c_mock_p : public ::testing::TestWithParam<std::string> {
       }
     }
     memset(&fake_port_token_, 0, sizeof(fake_port_token_));
-    strncpy(fake_port_token_.sysfspath,
-              sysfs_port.c_str(), sysfs_port.size() + 1);
-    strncpy(fake_port_token_.devpath,
-              dev_port.c_str(), dev_port.size() + 1);
+    fake_port_token_.sysfspath = sysfs_port.c_str();
+    fake_port_token_.devpath = dev_port.c_str();
     fake_port_token_.magic = FPGA_TOKEN_MAGIC;
     fake_port_token_.device_instance = 0;
     fake_port_token_.subdev_instance = 0;
     fake_port_token_.errors = nullptr;
 
     memset(&fake_fme_token_, 0, sizeof(fake_fme_token_));
-    strncpy(fake_fme_token_.sysfspath,
-              sysfs_fme.c_str(), sysfs_fme.size() + 1);
-    strncpy(fake_fme_token_.devpath,
-              dev_fme.c_str(), dev_fme.size() + 1);
+    fake_fme_token_.sysfspath = sysfs_fme.c_str();
+    fake_fme_token_.devpath = dev_fme.c_str();
     fake_fme_token_.magic = FPGA_TOKEN_MAGIC;
     fake_fme_token_.device_instance = 0;
     fake_fme_token_.subdev_instance = 0;
@@ -192,6 +188,7 @@ TEST_P(error_c_mock_p, error_01) {
 
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &fake_port_token_.errors);
+  fake_port_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -242,6 +239,7 @@ TEST_P(error_c_mock_p, error_02) {
 
   std::string errpath = sysfs_fme + "/errors";
   build_error_list(errpath.c_str(), &fake_fme_token_.errors);
+  fake_fme_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -294,6 +292,7 @@ TEST_P(error_c_mock_p, error_03) {
 
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &fake_port_token_.errors);
+  fake_port_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -373,6 +372,7 @@ TEST_P(error_c_mock_p, error_04) {
 
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &fake_port_token_.errors);
+  fake_port_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -443,6 +443,7 @@ TEST_P(error_c_mock_p, error_05) {
 
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &fake_port_token_.errors);
+  fake_port_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -472,6 +473,7 @@ TEST_P(error_c_mock_p, error_06) {
 
   std::string errpath = sysfs_fme + "/errors";
   build_error_list(errpath.c_str(), &fake_fme_token_.errors);
+  fake_fme_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -493,8 +495,9 @@ TEST_P(error_c_mock_p, error_06) {
 
   free_error_list(fake_fme_token_.errors);
 
-  // set error list to null
+  // set error list to empty
   fake_fme_token_.errors = nullptr;
+  fake_fme_token_.errors_built = true;
   EXPECT_EQ(FPGA_NOT_FOUND, xfpga_fpgaClearError(t, 0));
 }
 /**
@@ -514,6 +517,7 @@ TEST_P(error_c_mock_p, error_07) {
   std::string errpath = sysfs_fme + "/errors";
   // build errors and immediately remove errors dir
   build_error_list(errpath.c_str(), &fake_fme_token_.errors);
+  fake_fme_token_.errors_built = true;
 
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
   ASSERT_EQ(fpgaPropertiesGetNumErrors(filter_, &num_errors), FPGA_OK);
@@ -545,6 +549,7 @@ TEST_P(error_c_mock_p, error_08) {
 
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &fake_port_token_.errors);
+  fake_port_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -570,6 +575,7 @@ TEST_P(error_c_mock_p, error_09) {
 
   std::string errpath = sysfs_fme + "/errors";
   build_error_list(errpath.c_str(), &fake_fme_token_.errors);
+  fake_fme_token_.errors_built = true;
 
   // get number of error registers
   ASSERT_EQ(FPGA_OK, xfpga_fpgaGetProperties(t, &filter_));
@@ -587,9 +593,9 @@ TEST_P(error_c_mock_p, error_09) {
  *             xfpga_fpgaClearAllErrors() should return FPGA_INVALID_PARAM.
  */
 TEST_P(error_c_mock_p, error_12) {
-  auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  fpga_token fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
   ASSERT_NE(fme, nullptr);
-  auto port = token_add(sysfs_port.c_str(), dev_port.c_str());
+  fpga_token port = token_add(sysfs_port.c_str(), dev_port.c_str());
   ASSERT_NE(port, nullptr);
   auto tok = (struct _fpga_token *)fme;
 
@@ -597,6 +603,11 @@ TEST_P(error_c_mock_p, error_12) {
   EXPECT_EQ(FPGA_OK, xfpga_fpgaClearAllErrors(fme));
   tok->magic = 0x123;
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaClearAllErrors(fme));
+
+  // Tokens are interned, so release them for the next test.
+  tok->magic = FPGA_TOKEN_MAGIC;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&fme));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&port));
 }
 
 INSTANTIATE_TEST_CASE_P(error_c, error_c_mock_p,
@@ -614,9 +625,9 @@ class error_c_p : public error_c_mock_p {};
  *
  */
 TEST_P(error_c_p, error_10) {
-  auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  fpga_token fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
   ASSERT_NE(fme, nullptr);
-  auto port = token_add(sysfs_port.c_str(), dev_port.c_str());
+  fpga_token port = token_add(sysfs_port.c_str(), dev_port.c_str());
   ASSERT_NE(port, nullptr);
   auto tok = (struct _fpga_token *)fme;
 
@@ -627,6 +638,11 @@ TEST_P(error_c_p, error_10) {
   tok->magic = FPGA_TOKEN_MAGIC;
   EXPECT_EQ(FPGA_OK, xfpga_fpgaReadError(fme, 0, &val));
   EXPECT_EQ(FPGA_NOT_FOUND, xfpga_fpgaReadError(fme, 1000, &val));
+
+  // Tokens are interned, so release them for the next test.
+  tok->magic = FPGA_TOKEN_MAGIC;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&fme));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&port));
 }
 
 /**
@@ -639,15 +655,20 @@ TEST_P(error_c_p, error_10) {
  *
  */
 TEST_P(error_c_p, error_11) {
-  auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  fpga_token fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
   ASSERT_NE(fme, nullptr);
-  auto port = token_add(sysfs_port.c_str(), dev_port.c_str());
+  fpga_token port = token_add(sysfs_port.c_str(), dev_port.c_str());
   ASSERT_NE(port, nullptr);
   auto tok = (struct _fpga_token *)fme;
 
   EXPECT_EQ(FPGA_NOT_FOUND, xfpga_fpgaClearError(fme, 1000));
   tok->magic = 0x123;
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaClearError(fme, 0));
+
+  // Tokens are interned, so release them for the next test.
+  tok->magic = FPGA_TOKEN_MAGIC;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&fme));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&port));
 }
 
 /**
@@ -658,9 +679,9 @@ TEST_P(error_c_p, error_11) {
  *             xfpga_fpgaClearAllErrors() should return FPGA_NOT_FOUND.
  */
 TEST_P(error_c_p, error_13) {
-  auto fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  fpga_token fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
   ASSERT_NE(fme, nullptr);
-  auto port = token_add(sysfs_port.c_str(), dev_port.c_str());
+  fpga_token port = token_add(sysfs_port.c_str(), dev_port.c_str());
   ASSERT_NE(port, nullptr);
   auto tok = (struct _fpga_token *)fme;
 
@@ -669,6 +690,36 @@ TEST_P(error_c_p, error_13) {
   EXPECT_EQ(FPGA_NOT_FOUND, xfpga_fpgaGetErrorInfo(fme, 1000, &info));
   tok->magic = 0x123;
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaGetErrorInfo(fme, 0, &info));
+
+  // Tokens are interned, so release them for the next test.
+  tok->magic = FPGA_TOKEN_MAGIC;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&fme));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&port));
+}
+
+/**
+ * @test       lazy_errors
+ * @brief      A token's error list is built on the first error call,
+ *             and shared by clones of the token.
+ */
+TEST_P(error_c_p, lazy_errors) {
+  fpga_token fme = token_add(sysfs_fme.c_str(), dev_fme.c_str());
+  ASSERT_NE(fme, nullptr);
+  auto tok = (struct _fpga_token *)fme;
+  EXPECT_FALSE(tok->errors_built);
+  EXPECT_EQ(tok->errors, nullptr);
+
+  struct fpga_error_info info;
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaGetErrorInfo(fme, 0, &info));
+  EXPECT_TRUE(tok->errors_built);
+  ASSERT_NE(tok->errors, nullptr);
+
+  fpga_token clone = nullptr;
+  ASSERT_EQ(FPGA_OK, xfpga_fpgaCloneToken(fme, &clone));
+  EXPECT_EQ(((struct _fpga_token *)clone)->errors, tok->errors);
+
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&clone));
+  EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyToken(&fme));
 }
 
 INSTANTIATE_TEST_CASE_P(error_c, error_c_p,
@@ -702,8 +753,9 @@ TEST(error_c, error_01) {
  */
 TEST(error_c, error_06) {
   struct _fpga_token _t;
-  strncpy(_t.sysfspath, sysfs_port.c_str(), sysfs_port.size() + 1);
-  strncpy(_t.devpath, dev_port.c_str(), dev_port.size() + 1);
+  memset(&_t, 0, sizeof(_t));
+  _t.sysfspath = sysfs_port.c_str();
+  _t.devpath = dev_port.c_str();
   _t.magic = FPGA_TOKEN_MAGIC;
   _t.errors = nullptr;
 
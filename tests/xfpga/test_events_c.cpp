@@ -376,12 +376,14 @@ TEST(events, event_03) {
   struct _fpga_token _t;
 
   // token setup
-  strncpy(_t.sysfspath, sysfs_port.c_str(), sysfs_port.size() + 1);
-  strncpy(_t.devpath, dev_port.c_str(), dev_port.size() + 1);
+  memset(&_t, 0, sizeof(_t));
+  _t.sysfspath = sysfs_port.c_str();
+  _t.devpath = dev_port.c_str();
   _t.magic = FPGA_TOKEN_MAGIC;
   _t.errors = nullptr;
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &_t.errors);
+  _t.errors_built = true;
 
   memset(&_h, 0, sizeof(_h));
   _h.token = &_t;
@@ -394,12 +396,13 @@ TEST(events, event_03) {
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaRegisterEvent(&_h, e, eh, 0));
 
   // token/event mismatch.
-  strncpy(_t.sysfspath, sysfs_fme.c_str(), sysfs_fme.size() + 1);
-  strncpy(_t.devpath, dev_fme.c_str(), dev_fme.size() + 1);
+  _t.sysfspath = sysfs_fme.c_str();
+  _t.devpath = dev_fme.c_str();
   _t.magic = FPGA_TOKEN_MAGIC;
   _t.errors = nullptr;
   errpath = sysfs_fme + "/errors";
   build_error_list(errpath.c_str(), &_t.errors);
+  _t.errors_built = true;
 
   EXPECT_EQ(FPGA_INVALID_PARAM,
             xfpga_fpgaRegisterEvent(&_h, FPGA_EVENT_INTERRUPT, eh, 0));
@@ -432,12 +435,14 @@ TEST(events, event_04) {
   struct _fpga_token _t;
 
   // token setup
-  strncpy(_t.sysfspath, sysfs_port.c_str(), sysfs_port.size() + 1);
-  strncpy(_t.devpath, dev_port.c_str(), dev_port.size() + 1);
+  memset(&_t, 0, sizeof(_t));
+  _t.sysfspath = sysfs_port.c_str();
+  _t.devpath = dev_port.c_str();
   _t.magic = FPGA_TOKEN_MAGIC;
   _t.errors = nullptr;
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &_t.errors);
+  _t.errors_built = true;
 
   memset(&_h, 0, sizeof(_h));
   _h.token = &_t;
@@ -450,12 +455,13 @@ TEST(events, event_04) {
   EXPECT_EQ(FPGA_INVALID_PARAM, xfpga_fpgaUnregisterEvent(&_h, e, eh));
 
   // token/event mismatch.
-  strncpy(_t.sysfspath, sysfs_fme.c_str(), sysfs_fme.size() + 1);
-  strncpy(_t.devpath, dev_fme.c_str(), dev_fme.size() + 1);
+  _t.sysfspath = sysfs_fme.c_str();
+  _t.devpath = dev_fme.c_str();
   _t.magic = FPGA_TOKEN_MAGIC;
   _t.errors = nullptr;
   errpath = sysfs_fme + "/errors";
   build_error_list(errpath.c_str(), &_t.errors);
+  _t.errors_built = true;
 
   EXPECT_EQ(FPGA_INVALID_PARAM,
             xfpga_fpgaUnregisterEvent(&_h, FPGA_EVENT_INTERRUPT, eh));
@@ -1081,9 +1087,11 @@ TEST_P(events_mock_p, fme_interrupts_check){
   EXPECT_EQ(FPGA_INVALID_PARAM,res);
 
   // change sysfspath
-  strncpy(t->sysfspath, "null" , 5);
+  const char *sysfspath = t->sysfspath;
+  t->sysfspath = "null";
   res = check_err_interrupts_supported(handle_dev_,&obj);
   EXPECT_NE(FPGA_OK,res);
+  t->sysfspath = sysfspath;
 }
 
 /**
@@ -1116,9 +1124,11 @@ TEST_P(events_mock_p, afu_interrupts_check){
   EXPECT_EQ(FPGA_INVALID_PARAM,res);
 
   // change sysfspath
-  strncpy(t->sysfspath, "null", 5);
+  const char *sysfspath = t->sysfspath;
+  t->sysfspath = "null";
   res = check_err_interrupts_supported(handle_accel_,&obj);
   EXPECT_NE(FPGA_OK,res);
+  t->sysfspath = sysfspath;
 }
 
 /**
@@ -1284,5 +1294,49 @@ TEST_P(events_mock_p, irq_event_03) {
                                          eh_));
 }
 
+/**
+ * @test       irq_event_batch
+ *
+ * @brief      Given a driver with 4 user IRQs<br>
+ *             when xfpga_fpgaRegisterInterruptEvents is called<br>
+ *             for all of them, the call is successful,<br>
+ *             a range past the last vector or one already in use<br>
+ *             is rejected, and xfpga_fpgaUnregisterInterruptEvents<br>
+ *             frees the vectors for reuse.<br>
+ */
+TEST_P(events_mock_p, irq_event_batch) {
+  gEnableIRQ = true;
+  system_->register_ioctl_handler(DFL_FPGA_PORT_UINT_GET_IRQ_NUM, dfl_get_port_uint_irq);
+  system_->register_ioctl_handler(DFL_FPGA_PORT_UINT_SET_IRQ, set_dfl_irq);
+
+  fpga_event_handle ehs[4];
+  for (auto &e : ehs)
+    ASSERT_EQ(FPGA_OK, xfpga_fpgaCreateEventHandle(&e));
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaRegisterInterruptEvents(handle_accel_, 2, 4, ehs));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaRegisterInterruptEvents(handle_dev_, 0, 4, ehs));
+
+  ASSERT_EQ(FPGA_OK,
+            xfpga_fpgaRegisterInterruptEvents(handle_accel_, 0, 4, ehs));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaRegisterEvent(handle_accel_, FPGA_EVENT_INTERRUPT,
+                                    eh_, 3));
+
+  EXPECT_EQ(FPGA_OK,
+            xfpga_fpgaUnregisterInterruptEvents(handle_accel_, 4, ehs));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            xfpga_fpgaUnregisterInterruptEvents(handle_accel_, 4, ehs));
+
+  EXPECT_EQ(FPGA_OK,
+            xfpga_fpgaRegisterInterruptEvents(handle_accel_, 1, 3, ehs));
+  EXPECT_EQ(FPGA_OK,
+            xfpga_fpgaUnregisterInterruptEvents(handle_accel_, 3, ehs));
+
+  for (auto &e : ehs)
+    EXPECT_EQ(FPGA_OK, xfpga_fpgaDestroyEventHandle(&e));
+}
+
 INSTANTIATE_TEST_CASE_P(events, events_mock_p,
                         ::testing::ValuesIn(test_platform::mock_platforms({ "dfl-n3000","dfl-d5005" })));
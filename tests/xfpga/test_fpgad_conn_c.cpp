@@ -0,0 +1,333 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#ifdef __cplusplus
+
+extern "C" {
+#endif
+#include <opae/types.h>
+#include "types_int.h"
+#include "fpgad_conn_int.h"
+
+#ifdef __cplusplus
+}
+#endif
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "gtest/gtest.h"
+#include "fake_fpgad.h"
+
+namespace {
+
+const size_t num_events = 8;
+
+// Wait until cond() holds, for up to a second.
+template <typename C>
+bool wait_for(C cond) {
+  for (int i = 0; i < 1000; ++i) {
+    if (cond())
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return cond();
+}
+
+} // namespace
+
+class fpgad_conn_c_p : public ::testing::TestWithParam<bool> {
+ protected:
+  fpgad_conn_c_p()
+    : path_("/tmp/fpgad_conn_c_p." + std::to_string(getpid())),
+      fpgad_(path_, GetParam()) {}
+
+  virtual void SetUp() override {
+    setenv(FPGAD_EVENT_SOCKET_ENV, path_.c_str(), 1);
+    setenv(FPGAD_EVENT_BATCH_ENV, "1", 1);
+    ASSERT_TRUE(fpgad_.start());
+    for (size_t i = 0; i < num_events; ++i) {
+      std::memset(&eh_[i], 0, sizeof(eh_[i]));
+      eh_[i].magic = FPGA_EVENT_HANDLE_MAGIC;
+      eh_[i].fd = eventfd(0, EFD_NONBLOCK);
+      ASSERT_GE(eh_[i].fd, 0);
+    }
+  }
+
+  virtual void TearDown() override {
+    fpgad_conn_finalize();
+    fpgad_.stop();
+    for (size_t i = 0; i < num_events; ++i)
+      close(eh_[i].fd);
+    unsetenv(FPGAD_EVENT_BATCH_ENV);
+    unsetenv(FPGAD_EVENT_SOCKET_ENV);
+  }
+
+  fpga_handle handle(size_t i) {
+    return reinterpret_cast<fpga_handle>(&handles_[i]);
+  }
+
+  std::string path_;
+  fake_fpgad fpgad_;
+  struct _fpga_event_handle eh_[num_events];
+  char handles_[num_events];
+};
+
+/**
+ * @test       register_signal
+ * @brief      Test: fpgad_conn_register, fpgad_conn_unregister
+ * @details    Registrations from several handles share one daemon
+ *             connection when it batches, and otherwise get one per
+ *             handle after a single probe. The daemon's signal reaches the
+ *             eventfds, and unregistering removes exactly the named
+ *             event.<br>
+ */
+TEST_P(fpgad_conn_c_p, register_signal) {
+  for (size_t i = 0; i < num_events; ++i)
+    ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(i), &eh_[i],
+                                           FPGA_EVENT_ERROR, 0x100));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events; }));
+  if (GetParam()) {
+    EXPECT_EQ(1u, fpgad_.connections());
+  } else {
+    EXPECT_EQ(num_events + 1, fpgad_.connections());
+  }
+
+  fpgad_.signal_all();
+  for (size_t i = 0; i < num_events; ++i) {
+    uint64_t v = 0;
+    ASSERT_EQ(sizeof(v), read(eh_[i].fd, &v, sizeof(v)));
+    EXPECT_EQ(1u, v);
+  }
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgad_conn_unregister(handle(0), &eh_[1], FPGA_EVENT_ERROR));
+  EXPECT_EQ(FPGA_OK,
+            fpgad_conn_unregister(handle(0), &eh_[0], FPGA_EVENT_ERROR));
+  EXPECT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events - 1; }));
+}
+
+/**
+ * @test       release
+ * @brief      Test: fpgad_conn_release
+ * @details    Closing a handle unregisters all of its events, and
+ *             a batching daemon gets fewer messages than events.<br>
+ */
+TEST_P(fpgad_conn_c_p, release) {
+  for (size_t i = 0; i < num_events; ++i)
+    ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle((i + 1) % 2), &eh_[i],
+                                           FPGA_EVENT_ERROR, i));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events; }));
+
+  uint32_t messages = fpgad_.messages();
+  fpgad_conn_release(handle(0));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events / 2; }));
+  for (auto &r : fpgad_.registered())
+    EXPECT_EQ(0u, r.object_id % 2);
+
+  if (GetParam()) {
+    EXPECT_GT(messages + num_events / 2, fpgad_.messages());
+  } else {
+    EXPECT_EQ(messages + num_events / 2, fpgad_.messages());
+  }
+}
+
+/**
+ * @test       reconnect
+ * @brief      Test: fpgad_conn_register
+ * @details    When the daemon drops the shared connection, the next
+ *             request reconnects and registers everything again.
+ *             Registrations on a handle's connection go with it.<br>
+ */
+TEST_P(fpgad_conn_c_p, reconnect) {
+  for (size_t i = 0; i + 1 < num_events; ++i)
+    ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(i), &eh_[i],
+                                           FPGA_EVENT_ERROR, i));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events - 1; }));
+
+  fpgad_.drop_clients();
+  EXPECT_EQ(0u, fpgad_.num_registered());
+
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(num_events - 1),
+                                         &eh_[num_events - 1],
+                                         FPGA_EVENT_POWER_THERMAL, 0));
+  size_t expected = GetParam() ? num_events : 1;
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == expected; }));
+  if (GetParam()) {
+    EXPECT_EQ(2u, fpgad_.connections());
+    EXPECT_LE(1u, fpgad_.batches());
+  }
+
+  fpgad_.signal_all();
+  uint64_t v = 0;
+  EXPECT_EQ(sizeof(v), read(eh_[num_events - 1].fd, &v, sizeof(v)));
+  if (GetParam()) {
+    EXPECT_EQ(sizeof(v), read(eh_[0].fd, &v, sizeof(v)));
+  }
+}
+
+/**
+ * @test       no_daemon
+ * @brief      Test: fpgad_conn_register
+ * @details    Without a daemon, registration fails with
+ *             FPGA_NO_DAEMON, and unregistering without a
+ *             registration is an invalid parameter.<br>
+ */
+TEST_P(fpgad_conn_c_p, no_daemon) {
+  fpgad_.stop();
+  EXPECT_EQ(FPGA_NO_DAEMON, fpgad_conn_register(handle(0), &eh_[0],
+                                                FPGA_EVENT_ERROR, 0));
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgad_conn_unregister(handle(0), &eh_[0], FPGA_EVENT_ERROR));
+}
+
+INSTANTIATE_TEST_CASE_P(fpgad_conn_c, fpgad_conn_c_p,
+                        ::testing::Values(true, false));
+
+class fpgad_conn_batch_c_p : public fpgad_conn_c_p {};
+
+/**
+ * @test       refused
+ * @brief      Test: fpgad_conn_register, fpgad_conn_unregister
+ * @details    When the daemon refuses a batch, its registrations are
+ *             dropped: unregistering them is an invalid parameter,
+ *             and a new connection does not register them again.<br>
+ */
+TEST_P(fpgad_conn_batch_c_p, refused) {
+  fpgad_.refuse_batches(true);
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(0), &eh_[0],
+                                         FPGA_EVENT_ERROR, 0));
+  ASSERT_TRUE(wait_for([&] { return fpgad_.acks() == 1; }));
+  EXPECT_EQ(0u, fpgad_.num_registered());
+  fpgad_.refuse_batches(false);
+
+  EXPECT_EQ(FPGA_INVALID_PARAM,
+            fpgad_conn_unregister(handle(0), &eh_[0], FPGA_EVENT_ERROR));
+
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(1), &eh_[1],
+                                         FPGA_EVENT_ERROR, 1));
+  ASSERT_TRUE(wait_for([&] { return fpgad_.acks() == 2; }));
+  fpgad_.drop_clients();
+
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(2), &eh_[2],
+                                         FPGA_EVENT_ERROR, 2));
+  ASSERT_TRUE(wait_for([&] { return fpgad_.num_registered() == 2; }));
+  auto regs = fpgad_.registered();
+  ASSERT_EQ(2u, regs.size());
+  for (auto &r : regs)
+    EXPECT_NE(0u, r.object_id);
+}
+
+INSTANTIATE_TEST_CASE_P(fpgad_conn_c, fpgad_conn_batch_c_p,
+                        ::testing::Values(true));
+
+class fpgad_conn_legacy_c_p : public fpgad_conn_c_p {
+ protected:
+  virtual void SetUp() override {
+    fpgad_conn_c_p::SetUp();
+    unsetenv(FPGAD_EVENT_BATCH_ENV);
+  }
+};
+
+/**
+ * @test       other_handle_first
+ * @brief      Test: fpgad_conn_register, fpgad_conn_unregister
+ * @details    Without batching asked for, no hello is awaited and
+ *             each handle gets a connection of its own, so a
+ *             daemon that unregisters by event and object ID removes
+ *             the registration named, not one another handle made
+ *             first.<br>
+ */
+TEST_P(fpgad_conn_legacy_c_p, other_handle_first) {
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(0), &eh_[0],
+                                         FPGA_EVENT_ERROR, 0x100));
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(1), &eh_[1],
+                                         FPGA_EVENT_ERROR, 0x100));
+  ASSERT_TRUE(wait_for([&] { return fpgad_.num_registered() == 2; }));
+  EXPECT_EQ(2u, fpgad_.connections());
+  EXPECT_EQ(0u, fpgad_.batches());
+
+  EXPECT_EQ(FPGA_OK,
+            fpgad_conn_unregister(handle(1), &eh_[1], FPGA_EVENT_ERROR));
+  ASSERT_TRUE(wait_for([&] { return fpgad_.num_registered() == 1; }));
+
+  fpgad_.signal_all();
+  uint64_t v = 0;
+  EXPECT_EQ(sizeof(v), read(eh_[0].fd, &v, sizeof(v)));
+  EXPECT_GT(0, read(eh_[1].fd, &v, sizeof(v)));
+
+  fpgad_conn_release(handle(0));
+  EXPECT_TRUE(wait_for([&] { return fpgad_.num_registered() == 0; }));
+}
+
+/**
+ * @test       same_handle
+ * @brief      Test: fpgad_conn_register, fpgad_conn_release
+ * @details    Without batching, registrations through one handle
+ *             share its connection, which stays open until the last
+ *             of them is unregistered.<br>
+ */
+TEST_P(fpgad_conn_legacy_c_p, same_handle) {
+  for (size_t i = 0; i < num_events; ++i)
+    ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(0), &eh_[i],
+                                           FPGA_EVENT_ERROR, i));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events; }));
+  EXPECT_EQ(1u, fpgad_.connections());
+
+  EXPECT_EQ(FPGA_OK,
+            fpgad_conn_unregister(handle(0), &eh_[0], FPGA_EVENT_ERROR));
+  ASSERT_TRUE(wait_for([&] {
+    return fpgad_.num_registered() == num_events - 1; }));
+
+  fpgad_.signal_all();
+  uint64_t v = 0;
+  EXPECT_EQ(sizeof(v), read(eh_[1].fd, &v, sizeof(v)));
+
+  fpgad_conn_release(handle(0));
+  EXPECT_TRUE(wait_for([&] { return fpgad_.num_registered() == 0; }));
+
+  ASSERT_EQ(FPGA_OK, fpgad_conn_register(handle(0), &eh_[0],
+                                         FPGA_EVENT_ERROR, 0));
+  EXPECT_TRUE(wait_for([&] { return fpgad_.num_registered() == 1; }));
+  EXPECT_EQ(2u, fpgad_.connections());
+}
+
+INSTANTIATE_TEST_CASE_P(fpgad_conn_c, fpgad_conn_legacy_c_p,
+                        ::testing::Values(true, false));
@@ -56,15 +56,7 @@ using namespace opae::testing;
  * On hardware, the mmio map is a hash table.
  */
 static bool mmio_map_is_empty(struct wsid_tracker *root) {
-  if (!root || (root->n_hash_buckets == 0))
-    return true;
-
-  for (uint32_t i = 0; i < root->n_hash_buckets; i += 1) {
-    if (root->table[i])
-      return false;
-  }
-
-  return true;
+  return !root || !root->count;
 }
 
 #else
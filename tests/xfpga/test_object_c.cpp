@@ -29,6 +29,7 @@
 #endif // HAVE_CONFIG_H
 
 #include <uuid/uuid.h>
+#include <unistd.h>
 #include <fstream>
 #include "gtest/gtest.h"
 #include "mock/test_system.h"
@@ -237,6 +238,9 @@ TEST_P(sysobject_mock_p, xfpga_fpgaObjectWrite64) {
   strcpy(inv_path, invalid_path.c_str());
 
   obj->path = inv_path;
+  // drop the descriptor kept open by the previous writes
+  close(obj->fd);
+  obj->fd = -1;
 
   EXPECT_EQ(xfpga_fpgaObjectWrite64(object, 0xc0c0cafe, 0), FPGA_EXCEPTION);
 
@@ -251,6 +255,49 @@ TEST_P(sysobject_mock_p, xfpga_fpgaObjectWrite64) {
   EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
 }
 
+TEST_P(sysobject_mock_p, xfpga_fpgaObjectSync) {
+  uint32_t num_matches = 0;
+  ASSERT_EQ(xfpga_fpgaEnumerate(&dev_filter_, 1, tokens_.data(), tokens_.size(),
+                                &num_matches),
+            FPGA_OK);
+  ASSERT_GT(num_matches, 0);
+  _fpga_token *tk = static_cast<_fpga_token *>(tokens_[0]);
+  std::string syspath(tk->sysfspath);
+  syspath += "/testdata";
+  auto fp = system_->register_file(syspath);
+  ASSERT_NE(fp, nullptr) << strerror(errno);
+  fwrite(DATA.c_str(), DATA.size(), 1, fp);
+  fflush(fp);
+  fpga_object object;
+  ASSERT_EQ(xfpga_fpgaTokenGetObject(tokens_[0], "testdata", &object, 0),
+            FPGA_OK);
+  _fpga_object *obj = static_cast<_fpga_object *>(object);
+  // the initial read does not keep the file open
+  EXPECT_EQ(obj->fd, -1);
+  uint64_t ts0 = 0, ts1 = 0;
+  EXPECT_EQ(xfpga_fpgaObjectGetTimestamp(object, &ts0), FPGA_OK);
+  EXPECT_NE(ts0, 0);
+
+  rewind(fp);
+  std::string c0c0str = "0xc0c0cafe\n";
+  fwrite(c0c0str.c_str(), c0c0str.size(), 1, fp);
+  fflush(fp);
+  ASSERT_EQ(ftruncate(fileno(fp), c0c0str.size()), 0);
+  fclose(fp);
+
+  uint64_t value = 0;
+  EXPECT_EQ(xfpga_fpgaObjectSync(object, 0), FPGA_OK);
+  EXPECT_GE(obj->fd, 0);
+  EXPECT_EQ(xfpga_fpgaObjectRead64(object, &value, 0), FPGA_OK);
+  EXPECT_EQ(value, 0xc0c0cafe);
+  uint32_t size = 0;
+  EXPECT_EQ(xfpga_fpgaObjectGetSize(object, &size, 0), FPGA_OK);
+  EXPECT_EQ(size, c0c0str.size());
+  EXPECT_EQ(xfpga_fpgaObjectGetTimestamp(object, &ts1), FPGA_OK);
+  EXPECT_GE(ts1, ts0);
+  EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
+}
+
 TEST_P(sysobject_mock_p, xfpga_fpgaGetSize) {
   uint32_t num_matches = 0;
   ASSERT_EQ(xfpga_fpgaEnumerate(&dev_filter_, 1, tokens_.data(), tokens_.size(),
@@ -52,15 +52,7 @@ using namespace opae::testing;
  * On hardware, the mmio map is a hash table.
  */
 static bool mmio_map_is_empty(struct wsid_tracker *root) {
-  if (!root || (root->n_hash_buckets == 0))
-    return true;
-
-  for (uint32_t i = 0; i < root->n_hash_buckets; i += 1) {
-    if (root->table[i])
-      return false;
-  }
-
-  return true;
+  return !root || !root->count;
 }
 
 #else
@@ -230,8 +222,10 @@ TEST_P(openclose_c_p, open_05) {
   ASSERT_EQ(FPGA_OK, xfpga_fpgaClose(handle_));
 
   // Invalid token path
-  strcpy(_token->devpath,"/dev/intel-fpga-fme.01");
+  const char *devpath = _token->devpath;
+  _token->devpath = "/dev/intel-fpga-fme.01";
   res = xfpga_fpgaOpen(tokens_[0], &handle_, FPGA_OPEN_SHARED);
+  _token->devpath = devpath;
   ASSERT_EQ(FPGA_NO_DRIVER, res);
 }
 
@@ -380,12 +374,14 @@ TEST_P(openclose_c_mock_p, invalid_open_close) {
   const std::string dev_port = "/dev/intel-fpga-port.0";
 
   // token setup
-  strncpy(_tok.sysfspath, sysfs_port.c_str(), sysfs_port.size() + 1);
-  strncpy(_tok.devpath, dev_port.c_str(), dev_port.size() + 1);
+  memset(&_tok, 0, sizeof(_tok));
+  _tok.sysfspath = sysfs_port.c_str();
+  _tok.devpath = dev_port.c_str();
   _tok.magic = FPGA_TOKEN_MAGIC;
   _tok.errors = nullptr;
   std::string errpath = sysfs_port + "/errors";
   build_error_list(errpath.c_str(), &_tok.errors);
+  _tok.errors_built = true;
 
 #ifdef BUILD_ASE
   ASSERT_EQ(FPGA_OK, xfpga_fpgaOpen(tok, &h, 0));
@@ -0,0 +1,263 @@
+// Copyright(c) 2021, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#ifdef __cplusplus
+
+extern "C" {
+#endif
+#include <opae/types.h>
+#include "power_thermal_int.h"
+#include "types_int.h"
+#include "xfpga.h"
+
+extern struct power_thermal_monitor *monitors;
+
+int xfpga_plugin_initialize(void);
+int xfpga_plugin_finalize(void);
+
+#ifdef __cplusplus
+}
+#endif
+#include <opae/fpga.h>
+#include <cstdlib>
+#include <cstring>
+#include "gtest/gtest.h"
+#include "mock/test_system.h"
+
+using namespace opae::testing;
+
+class power_thermal_c_p : public ::testing::Test {
+ protected:
+  virtual void SetUp() override {
+    std::memset(&t_, 0, sizeof(t_));
+    t_.upper_c_threshold.is_valid = 1;
+    t_.upper_c_threshold.value = 90.0;
+    t_.upper_nc_threshold.is_valid = 1;
+    t_.upper_nc_threshold.value = 80.0;
+    t_.lower_c_threshold.is_valid = 1;
+    t_.lower_c_threshold.value = 5.0;
+    t_.hysteresis.is_valid = 1;
+    t_.hysteresis.value = 2.0;
+    tripped_ = 0;
+  }
+
+  metric_threshold t_;
+  uint32_t tripped_;
+};
+
+/**
+ * @test       upper
+ * @brief      Test: power_thermal_evaluate
+ * @details    Reaching an upper threshold reports a crossing once,
+ *             and a further threshold reports another.<br>
+ */
+TEST_F(power_thermal_c_p, upper) {
+  EXPECT_FALSE(power_thermal_evaluate(&t_, 70.0, &tripped_));
+  EXPECT_EQ(0u, tripped_);
+
+  EXPECT_TRUE(power_thermal_evaluate(&t_, 80.0, &tripped_));
+  EXPECT_EQ(POWER_THERMAL_UPPER_NC, tripped_);
+  EXPECT_FALSE(power_thermal_evaluate(&t_, 85.0, &tripped_));
+
+  EXPECT_TRUE(power_thermal_evaluate(&t_, 95.0, &tripped_));
+  EXPECT_EQ(POWER_THERMAL_UPPER_NC | POWER_THERMAL_UPPER_C, tripped_);
+}
+
+/**
+ * @test       hysteresis
+ * @brief      Test: power_thermal_evaluate
+ * @details    A tripped threshold clears only once the value is back
+ *             past it by the hysteresis, so a value hovering at the
+ *             threshold does not report again.<br>
+ */
+TEST_F(power_thermal_c_p, hysteresis) {
+  EXPECT_TRUE(power_thermal_evaluate(&t_, 80.0, &tripped_));
+  EXPECT_FALSE(power_thermal_evaluate(&t_, 79.0, &tripped_));
+  EXPECT_EQ(POWER_THERMAL_UPPER_NC, tripped_);
+  EXPECT_FALSE(power_thermal_evaluate(&t_, 80.0, &tripped_));
+
+  EXPECT_FALSE(power_thermal_evaluate(&t_, 78.0, &tripped_));
+  EXPECT_EQ(0u, tripped_);
+  EXPECT_TRUE(power_thermal_evaluate(&t_, 80.0, &tripped_));
+}
+
+/**
+ * @test       lower
+ * @brief      Test: power_thermal_evaluate
+ * @details    Lower thresholds trip at or below their value, and
+ *             invalid thresholds never trip.<br>
+ */
+TEST_F(power_thermal_c_p, lower) {
+  EXPECT_TRUE(power_thermal_evaluate(&t_, 5.0, &tripped_));
+  EXPECT_EQ(POWER_THERMAL_LOWER_C, tripped_);
+
+  t_.lower_c_threshold.is_valid = 0;
+  EXPECT_FALSE(power_thermal_evaluate(&t_, -100.0, &tripped_));
+  EXPECT_EQ(0u, tripped_);
+}
+
+class power_thermal_mock_p : public ::testing::TestWithParam<std::string> {
+ protected:
+  power_thermal_mock_p() : token_(nullptr), handle_(nullptr), eh_(nullptr) {}
+
+  virtual void SetUp() override {
+    uint32_t num_matches = 0;
+    fpga_properties filter = nullptr;
+
+    ASSERT_TRUE(test_platform::exists(GetParam()));
+    platform_ = test_platform::get(GetParam());
+    system_ = test_system::instance();
+    system_->initialize();
+    system_->prepare_syfs(platform_);
+
+    // No fpgad: events fall back to the in-process monitor.
+    setenv("OPAE_FPGAD_EVENT_SOCKET", "/tmp/no-such-fpgad-socket", 1);
+
+    ASSERT_EQ(xfpga_plugin_initialize(), FPGA_OK);
+    ASSERT_EQ(xfpga_fpgaGetProperties(nullptr, &filter), FPGA_OK);
+    ASSERT_EQ(fpgaPropertiesSetObjectType(filter, FPGA_DEVICE), FPGA_OK);
+    ASSERT_EQ(xfpga_fpgaEnumerate(&filter, 1, &token_, 1, &num_matches),
+              FPGA_OK);
+    EXPECT_EQ(fpgaDestroyProperties(&filter), FPGA_OK);
+    ASSERT_GT(num_matches, 0u);
+    // Exclusive: the monitor must not need a handle of its own.
+    ASSERT_EQ(xfpga_fpgaOpen(token_, &handle_, 0), FPGA_OK);
+    ASSERT_EQ(xfpga_fpgaCreateEventHandle(&eh_), FPGA_OK);
+  }
+
+  virtual void TearDown() override {
+    if (eh_) {
+      EXPECT_EQ(xfpga_fpgaDestroyEventHandle(&eh_), FPGA_OK);
+    }
+    if (handle_) {
+      EXPECT_EQ(xfpga_fpgaClose(handle_), FPGA_OK);
+      handle_ = nullptr;
+    }
+    if (token_) {
+      EXPECT_EQ(xfpga_fpgaDestroyToken(&token_), FPGA_OK);
+    }
+    EXPECT_EQ(monitors, nullptr);
+    xfpga_plugin_finalize();
+    unsetenv("OPAE_FPGAD_EVENT_SOCKET");
+    system_->finalize();
+  }
+
+  fpga_token token_;
+  fpga_handle handle_;
+  fpga_event_handle eh_;
+  test_platform platform_;
+  test_system *system_;
+};
+
+/**
+ * @test       register_unregister
+ * @brief      Test: power_thermal_register, power_thermal_unregister
+ * @details    Without fpgad, registering through an exclusively opened
+ *             device handle starts a monitor that reads through that
+ *             handle. Unregistering stops it, and a second unregister
+ *             finds nothing.<br>
+ */
+TEST_P(power_thermal_mock_p, register_unregister) {
+  ASSERT_EQ(xfpga_fpgaRegisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                    eh_, 0), FPGA_OK);
+  ASSERT_NE(monitors, nullptr);
+  ASSERT_NE(monitors->regs, nullptr);
+  EXPECT_EQ(monitors->regs->handle, handle_);
+  EXPECT_EQ(monitors->interval_ms, POWER_THERMAL_DEFAULT_INTERVAL_MS);
+
+  EXPECT_EQ(xfpga_fpgaUnregisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                      eh_), FPGA_OK);
+  EXPECT_EQ(monitors, nullptr);
+  EXPECT_EQ(power_thermal_unregister(handle_, eh_), FPGA_NOT_FOUND);
+}
+
+/**
+ * @test       interval
+ * @brief      Test: power_thermal_register, power_thermal_unregister
+ * @details    A monitor polls at the shortest interval registered,
+ *             and falls back to the next shortest once that
+ *             registration leaves.<br>
+ */
+TEST_P(power_thermal_mock_p, interval) {
+  fpga_event_handle eh2 = nullptr;
+
+  ASSERT_EQ(xfpga_fpgaCreateEventHandle(&eh2), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaRegisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                    eh_, 500), FPGA_OK);
+  ASSERT_EQ(xfpga_fpgaRegisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                    eh2, 10), FPGA_OK);
+  ASSERT_NE(monitors, nullptr);
+  EXPECT_EQ(monitors->next, nullptr);
+  EXPECT_EQ(monitors->interval_ms, 10u);
+
+  EXPECT_EQ(xfpga_fpgaUnregisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                      eh2), FPGA_OK);
+  ASSERT_NE(monitors, nullptr);
+  EXPECT_EQ(monitors->interval_ms, 500u);
+
+  EXPECT_EQ(xfpga_fpgaUnregisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                      eh_), FPGA_OK);
+  EXPECT_EQ(xfpga_fpgaDestroyEventHandle(&eh2), FPGA_OK);
+}
+
+/**
+ * @test       close
+ * @brief      Test: power_thermal_release
+ * @details    Closing the registering handle drops its registrations
+ *             and stops the monitor.<br>
+ */
+TEST_P(power_thermal_mock_p, close) {
+  ASSERT_EQ(xfpga_fpgaRegisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                    eh_, 10), FPGA_OK);
+  ASSERT_NE(monitors, nullptr);
+
+  EXPECT_EQ(xfpga_fpgaClose(handle_), FPGA_OK);
+  handle_ = nullptr;
+  EXPECT_EQ(monitors, nullptr);
+}
+
+/**
+ * @test       finalize
+ * @brief      Test: power_thermal_finalize
+ * @details    Finalizing stops monitors that still have registrations,
+ *             and the handle then closes cleanly.<br>
+ */
+TEST_P(power_thermal_mock_p, finalize) {
+  ASSERT_EQ(xfpga_fpgaRegisterEvent(handle_, FPGA_EVENT_POWER_THERMAL,
+                                    eh_, 10), FPGA_OK);
+  ASSERT_NE(monitors, nullptr);
+
+  power_thermal_finalize();
+  EXPECT_EQ(monitors, nullptr);
+  EXPECT_EQ(power_thermal_unregister(handle_, eh_), FPGA_NOT_FOUND);
+}
+
+INSTANTIATE_TEST_CASE_P(power_thermal_c, power_thermal_mock_p,
+    ::testing::ValuesIn(test_platform::mock_platforms({"dcp-vc"})));
@@ -389,9 +389,10 @@ TEST_P(sysfs_c_p, sysfs_invalid_tests) {
   char spath[SYSFS_PATH_MAX];
   fpga_result res;
 
-  char invalid_string[] = "...";
-  strncpy(t->sysfspath, invalid_string, 4);
+  const char *sysfspath = t->sysfspath;
+  t->sysfspath = "...";
   res = get_port_sysfs(handle_, spath);
+  t->sysfspath = sysfspath;
   EXPECT_EQ(FPGA_INVALID_PARAM, res);
 
   h->token = NULL;
@@ -470,11 +471,8 @@ TEST(sysfs_c, cat_sysfs_path_errors) {
 */
 TEST(sysfs_c, cat_token_sysfs_path) {
   _fpga_token tok;
-  std::copy(single_sysfs_fme.begin(), single_sysfs_fme.end(),
-            &tok.sysfspath[0]);
-  tok.sysfspath[single_sysfs_fme.size()] = '\0';
-  std::copy(single_dev_fme.begin(), single_dev_fme.end(), &tok.devpath[0]);
-  tok.devpath[single_dev_fme.size()] = '\0';
+  tok.sysfspath = single_sysfs_fme.c_str();
+  tok.devpath = single_dev_fme.c_str();
   std::vector<char> buffer(256);
   EXPECT_EQ(cat_token_sysfs_path(buffer.data(), &tok, "bitstream_id"), FPGA_OK);
   EXPECT_STREQ(buffer.data(),
@@ -492,11 +490,8 @@ TEST(sysfs_c, cat_token_sysfs_path) {
 TEST(sysfs_c, cat_handle_sysfs_path) {
   _fpga_token tok;
   _fpga_handle hnd;
-  std::copy(single_sysfs_fme.begin(), single_sysfs_fme.end(),
-            &tok.sysfspath[0]);
-  tok.sysfspath[single_sysfs_fme.size()] = '\0';
-  std::copy(single_dev_fme.begin(), single_dev_fme.end(), &tok.devpath[0]);
-  tok.devpath[single_dev_fme.size()] = '\0';
+  tok.sysfspath = single_sysfs_fme.c_str();
+  tok.devpath = single_dev_fme.c_str();
   hnd.token = &tok;
   std::vector<char> buffer(256);
   EXPECT_EQ(cat_handle_sysfs_path(buffer.data(), &hnd, "bitstream_id"),
@@ -515,9 +510,13 @@ TEST(sysfs_c, cat_handle_sysfs_path) {
 */
 TEST_P(sysfs_c_p, make_object) {
   _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  char sysfspath[SYSFS_PATH_MAX];
+  // The path may be globbed in place, so use a copy.
+  strncpy(sysfspath, tok->sysfspath, SYSFS_PATH_MAX - 1);
+  sysfspath[SYSFS_PATH_MAX - 1] = '\0';
   fpga_object object;
   // errors is a sysfs directory - this should call make_sysfs_group()
-  ASSERT_EQ(make_sysfs_object(tok->sysfspath, "errors", &object, 0, 0),
+  ASSERT_EQ(make_sysfs_object(sysfspath, "errors", &object, 0, 0),
             FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
 }
@@ -620,12 +619,16 @@ TEST_P(sysfs_c_hw_p, make_sysfs) {
   const std::string invalid_path =
       "/sys/class/fpga/intel-fpga-dev.0/intel-fpga-fme";
   _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  char sysfspath[SYSFS_PATH_MAX];
+  // The path may be globbed in place, so use a copy.
+  strncpy(sysfspath, tok->sysfspath, SYSFS_PATH_MAX - 1);
+  sysfspath[SYSFS_PATH_MAX - 1] = '\0';
   fpga_object obj;
-  auto res = make_sysfs_group(tok->sysfspath, "errors", &obj, 0, handle_);
+  auto res = make_sysfs_group(sysfspath, "errors", &obj, 0, handle_);
   EXPECT_EQ(res, FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
 
-  res = make_sysfs_group(tok->sysfspath, "errors", &obj, FPGA_OBJECT_GLOB,
+  res = make_sysfs_group(sysfspath, "errors", &obj, FPGA_OBJECT_GLOB,
                          handle_);
   EXPECT_EQ(res, FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
@@ -634,7 +637,7 @@ TEST_P(sysfs_c_hw_p, make_sysfs) {
                          &obj, 0, handle_);
   EXPECT_EQ(res, FPGA_NOT_FOUND);
 
-  res = make_sysfs_group(tok->sysfspath, "errors", &obj,
+  res = make_sysfs_group(sysfspath, "errors", &obj,
                          FPGA_OBJECT_RECURSE_ONE, handle_);
   EXPECT_EQ(res, FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
@@ -646,9 +649,13 @@ TEST_P(sysfs_c_hw_p, make_sysfs) {
  */
 TEST_P(sysfs_c_hw_p, make_object_glob) {
   _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  char sysfspath[SYSFS_PATH_MAX];
+  // The path may be globbed in place, so use a copy.
+  strncpy(sysfspath, tok->sysfspath, SYSFS_PATH_MAX - 1);
+  sysfspath[SYSFS_PATH_MAX - 1] = '\0';
   fpga_object object;
   // errors is a sysfs directory - this should call make_sysfs_group()
-  ASSERT_EQ(make_sysfs_object(tok->sysfspath, "errors", &object,
+  ASSERT_EQ(make_sysfs_object(sysfspath, "errors", &object,
                               FPGA_OBJECT_GLOB, 0),
             FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
@@ -670,13 +677,17 @@ TEST_P(sysfs_c_mock_p, make_sysfs) {
   const std::string invalid_path =
       "/sys/class/fpga/intel-fpga-dev.0/intel-fpga-fme";
   _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  char sysfspath[SYSFS_PATH_MAX];
+  // The path may be globbed in place, so use a copy.
+  strncpy(sysfspath, tok->sysfspath, SYSFS_PATH_MAX - 1);
+  sysfspath[SYSFS_PATH_MAX - 1] = '\0';
   fpga_object obj;
 
-  auto res = make_sysfs_group(tok->sysfspath, "errors", &obj, 0, handle_);
+  auto res = make_sysfs_group(sysfspath, "errors", &obj, 0, handle_);
   EXPECT_EQ(res, FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
 
-  res = make_sysfs_group(tok->sysfspath, "errors", &obj, FPGA_OBJECT_GLOB,
+  res = make_sysfs_group(sysfspath, "errors", &obj, FPGA_OBJECT_GLOB,
                          handle_);
   EXPECT_EQ(res, FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&obj), FPGA_OK);
@@ -685,7 +696,7 @@ TEST_P(sysfs_c_mock_p, make_sysfs) {
                          &obj, 0, handle_);
   EXPECT_EQ(res, FPGA_NOT_FOUND);
 
-  res = make_sysfs_group(tok->sysfspath, "errors", &obj,
+  res = make_sysfs_group(sysfspath, "errors", &obj,
                          FPGA_OBJECT_RECURSE_ONE, handle_);
   EXPECT_EQ(res, FPGA_OK);
 
@@ -698,9 +709,13 @@ TEST_P(sysfs_c_mock_p, make_sysfs) {
  */
 TEST_P(sysfs_c_mock_p, make_object_glob) {
   _fpga_token *tok = static_cast<_fpga_token *>(tokens_[0]);
+  char sysfspath[SYSFS_PATH_MAX];
+  // The path may be globbed in place, so use a copy.
+  strncpy(sysfspath, tok->sysfspath, SYSFS_PATH_MAX - 1);
+  sysfspath[SYSFS_PATH_MAX - 1] = '\0';
   fpga_object object;
   // errors is a sysfs directory - this should call make_sysfs_group()
-  ASSERT_EQ(make_sysfs_object(tok->sysfspath, "errors", &object, 
+  ASSERT_EQ(make_sysfs_object(sysfspath, "errors", &object, 
                               FPGA_OBJECT_GLOB, 0),
             FPGA_OK);
   EXPECT_EQ(xfpga_fpgaDestroyObject(&object), FPGA_OK);
@@ -1304,10 +1319,9 @@ TEST_P(sysfs_sockid_c_p, sysfs_path_is_valid) {
  *          it returns FPGA_INVALID_PARAM. 
  */
 TEST_P(sysfs_sockid_c_p, get_port_sysfs) {
-  _fpga_handle *h = static_cast<_fpga_handle *>(handle_);
-  _fpga_token *tok = static_cast<_fpga_token *>(h->token);
+  char spath[SYSFS_PATH_MAX];
 
-  EXPECT_EQ(get_port_sysfs(handle_, tok->sysfspath), FPGA_OK);
+  EXPECT_EQ(get_port_sysfs(handle_, spath), FPGA_OK);
 }
 
 INSTANTIATE_TEST_CASE_P(sysfs_c, sysfs_sockid_c_p,
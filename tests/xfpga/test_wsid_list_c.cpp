@@ -48,16 +48,7 @@ extern "C" {
  * On hardware, the mmio map is a hash table.
  */
 static bool mmio_map_is_empty(struct wsid_tracker *root) {
-  if (!root || (root->n_hash_buckets == 0))
-    { return true; }
-  else{
-    uint64_t i;
-    for (i = 0; i < root->n_hash_buckets; ++i) {
-      if (root->table[i])
-        { return false; }
-    }
-  }
-   return true;
+  return !root || !root->count;
 }
 #else
  /*
@@ -119,7 +110,7 @@ class wsid_list_f : public ::testing::Test {
 /*
  * @test    wsid_init_neg
  *
- * @details When wsid_tracker_init()'s n_hash_buckets parameter
+ * @details When wsid_tracker_init()'s n_entries parameter
  *          is greater then the max, the function returns NULL.
  */
 TEST_F(wsid_list_f, wsid_init_neg) {
@@ -149,16 +140,7 @@ TEST_F(wsid_list_f, wsid_add) {
 TEST_F(wsid_list_f, wsid_del) {
   uint32_t wsid = index_to_wsid(distribution_(generator_));
   EXPECT_TRUE(wsid_del(wsid_root_, wsid));
-  wsid_map *it = wsid_find(wsid_root_, wsid);
-  // now look for the wsid in the list
-  while (it != nullptr) {
-    if (it->wsid == wsid) {
-      break;
-    }
-    it = it->next;
-  }
-  // it is null when we've looked at whole list without finding wsid
-  EXPECT_EQ(it, nullptr);
+  EXPECT_EQ(wsid_find(wsid_root_, wsid), nullptr);
   // it isn't there so we shouldn't be able to delete it again
   EXPECT_FALSE(wsid_del(wsid_root_, wsid));
 }
@@ -193,3 +175,75 @@ TEST_F(wsid_list_f, stress) {
   EXPECT_EQ(stress_count, 0);
   wsid_root_ = nullptr;
 }
+
+/*
+ * @test    del_reinsert
+ *
+ * @details Growing a small tracker and deleting every third entry
+ *          leaves every other entry reachable by wsid and by index.
+ */
+TEST(wsid_list, del_reinsert) {
+  const uint64_t count = 400;
+  struct wsid_tracker *root = wsid_tracker_init(4);
+  ASSERT_NE(root, nullptr);
+
+  uint64_t i;
+  for (i = 0; i < count; ++i) {
+    ASSERT_TRUE(wsid_add(root, index_to_wsid(i), index_to_addr(i),
+                         index_to_phys(i), index_to_len(i),
+                         index_to_offset(i), index_to_index(i),
+                         index_to_flags(i)));
+  }
+
+  for (i = 0; i < count; i += 3) {
+    EXPECT_TRUE(wsid_del(root, index_to_wsid(i)));
+  }
+
+  for (i = 0; i < count; ++i) {
+    wsid_map *ws = wsid_find(root, index_to_wsid(i));
+    if (i % 3) {
+      ASSERT_NE(ws, nullptr);
+      EXPECT_EQ(ws->addr, index_to_addr(i));
+      ws = wsid_find_by_index(root, index_to_index(i));
+      ASSERT_NE(ws, nullptr);
+      EXPECT_EQ(ws->wsid, index_to_wsid(i));
+    } else {
+      EXPECT_EQ(ws, nullptr);
+      EXPECT_EQ(wsid_find_by_index(root, index_to_index(i)), nullptr);
+    }
+  }
+
+  stress_count = count - (count + 2) / 3;
+  wsid_tracker_cleanup(root, cleanup_cb);
+  EXPECT_EQ(stress_count, 0);
+}
+
+/*
+ * @test    shared_index
+ *
+ * @details When the entry reachable by an index is deleted,
+ *          wsid_find_by_index() returns another entry with that
+ *          index, and NULL once none remain.
+ */
+TEST(wsid_list, shared_index) {
+  struct wsid_tracker *root = wsid_tracker_init(4);
+  ASSERT_NE(root, nullptr);
+
+  EXPECT_TRUE(wsid_add(root, 10, 0, 0, 0, 0, 1, 0));
+  EXPECT_TRUE(wsid_add(root, 11, 0, 0, 0, 0, 1, 0));
+
+  wsid_map *ws = wsid_find_by_index(root, 1);
+  ASSERT_NE(ws, nullptr);
+  uint64_t first = ws->wsid;
+
+  EXPECT_TRUE(wsid_del(root, first));
+  ws = wsid_find_by_index(root, 1);
+  ASSERT_NE(ws, nullptr);
+  EXPECT_NE(ws->wsid, first);
+
+  EXPECT_TRUE(wsid_del(root, ws->wsid));
+  EXPECT_EQ(wsid_find_by_index(root, 1), nullptr);
+  EXPECT_TRUE(mmio_map_is_empty(root));
+
+  wsid_tracker_cleanup(root, nullptr);
+}